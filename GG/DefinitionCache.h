@@ -0,0 +1,121 @@
+// -*- C++ -*-
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+   
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+    
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+    
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+/** \file DefinitionCache.h \brief Contains the DefinitionCache class, a
+    process-wide cache of parsed Adam and Eve definitions. */
+
+#ifndef _GG_DefinitionCache_h_
+#define _GG_DefinitionCache_h_
+
+#include <GG/ParsedDefinition.h>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <iosfwd>
+
+
+namespace GG {
+
+/** A bounded, process-wide cache of parsed Adam and Eve definitions, used by
+    ExecuteModalDialog() and MakeEveDialog() so that opening the same dialog
+    again does not parse its files again.  Each dialog still gets its own
+    sheet and view; only the parse result is shared.
+
+    Definitions loaded from files are keyed by path, and are reloaded if the
+    file's modification time or size changes.  Definitions read from streams
+    are keyed by a hash of their contents and their filename, and a hit is
+    only counted if the contents match exactly.  When the cache is full, the
+    least recently used definition is evicted.  The cache may be used from
+    multiple threads. */
+class GG_API DefinitionCache
+{
+public:
+    /** Hit, miss and size counts for the cache. */
+    struct Statistics
+    {
+        Statistics();
+
+        std::size_t m_hits;      ///< the number of lookups satisfied from the cache
+        std::size_t m_misses;    ///< the number of lookups that loaded or parsed a definition
+        std::size_t m_evictions; ///< the number of definitions dropped to stay within Capacity()
+        std::size_t m_entries;   ///< the number of definitions currently cached
+    };
+
+    /** \name Structors */ ///@{
+    ~DefinitionCache();
+    //@}
+
+    /** \name Accessors */ ///@{
+    std::size_t      Capacity() const;   ///< returns the maximum number of definitions kept
+    Statistics       GetStatistics() const; ///< returns the cache's statistics
+    //@}
+
+    /** \name Mutators */ ///@{
+    /** Returns the definition in the file \a path, as LoadDefinition() does,
+        loading it only if it is not cached or has changed on disk.  \throw
+        std::runtime_error, std::logic_error Throws as LoadDefinition()
+        does. */
+    ParsedDefinition Get(const boost::filesystem::path& path, ParsedDefinition::Language language);
+
+    /** Returns the definition read from the rest of \a is, the contents of
+        \a filename, parsing it only if the same contents have not been cached
+        under the same filename.  The contents may also be a precompiled
+        definition, in which case \a is must have been opened in binary mode
+        (std::ios::binary), so that its bytes are read unaltered.  \throw
+        std::runtime_error Throws if precompiled contents are corrupt or in
+        another language.  \throw std::logic_error Throws if the contents
+        cannot be parsed. */
+    ParsedDefinition Get(std::istream& is, const std::string& filename, ParsedDefinition::Language language);
+
+    /** Sets the maximum number of definitions kept, evicting the least
+        recently used ones if there are more.  A capacity of 0 disables
+        caching. */
+    void             SetCapacity(std::size_t entries);
+
+    void             Clear();           ///< removes all cached definitions; the statistics are kept
+    void             ResetStatistics(); ///< sets the hit, miss and eviction counts to 0
+    //@}
+
+    /** The capacity of a newly created cache. */
+    static const std::size_t DEFAULT_CAPACITY;
+
+private:
+    struct Impl;
+
+    DefinitionCache();
+
+    static void CreateInstance();
+
+    boost::scoped_ptr<Impl> m_impl;
+
+    friend GG_API DefinitionCache& GetDefinitionCache();
+};
+
+/** Returns the singleton DefinitionCache instance. */
+GG_API DefinitionCache& GetDefinitionCache();
+
+}
+
+#endif
@@ -31,9 +31,43 @@
 
 #include <GG/Base.h>
 
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+
 
 namespace GG {
 
+    /** \brief Counts of the rendering work done by GG during a single frame.
+
+        These are accumulated by the DrawUtil functions, Texture::OrthoBlit(),
+        Font::RenderGlyph(), the clipping functions and GUI::RenderWindow().
+        Rendering done directly through OpenGL by user code is not counted.
+        \see GUI::LastFrameRenderStats() */
+    struct GG_API RenderStats
+    {
+        RenderStats(); ///< Default ctor.  All counts are zero.
+
+        void Reset();  ///< Sets all counts to zero.
+
+        std::size_t draw_calls;      ///< The number of glBegin()/glEnd() blocks and glDrawArrays() calls
+        std::size_t state_changes;   ///< The number of glEnable()/glDisable()/glTexParameter() state changes
+        std::size_t texture_binds;   ///< The number of glBindTexture() calls
+        std::size_t scissor_pushes;  ///< The number of calls to BeginScissorClipping()
+        std::size_t stencil_pushes;  ///< The number of calls to BeginStencilClipping()
+        std::size_t windows_visited; ///< The number of Wnds rendered by GUI::RenderWindow()
+        std::size_t windows_culled;  ///< The number of visible Wnds GUI::RenderWindow() skipped because they lie outside the clip rect
+        std::size_t windows_occluded; ///< The number of top-level Wnds GUI::Render() skipped because they were behind an opaque Wnd
+        std::size_t glyphs;          ///< The number of glyphs drawn by Font::RenderGlyph()
+        std::size_t state_queries;   ///< The number of glGet*() calls made by the clipping functions to fill or check their copy of the GL state
+        std::size_t stalls_avoided;  ///< The number of redundant glScissor(), glEnable(), glDisable() and glClearStencil() calls the clipping functions skipped, because their copy of the GL state showed the state was already set
+    };
+
+    /** Returns the RenderStats being accumulated for the frame currently
+        being rendered.  GUI::Render() resets this at the start of each
+        frame. */
+    GG_API RenderStats& FrameRenderStats();
+
     /** Calls the appropriate version of glColor*() with \a clr. */
     GG_API void glColor(Clr clr);
 
@@ -69,12 +103,40 @@ namespace GG {
         throughout the GG classes to render disabled controls. */
     GG_API Clr DisabledColor(Clr clr);
 
+    /** Forgets the CPU-side copy of the GL state kept by the clipping
+        functions below.  Rather than query or push GL state each time
+        clipping begins, they read the write masks, the scissor box and the
+        scissor and stencil enables once per frame, and keep track of their
+        own changes after that.  GUI::Render() calls this at the start of
+        each frame; code that changes that state outside of the clipping
+        functions in the middle of a frame, such as a Wnd::Render() that sets
+        its own color mask or scissor box, must call it too. */
+    GG_API void ResetGLStateCache();
+
+    /** Checks the copy of the GL state kept by the clipping functions
+        against GL.  Returns true if they match; otherwise, calls
+        ResetGLStateCache() and returns false.  The write masks are always
+        checked; the scissor and stencil state only outside of any
+        clipping.  This queries GL, so it stalls the pipeline; only when GG
+        is configured with VERIFY_GL_STATE_CACHE does GUI::RenderWindow()
+        call it, asserting on the result, after each Wnd::Render(). */
+    GG_API bool VerifyGLStateCache();
+
+    /** Returns true iff BeginScissorClipping() has been called more times
+        than EndScissorClipping(). */
+    GG_API bool ScissorClippingActive();
+
+    /** Returns the region the innermost scissor clipping currently
+        restricts drawing to, in GG screen coordinates.  \pre
+        ScissorClippingActive() */
+    GG_API Rect ActiveScissorClippingRegion();
+
     /** Sets up a GL scissor box, so that everything outside of the screen
         region defined by points \a ul and \a lr is clipped out.  These
         coordinates should be in GG screen coordinates, with +y downward,
         instead of GL's screen coordinates.  \note Failing to call
-        EndScissorClipping() after calling this function and before the next
-        unmatched glPopAttrib() call may produce unexpected results. */
+        EndScissorClipping() after calling this function may produce
+        unexpected results. */
     GG_API void BeginScissorClipping(Pt ul, Pt lr);
 
     /** Ends the current GL scissor box, restoring GL scissor state to what it
@@ -86,9 +148,10 @@ namespace GG {
         defined by points \a inner_ul and \a inner_lr, or outside of the
         screen region defined by points \a outer_ul and \a outer_lr, is
         clipped out.  \note Failing to call EndStencilClipping() after calling
-        this function and before the next unmatched glPopAttrib() call may
-        produce unexpected results.  \note An unnested call to
-        BeginStencilClipping() will clear the stencil buffer.  \pre There are
+        this function may produce unexpected results.  \note An unnested call
+        to BeginStencilClipping() will clear the stencil buffer; the stencil
+        function, operations and clear value are put back by the matching
+        EndStencilClipping().  \pre There are
         no more than GL_STENCIL_BITS - 1 nested calls to
         BeginStencilClipping() currently outstanding (each nested call uses a
         separate bit in the stencil buffer). */
@@ -159,6 +222,69 @@ namespace GG {
         rectangle. */
     GG_API void BubbleRectangle(Pt ul, Pt lr, Clr color, bool up, unsigned int corner_radius = 5);
 
+    /** \brief Colored geometry that is sent to OpenGL once, and then drawn as
+        many times as needed with a single call.
+
+        Vertices are added as arrays of float x, y pairs, each with its own
+        color.  The first time the geometry is rendered, it is compiled into
+        an OpenGL display list; each Render() after that is one
+        glCallList().  The client-side copy of the vertices is kept, so
+        primitives may still be added after a Render(); the next Render()
+        compiles all of them into a new list.  This suits shapes that are
+        drawn every frame but rarely change, like color gradients.  The vertices are drawn in the current modelview
+        transformation, so a shape built in a unit square can be placed and
+        sized with glTranslate() and glScale(). */
+    class GG_API RetainedGeometry : boost::noncopyable
+    {
+    public:
+        /** \name Structors */ ///@{
+        RetainedGeometry();  ///< default ctor
+        ~RetainedGeometry(); ///< dtor; frees the display list, if any
+        //@}
+
+        /** \name Accessors */ ///@{
+        bool        Empty() const;    ///< returns true iff no vertices have been added since construction or the last Clear()
+        std::size_t Vertices() const; ///< returns the number of vertices added since construction or the last Clear()
+        //@}
+
+        /** \name Mutators */ ///@{
+        /** Adds a primitive of type \a mode (GL_TRIANGLES, GL_QUAD_STRIP,
+            etc.), with the vertices in \a vertices (x, y pairs) colored by
+            the corresponding colors in \a colors.  \pre \a vertices.size()
+            == 2 * \a colors.size() */
+        void Add(GLenum mode, const std::vector<GLfloat>& vertices, const std::vector<Clr>& colors);
+
+        /** Draws all the primitives added so far, compiling them into a
+            display list first if that has not yet been done.  Does nothing
+            if Empty(). */
+        void Render();
+
+        void Clear(); ///< removes all primitives, and frees the display list
+        //@}
+
+    private:
+        struct Primitive
+        {
+            GLenum      mode;
+            std::size_t first;
+            std::size_t count;
+        };
+
+        std::vector<GLfloat>   m_vertices;
+        std::vector<Clr>       m_colors;
+        std::vector<Primitive> m_primitives;
+        std::size_t            m_vertex_count;
+        GLuint                 m_display_list;
+    };
+
+    /** Starts a new frame for the geometry that CircleArc() (and so the
+        circles and rounded rectangles) caches by size, bevel, angles and
+        colors.  Every arc drawn in the previous frame stays cached, however
+        many there were; arcs that have gone undrawn are dropped, least
+        recently drawn first, once more than a few hundred are cached.
+        GUI::Render() calls this at the start of each frame. */
+    GG_API void BeginGeometryCacheFrame();
+
 }
 
 #endif
@@ -37,6 +37,7 @@
 
 namespace GG {
 class Texture;
+class Timer;
 
 /** \brief A control that replays images in sequence, forwards or backwards,
     animated or one frame at a time.
@@ -64,7 +65,19 @@ class Texture;
     GG does not apply; when you set the end frame index to N, the last frame
     to be shown will be N, not N - 1. Also, while this control does not need
     to be the same size as the frames replayed within it, the size of the
-    frames is taken from the size of the control when it is contructed. */
+    frames is taken from the size of the control when it is contructed.
+    Textures that are still being loaded asynchronously (see
+    TextureManager::GetTextureAsync()) may be used; a placeholder is shown in
+    place of their frames until they finish loading.  The frames are split
+    out of their Textures once, by TextureManager::GetAnimationFrames(),
+    which packs small frames into shared animation atlas pages, so that the
+    frames of many DynamicGraphics come from the same few textures.  All
+    DynamicGraphics are advanced together, by a single Timer that fires at
+    the start of each GUI::Render(), rather than each one reading the clock
+    in its own Render().  DynamicGraphics that are not being drawn, because
+    they or an ancestor are hidden or their root window is not registered
+    with the GUI, are not advanced (and emit no signals) until they are
+    shown again. */
 class GG_API DynamicGraphic : public Control
 {
 public:
@@ -72,15 +85,16 @@ public:
     /** Emitted whenever playback ends because the last frame was reached and
         Looping() == false; the argument is the index of the last frame (may
         be the first frame, if playing in reverse).  \note Unlike most other
-        signals, this one is emitted during the execution of Render(), so keep
-        this in mind when processing this signal.*/
+        signals, this one is emitted during the execution of GUI::Render(),
+        while the animations are advanced, so keep this in mind when
+        processing this signal.*/
     typedef boost::signal<void (std::size_t)> StoppedSignalType;
 
     /** Emitted whenever the last frame of animation is reached; the argument
         is the index of the last frame (may be the first frame, if playing in
         reverse).  \note Unlike most other signals, this one is emitted during
-        the execution of Render(), so keep this in mind when processing this
-        signal.*/
+        the execution of GUI::Render(), while the animations are advanced, so
+        keep this in mind when processing this signal.*/
     typedef boost::signal<void (std::size_t)> EndFrameSignalType;
     //@}
 
@@ -96,6 +110,8 @@ public:
                    const std::vector<boost::shared_ptr<Texture> >& textures,
                    Flags<GraphicStyle> style = GRAPHIC_NONE, std::size_t frames = ALL_FRAMES,
                    Flags<WndFlag> flags = Flags<WndFlag>());
+
+    ~DynamicGraphic(); ///< dtor
     //@}
 
     /** \name Accessors */ ///@{
@@ -206,8 +222,9 @@ public:
 protected:
     struct FrameSet
     {
-        boost::shared_ptr<const Texture> texture; ///< the texture with the frames in it
-        std::size_t                      frames;  ///< the number of frames in this texture
+        boost::shared_ptr<const Texture> texture;     ///< the texture with the frames in it
+        std::size_t                      frames;      ///< the number of frames in this texture
+        std::vector<SubTexture>          subtextures; ///< the frames themselves; empty until they are first rendered
     };
 
     /** \name Accessors */ ///@{
@@ -226,6 +243,11 @@ protected:
 
 private:
     void ValidateStyle();             ///< ensures that the style flags are consistent
+    void Advance(unsigned int ticks); ///< advances playback to the time \a ticks, emitting any signals that result
+
+    /** Advances all DynamicGraphics to the time \a ticks; this is connected
+        to the shared animation Timer \a timer. */
+    static void AdvanceAll(unsigned int ticks, Timer* timer);
 
     std::vector<FrameSet> m_textures; ///< shared_ptrs to texture objects with all animation frames
 
@@ -58,6 +58,7 @@ namespace adobe {
 namespace GG {
 
 class EveDialog;
+class ParsedDefinition;
 class TextControl;
 
 /** Contains the result of a modal dialog created by ExecuteModalDialog(). */
@@ -131,8 +132,9 @@ typedef std::map<adobe::name_t, ArrayFunction> ArrayFunctions;
 
 
 /** Returns the result of executing the modal dialog described by \a
-    eve_definition and \a adam_definition.  \see ButtonHandler.  \see
-    SignalHandler. */
+    eve_definition and \a adam_definition.  Either file may be a source file
+    or a precompiled definition (see LoadDefinition()).  \see ButtonHandler.
+    \see SignalHandler. */
 ModalDialogResult ExecuteModalDialog(const boost::filesystem::path& eve_definition,
                                      const boost::filesystem::path& adam_definition,
                                      ButtonHandler button_handler,
@@ -184,8 +186,26 @@ ModalDialogResult ExecuteModalDialog(std::istream& eve_definition,
                                      SignalHandler signal_handler = SignalHandler(),
                                      RowFactory row_factory = RowFactory());
 
+/** Returns the result of executing the modal dialog described by the
+    already-parsed \a eve_definition and \a adam_definition.  The functions
+    provided in \a dictionary_functions and \a array_functions will be
+    available in the associated Adam and Eve scripts.  They will override any
+    functions with the same name registered with RegisterDictionaryFunction()
+    and RegisterArrayFunction(), respectively.  \see ButtonHandler.  \see
+    SignalHandler.  \see ParsedDefinition. */
+ModalDialogResult ExecuteModalDialog(const ParsedDefinition& eve_definition,
+                                     const ParsedDefinition& adam_definition,
+                                     const DictionaryFunctions& dictionary_functions,
+                                     const ArrayFunctions& array_functions,
+                                     const AdamFunctions& adam_functions,
+                                     ButtonHandler button_handler,
+                                     SignalHandler signal_handler = SignalHandler(),
+                                     RowFactory row_factory = RowFactory());
+
 /** Parses \a eve_definition and \a adam_definition, then instantiates and
-    returns an EveDialog.  \see ButtonHandler.  \see SignalHandler. */
+    returns an EveDialog.  Either file may be a source file or a precompiled
+    definition (see LoadDefinition()).  \see ButtonHandler.  \see
+    SignalHandler. */
 EveDialog* MakeEveDialog(const boost::filesystem::path& eve_definition,
                          const boost::filesystem::path& adam_definition,
                          ButtonHandler button_handler,
@@ -234,6 +254,22 @@ EveDialog* MakeEveDialog(std::istream& eve_definition,
                          SignalHandler signal_handler = SignalHandler(),
                          RowFactory row_factory = RowFactory());
 
+/** Instantiates and returns an EveDialog from the already-parsed \a
+    eve_definition and \a adam_definition.  The functions provided in \a
+    dictionary_functions and \a array_functions will be available in the
+    associated Adam and Eve scripts.  They will override any functions with
+    the same name registered with RegisterDictionaryFunction() and
+    RegisterArrayFunction(), respectively.  \see ButtonHandler.  \see
+    SignalHandler.  \see ParsedDefinition. */
+EveDialog* MakeEveDialog(const ParsedDefinition& eve_definition,
+                         const ParsedDefinition& adam_definition,
+                         const DictionaryFunctions& dictionary_functions,
+                         const ArrayFunctions& array_functions,
+                         const AdamFunctions& adam_functions,
+                         ButtonHandler button_handler,
+                         SignalHandler signal_handler = SignalHandler(),
+                         RowFactory row_factory = RowFactory());
+
 /** Usable as a SignalHandler, providing a convenient interface for handling a
     multitude of signals with separate SignalHandlers. */
 class DefaultSignalHandler
@@ -345,10 +381,8 @@ private:
                                    adobe::window_t&);
 
 
-    friend ModalDialogResult ExecuteModalDialog(std::istream& eve_definition,
-                                                const std::string& eve_filename,
-                                                std::istream& adam_definition,
-                                                const std::string& adam_filename,
+    friend ModalDialogResult ExecuteModalDialog(const ParsedDefinition& eve_definition,
+                                                const ParsedDefinition& adam_definition,
                                                 const DictionaryFunctions& dictionary_functions,
                                                 const ArrayFunctions& array_functions,
                                                 const AdamFunctions& adam_functions,
@@ -356,10 +390,8 @@ private:
                                                 SignalHandler signal_handler,
                                                 RowFactory row_factory);
 
-    friend EveDialog* MakeEveDialog(std::istream& eve_definition,
-                                    const std::string& eve_filename,
-                                    std::istream& adam_definition,
-                                    const std::string& adam_filename,
+    friend EveDialog* MakeEveDialog(const ParsedDefinition& eve_definition,
+                                    const ParsedDefinition& adam_definition,
                                     const DictionaryFunctions& dictionary_functions,
                                     const ArrayFunctions& array_functions,
                                     const AdamFunctions& adam_functions,
@@ -58,6 +58,7 @@ namespace boost {
 namespace GG {
 
 class Cursor;
+struct RenderStats;
 class Wnd;
 class EventPumpBase;
 class ModalEventPump;
@@ -206,6 +207,10 @@ public:
     double         FPS() const;                        ///< returns the frames per second at which the GUI is rendering
     std::string    FPSString() const;                  ///< returns a string of the form "[m_FPS] frames per second"
     double         MaxFPS() const;                     ///< returns the maximum allowed frames per second of rendering speed.  0 indicates no limit.
+    const RenderStats&
+                   LastFrameRenderStats() const;       ///< returns the rendering statistics gathered during the most recently completed frame
+    std::string    RenderStatsString() const;          ///< returns a one-line summary of LastFrameRenderStats()
+    bool           RenderStatsOverlayEnabled() const;  ///< returns true iff FPSString() and RenderStatsString() are drawn over the upper-left corner of the screen each frame
     virtual X      AppWidth() const = 0;               ///< returns the width of the application window/screen
     virtual Y      AppHeight() const = 0;              ///< returns the height of the application window/screen
     unsigned int   ButtonDownRepeatDelay() const;      ///< returns the \a delay value set by EnableMouseButtonDownRepeat()
@@ -215,6 +220,7 @@ public:
     unsigned int   MinDragDistance() const;            ///< returns the minimum distance an item must be dragged before it is a valid drag
     bool           DragDropWnd(const Wnd* wnd) const;  ///< returns true if \a wnd is currently begin dragged as part of a drag-and-drop operation
     bool           AcceptedDragDropWnd(const Wnd* wnd) const; ///< returns true if \a wnd is currently begin dragged as part of a drag-and-drop operation, and it is over a drop target that will accept it
+    bool           Registered(const Wnd* wnd) const;   ///< returns true iff \a wnd is in the z-list, is a modal window, or is being dragged as part of a drag-and-drop operation; that is, iff \a wnd and its children are rendered when Visible()
     bool           MouseButtonDown(unsigned int bn) const; ///< returns the up/down states of the mouse buttons
     Pt             MousePosition() const;              ///< returns the absolute position of mouse, based on the last mouse motion event
     Pt             MouseMovement() const;              ///< returns the relative position of mouse, based on the last mouse motion event
@@ -292,6 +298,7 @@ public:
     virtual void   Exit2DMode() = 0;             ///< restores GL to its condition prior to Enter2DMode() call
     void           EnableFPS(bool b = true);     ///< turns FPS calulations on or off
     void           SetMaxFPS(double max);        ///< sets the maximum allowed FPS, so the render loop does not act as a spinlock when it runs very quickly.  0 indicates no limit.
+    void           EnableRenderStatsOverlay(bool b = true); ///< turns the render statistics overlay on or off
     void           EnableMouseButtonDownRepeat(unsigned int delay, unsigned int interval); ///< delay and interval are in ms; Setting delay to 0 disables mouse button-down repeating completely.
     void           SetDoubleClickInterval(unsigned int interval); ///< sets the maximum interval allowed between clicks that is still considered a double-click, in ms
     void           SetMinDragTime(unsigned int time);     ///< sets the minimum time (in ms) an item must be dragged before it is a valid drag
@@ -360,6 +367,8 @@ public:
 
     boost::shared_ptr<Texture> StoreTexture(const boost::shared_ptr<Texture> &texture, const std::string& texture_name); ///< adds an already-constructed texture to the managed pool
     boost::shared_ptr<Texture> GetTexture(const std::string& name, bool mipmap = false); ///< loads the requested texture from file \a name; mipmap textures are generated if \a mipmap is true
+    SubTexture                 GetSubTexture(const std::string& name); ///< returns the image from file \a name, packed into a shared atlas page if it is small enough \see TextureManager::GetSubTexture()
+    boost::shared_ptr<Texture> GetTextureAsync(const std::string& name, bool mipmap = false); ///< starts loading the requested texture from file \a name in the background, and returns it immediately \see TextureManager::GetTextureAsync()
     void                       FreeTexture(const std::string& name); ///< removes the desired texture from the managed pool; since shared_ptr's are used, the texture may be deleted much later
 
     void SetStyleFactory(const boost::shared_ptr<StyleFactory>& factory); ///< sets the currently-installed style factory
@@ -370,7 +379,11 @@ public:
     //@}
 
     static GUI*  GetGUI();                ///< allows any GG code access to GUI framework by calling GUI::GetGUI()
-    static void  RenderWindow(Wnd* wnd);  ///< renders a window (if it is visible) and all its visible descendents recursively
+    /** Renders a window (if it is visible) and all its visible descendents
+        recursively.  Descendents that lie entirely outside the region their
+        parents clip them to, or outside the screen or the active scissor
+        clipping region, are skipped along with their own descendents. */
+    static void  RenderWindow(Wnd* wnd);
 
     /** \name Exceptions */ ///@{
     /** The base class for GUI exceptions. */
@@ -407,6 +420,10 @@ private:
     // DragDrop{Enter|Leave} as appropriate
     Wnd*           CheckedGetWindowUnder(const Pt& pt, Flags<ModKey> mod_keys);
 
+    // Renders \a wnd and its descendents, skipping those that lie entirely
+    // outside \a clip_rect, the region \a wnd's parent clips it to
+    static void    RenderWindow(Wnd* wnd, const Rect& clip_rect);
+
     static GUI*                       s_gui;
     static boost::shared_ptr<GUIImpl> s_impl;
 
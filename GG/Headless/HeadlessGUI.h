@@ -0,0 +1,170 @@
+// -*- C++ -*-
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+   
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+    
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+    
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+/** \file HeadlessGUI.h \brief Contains HeadlessGUI, a driver that renders
+    GG off-screen with software OpenGL, for use in tests and benchmarks. */
+
+#ifndef _GG_HeadlessGUI_h_
+#define _GG_HeadlessGUI_h_
+
+#include <GG/GUI.h>
+
+#include <deque>
+#include <vector>
+
+
+#ifdef _MSC_VER
+# ifdef GiGiHeadless_EXPORTS
+#  define GG_HEADLESS_API __declspec(dllexport)
+# else
+#  define GG_HEADLESS_API __declspec(dllimport)
+# endif
+#else
+# define GG_HEADLESS_API
+#endif
+
+struct osmesa_context;
+
+namespace GG {
+
+/** \brief This is a singleton class that represents the GUI framework of an
+    application with no window, no display, and no input devices.
+
+    <p>HeadlessGUI renders into an off-screen OSMesa buffer of AppWidth() x
+    AppHeight() pixels, so it can run on build machines with no display at
+    all.  Everything that reads the frame buffer works as usual; in
+    particular, SaveWndAsPNG() can be used to capture rendered frames.
+
+    <p>Time does not pass on its own.  Ticks() returns a clock that is under
+    the control of the user: it advances by FrameTicks() milliseconds after
+    each rendered frame, and can be set or advanced directly with SetTicks()
+    and AdvanceTicks().  This makes Timer-driven code run identically from
+    one run to the next.
+
+    <p>Input comes from a script of events queued up with ScriptEvent().
+    Each event is stamped with the time at which it should be delivered;
+    HandleSystemEvents() sends each scripted event to HandleGGEvent() once
+    Ticks() reaches its time stamp.
+
+    <p>Run() returns after MaxFrames() frames have been rendered, or when
+    Exit() is called.  Like SDLGUI, HeadlessGUI is designed so the main() of
+    the application can consist of just the one line "gui();". */
+class GG_HEADLESS_API HeadlessGUI : public GUI
+{
+public:
+    /** \brief A single scripted input event. */
+    struct GG_HEADLESS_API ScriptedEvent
+    {
+        ScriptedEvent(); ///< default ctor
+        ScriptedEvent(unsigned int ticks_, EventType event_, Key key_, boost::uint32_t key_code_point_,
+                      Flags<ModKey> mod_keys_, const Pt& pos_, const Pt& rel_); ///< ctor
+
+        unsigned int    ticks;          ///< the time at which the event is delivered
+        EventType       event;
+        Key             key;
+        boost::uint32_t key_code_point;
+        Flags<ModKey>   mod_keys;
+        Pt              pos;
+        Pt              rel;
+    };
+
+    /** \name Structors */ ///@{
+    explicit HeadlessGUI(int w = 1024, int h = 768, const std::string& app_name = "GG"); ///< ctor
+    virtual ~HeadlessGUI();
+    //@}
+
+    /** \name Accessors */ ///@{
+    virtual X AppWidth() const;
+    virtual Y AppHeight() const;
+    virtual unsigned int Ticks() const;
+
+    unsigned int   FrameTicks() const;    ///< returns the number of milliseconds the clock advances after each frame
+    std::size_t    MaxFrames() const;     ///< returns the number of frames after which Run() returns; 0 means no limit
+    std::size_t    FramesRendered() const; ///< returns the number of frames rendered so far
+    std::size_t    PendingScriptedEvents() const; ///< returns the number of scripted events not yet delivered
+    //@}
+
+    /** \name Mutators */ ///@{
+    void           operator()();      ///< external interface to Run()
+    virtual void   Exit(int code);
+    virtual void   Wait(unsigned int ms); ///< advances the clock by \a ms milliseconds, instead of sleeping
+
+    virtual void   Enter2DMode();
+    virtual void   Exit2DMode();
+
+    void           SetTicks(unsigned int ticks);       ///< sets the clock to \a ticks
+    void           AdvanceTicks(unsigned int ticks);   ///< advances the clock by \a ticks milliseconds
+    void           SetFrameTicks(unsigned int ticks);  ///< sets the number of milliseconds the clock advances after each frame; 0 means the clock only moves when set explicitly
+    void           SetMaxFrames(std::size_t frames);   ///< sets the number of frames after which Run() returns; 0 means no limit
+
+    /** Queues \a event for delivery once Ticks() >= \a event.ticks.  Events
+        with equal time stamps are delivered in the order they were
+        queued. */
+    void           ScriptEvent(const ScriptedEvent& event);
+
+    /** Queues a mouse event of type \a event at \a pos for delivery once
+        Ticks() >= \a ticks. */
+    void           ScriptEvent(unsigned int ticks, EventType event, const Pt& pos, Flags<ModKey> mod_keys = Flags<ModKey>());
+
+    void           ClearScriptedEvents(); ///< discards all undelivered scripted events
+    //@}
+
+    static HeadlessGUI* GetGUI(); ///< allows any code to access the gui framework by calling HeadlessGUI::GetGUI()
+
+protected:
+    void SetAppSize(const GG::Pt& size);
+
+    // these are called at the beginning of the gui's execution
+    virtual void   HeadlessInit();   ///< creates the off-screen OpenGL context
+    virtual void   GLInit();         ///< allows user to specify OpenGL initialization code; called at the end of HeadlessInit()
+    virtual void   Initialize();     ///< provides one-time gui initialization
+
+    virtual void   HandleSystemEvents();
+
+    virtual void   RenderBegin();
+    virtual void   RenderEnd();
+
+    // these are called at the end of the gui's execution
+    virtual void   FinalCleanup();   ///< provides one-time gui cleanup
+    virtual void   HeadlessQuit();   ///< destroys the off-screen OpenGL context
+
+    virtual void   Run();
+
+private:
+    X                          m_app_width;      ///< application width and height (defaults to 1024 x 768)
+    Y                          m_app_height;
+    unsigned int               m_ticks;
+    unsigned int               m_frame_ticks;
+    std::size_t                m_max_frames;
+    std::size_t                m_frames_rendered;
+    bool                       m_done;
+    std::deque<ScriptedEvent>  m_scripted_events; ///< kept sorted by time stamp
+    osmesa_context*            m_context;
+    std::vector<unsigned char> m_color_buffer;
+};
+
+} // namespace GG
+
+#endif
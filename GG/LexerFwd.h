@@ -28,6 +28,7 @@
 #ifndef _GG_LexerFwd_h_
 #define _GG_LexerFwd_h_
 
+#include <GG/TableLexer.h>
 #include <GG/adobe/name.hpp>
 
 #include <boost/spirit/home/support/iterators/line_pos_iterator.hpp>
@@ -51,7 +52,7 @@ typedef boost::spirit::lex::lexertl::position_token<
     >
 > token_type;
 
-typedef boost::spirit::lex::lexertl::actor_lexer<token_type> spirit_lexer_base_type;
+typedef detail::table_lexer<token_type> spirit_lexer_base_type;
 
 }
 
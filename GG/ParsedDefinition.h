@@ -0,0 +1,136 @@
+// -*- C++ -*-
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+   
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+    
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+    
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+/** \file ParsedDefinition.h \brief Contains the ParsedDefinition class, which
+    holds the result of parsing an Adam or Eve definition, and the functions
+    that read and write its precompiled binary form. */
+
+#ifndef _GG_ParsedDefinition_h_
+#define _GG_ParsedDefinition_h_
+
+#include <GG/Export.h>
+#include <GG/adobe/array.hpp>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <iosfwd>
+#include <string>
+
+
+namespace adobe {
+    struct adam_callback_suite_t;
+    struct eve_callback_suite_t;
+}
+
+namespace boost {
+    class any;
+}
+
+namespace GG {
+
+/** The result of parsing an Adam or Eve definition.  A definition records the
+    callbacks the parser made, in order, with their arguments (expressions,
+    positions, names and comments).  Replaying it into a callback suite has
+    the same effect as parsing the source again, without running the parser.
+    Copies share their records, so a ParsedDefinition is cheap to copy.
+
+    A definition can be written out in a compact binary form with Write(),
+    and read back with Read() or LoadDefinition().  The binary form uses the
+    byte order of the machine that wrote it; Read() rejects files written
+    with a different byte order. */
+class GG_API ParsedDefinition
+{
+public:
+    /** The language of a definition. */
+    enum Language {
+        ADAM,
+        EVE
+    };
+
+    /** \name Structors */ ///@{
+    ParsedDefinition(); ///< Constructs an empty Adam definition.
+    //@}
+
+    /** \name Accessors */ ///@{
+    Language              GetLanguage() const; ///< Returns the language of the definition.
+    bool                  Empty() const;       ///< Returns true iff the definition has no records.
+
+    /** Returns the recorded callbacks, one array per callback.  The layout of
+        each record is an implementation detail, but two definitions with
+        equal records replay identically. */
+    const adobe::array_t& Records() const;
+
+    /** Makes the Adam callbacks recorded in this definition on \a callbacks.
+        \throw std::logic_error Throws if this is not an Adam definition. */
+    void                  Replay(const adobe::adam_callback_suite_t& callbacks) const;
+
+    /** Makes the Eve callbacks recorded in this definition on \a callbacks.
+        Views at the top level of the definition are added to \a parent.
+        \throw std::logic_error Throws if this is not an Eve definition. */
+    void                  Replay(const boost::any& parent,
+                                 const adobe::eve_callback_suite_t& callbacks) const;
+
+    /** Writes the precompiled binary form of the definition to \a os, which
+        should be opened in binary mode.  \throw std::runtime_error Throws if
+        a record contains a value that cannot be written. */
+    void                  Write(std::ostream& os) const;
+    //@}
+
+    /** \name Mutators */ ///@{
+    /** Parses \a text, the contents of \a filename, as \a language, and
+        replaces this definition's records with the result.  Returns false,
+        leaving the definition empty, if the parse fails; the error will have
+        been reported as by GG::Parse(). */
+    bool                  Parse(Language language, const std::string& text, const std::string& filename);
+
+    /** Replaces this definition with the precompiled definition in [\a data,
+        \a data + \a size).  \throw std::runtime_error Throws if the data are
+        not a valid precompiled definition. */
+    void                  Read(const char* data, std::size_t size);
+    //@}
+
+    /** Returns true iff [\a data, \a data + \a size) begins like a
+        precompiled definition. */
+    static bool           IsPrecompiled(const char* data, std::size_t size);
+
+private:
+    Language                                m_language;
+    boost::shared_ptr<const adobe::array_t> m_records;
+};
+
+/** Returns the definition in the file \a path, which may be an Adam or Eve
+    source file or a precompiled definition.  The file is memory-mapped rather
+    than read.  Source files are parsed as \a language; a precompiled file
+    must have been precompiled from \a language.  \throw std::runtime_error
+    Throws if the file cannot be mapped, or if a precompiled file is corrupt
+    or in another language.  \throw std::logic_error Throws if a source file
+    cannot be parsed. */
+GG_API ParsedDefinition LoadDefinition(const boost::filesystem::path& path,
+                                       ParsedDefinition::Language language);
+
+}
+
+#endif
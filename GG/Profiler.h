@@ -0,0 +1,189 @@
+// -*- C++ -*-
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+/** \file Profiler.h \brief Contains the Profiler class and the GG_PROFILE_*
+    macros, which time the phases of each GUI frame. */
+
+#ifndef _GG_Profiler_h_
+#define _GG_Profiler_h_
+
+#include <GG/Config.h>
+#include <GG/Export.h>
+
+#include <boost/cstdint.hpp>
+#include <boost/preprocessor/cat.hpp>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+namespace GG {
+
+/** \brief Records nested, timed zones for each GUI frame into a ring buffer
+    of the most recent frames.
+
+    Zones are normally opened and closed with the GG_PROFILE_ZONE() and
+    GG_PROFILE_ZONE_DETAIL() macros, and frames are delimited with
+    GG_PROFILE_FRAME().  All of these macros expand to nothing unless GG was
+    configured with ENABLE_PROFILING, so instrumented code costs nothing in
+    a normal build.  The Profiler is not threadsafe; zones should only be
+    opened from the GUI thread.
+
+    The recorded frames can be written out with WriteChromeTrace(), and the
+    result loaded into chrome://tracing or any other viewer that understands
+    the Chrome trace event format. */
+class GG_API Profiler
+{
+public:
+    /** A single timed zone.  Times are in microseconds since the Profiler
+        was created. */
+    struct GG_API Zone
+    {
+        /** The size of the detail buffer, including its terminating
+            null.  Longer detail text is truncated. */
+        static const std::size_t DETAIL_SIZE = 64;
+
+        Zone();
+        Zone(const char* name, const char* detail, boost::uint64_t begin, std::size_t depth);
+
+        const char*     name;   ///< The name of the zone; must be a string literal, or otherwise outlive the Profiler
+        char            detail[DETAIL_SIZE]; ///< Extra information about this zone (e.g. the name of the Wnd being rendered); may be empty
+        boost::uint64_t begin;  ///< The time at which the zone was opened
+        boost::uint64_t end;    ///< The time at which the zone was closed
+        std::size_t     depth;  ///< The number of zones enclosing this one
+    };
+
+    /** All the zones recorded during one frame, in the order they were
+        opened. */
+    struct GG_API Frame
+    {
+        Frame();
+
+        std::size_t       number; ///< The sequence number of this frame
+        boost::uint64_t   begin;  ///< The time at which the frame started
+        boost::uint64_t   end;    ///< The time at which the frame ended
+        std::vector<Zone> zones;  ///< The zones recorded during the frame
+    };
+
+    /** \name Accessors */ ///@{
+    bool         Enabled() const;       ///< Returns true iff zones are currently being recorded
+    std::size_t  Capacity() const;      ///< Returns the number of frames kept in the ring buffer
+    std::size_t  FramesRecorded() const; ///< Returns the number of complete frames currently held in the ring buffer
+
+    /** Returns the complete frame \a frames_ago frames before the most
+        recent one.  \a frames_ago must be less than FramesRecorded(). */
+    const Frame& RecordedFrame(std::size_t frames_ago = 0) const;
+
+    /** Returns the current time, in microseconds since the Profiler was
+        created. */
+    boost::uint64_t Now() const;
+
+    /** Writes all complete frames in the ring buffer to \a os, in the Chrome
+        trace event JSON format. */
+    void         WriteChromeTrace(std::ostream& os) const;
+
+    /** Writes all complete frames in the ring buffer to the file \a
+        filename, in the Chrome trace event JSON format. */
+    void         WriteChromeTrace(const std::string& filename) const;
+    //@}
+
+    /** \name Mutators */ ///@{
+    void         Enable(bool b = true); ///< Turns zone recording on or off
+    void         SetCapacity(std::size_t frames); ///< Sets the number of frames kept in the ring buffer, discarding all recorded frames
+    void         Clear();               ///< Discards all recorded frames
+
+    void         BeginFrame();          ///< Starts a new frame, overwriting the oldest frame in the ring buffer if it is full
+    void         EndFrame();            ///< Ends the current frame
+
+    /** Opens a zone named \a name, and returns a handle that must later be
+        passed to EndZone().  \a name must be a string literal, or otherwise
+        outlive the Profiler.  \a detail, if given, is copied into the zone,
+        so recording a zone never allocates once the frame's zone storage
+        has grown to its steady-state size. */
+    std::size_t  BeginZone(const char* name, const char* detail = 0);
+
+    /** Closes the zone \a zone previously returned by BeginZone(). */
+    void         EndZone(std::size_t zone);
+    //@}
+
+    static Profiler& Instance(); ///< Returns the singleton Profiler
+
+    /** The value returned by BeginZone() when no zone was opened. */
+    static const std::size_t INVALID_ZONE;
+
+private:
+    Profiler();
+    Profiler(const Profiler&); // disabled
+    Profiler& operator=(const Profiler&); // disabled
+
+    bool               m_enabled;
+    std::vector<Frame> m_frames;
+    std::size_t        m_current_frame;
+    std::size_t        m_frames_recorded;
+    std::size_t        m_frame_number;
+    bool               m_in_frame;
+    std::size_t        m_depth;
+    boost::uint64_t    m_start_time;
+};
+
+/** \brief Opens a Profiler zone on construction, and closes it on
+    destruction. */
+class GG_API ScopedProfileZone
+{
+public:
+    explicit ScopedProfileZone(const char* name);
+    ScopedProfileZone(const char* name, const std::string& detail);
+    ~ScopedProfileZone();
+
+private:
+    std::size_t m_zone;
+};
+
+/** \brief Begins a Profiler frame on construction, and ends it on
+    destruction. */
+class GG_API ScopedProfileFrame
+{
+public:
+    ScopedProfileFrame();
+    ~ScopedProfileFrame();
+};
+
+} // namespace GG
+
+#if GG_ENABLE_PROFILING
+# define GG_PROFILE_ZONE(name)                                          \
+    ::GG::ScopedProfileZone BOOST_PP_CAT(gg_profile_zone_, __LINE__)(name)
+# define GG_PROFILE_ZONE_DETAIL(name, detail)                           \
+    ::GG::ScopedProfileZone BOOST_PP_CAT(gg_profile_zone_, __LINE__)(name, detail)
+# define GG_PROFILE_FRAME()                                             \
+    ::GG::ScopedProfileFrame BOOST_PP_CAT(gg_profile_frame_, __LINE__)
+#else
+# define GG_PROFILE_ZONE(name)
+# define GG_PROFILE_ZONE_DETAIL(name, detail)
+# define GG_PROFILE_FRAME()
+#endif
+
+#endif
@@ -34,6 +34,8 @@
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/tuple/tuple.hpp>
 
+#include <iostream>
+
 
 namespace GG {
 
@@ -53,7 +53,10 @@ extern GG_API const GraphicStyle GRAPHIC_PROPSCALE;   ///< If GRAPHIC_FITGRAPHIC
 
     Though the SubTexture displayed in a StaticGraphic is fixed, its size is
     not; the image can be scaled (proportionately or not) to fit in the
-    StaticGraphic's window area. \see GraphicStyle*/
+    StaticGraphic's window area.  If the StaticGraphic is created from a
+    Texture that is still being loaded asynchronously (see
+    TextureManager::GetTextureAsync()), a placeholder is shown until the load
+    completes. \see GraphicStyle*/
 class GG_API StaticGraphic : public Control
 {
 public:
@@ -99,6 +102,8 @@ private:
 
     SubTexture          m_graphic;
     Flags<GraphicStyle> m_style; ///< position of texture wrt the window area
+
+    boost::shared_ptr<const Texture> m_loading_texture; ///< the texture m_graphic will be made from, once it is loaded
 };
 
 } // namespace GG
@@ -0,0 +1,537 @@
+// -*- C++ -*-
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+/** \file TableLexer.h \brief Contains table_lexer, a hand-written,
+    table-driven replacement for the lexertl engine behind GG::lexer. */
+
+#ifndef _GG_TableLexer_h_
+#define _GG_TableLexer_h_
+
+#include <GG/Export.h>
+
+#include <boost/cstdint.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/spirit/home/support/detail/lexer/consts.hpp>
+#include <boost/spirit/home/lex/lexer/lexertl/functor.hpp>
+#include <boost/spirit/home/lex/lexer/lexertl/iterator.hpp>
+#include <boost/spirit/home/lex/lexer/lexertl/static_functor_data.hpp>
+#include <boost/spirit/home/support/iterators/line_pos_iterator.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace GG { namespace detail {
+
+    /** The kinds of token a table_lexer can match.  Each one stands for one
+        of the regular expressions used by GG::lexer's token definitions, and
+        a token definition is matched as a kind by giving it the id
+        LexerTokenID() returns for that kind. */
+    enum LexerTokenKind
+    {
+        LEXER_NONE = -1,
+        LEXER_WORD,             ///< [a-zA-Z]\\w* (identifiers and keywords)
+        LEXER_LEAD_COMMENT,     ///< a non-nesting C-style block comment
+        LEXER_TRAIL_COMMENT,    ///< a C++-style comment, up to the end of the line
+        LEXER_QUOTED_STRING,    ///< "..." or '...', without escapes
+        LEXER_NUMBER,           ///< \\d+(\\.\\d*)?
+        LEXER_EQ_OP,            ///< == or !=
+        LEXER_REL_OP,           ///< <, >, <= or >=
+        LEXER_MUL_OP,           ///< *, / or %
+        LEXER_DEFINE,           ///< <==
+        LEXER_OR,               ///< ||
+        LEXER_AND,              ///< &&
+        LEXER_WHITESPACE,       ///< \\s+
+        NUM_LEXER_TOKEN_KINDS
+    };
+
+    /** The id of the first token kind; the ids lie between the ids of
+        single-character tokens, which are the characters themselves, and
+        boost::spirit::lex::min_token_id, from which the ids of the other
+        token definitions are assigned. */
+    const std::size_t LEXER_TOKEN_ID_BASE = 0x100;
+
+    /** Returns the token id to give a token definition matched as \a kind.
+        The definition's regular expression is not used by table_lexer, but
+        should be the one \a kind stands for, so that the definition matches
+        the same tokens under other lexer engines. */
+    inline std::size_t LexerTokenID(LexerTokenKind kind)
+    { return LEXER_TOKEN_ID_BASE + kind; }
+
+    /** Returns the kind of token a token definition with id \a id is matched
+        as, or LEXER_NONE if \a id is not the id of a kind. */
+    inline LexerTokenKind LexerTokenKindOfID(std::size_t id)
+    {
+        return LEXER_TOKEN_ID_BASE <= id && id < LEXER_TOKEN_ID_BASE + NUM_LEXER_TOKEN_KINDS ?
+            LexerTokenKind(id - LEXER_TOKEN_ID_BASE) : LEXER_NONE;
+    }
+
+    /** Gives LexerTables access to the characters under an input iterator,
+        so that candidate tokens are matched on the underlying iterator, and
+        the input iterator is only advanced past the token finally chosen. */
+    template <typename Iterator>
+    struct lexer_base_iterator
+    {
+        typedef Iterator type;
+
+        static const type& get(const Iterator& it)
+            { return it; }
+    };
+
+    /** Specialization for line_pos_iterator, which counts line breaks each
+        time it is incremented. */
+    template <typename Iterator>
+    struct lexer_base_iterator<boost::spirit::line_pos_iterator<Iterator> >
+    {
+        typedef Iterator type;
+
+        static type get(const boost::spirit::line_pos_iterator<Iterator>& it)
+            { return it.base(); }
+    };
+
+    /** The match tables for all the states of one table_lexer.  Tokens are
+        matched the way lexertl matches them: the longest match wins, and
+        among matches of equal length the token defined first wins.  Each
+        state has a 256-entry table of the single-character tokens, and for
+        each possible first character a bitmask of the other kinds of token
+        that may start with it.  Keywords are found through a perfect hash of
+        their text, built when they are added, so an identifier is never
+        turned into an adobe::name_t just to see whether it is a keyword. */
+    class GG_API LexerTables
+    {
+    public:
+        LexerTables(); ///< Ctor.  State 0 is "INITIAL".
+
+        std::size_t NumStates() const;
+
+        /** Returns the id of state \a name, or boost::lexer::npos if there is
+            no such state. */
+        std::size_t StateID(const char* name) const;
+
+        /** Returns the name of state \a state. */
+        const char* StateName(std::size_t state) const;
+
+        /** Returns the id of state \a name, adding it if necessary. */
+        std::size_t AddState(const char* name);
+
+        /** Adds a token with id \a id matching the single character \a c in
+            state \a state, and returns its unique id.  A match switches to
+            state \a target, unless \a target is boost::lexer::npos. */
+        std::size_t AddToken(std::size_t state, char c, std::size_t id, std::size_t target);
+
+        /** Adds a token with id \a id in state \a state, and returns its
+            unique id.  If \a id is the id of a LexerTokenKind, the token is
+            matched as that kind; otherwise \a pattern must be a keyword (a
+            word, or words separated by '|').  A match switches to state \a
+            target, unless \a target is boost::lexer::npos.  \throw
+            std::logic_error Throws if \a id is not the id of a kind and \a
+            pattern is not a keyword. */
+        std::size_t AddToken(std::size_t state, const std::string& pattern, std::size_t id, std::size_t target);
+
+        /** Removes all the tokens from state \a state. */
+        void        Clear(std::size_t state);
+
+        /** Matches the next token in [\a end, \a last) in state \a state,
+            leaving \a end just past it.  Returns its id, 0 at the end of the
+            input, or boost::lexer::npos (leaving \a end alone) if nothing
+            matches.  This is the interface lexertl's generated next_token()
+            functions provide. */
+        template <typename Iterator>
+        std::size_t Next(std::size_t& state, Iterator& end, const Iterator& last, std::size_t& unique_id) const;
+
+    private:
+        struct Rule
+        {
+            Rule();
+            Rule(std::size_t id, std::size_t unique_id, std::size_t target);
+
+            std::size_t m_id;        ///< boost::lexer::npos if this rule is not defined
+            std::size_t m_unique_id; ///< also the rule's priority; lower wins
+            std::size_t m_target;    ///< boost::lexer::npos to stay in the same state
+        };
+
+        struct Keyword
+        {
+            std::string m_text;
+            Rule        m_rule;
+        };
+
+        struct State
+        {
+            State();
+
+            std::string               m_name;
+            std::size_t               m_num_rules;
+            Rule                      m_kinds[NUM_LEXER_TOKEN_KINDS];
+            Rule                      m_chars[256];
+            unsigned int              m_first_chars[256];  ///< bitmasks of kinds in m_kinds
+            std::vector<Keyword>      m_keywords;
+            std::vector<std::size_t>  m_keyword_slots;     ///< indices into m_keywords, or npos
+            boost::uint32_t           m_keyword_seed;
+        };
+
+        void              UpdateFirstChars(State& state);
+        void              BuildKeywordHash(State& state);
+        static bool       StartsKind(LexerTokenKind kind, unsigned char c);
+        static bool       IsWordChar(unsigned char c);
+        static bool       IsSpace(unsigned char c);
+        static boost::uint32_t Hash(boost::uint32_t hash, unsigned char c);
+
+        template <typename Iterator>
+        const Rule*       FindKeyword(const State& state, boost::uint32_t hash, std::size_t length, Iterator first) const;
+
+        template <typename Iterator>
+        static std::size_t Match(LexerTokenKind kind, Iterator it, const Iterator& last);
+
+        std::vector<State> m_states;
+    };
+
+
+    /** The shared data of the Spirit.Lex functor used by table_lexer.  This
+        is lexertl's static_data, with the state machine replaced by a
+        LexerTables. */
+    template <typename Iterator, typename HasActors, typename HasState, typename TokenValue>
+    class table_lexer_data :
+        public boost::spirit::lex::lexertl::detail::static_data<Iterator, HasActors, HasState, TokenValue>
+    {
+    protected:
+        typedef boost::spirit::lex::lexertl::detail::static_data<Iterator, HasActors, HasState, TokenValue> base_type;
+        typedef typename base_type::char_type char_type;
+
+    public:
+        template <typename IterData>
+        table_lexer_data(const IterData& data, Iterator& first, const Iterator& last) :
+            base_type(data, first, last),
+            m_tables(data.m_tables)
+            {}
+
+        void set_state_name(const char_type* new_state)
+            {
+                std::size_t state = m_tables->StateID(new_state);
+                BOOST_ASSERT(state != boost::lexer::npos);
+                if (state != boost::lexer::npos)
+                    this->state_ = state;
+            }
+
+        const char_type* get_state_name() const
+            { return m_tables->StateName(this->state_); }
+
+        std::size_t get_state_id(const char_type* state) const
+            { return m_tables->StateID(state); }
+
+        std::size_t next(Iterator& end, std::size_t& unique_id, bool& prev_bol)
+            {
+                prev_bol = this->bol_;
+                return m_tables->Next(this->state_, end, this->last_, unique_id);
+            }
+
+    private:
+        const LexerTables* m_tables;
+    };
+
+
+    /** A Spirit.Lex lexer engine, usable in place of
+        boost::spirit::lex::lexertl::lexer as the base of a
+        boost::spirit::lex::lexer.  It builds no DFA; token definitions are
+        mapped onto the hand-written matchers in LexerTables instead, so only
+        definitions with the id of a LexerTokenKind, keywords and single
+        characters may be used.  Lexer semantic actions and pattern
+        macros are not supported. */
+    template <typename Token,
+              typename Iterator = typename Token::iterator_type,
+              typename Functor = boost::spirit::lex::lexertl::functor<Token, table_lexer_data, Iterator, boost::mpl::false_> >
+    class table_lexer
+    {
+    private:
+        struct dummy { void true_() {} };
+        typedef void (dummy::*safe_bool)();
+
+        static const std::size_t all_states_id = static_cast<std::size_t>(-2);
+
+    public:
+        operator safe_bool() const
+            { return &dummy::true_; }
+
+        typedef typename std::iterator_traits<Iterator>::value_type char_type;
+        typedef std::basic_string<char_type> string_type;
+
+        typedef Token token_type;
+        typedef typename Token::id_type id_type;
+        typedef boost::spirit::lex::lexertl::iterator<Functor> iterator_type;
+
+    private:
+        struct iterator_data_type
+        {
+            typedef typename Functor::next_token_functor next_token_functor;
+            typedef typename Functor::get_state_name_type get_state_name_type;
+
+            explicit iterator_data_type(const LexerTables& tables) :
+                next_(0),
+                get_state_name_(0),
+                num_states_(tables.NumStates()),
+                bol_(false),
+                m_tables(&tables)
+                {}
+
+            // next_ and get_state_name_ are required by lexertl's
+            // static_data, but table_lexer_data never calls them.
+            next_token_functor  next_;
+            get_state_name_type get_state_name_;
+            std::size_t         num_states_;
+            bool                bol_;
+            const LexerTables*  m_tables;
+        };
+
+    public:
+        iterator_type begin(Iterator& first, const Iterator& last, const char_type* initial_state = 0) const
+            { return iterator_type(iterator_data_type(m_tables), first, last, initial_state); }
+
+        iterator_type end() const
+            { return iterator_type(); }
+
+    protected:
+        table_lexer(unsigned int) {}
+
+    public:
+        std::size_t add_token(const char_type* state, char_type tokendef, std::size_t token_id, const char_type* targetstate)
+            {
+                if (state == all_states()) {
+                    std::size_t retval = boost::lexer::npos;
+                    for (std::size_t i = 0; i < m_tables.NumStates(); ++i) {
+                        retval = m_tables.AddToken(i, tokendef, token_id, boost::lexer::npos);
+                    }
+                    return retval;
+                }
+                return m_tables.AddToken(add_state(state), tokendef, token_id, target_state(targetstate));
+            }
+
+        std::size_t add_token(const char_type* state, const string_type& tokendef, std::size_t token_id, const char_type* targetstate)
+            {
+                if (state == all_states()) {
+                    std::size_t retval = boost::lexer::npos;
+                    for (std::size_t i = 0; i < m_tables.NumStates(); ++i) {
+                        retval = m_tables.AddToken(i, tokendef, token_id, boost::lexer::npos);
+                    }
+                    return retval;
+                }
+                return m_tables.AddToken(add_state(state), tokendef, token_id, target_state(targetstate));
+            }
+
+        void add_pattern(const char_type*, const string_type& name, const string_type&)
+            { throw std::logic_error("GG::detail::table_lexer does not support pattern macros (\"" + name + "\")"); }
+
+        void clear(const char_type* state)
+            {
+                std::size_t state_id = m_tables.StateID(state);
+                if (state_id != boost::lexer::npos)
+                    m_tables.Clear(state_id);
+            }
+
+        std::size_t add_state(const char_type* state)
+            {
+                if (state == all_states())
+                    return all_states_id;
+                return m_tables.AddState(state);
+            }
+
+        string_type initial_state() const
+            { return string_type(m_tables.StateName(0)); }
+
+        string_type all_states() const
+            { return string_type("*"); }
+
+        bool init_dfa(bool = false) const
+            { return true; }
+
+    private:
+        std::size_t target_state(const char_type* targetstate)
+            { return targetstate ? m_tables.AddState(targetstate) : boost::lexer::npos; }
+
+        LexerTables m_tables;
+    };
+
+
+    // inline and template implementations
+    inline bool LexerTables::IsWordChar(unsigned char c)
+    { return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_'; }
+
+    inline bool LexerTables::IsSpace(unsigned char c)
+    { return c == ' ' || ('\t' <= c && c <= '\r'); }
+
+    inline boost::uint32_t LexerTables::Hash(boost::uint32_t hash, unsigned char c)
+    { return (hash ^ c) * 16777619u; }
+
+    template <typename Iterator>
+    std::size_t LexerTables::Next(std::size_t& state, Iterator& end, const Iterator& last, std::size_t& unique_id) const
+    {
+        if (end == last) {
+            unique_id = boost::lexer::npos;
+            return 0;
+        }
+
+        typedef lexer_base_iterator<Iterator> base;
+        const typename base::type first = base::get(end);
+        const typename base::type stop = base::get(last);
+
+        const State& current = m_states[state];
+        const unsigned char c = *first;
+
+        const Rule* best = 0;
+        std::size_t best_length = 0;
+        if (current.m_chars[c].m_id != boost::lexer::npos) {
+            best = &current.m_chars[c];
+            best_length = 1;
+        }
+
+        for (unsigned int kinds = current.m_first_chars[c]; kinds; kinds &= kinds - 1) {
+            int kind = 0;
+            while (!(kinds & (1u << kind))) {
+                ++kind;
+            }
+
+            const Rule* rule = &current.m_kinds[kind];
+            std::size_t length = 0;
+            if (kind == LEXER_WORD) {
+                typename base::type it = first;
+                boost::uint32_t hash = Hash(current.m_keyword_seed, c);
+                for (++it, length = 1; it != stop && IsWordChar(*it); ++it, ++length) {
+                    hash = Hash(hash, *it);
+                }
+                if (!current.m_keyword_slots.empty()) {
+                    const Rule* keyword = FindKeyword(current, hash, length, first);
+                    if (keyword && (rule->m_id == boost::lexer::npos || keyword->m_unique_id < rule->m_unique_id))
+                        rule = keyword;
+                }
+            } else {
+                length = Match(LexerTokenKind(kind), first, stop);
+            }
+            if (!length || rule->m_id == boost::lexer::npos)
+                continue;
+
+            if (best_length < length || (best_length == length && rule->m_unique_id < best->m_unique_id)) {
+                best = rule;
+                best_length = length;
+            }
+        }
+
+        if (!best) {
+            unique_id = boost::lexer::npos;
+            return boost::lexer::npos;
+        }
+
+        std::advance(end, best_length);
+        if (best->m_target != boost::lexer::npos)
+            state = best->m_target;
+        unique_id = best->m_unique_id;
+        return best->m_id;
+    }
+
+    template <typename Iterator>
+    const LexerTables::Rule* LexerTables::FindKeyword(const State& state, boost::uint32_t hash, std::size_t length, Iterator first) const
+    {
+        std::size_t index = state.m_keyword_slots[hash & (state.m_keyword_slots.size() - 1)];
+        if (index == boost::lexer::npos)
+            return 0;
+        const Keyword& keyword = state.m_keywords[index];
+        if (keyword.m_text.size() != length || !std::equal(keyword.m_text.begin(), keyword.m_text.end(), first))
+            return 0;
+        return &keyword.m_rule;
+    }
+
+    template <typename Iterator>
+    std::size_t LexerTables::Match(LexerTokenKind kind, Iterator it, const Iterator& last)
+    {
+        // The first character has already been checked against
+        // StartsKind(kind).
+        std::size_t length = 1;
+        const char c = *it++;
+        switch (kind) {
+        case LEXER_LEAD_COMMENT:
+            if (it == last || *it != '*')
+                return 0;
+            ++it;
+            ++length;
+            for (bool star = false; it != last; ++length) {
+                const char next = *it++;
+                if (star && next == '/')
+                    return length + 1;
+                star = next == '*';
+            }
+            return 0;
+
+        case LEXER_TRAIL_COMMENT:
+            if (it == last || *it != '/')
+                return 0;
+            for (; it != last && *it != '\n'; ++it, ++length) {}
+            return length;
+
+        case LEXER_QUOTED_STRING:
+            for (; it != last; ++length) {
+                if (*it++ == c)
+                    return length + 1;
+            }
+            return 0;
+
+        case LEXER_NUMBER:
+            for (; it != last && '0' <= *it && *it <= '9'; ++it, ++length) {}
+            if (it != last && *it == '.') {
+                for (++it, ++length; it != last && '0' <= *it && *it <= '9'; ++it, ++length) {}
+            }
+            return length;
+
+        case LEXER_EQ_OP:
+            return it != last && *it == '=' ? 2 : 0;
+
+        case LEXER_REL_OP:
+            return it != last && *it == '=' ? 2 : 1;
+
+        case LEXER_MUL_OP:
+            return 1;
+
+        case LEXER_DEFINE:
+            if (it == last || *it != '=')
+                return 0;
+            ++it;
+            return it != last && *it == '=' ? 3 : 0;
+
+        case LEXER_OR:
+        case LEXER_AND:
+            return it != last && *it == c ? 2 : 0;
+
+        case LEXER_WHITESPACE:
+            for (; it != last && IsSpace(*it); ++it, ++length) {}
+            return length;
+
+        default:
+            return 0;
+        }
+    }
+
+} }
+
+#endif
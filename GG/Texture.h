@@ -34,17 +34,22 @@
 #include <GG/Base.h>
 #include <GG/Exception.h>
 
+#include <boost/weak_ptr.hpp>
+
 
 namespace GG {
 
 /** \brief This class encapsulates an OpenGL texture object.
 
-    If the dimensions of the image used to initialize the texture are not both
-    powers of two, the texture is created with dimensions of the next largest
-    (or equal) powers of two.  The original image occupies the region near the
-    texture's origin, and the rest is zero-initialized.  This is done to
-    prevent the image from being scaled, since textures used in a GUI almost
-    always must maintain pixel accuracy.  The original image size and
+    If the OpenGL implementation supports non-power-of-two textures (see
+    NonPowerOfTwoSupported()), the texture is created with exactly the
+    dimensions of the image used to initialize it.  Otherwise, if the
+    dimensions of the image are not both powers of two, the texture is
+    created with dimensions of the next largest (or equal) powers of two.
+    The original image occupies the region near the texture's origin, and the
+    rest is zero-initialized.  This is done to prevent the image from being
+    scaled, since textures used in a GUI almost always must maintain pixel
+    accuracy.  The original image size and
     corresponding texture coords are saved, and can be accessed through
     DefaultWidth(), DefaultHeight(), and DefaultTexCoords(), respectively.
     These are kept so that only the originally-loaded-image part of the
@@ -75,6 +80,7 @@ public:
     const GLfloat*   DefaultTexCoords() const; ///< texture coordinates to use by default when blitting this texture
     X                DefaultWidth() const;     ///< returns width in pixels, based on initial image (0 if texture was not loaded)
     Y                DefaultHeight() const;    ///< returns height in pixels, based on initial image (0 if texture was not loaded)
+    bool             Loading() const;          ///< returns true while an asynchronous load started by TextureManager::GetTextureAsync() is still in progress
 
     /** Blit any portion of texture to any place on screen, scaling as
         necessary*/
@@ -88,8 +94,11 @@ public:
     /** \name Mutators */ ///@{
     // intialization functions
     /** Frees any currently-held memory and loads a texture from file \a
-        filename.  \throw GG::Texture::BadFile Throws if the texture creation
-        fails. */
+        filename.  DDS and KTX files containing DXT1, DXT3, DXT5, ETC1 or ETC2
+        data are uploaded still compressed, along with any mipmaps they
+        contain, if the OpenGL implementation supports the format; otherwise
+        they are decompressed first.  \throw GG::Texture::BadFile Throws if
+        the texture creation fails. */
     void Load(const std::string& filename, bool mipmap = false);
 
     /** Frees any currently-held memory and creates a texture from supplied
@@ -112,6 +121,12 @@ public:
     void Clear();  ///< frees the opengl texture object associated with this object
     //@}
 
+    /** Returns true iff the current OpenGL context supports textures whose
+        dimensions are not powers of two, either through OpenGL 2.0 or the
+        ARB_texture_non_power_of_two extension.  This is detected once, the
+        first time it is called with an OpenGL context current. */
+    static bool NonPowerOfTwoSupported();
+
     /** \name Exceptions */ ///@{
     /** The base class for Texture exceptions. */
     GG_ABSTRACT_EXCEPTION(Exception);
@@ -129,9 +144,38 @@ public:
 private:
     Texture(const Texture& rhs);             ///< disabled
     Texture& operator=(const Texture& rhs);  ///< disabled
-    void InitFromRawData(X width, Y height, const unsigned char* image, GLenum format, GLenum type,
-                         unsigned int bytes_per_pixel, bool mipmap);
-    unsigned char* GetRawBytes();
+
+    /** Loads the DDS or KTX file \a path_name. */
+    void LoadCompressed(const std::string& path_name, bool mipmap);
+
+    /** Loads the PNG or JPEG file \a path_name a few rows at a time,
+        without holding a decoded copy of the whole image.  Returns false,
+        having done nothing, if the file cannot be decoded that way. */
+    bool LoadStreaming(const std::string& path_name, bool mipmap);
+
+    /** Creates the OpenGL texture object and its storage, and uploads \a
+        image into it; if \a image is 0, the storage is left for
+        UploadRows() to fill.  If \a mipmap is true and GL_GENERATE_MIPMAP
+        is available, it is turned on before anything is uploaded, so that
+        GL keeps the mipmaps up to date as the image arrives. */
+    void InitStorage(X width, Y height, const unsigned char* image, GLenum format, GLenum type,
+                     unsigned int bytes_per_pixel, bool mipmap);
+
+    /** Uploads the \a rows rows in \a rows_data into storage created by
+        InitStorage(), starting at row \a first_row of the texture. */
+    void UploadRows(const unsigned char* rows_data, Y first_row, Y rows);
+
+    /** Finishes the mipmaps (if any) once all of \a image has been
+        uploaded.  Where GL_GENERATE_MIPMAP is available GL has already
+        built them, and it is turned off again; otherwise they are built by
+        box filtering on the CPU, from the texture read back if \a image is
+        0 or does not fill it. */
+    void FinishInit(const unsigned char* image);
+
+    /** Uploads the prebuilt \a width x \a height mipmap level \a level. */
+    void UploadMipmapLevel(unsigned int level, X width, Y height, const unsigned char* data);
+
+    unsigned char* GetRawBytes() const;
 
     std::string m_filename;   ///< filename from which this Texture was constructed ("" if not loaded from a file)
 
@@ -151,6 +195,10 @@ private:
     GLfloat      m_tex_coords[4];  ///< the texture coords used to blit from this texture by default (reflecting original image width and height)
     X            m_default_width;  ///< the original width and height of this texture to be used in blitting 
     Y            m_default_height;
+
+    bool         m_loading;        ///< true while an asynchronous load is in progress
+
+    friend class TextureManager;
 };
 
 /** \brief This class is a convenient way to store the info needed to use a
@@ -169,6 +217,13 @@ public:
         coordinates are not well formed.*/
     SubTexture(const boost::shared_ptr<const Texture>& texture, X x1, Y y1, X x2, Y y2);
 
+    /** Creates a SubTexture from a region of another SubTexture.  The
+        coordinates are in pixels, relative to the upper left corner of \a
+        subtexture.  \throw GG::SubTexture::InvalidTextureCoordinates Throws
+        if the texture coordinates are not well formed, or lie outside \a
+        subtexture.*/
+    SubTexture(const SubTexture& subtexture, X x1, Y y1, X x2, Y y2);
+
     SubTexture(const SubTexture& rhs); ///< copy ctor
     const SubTexture& operator=(const SubTexture& rhs); ///< assignment operator
     virtual ~SubTexture(); ///< virtual dtor
@@ -223,10 +278,41 @@ private:
     request a texture through GetTexture(); if the texture is not already
     resident, it will be loaded.  If the user would like to create her own
     images and store them in the manager, that can be accomplished via
-    StoreTexture() calls.*/
+    StoreTexture() calls.
+
+    Textures requested through GetTextureAsync() are decoded on a pool of
+    worker threads, then uploaded to OpenGL a few rows at a time by
+    UploadPendingTextures(), which GUI::Render() calls once per frame.  This
+    keeps the loading of large images from stalling the GUI.
+
+    Small images requested through GetSubTexture() are packed into shared
+    atlas pages, instead of each getting its own power-of-two-sized OpenGL
+    texture.  Widgets drawn from the same page do not need to bind a new
+    texture for each draw, and no memory is wasted on padding.  Atlas pages
+    use GL_NEAREST filtering, since the images packed into them are normally
+    blitted unscaled.  The frames of animations requested through
+    GetAnimationFrames() are packed into a separate set of pages, which use
+    GL_LINEAR filtering, since animations are often drawn scaled. */
 class GG_API TextureManager
 {
 public:
+    /** \name Structors */ ///@{
+    ~TextureManager(); ///< dtor; stops the asynchronous loading threads
+    //@}
+
+    /** \name Accessors */ ///@{
+    std::size_t       PendingTextures() const; ///< returns the number of textures requested via GetTextureAsync() that are not yet completely loaded
+    unsigned int      UploadTimeSlice() const; ///< returns the approximate number of microseconds UploadPendingTextures() may spend per call
+    const SubTexture& Placeholder() const;     ///< returns the image drawn in place of textures that are still loading; may be empty
+    bool              AtlasEnabled() const;    ///< returns true iff GetSubTexture() packs small images into shared atlas pages
+    std::size_t       AtlasPages() const;      ///< returns the number of atlas pages allocated so far, including animation atlas pages
+
+    /** Draws the placeholder for a texture that is still loading into the
+        rectangle from \a pt1 to \a pt2.  If Placeholder() is empty, a
+        translucent gray rectangle is drawn instead. */
+    void              RenderPlaceholder(const Pt& pt1, const Pt& pt2) const;
+    //@}
+
     /** \name Mutators */ ///@{
     /** Stores a pre-existing GG::Texture in the manager's texture pool, and
         returns a shared_ptr to it. \warning Calling code <b>must not</b>
@@ -245,20 +331,108 @@ public:
         from disk. */
     boost::shared_ptr<Texture> GetTexture(const std::string& name, bool mipmap = false);
 
+    /** Returns a shared_ptr to the texture created from image file \a name,
+        without waiting for the image to be loaded.  If the texture is not
+        present in the manager's pool, only the image file's header is read
+        before returning; the returned Texture has valid DefaultWidth() and
+        DefaultHeight(), but no OpenGL texture, and Loading() is true until
+        the image has been decoded and uploaded.  If decoding or uploading
+        fails, the error is reported on std::cerr and the Texture is left
+        empty.  \note When GG uses DevIL to load images, this is equivalent
+        to GetTexture().  \throw GG::Texture::BadFile Throws if the file does
+        not exist or is not of a supported type. */
+    boost::shared_ptr<Texture> GetTextureAsync(const std::string& name, bool mipmap = false);
+
+    /** Returns a SubTexture containing the image from image file \a name.
+        If AtlasEnabled() is true and the image is small enough, it is packed
+        into a shared atlas page the first time it is requested, and the
+        returned SubTexture refers to its region of that page.  Otherwise,
+        this returns a SubTexture covering all of GetTexture(\a name).  \note
+        When GG uses DevIL to load images, images are never atlased.  \throw
+        GG::Texture::BadFile Throws if the file cannot be loaded. */
+    SubTexture                 GetSubTexture(const std::string& name);
+
+    /** Returns one SubTexture for each of the first \a frames frames of the
+        sprite sheet \a texture.  The \a frame_width x \a frame_height
+        frames are laid out in rows, like text, and each has \a margin pixels
+        of space above and to the left of it.  If AtlasEnabled() is true, \a
+        texture is not mipmapped, and the frames are small enough, the frames
+        are copied into shared animation atlas pages, so that all the
+        animations on screen are drawn from a few textures; otherwise, the
+        returned SubTextures refer to \a texture itself.  The result is
+        cached, so a sprite sheet used by many animations is only split up
+        once.  Returns an empty vector if \a texture is still loading, or
+        has no OpenGL texture. */
+    std::vector<SubTexture>    GetAnimationFrames(const boost::shared_ptr<const Texture>& texture,
+                                                  X frame_width, Y frame_height, unsigned int margin,
+                                                  std::size_t frames);
+
+    /** Uploads textures decoded by the asynchronous loading threads to
+        OpenGL, spending about UploadTimeSlice() microseconds.  At least one
+        piece of one texture is uploaded on each call, so loading always
+        makes progress.  Must be called from the thread that owns the OpenGL
+        context; GUI::Render() does this once per frame. */
+    void                UploadPendingTextures();
+
+    /** Sets the approximate number of microseconds UploadPendingTextures()
+        may spend per call. */
+    void                SetUploadTimeSlice(unsigned int microseconds);
+
+    /** Sets the number of threads used to decode images requested via
+        GetTextureAsync().  This only has an effect before the first such
+        request. */
+    void                SetAsyncLoadThreads(std::size_t threads);
+
+    /** Sets the image drawn in place of textures that are still loading. */
+    void                SetPlaceholder(const SubTexture& placeholder);
+
+    /** Turns packing of small images into atlas pages by GetSubTexture() on
+        or off.  Images already packed stay in their pages. */
+    void                EnableAtlas(bool b = true);
+
     /** Removes the manager's shared_ptr to the texture created from image
-        file \a name, if it exists.  \note Due to shared_ptr semantics, the
-        texture may not be deleted until much later. */
+        file \a name, if it exists, and forgets any atlased copy of it.
+        \note Due to shared_ptr semantics, the texture may not be deleted
+        until much later.  The space an atlased image occupies in its page is
+        not reclaimed. */
     void                FreeTexture(const std::string& name);
     //@}
 
 private:
+    struct AsyncLoader;
+    struct AtlasPage;
+
+    /** The frames of a sprite sheet, as returned by GetAnimationFrames(). */
+    struct AnimationFrames
+    {
+        boost::weak_ptr<const Texture> texture;
+        X                              frame_width;
+        Y                              frame_height;
+        unsigned int                   margin;
+        std::vector<SubTexture>        frames;
+    };
+
     TextureManager();
     boost::shared_ptr<Texture> LoadTexture(const std::string& filename, bool mipmap);
+    SubTexture                 AtlasImage(std::vector<boost::shared_ptr<AtlasPage> >& pages, GLenum filter,
+                                          X width, Y height, const unsigned char* image, GLenum format,
+                                          unsigned int bytes_pp);
 
     static bool s_created;
     static bool s_il_initialized;
     std::map<std::string, boost::shared_ptr<Texture> > m_textures;
 
+    boost::shared_ptr<AsyncLoader>                     m_async_loader;
+    std::size_t                                        m_async_load_threads;
+    unsigned int                                       m_upload_time_slice;
+    SubTexture                                         m_placeholder;
+
+    bool                                               m_atlas_enabled;
+    std::vector<boost::shared_ptr<AtlasPage> >         m_atlas_pages;
+    std::map<std::string, SubTexture>                  m_atlas_images;
+    std::vector<boost::shared_ptr<AtlasPage> >         m_animation_atlas_pages;
+    std::vector<AnimationFrames>                       m_animation_frames;
+
     friend TextureManager& GetTextureManager();
 };
 
@@ -298,6 +298,12 @@ public:
         of its parent, for clipping purposes.  \see ChildClippingMode. */
     bool NonClientChild() const;
 
+    /** Returns true iff this Wnd has declared that it covers every pixel of
+        its rectangle with fully opaque color when rendered, so that
+        top-level Wnds entirely behind it need not be rendered.  \see
+        SetOpaque() */
+    bool Opaque() const;
+
     /** Returns true iff this Wnd will be rendered if it is registered. */
     bool Visible() const;
 
@@ -490,6 +496,13 @@ public:
         its parent, for clipping purposes.  \see ChildClippingMode. */
     void NonClientChild(bool b);
 
+    /** Sets whether this Wnd covers every pixel of its rectangle with fully
+        opaque color when rendered.  GUI::Render() skips top-level and modal
+        Wnds that lie entirely behind a single opaque Wnd.  Only set this for
+        Wnds whose Render() really does fill their whole rectangle; the
+        default is false. */
+    void SetOpaque(bool b = true);
+
     void MoveTo(const Pt& pt);     ///< Moves upper-left corner of window to \a pt.
     void OffsetMove(const Pt& pt); ///< Moves window by \a pt pixels.
 
@@ -872,6 +885,7 @@ private:
     std::string       m_drag_drop_data_type; ///< The type of drag-and-drop data this Wnd represents, if any
     ChildClippingMode m_child_clipping_mode;
     bool              m_non_client_child;
+    bool              m_opaque;        ///< True iff this Wnd fills its rectangle with opaque color
     Pt                m_upperleft;     ///< Upper left point of window
     Pt                m_lowerright;    ///< Lower right point of window
     Pt                m_min_size;      ///< Minimum window size Pt(0, 0) (= none) by default
@@ -428,6 +428,22 @@ class sheet_t : boost::noncopyable
 */
     void reinitialize();
 
+/*!
+
+  Opts in to calculating independent output and logic cells
+  concurrently during update(). Cells whose inputs have all been
+  calculated are calculated together, each thread using its own copy
+  of \ref machine_m. Monitor callbacks are still called on the calling
+  thread, in the same order as in a serial update. The function
+  lookups installed on \ref machine_m must be safe to call
+  concurrently when this is enabled.
+
+  \param thread_count the number of threads to use, including the
+  calling thread. 0 or 1 (the default) calculates serially.
+
+*/
+    void set_parallel_update(std::size_t thread_count);
+
 
 /*!
     
@@ -3,11 +3,17 @@
 
 #include <GG/adobe/adam.hpp>
 
+#include <boost/shared_ptr.hpp>
+
 #include <set>
 
 
 namespace adobe {
 
+namespace implementation {
+    struct adam_function_body_t;
+}
+
 class adam_function_t
 {
 public:
@@ -37,6 +43,7 @@ private:
     name_t m_function_name;
     std::vector<name_t> m_parameter_names;
     std::vector<array_t> m_statements;
+    boost::shared_ptr<const implementation::adam_function_body_t> m_body;
 };
 
 }
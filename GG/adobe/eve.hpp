@@ -196,11 +196,19 @@ place subviews inside this one.
                             bool                        reverse=false);
 
 /*!
-\brief set_visible
+\brief Shows or hides a view element, and with it all of its subviews. Hidden elements take no part
+in the layout. Elements being shown are measured again by the next call to \c update().
 */
 
     void set_visible(iterator, bool);
 
+/*!
+\brief Marks a view element as needing to be measured again, because its contents have changed.
+The next call to \c update() will measure it.
+*/
+
+    void set_dirty(iterator);
+
 
 /*!
 \brief This call performs the layout, it will call each element to get its dimentions, solve the layout, and place each item. Specifying a width and height less than the solved width and height will give undefined results. To resize a view, call \c evaluate() to get the minimum size then use \c adjust().
@@ -215,6 +223,24 @@ place subviews inside this one.
 
     std::pair<long, long> evaluate(evaluate_options_t options, long width = 0, long height = 0);
 
+/*!
+
+\brief Performs the layout incrementally. Only elements marked with \c set_dirty(), or shown
+with \c set_visible(), since the last layout are measured again. If none of them measure
+differently, no element has been shown or hidden, and the arguments are those of the last layout,
+the last result is returned without solving the layout again. Otherwise the layout is solved, and
+only elements with new place data, or which were measured again, are placed.
+
+\param options options to be passed to the solution engine.
+\param width if not zero, \c width is used for the width of the layout rather than the solved width.
+\param height if not zero, \c height is used for the height of the layout rather than the solved height.
+
+\sa
+    \ref adobe::eve_t::evaluate
+*/
+
+    std::pair<long, long> update(evaluate_options_t options, long width = 0, long height = 0);
+
 
 /*!
 
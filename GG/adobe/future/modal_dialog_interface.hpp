@@ -187,6 +187,8 @@ public:
                                const std::string& layout_source,
                                std::istream& sheet,
                                const std::string& sheet_source);
+    platform_display_type init(const GG::ParsedDefinition& layout,
+                               const GG::ParsedDefinition& sheet);
     dialog_result_t go();
 
     dictionary_t            input_m;
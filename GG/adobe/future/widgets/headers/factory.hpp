@@ -57,6 +57,12 @@
 //
 /*************************************************************************************************/
 
+namespace GG {
+    class ParsedDefinition;
+}
+
+/*************************************************************************************************/
+
 namespace adobe {
 
 /*************************************************************************************************/
@@ -407,6 +413,24 @@ adobe::auto_ptr<eve_client_holder> make_view(const std::string&
 
 /*************************************************************************************************/
 
+/*
+    Creates the view described by the Eve definition \a layout, as if it had
+    been parsed from a stream by the other overload, without parsing.
+*/
+adobe::auto_ptr<eve_client_holder> make_view(const GG::ParsedDefinition&            layout,
+                                             sheet_t&                               sheet,
+                                             behavior_t&                            root_behavior,
+                                             vm_lookup_t&                           lookup,
+                                             const button_notifier_t&               top_level_button_notifier,
+                                             const button_notifier_t&               button_notifier,
+                                             const signal_notifier_t&               signal_notifier,
+                                             const row_factory_t&                   row_factory,
+                                             size_enum_t                            dialog_size,
+                                             const widget_factory_proc_t&           proc = default_widget_factory_proc(),
+                                             platform_display_type                  display_root=platform_display_type());
+
+/*************************************************************************************************/
+
 } // namespace adobe
 
 /*************************************************************************************************/
@@ -31,25 +31,49 @@ namespace adobe {
 struct visible_change_queue_t
 {
     visible_change_queue_t(eve_t& eve) :
+        eve_m(eve),
         root_m(false),
         hide_queue_m(root_m.insert_behavior(true)),
-        eve_eval_token_m(root_m.insert(boost::bind(&eve_t::evaluate, boost::ref(eve), eve_t::evaluate_nested, 0, 0))),
+        eve_eval_token_m(root_m.insert(boost::bind(&visible_change_queue_t::evaluate, this))),
         show_queue_m(root_m.insert_behavior(true)),
-        force_m(false)
+        force_m(false),
+        dirty_m(false)
     { }
 
+    eve_t&                       eve_m;
     behavior_t                   root_m;
     behavior_t::behavior_token_t hide_queue_m;
     behavior_t::verb_token_t     eve_eval_token_m;
     behavior_t::behavior_token_t show_queue_m;
     bool                         force_m; // force an update irrespective of the show/hide queues being empty
+    bool                         dirty_m; // some views have been marked dirty since the last update
+
+    /*
+        Marks view as needing to be measured again. The layout is not updated until the next call
+        to update(), so that views changed together are measured in a single pass.
+    */
+    void set_dirty(eve_t::iterator view)
+    {
+        eve_m.set_dirty(view);
+        dirty_m = true;
+    }
+
+    void evaluate()
+    {
+        // A forced update measures every view, not only those marked dirty or shown.
+        if (force_m)
+            eve_m.evaluate(eve_t::evaluate_nested);
+        else
+            eve_m.update(eve_t::evaluate_nested);
+    }
 
     void update()
     {
-        if (force_m || hide_queue_m->empty() == false || show_queue_m->empty() == false)
+        if (force_m || dirty_m || hide_queue_m->empty() == false || show_queue_m->empty() == false)
             root_m();
 
         force_m = false;
+        dirty_m = false;
     }
 };
 
@@ -276,8 +276,9 @@ struct force_relayout_view_adaptor
 {
     typedef typename ViewConcept<View>::model_type model_type;
 
-    force_relayout_view_adaptor(View& view, visible_change_queue_t& queue) :
+    force_relayout_view_adaptor(View& view, eve_t::iterator proxy, visible_change_queue_t& queue) :
         view_m(&view),
+        proxy_m(proxy),
         queue_m(&queue)
         { }
 
@@ -287,10 +288,13 @@ struct force_relayout_view_adaptor
 
             ViewConcept<View>::display(*view_m, value);
 
-            queue_m->force_m = true;
+            // Only this view has changed - it is measured again, with any other dirty views, by
+            // the queue's next update.
+            queue_m->set_dirty(proxy_m);
         }
 
     View*                   view_m;
+    eve_t::iterator         proxy_m;
     visible_change_queue_t* queue_m;
 };
 
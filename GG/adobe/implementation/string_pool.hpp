@@ -21,6 +21,12 @@ namespace adobe {
 
 /**************************************************************************************************/
 
+/*
+    Interns strings: add() returns the same pointer for equal strings, valid for the lifetime of
+    the pool. add() may be called from several threads at once; strings already in the pool are
+    found without locking, and new strings take only the lock of one of several shards.
+*/
+
 class unique_string_pool_t : boost::noncopyable
 {
 public:
@@ -17,6 +17,7 @@
 #define BOOST_FUNCTION_NO_DEPRECATED
 #include <boost/function.hpp>
 #include <boost/operators.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <GG/adobe/array_fwd.hpp>
 #include <GG/adobe/name_fwd.hpp>
@@ -60,7 +61,32 @@ class virtual_machine_t
     ~virtual_machine_t();
 #endif
 
+    /*
+        An expression compiled once into a flat instruction sequence, for expressions which
+        are evaluated many times. Operators are resolved to their implementations, literal
+        operands are stored once in a constant pool, variable names become operands of the
+        variable instruction, and the deferred operands of &&, || and ?: become jumps within
+        the sequence. The expression_t form remains the interchange format; copies of a
+        compiled_expression_t share the compiled form.
+    */
+    class compiled_expression_t
+    {
+     public:
+        compiled_expression_t();
+        explicit compiled_expression_t(const expression_t& expression);
+
+        bool empty() const;
+
+        struct implementation_t;
+
+     private:
+        friend class virtual_machine_t;
+
+        boost::shared_ptr<const implementation_t> object_m;
+    };
+
     void evaluate(const expression_t& expression);
+    void evaluate(const compiled_expression_t& expression);
 #if 0
     void evaluate_named_arguments(const dictionary_t&);
 #endif
@@ -36,6 +36,7 @@
 namespace GG {
 
 class Font;
+class RetainedGeometry;
 template <class T>
 class Slider;
 
@@ -81,8 +82,10 @@ private:
 
     double m_hue;
     double m_saturation;
-    std::vector<std::vector<std::pair<double, double> > >  m_vertices;
-    std::vector<std::vector<Clr> > m_colors;
+
+    /** The hue-saturation gradient, built in the unit square on the first
+        Render(). */
+    boost::shared_ptr<RetainedGeometry> m_gradient;
 };
 
 
@@ -0,0 +1,29 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+    std::size_t g_allocations = 0;
+}
+
+std::size_t Allocations()
+{ return g_allocations; }
+
+void* operator new(std::size_t size) throw(std::bad_alloc)
+{
+    ++g_allocations;
+    if (void* retval = std::malloc(size ? size : 1))
+        return retval;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) throw(std::bad_alloc)
+{ return operator new(size); }
+
+void operator delete(void* ptr) throw()
+{ std::free(ptr); }
+
+void operator delete[](void* ptr) throw()
+{ std::free(ptr); }
@@ -0,0 +1,16 @@
+#ifndef _GG_bench_AllocationCounter_h_
+#define _GG_bench_AllocationCounter_h_
+
+#include <cstddef>
+
+// Allocation counting
+//
+// AllocationCounter.cpp replaces the global operator new and operator
+// delete, so every benchmark linked with it can count the heap allocations
+// made by the code it times.
+
+/** Returns the number of times operator new or operator new[] has been
+    called since the program started. */
+std::size_t Allocations();
+
+#endif
@@ -0,0 +1,540 @@
+#include <GG/Headless/HeadlessGUI.h>
+
+#include <GG/Button.h>
+#include <GG/Config.h>
+#include <GG/DrawUtil.h>
+#include <GG/EveGlue.h>
+#include <GG/Filesystem.h>
+#include <GG/Layout.h>
+#include <GG/ListBox.h>
+#include <GG/MultiEdit.h>
+#include <GG/StaticGraphic.h>
+#include <GG/StyleFactory.h>
+#include <GG/dialogs/ColorDlg.h>
+
+#include "AllocationCounter.h"
+
+#if GG_HAVE_LIBPNG
+# include "GIL/extension/io/png_io.hpp"
+#endif
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+// Frame-time benchmarks
+//
+// Each scenario builds a set of windows, then is driven for a fixed number of
+// frames on the headless driver, with scripted mouse input sweeping over the
+// windows.  The time, number of heap allocations, and number of draw calls
+// of every frame are recorded, and the p50/p99 of each is written out as
+// JSON, for comparison between runs.  Since the headless driver's clock only
+// advances by a fixed amount per frame, Timers and the scripted input behave
+// identically from run to run; only the measured times vary.
+//
+// Scenarios that load a texture also report how long the load took, and how
+// far it raised the process's peak resident set size (on Linux only; -1
+// elsewhere).
+//
+// Usage: gg-bench [--frames N] [--output file.json] [scenario ...]
+//
+// If any scenario names are given, only those scenarios are run.
+
+
+
+namespace {
+    const std::size_t WARMUP_FRAMES = 10;
+    const std::size_t DEFAULT_FRAMES = 300;
+    const unsigned int CLICK_INTERVAL = 15;
+
+    std::size_t g_frames = DEFAULT_FRAMES;
+
+    boost::uint64_t Microseconds()
+    {
+        using namespace boost::posix_time;
+        static const ptime EPOCH(microsec_clock::universal_time());
+        return (microsec_clock::universal_time() - EPOCH).total_microseconds();
+    }
+
+    boost::shared_ptr<GG::Font> BenchFont()
+    { return GG::GUI::GetGUI()->GetStyleFactory()->DefaultFont(); }
+
+    GG::Rect ScreenRect(const GG::Wnd* wnd)
+    { return GG::Rect(wnd->UpperLeft(), wnd->LowerRight()); }
+
+    bool IgnoreButton(adobe::name_t, const adobe::any_regular_t&)
+    { return false; }
+
+    // Scripts one mouse move per frame over \a area, in a deterministic
+    // pattern that visits most of it, with a left click every
+    // CLICK_INTERVAL frames.
+    void ScriptMouseSweep(GG::HeadlessGUI& gui, const GG::Rect& area, std::size_t frames, bool clicks)
+    {
+        const unsigned int start = gui.Ticks();
+        const int w = std::max(1, Value(area.Width()));
+        const int h = std::max(1, Value(area.Height()));
+        GG::Pt prev = area.ul;
+        for (std::size_t i = 0; i < frames; ++i) {
+            unsigned int ticks = start + i * gui.FrameTicks();
+            GG::Pt pt = area.ul + GG::Pt(GG::X(static_cast<int>(i * 37 % w)), GG::Y(static_cast<int>(i * 53 % h)));
+            gui.ScriptEvent(GG::HeadlessGUI::ScriptedEvent(ticks, GG::GUI::MOUSEMOVE, GG::GGK_UNKNOWN, 0,
+                                                           GG::Flags<GG::ModKey>(), pt, pt - prev));
+            if (clicks && i % CLICK_INTERVAL == CLICK_INTERVAL - 1) {
+                gui.ScriptEvent(ticks, GG::GUI::LPRESS, pt);
+                gui.ScriptEvent(ticks, GG::GUI::LRELEASE, pt);
+            }
+            prev = pt;
+        }
+    }
+
+    void ScriptKeys(GG::HeadlessGUI& gui, GG::Key key, std::size_t frames)
+    {
+        const unsigned int start = gui.Ticks();
+        for (std::size_t i = 0; i < frames; ++i) {
+            unsigned int ticks = start + i * gui.FrameTicks();
+            gui.ScriptEvent(GG::HeadlessGUI::ScriptedEvent(ticks, GG::GUI::KEYPRESS, key, 0,
+                                                           GG::Flags<GG::ModKey>(), GG::Pt(), GG::Pt()));
+            gui.ScriptEvent(GG::HeadlessGUI::ScriptedEvent(ticks, GG::GUI::KEYRELEASE, key, 0,
+                                                           GG::Flags<GG::ModKey>(), GG::Pt(), GG::Pt()));
+        }
+    }
+
+    struct FrameSample
+    {
+        FrameSample() : microseconds(0), allocations(0), draw_calls(0) {}
+        boost::uint64_t microseconds;
+        std::size_t     allocations;
+        std::size_t     draw_calls;
+    };
+
+    template <class T>
+    T Percentile(std::vector<T> values, double p)
+    {
+        if (values.empty())
+            return T();
+        std::sort(values.begin(), values.end());
+        std::size_t index = static_cast<std::size_t>(p * (values.size() - 1) + 0.5);
+        return values[index];
+    }
+
+    /** The windows created by a scenario's setup function are added to \a
+        windows, and deleted when the scenario is done. */
+    typedef void (*SetupFn)(GG::HeadlessGUI& gui, std::vector<GG::Wnd*>& windows, std::size_t frames);
+
+    struct Scenario
+    {
+        Scenario() : setup(0) {}
+        Scenario(const std::string& name_, SetupFn setup_) : name(name_), setup(setup_) {}
+        Scenario(const std::string& name_, const std::string& eve_file_, const std::string& adam_file_) :
+            name(name_), setup(0), eve_file(eve_file_), adam_file(adam_file_) {}
+        std::string name;
+        SetupFn     setup;
+        std::string eve_file;  // only used by Eve scenarios
+        std::string adam_file; // only used by Eve scenarios
+    };
+
+    struct ScenarioResult
+    {
+        ScenarioResult() : load_time_us(-1), peak_memory_kb(-1) {}
+        std::string              name;
+        std::vector<FrameSample> samples;
+        long                     load_time_us;   // -1 if the scenario loads no texture
+        long                     peak_memory_kb; // -1 if not measured
+    };
+
+    // set by the setup functions of texture-loading scenarios
+    long g_load_time_us = -1;
+    long g_peak_memory_kb = -1;
+
+    /** Returns the value of the field \a name (e.g. "VmRSS:") of
+        /proc/self/status, in kB, or -1 if it cannot be read. */
+    long ProcStatusKB(const std::string& name)
+    {
+        std::ifstream ifs("/proc/self/status");
+        std::string field;
+        while (ifs >> field) {
+            if (field == name) {
+                long retval = -1;
+                ifs >> retval;
+                return retval;
+            }
+            std::getline(ifs, field);
+        }
+        return -1;
+    }
+
+    /** Resets the process's peak resident set size to its current resident
+        set size.  Returns false if this is not possible. */
+    bool ResetPeakMemory()
+    {
+        std::ofstream ofs("/proc/self/clear_refs");
+        ofs << "5";
+        ofs.close();
+        return !ofs.fail();
+    }
+
+
+    ////////////////////////////////////////
+    // Scenarios
+    ////////////////////////////////////////
+    const std::size_t LAYOUT_ROWS = 20;
+    const std::size_t LAYOUT_COLUMNS = 10;
+    const std::size_t LISTBOX_ROWS = 100000;
+    const std::size_t MULTIEDIT_BYTES = 10 * 1024 * 1024;
+    const std::size_t NESTING_DEPTH = 200;
+    const int LARGE_IMAGE_SIZE = 4096;
+
+    class BoxWnd : public GG::Wnd
+    {
+    public:
+        BoxWnd(GG::X x, GG::Y y, GG::X w, GG::Y h) :
+            Wnd(x, y, w, h, GG::INTERACTIVE)
+            {}
+        virtual void Render()
+            { GG::FlatRectangle(UpperLeft(), LowerRight(), GG::CLR_GRAY, GG::CLR_BLACK, 1); }
+    };
+
+    void ButtonsInLayout(GG::HeadlessGUI& gui, std::vector<GG::Wnd*>& windows, std::size_t frames)
+    {
+        GG::Wnd* container = new BoxWnd(GG::X(10), GG::Y(10), GG::X(1000), GG::Y(740));
+        GG::Layout* layout = new GG::Layout(GG::X0, GG::Y0, container->Width(), container->Height(),
+                                            LAYOUT_ROWS, LAYOUT_COLUMNS, 2, 2);
+        for (std::size_t row = 0; row < LAYOUT_ROWS; ++row) {
+            for (std::size_t column = 0; column < LAYOUT_COLUMNS; ++column) {
+                std::string label = "Button " + boost::lexical_cast<std::string>(row * LAYOUT_COLUMNS + column);
+                layout->Add(new GG::Button(GG::X0, GG::Y0, GG::X(90), GG::Y(30), label, BenchFont(), GG::CLR_GRAY),
+                            row, column);
+            }
+        }
+        container->SetLayout(layout);
+        gui.Register(container);
+        windows.push_back(container);
+        ScriptMouseSweep(gui, ScreenRect(container), frames, true);
+    }
+
+    void HugeListBox(GG::HeadlessGUI& gui, std::vector<GG::Wnd*>& windows, std::size_t frames)
+    {
+        GG::ListBox* list = new GG::ListBox(GG::X(10), GG::Y(10), GG::X(600), GG::Y(740), GG::CLR_GRAY, GG::CLR_WHITE);
+        boost::shared_ptr<GG::Font> font = BenchFont();
+        for (std::size_t i = 0; i < LISTBOX_ROWS; ++i) {
+            GG::ListBox::Row* row = new GG::ListBox::Row(GG::X(580), GG::Y(20), "");
+            row->push_back("Row " + boost::lexical_cast<std::string>(i), font);
+            list->Insert(row);
+        }
+        gui.Register(list);
+        windows.push_back(list);
+        // scroll through the list with the wheel while the mouse sweeps
+        // across it
+        ScriptMouseSweep(gui, ScreenRect(list), frames, true);
+        const GG::Pt center = ScreenRect(list).ul + GG::Pt(list->Width() / 2, list->Height() / 2);
+        for (std::size_t i = 0; i < frames; ++i) {
+            gui.ScriptEvent(GG::HeadlessGUI::ScriptedEvent(gui.Ticks() + i * gui.FrameTicks(), GG::GUI::MOUSEWHEEL,
+                                                           GG::GGK_UNKNOWN, 0, GG::Flags<GG::ModKey>(),
+                                                           center, GG::Pt(GG::X0, -GG::Y1)));
+        }
+    }
+
+    void HugeMultiEdit(GG::HeadlessGUI& gui, std::vector<GG::Wnd*>& windows, std::size_t frames)
+    {
+        const std::string line = "The quick brown fox jumps over the lazy dog.  0123456789 ABCDEFGHIJKLMNOPQRSTU\n";
+        std::string text;
+        text.reserve(MULTIEDIT_BYTES + line.size());
+        while (text.size() < MULTIEDIT_BYTES) {
+            text += line;
+        }
+        GG::MultiEdit* edit = new GG::MultiEdit(GG::X(10), GG::Y(10), GG::X(1000), GG::Y(740), text, BenchFont(),
+                                                GG::CLR_GRAY, GG::MULTI_NONE, GG::CLR_BLACK, GG::CLR_WHITE);
+        gui.Register(edit);
+        gui.SetFocusWnd(edit);
+        windows.push_back(edit);
+        ScriptKeys(gui, GG::GGK_PAGEDOWN, frames);
+    }
+
+    void ColorDialog(GG::HeadlessGUI& gui, std::vector<GG::Wnd*>& windows, std::size_t frames)
+    {
+        GG::ColorDlg* dlg = new GG::ColorDlg(GG::X(100), GG::Y(100), GG::CLR_CYAN, BenchFont(),
+                                             GG::CLR_GRAY, GG::CLR_GRAY, GG::CLR_BLACK);
+        gui.Register(dlg);
+        windows.push_back(dlg);
+        // no clicks, since these would eventually hit the Ok or Cancel
+        // button
+        ScriptMouseSweep(gui, ScreenRect(dlg), frames, false);
+    }
+
+    void DeepNesting(GG::HeadlessGUI& gui, std::vector<GG::Wnd*>& windows, std::size_t frames)
+    {
+        const int INSET = 1;
+        GG::Wnd* root = new BoxWnd(GG::X(10), GG::Y(10), GG::X(1000), GG::Y(740));
+        GG::Wnd* parent = root;
+        for (std::size_t i = 0; i < NESTING_DEPTH; ++i) {
+            GG::Wnd* child = new BoxWnd(GG::X(INSET), GG::Y(INSET),
+                                        parent->Width() - 2 * INSET, parent->Height() - 2 * INSET);
+            parent->AttachChild(child);
+            parent = child;
+        }
+        gui.Register(root);
+        windows.push_back(root);
+        ScriptMouseSweep(gui, ScreenRect(root), frames, true);
+    }
+
+#if GG_HAVE_LIBPNG
+    /** Returns the name of a LARGE_IMAGE_SIZE x LARGE_IMAGE_SIZE RGBA PNG,
+        creating it in the temporary directory if necessary. */
+    std::string LargeImageFile()
+    {
+        namespace fs = boost::filesystem;
+        fs::path path = fs::temp_directory_path() /
+            ("gg_bench_" + boost::lexical_cast<std::string>(LARGE_IMAGE_SIZE) + ".png");
+        if (!fs::exists(path)) {
+            namespace gil = boost::gil;
+            gil::rgba8_image_t image(LARGE_IMAGE_SIZE, LARGE_IMAGE_SIZE);
+            gil::rgba8_view_t view = gil::view(image);
+            for (int y = 0; y < LARGE_IMAGE_SIZE; ++y) {
+                for (int x = 0; x < LARGE_IMAGE_SIZE; ++x) {
+                    view(x, y) = gil::rgba8_pixel_t(x & 0xFF, y & 0xFF, (x * y) >> 8 & 0xFF, 0xFF);
+                }
+            }
+            gil::png_write_view(GG::PathToUTF8(path), gil::const_view(image));
+        }
+        return GG::PathToUTF8(path);
+    }
+
+    void LargeTextureLoad(GG::HeadlessGUI& gui, std::vector<GG::Wnd*>& windows, std::size_t frames)
+    {
+        std::string filename = LargeImageFile();
+        gui.FreeTexture(filename);
+
+        bool peak_reset = ResetPeakMemory();
+        long memory_before = ProcStatusKB("VmRSS:");
+        boost::uint64_t start = Microseconds();
+        boost::shared_ptr<GG::Texture> texture = gui.GetTexture(filename);
+        g_load_time_us = static_cast<long>(Microseconds() - start);
+        long peak_memory = ProcStatusKB("VmHWM:");
+        if (peak_reset && 0 <= memory_before && 0 <= peak_memory)
+            g_peak_memory_kb = peak_memory - memory_before;
+        gui.FreeTexture(filename);
+
+        GG::StaticGraphic* graphic = new GG::StaticGraphic(GG::X(10), GG::Y(10), GG::X(1000), GG::Y(740), texture,
+                                                           GG::GRAPHIC_FITGRAPHIC | GG::GRAPHIC_PROPSCALE);
+        gui.Register(graphic);
+        windows.push_back(graphic);
+        ScriptMouseSweep(gui, ScreenRect(graphic), frames, false);
+    }
+#endif
+
+    void EveDialogScenario(GG::HeadlessGUI& gui, std::vector<GG::Wnd*>& windows, std::size_t frames,
+                           const std::string& eve_file, const std::string& adam_file)
+    {
+        GG::EveDialog* dlg = GG::MakeEveDialog(GG::UTF8ToPath(eve_file), GG::UTF8ToPath(adam_file), &IgnoreButton);
+        gui.Register(dlg);
+        windows.push_back(dlg);
+        ScriptMouseSweep(gui, ScreenRect(dlg), frames, true);
+    }
+
+    std::vector<Scenario> AllScenarios()
+    {
+        std::vector<Scenario> retval;
+        retval.push_back(Scenario("buttons_in_layout", &ButtonsInLayout));
+        retval.push_back(Scenario("listbox_100k_rows", &HugeListBox));
+        retval.push_back(Scenario("multiedit_10mb", &HugeMultiEdit));
+        retval.push_back(Scenario("color_dlg", &ColorDialog));
+        retval.push_back(Scenario("deep_nesting", &DeepNesting));
+#if GG_HAVE_LIBPNG
+        retval.push_back(Scenario("texture_load_4096", &LargeTextureLoad));
+#endif
+
+        namespace fs = boost::filesystem;
+        fs::path eve_dir = GG::UTF8ToPath(BENCH_DATA_DIR) / "asl_1.0.43_eve_files";
+        fs::path adam_dir = GG::UTF8ToPath(BENCH_DATA_DIR) / "asl_1.0.43_adam_files";
+        std::vector<fs::path> eve_files;
+        if (fs::is_directory(eve_dir)) {
+            for (fs::directory_iterator it(eve_dir); it != fs::directory_iterator(); ++it) {
+                if (it->path().extension() == ".eve")
+                    eve_files.push_back(it->path());
+            }
+        }
+        std::sort(eve_files.begin(), eve_files.end());
+        for (std::size_t i = 0; i < eve_files.size(); ++i) {
+            fs::path adam_file = adam_dir / (eve_files[i].stem().native() + ".adm");
+            if (fs::exists(adam_file)) {
+                retval.push_back(Scenario("eve_" + eve_files[i].stem().native(),
+                                          GG::PathToUTF8(eve_files[i]), GG::PathToUTF8(adam_file)));
+            }
+        }
+        return retval;
+    }
+
+
+    ////////////////////////////////////////
+    // BenchGUI
+    ////////////////////////////////////////
+    class BenchGUI : public GG::HeadlessGUI
+    {
+    public:
+        BenchGUI(const std::vector<Scenario>& scenarios) :
+            HeadlessGUI(1024, 768, "GiGi benchmarks"),
+            m_scenarios(scenarios),
+            m_current(0),
+            m_frame(0),
+            m_frame_begin(0),
+            m_allocations_begin(0)
+            { SetMaxFrames(m_scenarios.size() * (WARMUP_FRAMES + g_frames)); }
+
+        const std::vector<ScenarioResult>& Results() const
+            { return m_results; }
+
+    protected:
+        virtual void Initialize()
+            {
+                if (!m_scenarios.empty())
+                    BeginScenario();
+            }
+
+        virtual void HandleSystemEvents()
+            {
+                m_frame_begin = Microseconds();
+                m_allocations_begin = Allocations();
+                HeadlessGUI::HandleSystemEvents();
+            }
+
+        virtual void RenderEnd()
+            {
+                HeadlessGUI::RenderEnd();
+                if (m_current == m_scenarios.size())
+                    return;
+                if (WARMUP_FRAMES <= m_frame) {
+                    FrameSample sample;
+                    sample.microseconds = Microseconds() - m_frame_begin;
+                    sample.allocations = Allocations() - m_allocations_begin;
+                    sample.draw_calls = LastFrameRenderStats().draw_calls;
+                    m_results.back().samples.push_back(sample);
+                }
+                if (++m_frame == WARMUP_FRAMES + g_frames) {
+                    EndScenario();
+                    if (++m_current < m_scenarios.size())
+                        BeginScenario();
+                }
+            }
+
+    private:
+        void BeginScenario()
+            {
+                const Scenario& scenario = m_scenarios[m_current];
+                std::cerr << "Running " << scenario.name << " ..." << std::endl;
+                m_results.push_back(ScenarioResult());
+                m_results.back().name = scenario.name;
+                m_results.back().samples.reserve(g_frames);
+                m_frame = 0;
+                std::size_t frames = WARMUP_FRAMES + g_frames;
+                g_load_time_us = g_peak_memory_kb = -1;
+                if (scenario.setup)
+                    scenario.setup(*this, m_windows, frames);
+                else
+                    EveDialogScenario(*this, m_windows, frames, scenario.eve_file, scenario.adam_file);
+                m_results.back().load_time_us = g_load_time_us;
+                m_results.back().peak_memory_kb = g_peak_memory_kb;
+            }
+
+        void EndScenario()
+            {
+                ClearScriptedEvents();
+                for (std::size_t i = 0; i < m_windows.size(); ++i) {
+                    delete m_windows[i];
+                }
+                m_windows.clear();
+            }
+
+        std::vector<Scenario>       m_scenarios;
+        std::size_t                 m_current;
+        std::size_t                 m_frame;
+        boost::uint64_t             m_frame_begin;
+        std::size_t                 m_allocations_begin;
+        std::vector<GG::Wnd*>       m_windows;
+        std::vector<ScenarioResult> m_results;
+    };
+
+
+    ////////////////////////////////////////
+    // Output
+    ////////////////////////////////////////
+    void WriteStat(std::ostream& os, const char* name, const std::vector<boost::uint64_t>& values)
+    {
+        os << "\"" << name << "\":{\"p50\":" << Percentile(values, 0.50)
+           << ",\"p99\":" << Percentile(values, 0.99)
+           << ",\"max\":" << Percentile(values, 1.0) << "}";
+    }
+
+    void WriteJSON(std::ostream& os, const std::vector<ScenarioResult>& results)
+    {
+        os << "{\n\"frames\":" << g_frames << ",\n\"warmup_frames\":" << WARMUP_FRAMES << ",\n\"scenarios\":[";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const ScenarioResult& result = results[i];
+            std::vector<boost::uint64_t> times, allocations, draw_calls;
+            for (std::size_t j = 0; j < result.samples.size(); ++j) {
+                times.push_back(result.samples[j].microseconds);
+                allocations.push_back(result.samples[j].allocations);
+                draw_calls.push_back(result.samples[j].draw_calls);
+            }
+            os << (i ? ",\n" : "\n") << "{\"name\":\"" << result.name << "\",";
+            WriteStat(os, "frame_time_us", times);
+            os << ",";
+            WriteStat(os, "allocations", allocations);
+            os << ",";
+            WriteStat(os, "draw_calls", draw_calls);
+            if (0 <= result.load_time_us) {
+                os << ",\"load_time_us\":" << result.load_time_us
+                   << ",\"peak_memory_kb\":" << result.peak_memory_kb;
+            }
+            os << "}";
+        }
+        os << "\n]}\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string output_file;
+    std::vector<std::string> selected;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            g_frames = boost::lexical_cast<std::size_t>(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            output_file = argv[++i];
+        } else if (arg == "--help") {
+            std::cout << "Usage: " << argv[0] << " [--frames N] [--output file.json] [scenario ...]\n";
+            return 0;
+        } else {
+            selected.push_back(arg);
+        }
+    }
+
+    std::vector<Scenario> scenarios = AllScenarios();
+    if (!selected.empty()) {
+        std::vector<Scenario> filtered;
+        for (std::size_t i = 0; i < scenarios.size(); ++i) {
+            if (std::find(selected.begin(), selected.end(), scenarios[i].name) != selected.end())
+                filtered.push_back(scenarios[i]);
+        }
+        scenarios.swap(filtered);
+    }
+    if (scenarios.empty()) {
+        std::cerr << "No scenarios to run.\n";
+        return 1;
+    }
+
+    BenchGUI gui(scenarios);
+    gui();
+
+    if (output_file.empty()) {
+        WriteJSON(std::cout, gui.Results());
+    } else {
+        std::ofstream ofs(output_file.c_str());
+        WriteJSON(ofs, gui.Results());
+    }
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include <GG/adobe/adam_parser.hpp>
+#include <GG/adobe/array.hpp>
+#include <GG/adobe/dictionary.hpp>
+#include <GG/adobe/name.hpp>
+#include <GG/adobe/string.hpp>
+#include <GG/adobe/virtual_machine.hpp>
+
+#include "AllocationCounter.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Expression evaluation microbenchmarks
+//
+// Every expression in test/test_expressions that can be evaluated against a
+// fixed set of variables, plus a few expressions that stress the
+// short-circuiting operators, ?: and string concatenation, is evaluated
+// repeatedly by adobe::virtual_machine_t, both from its expression array and
+// from its compiled form, after checking that both forms give the same
+// value.  The time and number of heap allocations per evaluation are
+// written out as JSON, for comparison between runs.
+//
+// Usage: gg-expression-bench [--iterations N] [--output file.json]
+
+
+
+namespace {
+    const std::size_t DEFAULT_ITERATIONS = 100000;
+
+    std::size_t g_iterations = DEFAULT_ITERATIONS;
+
+    const char* EXTRA_EXPRESSIONS[] = {
+        "a && (b || c) && !d",
+        "b || (a && c && (q || r))",
+        "a ? (c ? x + y : x - y) : (d ? x * y : x / y)",
+        "s + \" and \" + t + \" again\"",
+        "x + y * 2 - x / y + x * (y - 1)",
+        "a ? [x, y, s] : {u: x, v: t}"
+    };
+
+    boost::uint64_t Microseconds()
+    {
+        using namespace boost::posix_time;
+        static const ptime EPOCH(microsec_clock::universal_time());
+        return (microsec_clock::universal_time() - EPOCH).total_microseconds();
+    }
+
+    // Single-letter variables a-d, q and r are booleans, s and t are
+    // strings, and the rest are numbers.
+    adobe::any_regular_t LookupVariable(adobe::name_t name)
+    {
+        const char* str = name.c_str();
+        if (!str[0] || str[1])
+            return adobe::any_regular_t();
+        switch (str[0]) {
+        case 'a': case 'c': case 'q': return adobe::any_regular_t(true);
+        case 'b': case 'd': case 'r': return adobe::any_regular_t(false);
+        case 's': return adobe::any_regular_t(adobe::string_t("some string"));
+        case 't': return adobe::any_regular_t(adobe::string_t("another string"));
+        default:  return adobe::any_regular_t(double(str[0] - 'a' + 1));
+        }
+    }
+
+    struct Sample
+    {
+        Sample() : nanoseconds(0.0), allocations(0.0) {}
+        double nanoseconds; // per evaluation
+        double allocations; // per evaluation
+    };
+
+    struct ExpressionResult
+    {
+        std::string source;
+        Sample      interpreted;
+        Sample      compiled;
+    };
+
+    template <class Expression>
+    Sample Time(adobe::virtual_machine_t& vm, const Expression& expression)
+    {
+        std::size_t allocations = Allocations();
+        boost::uint64_t start = Microseconds();
+        for (std::size_t i = 0; i < g_iterations; ++i) {
+            vm.evaluate(expression);
+            vm.pop_back();
+        }
+        Sample retval;
+        retval.nanoseconds = (Microseconds() - start) * 1000.0 / g_iterations;
+        retval.allocations = static_cast<double>(Allocations() - allocations) / g_iterations;
+        return retval;
+    }
+
+    /** Returns true iff \a expression evaluates without throwing.  A
+        separate VM is used, since a throw can leave values on its stack. */
+    bool Evaluates(const adobe::array_t& expression)
+    {
+        adobe::virtual_machine_t vm;
+        vm.set_variable_lookup(&LookupVariable);
+        try {
+            vm.evaluate(expression);
+            vm.pop_back();
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    /** Returns the value \a expression evaluates to, interpreted or
+        compiled. */
+    template <class Expression>
+    adobe::any_regular_t EvaluatedValue(const Expression& expression)
+    {
+        adobe::virtual_machine_t vm;
+        vm.set_variable_lookup(&LookupVariable);
+        vm.evaluate(expression);
+        return vm.back();
+    }
+
+    std::string JSONString(const std::string& str)
+    {
+        std::string retval = "\"";
+        for (std::size_t i = 0; i < str.size(); ++i) {
+            if (str[i] == '"' || str[i] == '\\')
+                retval += '\\';
+            retval += str[i];
+        }
+        return retval + "\"";
+    }
+
+    void WriteSample(std::ostream& os, const char* name, const Sample& sample)
+    {
+        os << "\"" << name << "\":{\"ns\":" << sample.nanoseconds
+           << ",\"allocations\":" << sample.allocations << "}";
+    }
+
+    void WriteJSON(std::ostream& os, const std::vector<ExpressionResult>& results, std::size_t skipped)
+    {
+        Sample interpreted_total, compiled_total;
+        os << "{\n\"iterations\":" << g_iterations << ",\n\"skipped\":" << skipped << ",\n\"expressions\":[";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const ExpressionResult& result = results[i];
+            os << (i ? ",\n" : "\n") << "{\"source\":" << JSONString(result.source) << ",";
+            WriteSample(os, "interpreted", result.interpreted);
+            os << ",";
+            WriteSample(os, "compiled", result.compiled);
+            os << "}";
+            interpreted_total.nanoseconds += result.interpreted.nanoseconds;
+            interpreted_total.allocations += result.interpreted.allocations;
+            compiled_total.nanoseconds += result.compiled.nanoseconds;
+            compiled_total.allocations += result.compiled.allocations;
+        }
+        os << "\n],\n\"total\":{";
+        WriteSample(os, "interpreted", interpreted_total);
+        os << ",";
+        WriteSample(os, "compiled", compiled_total);
+        os << "}\n}\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string output_file;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            g_iterations = std::max<std::size_t>(1, boost::lexical_cast<std::size_t>(argv[++i]));
+        } else if (arg == "--output" && i + 1 < argc) {
+            output_file = argv[++i];
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--iterations N] [--output file.json]\n";
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<std::string> sources;
+    std::ifstream ifs((std::string(BENCH_DATA_DIR) + "/test_expressions").c_str());
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (!line.empty())
+            sources.push_back(line);
+    }
+    sources.insert(sources.end(), EXTRA_EXPRESSIONS,
+                   EXTRA_EXPRESSIONS + sizeof(EXTRA_EXPRESSIONS) / sizeof(EXTRA_EXPRESSIONS[0]));
+
+    adobe::virtual_machine_t vm;
+    vm.set_variable_lookup(&LookupVariable);
+
+    std::vector<ExpressionResult> results;
+    std::size_t skipped = 0;
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        adobe::array_t expression;
+        try {
+            expression = adobe::parse_adam_expression(sources[i]);
+        } catch (const std::exception&) {
+            ++skipped;
+            continue;
+        }
+        if (!Evaluates(expression)) {
+            ++skipped;
+            continue;
+        }
+        std::cerr << "Timing " << sources[i] << " ..." << std::endl;
+        adobe::virtual_machine_t::compiled_expression_t compiled(expression);
+        // a compiled form that computes something else would be timed
+        // meaninglessly, so no timings are reported for any expression
+        // unless both forms agree on every one
+        if (EvaluatedValue(compiled) != EvaluatedValue(expression)) {
+            std::cerr << "The compiled form of " << sources[i] << " evaluates to a different value "
+                "than the expression itself; no timings are reported." << std::endl;
+            return 1;
+        }
+        results.push_back(ExpressionResult());
+        results.back().source = sources[i];
+        results.back().interpreted = Time(vm, expression);
+        results.back().compiled = Time(vm, compiled);
+    }
+
+    if (output_file.empty()) {
+        WriteJSON(std::cout, results, skipped);
+    } else {
+        std::ofstream ofs(output_file.c_str());
+        WriteJSON(ofs, results, skipped);
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <GG/adobe/name.hpp>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Name interning microbenchmarks
+//
+// adobe::name_t is constructed from strings constantly, by the parsers, the
+// factories and every get_value call, and each construction interns its
+// string.  This times interning names that are already interned (the common
+// case) and names that are new, on one thread and on several threads at
+// once, and writes the time per name out as JSON, for comparison between
+// runs.
+//
+// Usage: gg-name-bench [--iterations N] [--output file.json]
+
+
+namespace {
+    const std::size_t DEFAULT_ITERATIONS = 200;
+    const std::size_t NUM_NAMES = 4096;
+    const std::size_t THREAD_COUNTS[] = { 1, 2, 4, 8 };
+    const std::size_t NUM_THREAD_COUNTS = sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]);
+
+    std::size_t g_iterations = DEFAULT_ITERATIONS;
+
+    boost::uint64_t Microseconds()
+    {
+        using namespace boost::posix_time;
+        static const ptime EPOCH(microsec_clock::universal_time());
+        return (microsec_clock::universal_time() - EPOCH).total_microseconds();
+    }
+
+    /** Returns \a count identifier-like strings starting with \a prefix,
+        similar in length to the cell and view parameter names in Adam and
+        Eve definitions. */
+    std::vector<std::string> Names(const std::string& prefix, std::size_t count)
+    {
+        std::vector<std::string> retval;
+        for (std::size_t i = 0; i < count; ++i) {
+            retval.push_back(prefix + "_name_" + boost::lexical_cast<std::string>(i));
+        }
+        return retval;
+    }
+
+    struct InternNames
+    {
+        InternNames(const std::vector<std::string>& names, std::size_t iterations) :
+            m_names(&names),
+            m_iterations(iterations)
+        {}
+        void operator()() const
+        {
+            for (std::size_t i = 0; i < m_iterations; ++i) {
+                for (std::size_t j = 0; j < m_names->size(); ++j) {
+                    adobe::name_t name((*m_names)[j].c_str());
+                }
+            }
+        }
+        const std::vector<std::string>* m_names;
+        std::size_t                     m_iterations;
+    };
+
+    struct Result
+    {
+        Result() : threads(0), nanoseconds(0.0) {}
+        std::string scenario;
+        std::size_t threads;
+        double      nanoseconds; // wall time per name on each thread
+    };
+
+    /** Interns every string in names[i] on thread i, \a iterations times,
+        and returns the time per name. */
+    Result Time(const std::string& scenario,
+                const std::vector<std::vector<std::string> >& names,
+                std::size_t iterations)
+    {
+        boost::thread_group threads;
+        boost::uint64_t start = Microseconds();
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            threads.create_thread(InternNames(names[i], iterations));
+        }
+        threads.join_all();
+        Result retval;
+        retval.scenario = scenario;
+        retval.threads = names.size();
+        retval.nanoseconds = (Microseconds() - start) * 1000.0 / (iterations * names[0].size());
+        return retval;
+    }
+
+    void WriteJSON(std::ostream& os, const std::vector<Result>& results)
+    {
+        os << "{\n\"iterations\":" << g_iterations << ",\n\"names\":" << NUM_NAMES << ",\n\"results\":[";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Result& result = results[i];
+            os << (i ? ",\n" : "\n") << "{\"scenario\":\"" << result.scenario << "\",\"threads\":"
+               << result.threads << ",\"ns\":" << result.nanoseconds << "}";
+        }
+        os << "\n]\n}\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string output_file;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            g_iterations = std::max<std::size_t>(1, boost::lexical_cast<std::size_t>(argv[++i]));
+        } else if (arg == "--output" && i + 1 < argc) {
+            output_file = argv[++i];
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--iterations N] [--output file.json]\n";
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<Result> results;
+    for (std::size_t i = 0; i < NUM_THREAD_COUNTS; ++i) {
+        std::size_t thread_count = THREAD_COUNTS[i];
+        std::string suffix = boost::lexical_cast<std::string>(thread_count);
+        std::cerr << "Timing " << thread_count << " thread(s) ..." << std::endl;
+
+        // every thread interns the same, already-interned names
+        std::vector<std::vector<std::string> > shared(thread_count, Names("shared", NUM_NAMES));
+        Time("existing", shared, 1);
+        results.push_back(Time("existing", shared, g_iterations));
+
+        // every thread interns its own names, which are new the first time
+        std::vector<std::vector<std::string> > distinct;
+        for (std::size_t j = 0; j < thread_count; ++j) {
+            distinct.push_back(Names("new" + suffix + "_" + boost::lexical_cast<std::string>(j), NUM_NAMES));
+        }
+        results.push_back(Time("new", distinct, 1));
+
+        // every thread interns the same names, which are new the first time
+        std::vector<std::vector<std::string> > contended(thread_count, Names("contended" + suffix, NUM_NAMES));
+        results.push_back(Time("new-contended", contended, 1));
+    }
+
+    if (output_file.empty()) {
+        WriteJSON(std::cout, results);
+    } else {
+        std::ofstream ofs(output_file.c_str());
+        WriteJSON(ofs, results);
+    }
+    return 0;
+}
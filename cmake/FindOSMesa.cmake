@@ -0,0 +1,20 @@
+# - Find the OSMesa off-screen software OpenGL renderer
+#
+# This module defines
+#  OSMESA_INCLUDE_DIR, where to find GL/osmesa.h
+#  OSMESA_LIBRARY, the library to link against to use OSMesa
+#  OSMESA_FOUND, If false, do not try to use OSMesa
+
+find_path(OSMESA_INCLUDE_DIR GL/osmesa.h
+    PATHS /usr/include /usr/local/include /opt/local/include
+)
+
+find_library(OSMESA_LIBRARY
+    NAMES OSMesa OSMesa32 osmesa
+    PATHS /usr/lib /usr/local/lib /opt/local/lib
+)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(OSMesa DEFAULT_MSG OSMESA_LIBRARY OSMESA_INCLUDE_DIR)
+
+mark_as_advanced(OSMESA_INCLUDE_DIR OSMESA_LIBRARY)
@@ -0,0 +1,544 @@
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+#include "CompressedImage.h"
+
+#include <GG/Texture.h>
+
+#include <boost/cstdint.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+
+using namespace GG;
+using namespace GG::detail;
+
+namespace {
+    const unsigned char KTX_IDENTIFIER[12] =
+        { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const boost::uint32_t KTX_ENDIANNESS = 0x04030201;
+    const boost::uint32_t KTX_SWAPPED_ENDIANNESS = 0x01020304;
+
+    const std::size_t DDS_HEADER_SIZE = 128; // including the "DDS " magic number
+    const std::size_t DDS_DX10_HEADER_SIZE = 20;
+    const boost::uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    const boost::uint32_t DDPF_FOURCC = 0x4;
+
+    const int ETC_MODIFIERS[8][2] = {
+        {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}
+    };
+
+    const int ETC2_DISTANCES[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+    const int EAC_MODIFIERS[16][8] = {
+        {-3, -6, -9, -15, 2, 5, 8, 14},
+        {-3, -7, -10, -13, 2, 6, 9, 12},
+        {-2, -5, -8, -13, 1, 4, 7, 12},
+        {-2, -4, -6, -13, 1, 3, 5, 12},
+        {-3, -6, -8, -12, 2, 5, 7, 11},
+        {-3, -7, -9, -11, 2, 6, 8, 10},
+        {-4, -7, -8, -11, 3, 6, 7, 10},
+        {-3, -5, -8, -11, 2, 4, 7, 10},
+        {-2, -6, -8, -10, 1, 5, 7, 9},
+        {-2, -5, -8, -10, 1, 4, 7, 9},
+        {-2, -4, -8, -10, 1, 3, 7, 9},
+        {-2, -5, -7, -10, 1, 4, 6, 9},
+        {-3, -4, -7, -10, 2, 3, 6, 9},
+        {-1, -2, -3, -10, 0, 1, 2, 9},
+        {-4, -6, -8, -9, 3, 5, 7, 8},
+        {-3, -5, -7, -9, 2, 4, 6, 8}
+    };
+
+    boost::uint32_t ReadLE32(const unsigned char* bytes)
+    { return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (boost::uint32_t(bytes[3]) << 24); }
+
+    boost::uint32_t ReadBE32(const unsigned char* bytes)
+    { return (boost::uint32_t(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3]; }
+
+    boost::uint32_t SwapBytes(boost::uint32_t value)
+    { return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24); }
+
+    boost::uint32_t FourCC(const char* code)
+    { return ReadLE32(reinterpret_cast<const unsigned char*>(code)); }
+
+    unsigned char Clamp255(int value)
+    { return static_cast<unsigned char>(std::min(255, std::max(0, value))); }
+
+    unsigned char Extend4(int value)
+    { return static_cast<unsigned char>((value << 4) | value); }
+
+    unsigned char Extend5(int value)
+    { return static_cast<unsigned char>((value << 3) | (value >> 2)); }
+
+    unsigned char Extend6(int value)
+    { return static_cast<unsigned char>((value << 2) | (value >> 4)); }
+
+    unsigned char Extend7(int value)
+    { return static_cast<unsigned char>((value << 1) | (value >> 6)); }
+
+    std::size_t BlockBytes(GLenum internal_format)
+    {
+        return (internal_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ||
+                internal_format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ||
+                internal_format == GL_COMPRESSED_RGB8_ETC2) ? 8 : 16;
+    }
+
+    std::size_t LevelSize(GLenum internal_format, X width, Y height)
+    {
+        std::size_t blocks_wide = std::max(1, (Value(width) + 3) / 4);
+        std::size_t blocks_high = std::max(1, (Value(height) + 3) / 4);
+        return blocks_wide * blocks_high * BlockBytes(internal_format);
+    }
+
+    void ReadFile(const std::string& path_name, std::vector<unsigned char>& contents)
+    {
+        std::ifstream ifs(path_name.c_str(), std::ios::in | std::ios::binary);
+        if (!ifs)
+            throw Texture::BadFile("Could not open compressed texture file \"" + path_name + "\"");
+        ifs.seekg(0, std::ios::end);
+        contents.resize(static_cast<std::size_t>(ifs.tellg()));
+        ifs.seekg(0, std::ios::beg);
+        if (!contents.empty())
+            ifs.read(reinterpret_cast<char*>(&contents[0]), contents.size());
+        if (!ifs)
+            throw Texture::BadFile("Could not read compressed texture file \"" + path_name + "\"");
+    }
+
+    /** Moves \a contents into \a image, and records levels of the sizes
+        implied by the image's format and dimensions, starting at \a offset. */
+    void AddLevels(const std::string& path_name, std::vector<unsigned char>& contents, std::size_t offset,
+                   X width, Y height, std::size_t levels, CompressedImage& image)
+    {
+        for (std::size_t i = 0; i < levels; ++i) {
+            CompressedImage::Level level;
+            level.width = width;
+            level.height = height;
+            level.offset = offset;
+            level.size = LevelSize(image.internal_format, width, height);
+            if (contents.size() < offset + level.size)
+                throw Texture::BadFile("Compressed texture file \"" + path_name + "\" is truncated");
+            image.levels.push_back(level);
+            offset += level.size;
+            if (width == 1 && height == 1)
+                break;
+            width = std::max(X1, width / 2);
+            height = std::max(Y1, height / 2);
+        }
+        image.data.swap(contents);
+    }
+
+    void ReadDDS(const std::string& path_name, std::vector<unsigned char>& contents, CompressedImage& image)
+    {
+        if (contents.size() < DDS_HEADER_SIZE)
+            throw Texture::BadFile("Compressed texture file \"" + path_name + "\" is truncated");
+        const unsigned char* header = &contents[0];
+        boost::uint32_t flags = ReadLE32(header + 8);
+        Y height(static_cast<int>(ReadLE32(header + 12)));
+        X width(static_cast<int>(ReadLE32(header + 16)));
+        std::size_t levels = (flags & DDSD_MIPMAPCOUNT) ? std::max(boost::uint32_t(1), ReadLE32(header + 28)) : 1;
+        boost::uint32_t pixel_format_flags = ReadLE32(header + 80);
+        boost::uint32_t four_cc = ReadLE32(header + 84);
+        std::size_t offset = DDS_HEADER_SIZE;
+
+        if (!(pixel_format_flags & DDPF_FOURCC))
+            throw Texture::BadFile("Texture file \"" + path_name + "\" is not a compressed DDS file");
+
+        if (four_cc == FourCC("DXT1")) {
+            image.internal_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        } else if (four_cc == FourCC("DXT3")) {
+            image.internal_format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+        } else if (four_cc == FourCC("DXT5")) {
+            image.internal_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        } else if (four_cc == FourCC("DX10")) {
+            if (contents.size() < DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE)
+                throw Texture::BadFile("Compressed texture file \"" + path_name + "\" is truncated");
+            boost::uint32_t dxgi_format = ReadLE32(header + DDS_HEADER_SIZE);
+            boost::uint32_t array_size = ReadLE32(header + DDS_HEADER_SIZE + 12);
+            if (1 < array_size)
+                throw Texture::BadFile("DDS file \"" + path_name + "\" contains a texture array");
+            switch (dxgi_format) {
+            case 71: case 72: image.internal_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break; // BC1
+            case 74: case 75: image.internal_format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break; // BC2
+            case 77: case 78: image.internal_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break; // BC3
+            default: throw Texture::BadFile("DDS file \"" + path_name + "\" uses an unsupported DXGI format");
+            }
+            offset += DDS_DX10_HEADER_SIZE;
+        } else {
+            throw Texture::BadFile("DDS file \"" + path_name + "\" uses an unsupported compression format");
+        }
+
+        AddLevels(path_name, contents, offset, width, height, levels, image);
+    }
+
+    void ReadKTX(const std::string& path_name, std::vector<unsigned char>& contents, CompressedImage& image)
+    {
+        const std::size_t KTX_HEADER_SIZE = 64;
+        if (contents.size() < KTX_HEADER_SIZE)
+            throw Texture::BadFile("Compressed texture file \"" + path_name + "\" is truncated");
+        const unsigned char* header = &contents[0];
+
+        boost::uint32_t endianness = ReadLE32(header + 12);
+        if (endianness != KTX_ENDIANNESS && endianness != KTX_SWAPPED_ENDIANNESS)
+            throw Texture::BadFile("KTX file \"" + path_name + "\" has an invalid header");
+        const bool swap = endianness == KTX_SWAPPED_ENDIANNESS;
+        boost::uint32_t fields[12];
+        for (std::size_t i = 0; i < 12; ++i) {
+            fields[i] = ReadLE32(header + 16 + 4 * i);
+            if (swap)
+                fields[i] = SwapBytes(fields[i]);
+        }
+        boost::uint32_t gl_type = fields[0];
+        boost::uint32_t gl_internal_format = fields[3];
+        X width(static_cast<int>(fields[5]));
+        Y height(static_cast<int>(fields[6]));
+        boost::uint32_t depth = fields[7];
+        boost::uint32_t array_elements = fields[8];
+        boost::uint32_t faces = fields[9];
+        std::size_t levels = std::max(boost::uint32_t(1), fields[10]);
+        boost::uint32_t key_value_bytes = fields[11];
+
+        if (gl_type != 0)
+            throw Texture::BadFile("Texture file \"" + path_name + "\" is not a compressed KTX file");
+        if (1 < depth || array_elements || faces != 1 || height < Y1)
+            throw Texture::BadFile("KTX file \"" + path_name + "\" does not contain a single 2D texture");
+
+        switch (gl_internal_format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+            image.internal_format = gl_internal_format;
+            break;
+        case GL_ETC1_RGB8_OES:
+            image.internal_format = GL_COMPRESSED_RGB8_ETC2;
+            break;
+        default:
+            throw Texture::BadFile("KTX file \"" + path_name + "\" uses an unsupported compression format");
+        }
+
+        // each level is preceded by its size, and padded to a multiple of
+        // four bytes; the sizes are checked, then the levels are read as if
+        // they were packed back to back
+        std::vector<unsigned char> packed;
+        std::size_t offset = KTX_HEADER_SIZE + key_value_bytes;
+        X level_width = width;
+        Y level_height = height;
+        std::size_t i = 0;
+        for (; i < levels; ++i) {
+            if (contents.size() < offset + 4)
+                throw Texture::BadFile("Compressed texture file \"" + path_name + "\" is truncated");
+            boost::uint32_t image_size = ReadLE32(&contents[offset]);
+            if (swap)
+                image_size = SwapBytes(image_size);
+            offset += 4;
+            if (image_size != LevelSize(image.internal_format, level_width, level_height) ||
+                contents.size() < offset + image_size) {
+                throw Texture::BadFile("KTX file \"" + path_name + "\" has a corrupt mipmap level");
+            }
+            packed.insert(packed.end(), contents.begin() + offset, contents.begin() + offset + image_size);
+            offset += (image_size + 3) & ~3u;
+            level_width = std::max(X1, level_width / 2);
+            level_height = std::max(Y1, level_height / 2);
+        }
+
+        AddLevels(path_name, packed, 0, width, height, i, image);
+    }
+
+    /** Decodes one 8-byte DXT color block into \a texels; \a four_color is
+        true for DXT3 and DXT5 blocks, which never use the transparent
+        three-color mode. */
+    void DecodeDXTColor(const unsigned char* block, bool four_color, unsigned char texels[16][4])
+    {
+        unsigned int c0 = block[0] | (block[1] << 8);
+        unsigned int c1 = block[2] | (block[3] << 8);
+        unsigned char colors[4][4];
+        for (int i = 0; i < 2; ++i) {
+            unsigned int c = i ? c1 : c0;
+            colors[i][0] = Extend5((c >> 11) & 0x1F);
+            colors[i][1] = Extend6((c >> 5) & 0x3F);
+            colors[i][2] = Extend5(c & 0x1F);
+            colors[i][3] = 255;
+        }
+        if (four_color || c1 < c0) {
+            for (int j = 0; j < 3; ++j) {
+                colors[2][j] = static_cast<unsigned char>((2 * colors[0][j] + colors[1][j]) / 3);
+                colors[3][j] = static_cast<unsigned char>((colors[0][j] + 2 * colors[1][j]) / 3);
+            }
+            colors[2][3] = colors[3][3] = 255;
+        } else {
+            for (int j = 0; j < 3; ++j) {
+                colors[2][j] = static_cast<unsigned char>((colors[0][j] + colors[1][j]) / 2);
+                colors[3][j] = 0;
+            }
+            colors[2][3] = 255;
+            colors[3][3] = 0;
+        }
+        boost::uint32_t indices = ReadLE32(block + 4);
+        for (int i = 0; i < 16; ++i)
+            std::memcpy(texels[i], colors[(indices >> (2 * i)) & 3], 4);
+    }
+
+    void DecodeDXT3Alpha(const unsigned char* block, unsigned char texels[16][4])
+    {
+        for (int i = 0; i < 16; ++i) {
+            int alpha = (block[i / 2] >> (4 * (i % 2))) & 0xF;
+            texels[i][3] = Extend4(alpha);
+        }
+    }
+
+    void DecodeDXT5Alpha(const unsigned char* block, unsigned char texels[16][4])
+    {
+        int alphas[8];
+        alphas[0] = block[0];
+        alphas[1] = block[1];
+        if (alphas[1] < alphas[0]) {
+            for (int i = 2; i < 8; ++i)
+                alphas[i] = ((8 - i) * alphas[0] + (i - 1) * alphas[1]) / 7;
+        } else {
+            for (int i = 2; i < 6; ++i)
+                alphas[i] = ((6 - i) * alphas[0] + (i - 1) * alphas[1]) / 5;
+            alphas[6] = 0;
+            alphas[7] = 255;
+        }
+        boost::uint64_t indices = 0;
+        for (int i = 7; 2 <= i; --i)
+            indices = (indices << 8) | block[i];
+        for (int i = 0; i < 16; ++i)
+            texels[i][3] = static_cast<unsigned char>(alphas[(indices >> (3 * i)) & 7]);
+    }
+
+    /** Decodes one 8-byte ETC2 RGB block (which may also be an ETC1 block)
+        into \a texels. */
+    void DecodeETC2Color(const unsigned char* block, unsigned char texels[16][4])
+    {
+        boost::uint32_t pixel_bits = ReadBE32(block + 4);
+        int base[2][3];
+        bool differential = block[3] & 2;
+
+        if (differential) {
+            int r = block[0] >> 3, dr = (block[0] & 7) - ((block[0] & 4) << 1);
+            int g = block[1] >> 3, dg = (block[1] & 7) - ((block[1] & 4) << 1);
+            int b = block[2] >> 3, db = (block[2] & 7) - ((block[2] & 4) << 1);
+
+            if (r + dr < 0 || 31 < r + dr) { // T mode
+                unsigned char paint[4][3];
+                unsigned char c1[3] = {
+                    Extend4(((block[0] >> 1) & 0xC) | (block[0] & 3)), Extend4(block[1] >> 4), Extend4(block[1] & 0xF)
+                };
+                unsigned char c2[3] = {
+                    Extend4(block[2] >> 4), Extend4(block[2] & 0xF), Extend4(block[3] >> 4)
+                };
+                int distance = ETC2_DISTANCES[((block[3] >> 1) & 6) | (block[3] & 1)];
+                for (int j = 0; j < 3; ++j) {
+                    paint[0][j] = c1[j];
+                    paint[1][j] = Clamp255(c2[j] + distance);
+                    paint[2][j] = c2[j];
+                    paint[3][j] = Clamp255(c2[j] - distance);
+                }
+                for (int i = 0; i < 16; ++i) {
+                    int index = (((pixel_bits >> (i + 16)) & 1) << 1) | ((pixel_bits >> i) & 1);
+                    int x = i / 4, y = i % 4;
+                    std::memcpy(texels[y * 4 + x], paint[index], 3);
+                    texels[y * 4 + x][3] = 255;
+                }
+                return;
+            } else if (g + dg < 0 || 31 < g + dg) { // H mode
+                unsigned char paint[4][3];
+                unsigned char c1[3] = {
+                    Extend4((block[0] >> 3) & 0xF),
+                    Extend4(((block[0] & 7) << 1) | ((block[1] >> 4) & 1)),
+                    Extend4((block[1] & 8) | ((block[1] & 3) << 1) | (block[2] >> 7))
+                };
+                unsigned char c2[3] = {
+                    Extend4((block[2] >> 3) & 0xF),
+                    Extend4(((block[2] & 7) << 1) | (block[3] >> 7)),
+                    Extend4((block[3] >> 3) & 0xF)
+                };
+                boost::uint32_t value1 = (c1[0] << 16) | (c1[1] << 8) | c1[2];
+                boost::uint32_t value2 = (c2[0] << 16) | (c2[1] << 8) | c2[2];
+                int distance = ETC2_DISTANCES[(block[3] & 4) | ((block[3] & 1) << 1) | (value2 <= value1 ? 1 : 0)];
+                for (int j = 0; j < 3; ++j) {
+                    paint[0][j] = Clamp255(c1[j] + distance);
+                    paint[1][j] = Clamp255(c1[j] - distance);
+                    paint[2][j] = Clamp255(c2[j] + distance);
+                    paint[3][j] = Clamp255(c2[j] - distance);
+                }
+                for (int i = 0; i < 16; ++i) {
+                    int index = (((pixel_bits >> (i + 16)) & 1) << 1) | ((pixel_bits >> i) & 1);
+                    int x = i / 4, y = i % 4;
+                    std::memcpy(texels[y * 4 + x], paint[index], 3);
+                    texels[y * 4 + x][3] = 255;
+                }
+                return;
+            } else if (b + db < 0 || 31 < b + db) { // planar mode
+                int origin[3] = {
+                    Extend6((block[0] >> 1) & 0x3F),
+                    Extend7(((block[0] & 1) << 6) | ((block[1] >> 1) & 0x3F)),
+                    Extend6(((block[1] & 1) << 5) | (block[2] & 0x18) | ((block[2] & 3) << 1) | (block[3] >> 7))
+                };
+                int horizontal[3] = {
+                    Extend6(((block[3] >> 1) & 0x3E) | (block[3] & 1)),
+                    Extend7((block[4] >> 1) & 0x7F),
+                    Extend6(((block[4] & 1) << 5) | (block[5] >> 3))
+                };
+                int vertical[3] = {
+                    Extend6(((block[5] & 7) << 3) | (block[6] >> 5)),
+                    Extend7(((block[6] & 0x1F) << 2) | (block[7] >> 6)),
+                    Extend6(block[7] & 0x3F)
+                };
+                for (int y = 0; y < 4; ++y) {
+                    for (int x = 0; x < 4; ++x) {
+                        for (int j = 0; j < 3; ++j) {
+                            int value = x * (horizontal[j] - origin[j]) + y * (vertical[j] - origin[j]) + 4 * origin[j] + 2;
+                            texels[y * 4 + x][j] = Clamp255(value >> 2);
+                        }
+                        texels[y * 4 + x][3] = 255;
+                    }
+                }
+                return;
+            }
+
+            base[0][0] = Extend5(r);
+            base[0][1] = Extend5(g);
+            base[0][2] = Extend5(b);
+            base[1][0] = Extend5(r + dr);
+            base[1][1] = Extend5(g + dg);
+            base[1][2] = Extend5(b + db);
+        } else {
+            for (int j = 0; j < 3; ++j) {
+                base[0][j] = Extend4(block[j] >> 4);
+                base[1][j] = Extend4(block[j] & 0xF);
+            }
+        }
+
+        const int* modifiers[2] = { ETC_MODIFIERS[(block[3] >> 5) & 7], ETC_MODIFIERS[(block[3] >> 2) & 7] };
+        bool flip = block[3] & 1;
+        for (int i = 0; i < 16; ++i) {
+            int x = i / 4, y = i % 4;
+            int subblock = flip ? (2 <= y) : (2 <= x);
+            int index = (((pixel_bits >> (i + 16)) & 1) << 1) | ((pixel_bits >> i) & 1);
+            int modifier = modifiers[subblock][index & 1];
+            if (index & 2)
+                modifier = -modifier;
+            for (int j = 0; j < 3; ++j)
+                texels[y * 4 + x][j] = Clamp255(base[subblock][j] + modifier);
+            texels[y * 4 + x][3] = 255;
+        }
+    }
+
+    void DecodeEACAlpha(const unsigned char* block, unsigned char texels[16][4])
+    {
+        int base = block[0];
+        int multiplier = block[1] >> 4;
+        const int* modifiers = EAC_MODIFIERS[block[1] & 0xF];
+        boost::uint64_t indices = 0;
+        for (int i = 2; i < 8; ++i)
+            indices = (indices << 8) | block[i];
+        for (int i = 0; i < 16; ++i) {
+            int x = i / 4, y = i % 4;
+            int index = static_cast<int>((indices >> (45 - 3 * i)) & 7);
+            texels[y * 4 + x][3] = Clamp255(base + modifiers[index] * multiplier);
+        }
+    }
+}
+
+///////////////////////////////////////
+// struct GG::detail::CompressedImage
+///////////////////////////////////////
+CompressedImage::CompressedImage() :
+    internal_format(GL_INVALID_ENUM)
+{}
+
+
+///////////////////////////////////////
+// free functions
+///////////////////////////////////////
+bool GG::detail::IsCompressedImageExtension(const std::string& extension)
+{ return extension == ".dds" || extension == ".ktx"; }
+
+void GG::detail::ReadCompressedImage(const std::string& path_name, CompressedImage& image)
+{
+    image = CompressedImage();
+    std::vector<unsigned char> contents;
+    ReadFile(path_name, contents);
+    if (4 <= contents.size() && std::memcmp(&contents[0], "DDS ", 4) == 0)
+        ReadDDS(path_name, contents, image);
+    else if (sizeof(KTX_IDENTIFIER) <= contents.size() && std::memcmp(&contents[0], KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) == 0)
+        ReadKTX(path_name, contents, image);
+    else
+        throw Texture::BadFile("Texture file \"" + path_name + "\" is neither a DDS nor a KTX file");
+}
+
+void GG::detail::DecompressImageLevel(const CompressedImage& image, std::size_t level,
+                                      std::vector<unsigned char>& rgba)
+{
+    const CompressedImage::Level& image_level = image.levels[level];
+    const int width = Value(image_level.width);
+    const int height = Value(image_level.height);
+    const std::size_t block_bytes = BlockBytes(image.internal_format);
+    rgba.resize(4 * width * height);
+
+    const unsigned char* block = &image.data[image_level.offset];
+    for (int block_y = 0; block_y < height; block_y += 4) {
+        for (int block_x = 0; block_x < width; block_x += 4, block += block_bytes) {
+            unsigned char texels[16][4];
+            switch (image.internal_format) {
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                DecodeDXTColor(block, false, texels);
+                for (int i = 0; i < 16; ++i)
+                    texels[i][3] = 255;
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+                DecodeDXTColor(block, false, texels);
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+                DecodeDXTColor(block + 8, true, texels);
+                DecodeDXT3Alpha(block, texels);
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                DecodeDXTColor(block + 8, true, texels);
+                DecodeDXT5Alpha(block, texels);
+                break;
+            case GL_COMPRESSED_RGB8_ETC2:
+                DecodeETC2Color(block, texels);
+                break;
+            case GL_COMPRESSED_RGBA8_ETC2_EAC:
+                DecodeETC2Color(block + 8, texels);
+                DecodeEACAlpha(block, texels);
+                break;
+            }
+
+            // blocks on the right and bottom edges may hang off the image
+            for (int y = 0; y < 4 && block_y + y < height; ++y) {
+                for (int x = 0; x < 4 && block_x + x < width; ++x) {
+                    std::memcpy(&rgba[4 * ((block_y + y) * width + block_x + x)], texels[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+}
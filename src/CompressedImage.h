@@ -0,0 +1,88 @@
+// -*- C++ -*-
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+
+   Zach Laine
+   whatwasthataddress@gmail.com
+*/
+
+#ifndef _CompressedImage_h_
+#define _CompressedImage_h_
+
+#include <GG/Base.h>
+
+#include <string>
+#include <vector>
+
+
+#ifndef GL_COMPRESSED_RGB8_ETC2
+# define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+# define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_ETC1_RGB8_OES
+# define GL_ETC1_RGB8_OES 0x8D64
+#endif
+
+namespace GG { namespace detail {
+
+    /** A block-compressed image, with its mipmap levels, as read from a DDS
+        or KTX file.  Every level is stored in \a data, back to back. */
+    struct CompressedImage
+    {
+        struct Level
+        {
+            X           width;
+            Y           height;
+            std::size_t offset; ///< the offset of the level's blocks in data
+            std::size_t size;   ///< the size of the level's blocks, in bytes
+        };
+
+        CompressedImage();
+
+        /** The GL_COMPRESSED_* internal format of the blocks; one of the
+            S3TC DXT1/DXT3/DXT5 formats, GL_COMPRESSED_RGB8_ETC2 or
+            GL_COMPRESSED_RGBA8_ETC2_EAC.  ETC1 images are reported as
+            GL_COMPRESSED_RGB8_ETC2, which is a superset of ETC1. */
+        GLenum                     internal_format;
+        std::vector<Level>         levels;
+        std::vector<unsigned char> data;
+    };
+
+    /** Returns true iff \a extension (which must be lowercase, and include
+        the leading '.') names a compressed image file format. */
+    bool IsCompressedImageExtension(const std::string& extension);
+
+    /** Reads the DDS or KTX file \a path_name into \a image.  \throw
+        GG::Texture::BadFile Throws if the file cannot be read, or does not
+        contain a single 2D image in a supported compressed format. */
+    void ReadCompressedImage(const std::string& path_name, CompressedImage& image);
+
+    /** Decodes level \a level of \a image into 8-bit RGBA pixels, for use
+        when the OpenGL implementation cannot use the compressed format
+        directly. */
+    void DecompressImageLevel(const CompressedImage& image, std::size_t level,
+                              std::vector<unsigned char>& rgba);
+
+} }
+
+#endif
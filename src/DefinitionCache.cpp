@@ -0,0 +1,274 @@
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+#include <GG/DefinitionCache.h>
+
+#include <GG/Filesystem.h>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/once.hpp>
+
+#include <ctime>
+#include <istream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <stdexcept>
+
+
+using namespace GG;
+
+namespace {
+    /** The singleton cache, created by the first call to
+        GetDefinitionCache().  It is created through boost::call_once, since
+        a function-local static's construction is not thread-safe under
+        C++98, and a namespace-scope object might be used by other static
+        initializers before it is constructed.  It is never destroyed, so
+        that it outlives any static that uses it. */
+    DefinitionCache* g_definition_cache = 0;
+    boost::once_flag g_definition_cache_once = BOOST_ONCE_INIT;
+}
+
+///////////////////////////////////////
+// struct GG::DefinitionCache::Impl
+///////////////////////////////////////
+struct DefinitionCache::Impl
+{
+    // For files, name is the path and hash is 0.  For streams, name is the
+    // filename and hash is the hash of the contents.
+    struct Key
+    {
+        Key(ParsedDefinition::Language language_, const std::string& name_, std::size_t hash_) :
+            language(language_),
+            name(name_),
+            hash(hash_)
+            {}
+
+        bool operator<(const Key& rhs) const
+            {
+                if (language != rhs.language)
+                    return language < rhs.language;
+                if (hash != rhs.hash)
+                    return hash < rhs.hash;
+                return name < rhs.name;
+            }
+
+        ParsedDefinition::Language language;
+        std::string                name;
+        std::size_t                hash;
+    };
+
+    struct Entry
+    {
+        Entry(const Key& key_) :
+            key(key_),
+            write_time(0),
+            size(0)
+            {}
+
+        Key              key;
+        std::time_t      write_time; // files only
+        boost::uintmax_t size;       // files only
+        std::string      contents;   // streams only
+        ParsedDefinition definition;
+    };
+
+    typedef std::list<Entry> EntryList; // most recently used first
+    typedef std::map<Key, EntryList::iterator> EntryMap;
+
+    Impl() :
+        capacity(DEFAULT_CAPACITY)
+        {}
+
+    /** Returns the entry for \a key, moved to the front of the list, or 0 if
+        there is none.  Must be called with the mutex locked. */
+    Entry* Find(const Key& key)
+        {
+            EntryMap::iterator it = map.find(key);
+            if (it == map.end())
+                return 0;
+            entries.splice(entries.begin(), entries, it->second);
+            return &entries.front();
+        }
+
+    /** Caches \a entry, replacing any entry with the same key, and evicts
+        entries beyond the capacity.  Must be called with the mutex locked. */
+    void Insert(const Entry& entry)
+        {
+            if (!capacity)
+                return;
+            EntryMap::iterator it = map.find(entry.key);
+            if (it != map.end()) {
+                entries.erase(it->second);
+                map.erase(it);
+            }
+            entries.push_front(entry);
+            map.insert(std::make_pair(entry.key, entries.begin()));
+            Trim();
+        }
+
+    void Trim()
+        {
+            while (capacity < entries.size()) {
+                map.erase(entries.back().key);
+                entries.pop_back();
+                ++statistics.m_evictions;
+            }
+        }
+
+    mutable boost::mutex mutex;
+    std::size_t          capacity;
+    EntryList            entries;
+    EntryMap             map;
+    Statistics           statistics;
+};
+
+
+///////////////////////////////////////
+// struct GG::DefinitionCache::Statistics
+///////////////////////////////////////
+DefinitionCache::Statistics::Statistics() :
+    m_hits(0),
+    m_misses(0),
+    m_evictions(0),
+    m_entries(0)
+{}
+
+
+///////////////////////////////////////
+// class GG::DefinitionCache
+///////////////////////////////////////
+const std::size_t DefinitionCache::DEFAULT_CAPACITY = 64;
+
+DefinitionCache::DefinitionCache() :
+    m_impl(new Impl)
+{}
+
+DefinitionCache::~DefinitionCache()
+{}
+
+void DefinitionCache::CreateInstance()
+{ g_definition_cache = new DefinitionCache; }
+
+std::size_t DefinitionCache::Capacity() const
+{
+    boost::mutex::scoped_lock lock(m_impl->mutex);
+    return m_impl->capacity;
+}
+
+DefinitionCache::Statistics DefinitionCache::GetStatistics() const
+{
+    boost::mutex::scoped_lock lock(m_impl->mutex);
+    Statistics retval = m_impl->statistics;
+    retval.m_entries = m_impl->entries.size();
+    return retval;
+}
+
+ParsedDefinition DefinitionCache::Get(const boost::filesystem::path& path, ParsedDefinition::Language language)
+{
+    Impl::Entry entry(Impl::Key(language, PathToUTF8(path), 0));
+    entry.write_time = boost::filesystem::last_write_time(path);
+    entry.size = boost::filesystem::file_size(path);
+
+    {
+        boost::mutex::scoped_lock lock(m_impl->mutex);
+        Impl::Entry* cached = m_impl->Find(entry.key);
+        if (cached && cached->write_time == entry.write_time && cached->size == entry.size) {
+            ++m_impl->statistics.m_hits;
+            return cached->definition;
+        }
+        ++m_impl->statistics.m_misses;
+    }
+
+    // The mutex is not held while loading, so that a slow load does not
+    // block lookups of other definitions.
+    entry.definition = LoadDefinition(path, language);
+
+    boost::mutex::scoped_lock lock(m_impl->mutex);
+    m_impl->Insert(entry);
+    return entry.definition;
+}
+
+ParsedDefinition DefinitionCache::Get(std::istream& is, const std::string& filename, ParsedDefinition::Language language)
+{
+    std::string contents((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    Impl::Entry entry(Impl::Key(language, filename, boost::hash_range(contents.begin(), contents.end())));
+
+    {
+        boost::mutex::scoped_lock lock(m_impl->mutex);
+        Impl::Entry* cached = m_impl->Find(entry.key);
+        if (cached && cached->contents == contents) {
+            ++m_impl->statistics.m_hits;
+            return cached->definition;
+        }
+        ++m_impl->statistics.m_misses;
+    }
+
+    if (ParsedDefinition::IsPrecompiled(contents.data(), contents.size())) {
+        entry.definition.Read(contents.data(), contents.size());
+        if (entry.definition.GetLanguage() != language) {
+            throw std::runtime_error("Precompiled definition \"" + filename + "\" was not precompiled from " +
+                                     (language == ParsedDefinition::ADAM ? "Adam." : "Eve."));
+        }
+    } else if (!entry.definition.Parse(language, contents, filename)) {
+        throw std::logic_error(language == ParsedDefinition::ADAM ? "Adam parse failed." : "Eve parse failed.");
+    }
+    entry.contents.swap(contents);
+
+    boost::mutex::scoped_lock lock(m_impl->mutex);
+    m_impl->Insert(entry);
+    return entry.definition;
+}
+
+void DefinitionCache::SetCapacity(std::size_t entries)
+{
+    boost::mutex::scoped_lock lock(m_impl->mutex);
+    m_impl->capacity = entries;
+    m_impl->Trim();
+}
+
+void DefinitionCache::Clear()
+{
+    boost::mutex::scoped_lock lock(m_impl->mutex);
+    m_impl->entries.clear();
+    m_impl->map.clear();
+}
+
+void DefinitionCache::ResetStatistics()
+{
+    boost::mutex::scoped_lock lock(m_impl->mutex);
+    m_impl->statistics = Statistics();
+}
+
+
+///////////////////////////////////////
+// free functions
+///////////////////////////////////////
+DefinitionCache& GG::GetDefinitionCache()
+{
+    boost::call_once(&DefinitionCache::CreateInstance, g_definition_cache_once);
+    return *g_definition_cache;
+}
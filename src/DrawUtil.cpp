@@ -27,6 +27,8 @@
 #include <GG/ClrConstants.h>
 #include <GG/GUI.h>
 
+#include <boost/shared_ptr.hpp>
+
 #include <valarray>
 
 namespace { // file-scope constants and functions
@@ -38,21 +40,177 @@ namespace { // file-scope constants and functions
     /// a stack of the currently-active clipping rects, in GG coordinates, not OpenGL scissor coordinates
     std::vector<Rect> g_scissor_clipping_rects;
 
-    GLboolean g_prev_color_writemask[4];
-    GLboolean g_prev_depth_writemask;
+    /** A CPU-side copy of the GL state the clipping functions depend on, as
+        it was outside of any clipping.  It is read from GL the first time
+        it is needed in each frame, instead of being queried or pushed on
+        GL's attribute stacks each time clipping begins. */
+    struct GLStateCache
+    {
+        GLStateCache() : valid(false), stencil_valid(false) {}
+
+        bool      valid;
+        GLboolean color_writemask[4];
+        GLboolean depth_writemask;
+        GLboolean scissor_test;
+        GLboolean stencil_test;
+        GLint     scissor_box[4];
+
+        // read separately, the first time stencil clipping is used
+        bool      stencil_valid;
+        GLint     stencil_func;
+        GLint     stencil_ref;
+        GLint     stencil_value_mask;
+        GLint     stencil_fail;
+        GLint     stencil_pass_depth_fail;
+        GLint     stencil_pass_depth_pass;
+        GLint     stencil_clear_value;
+    };
+    GLStateCache g_gl_state;
+
+    /// the scissor box most recently given to GL, in GL coordinates
+    GLint g_curr_scissor_box[4] = { 0, 0, 0, 0 };
 
     /// the index of the next stencil bit to use for stencil clipping
     unsigned int g_stencil_bit = 0;
 
+    /// the rendering statistics for the frame currently being rendered
+    RenderStats g_render_stats;
+
+    void CountedBegin(GLenum mode)
+    {
+        ++g_render_stats.draw_calls;
+        glBegin(mode);
+    }
+
+    void CountedEnable(GLenum cap)
+    {
+        ++g_render_stats.state_changes;
+        glEnable(cap);
+    }
+
+    void CountedDisable(GLenum cap)
+    {
+        ++g_render_stats.state_changes;
+        glDisable(cap);
+    }
+
+    void FillGLStateCache()
+    {
+        if (g_gl_state.valid)
+            return;
+        glGetBooleanv(GL_COLOR_WRITEMASK, g_gl_state.color_writemask);
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &g_gl_state.depth_writemask);
+        glGetBooleanv(GL_SCISSOR_TEST, &g_gl_state.scissor_test);
+        glGetBooleanv(GL_STENCIL_TEST, &g_gl_state.stencil_test);
+        glGetIntegerv(GL_SCISSOR_BOX, g_gl_state.scissor_box);
+        std::copy(g_gl_state.scissor_box, g_gl_state.scissor_box + 4, g_curr_scissor_box);
+        g_render_stats.state_queries += 5;
+        g_gl_state.valid = true;
+    }
+
+    void FillStencilStateCache()
+    {
+        if (g_gl_state.stencil_valid)
+            return;
+        glGetIntegerv(GL_STENCIL_FUNC, &g_gl_state.stencil_func);
+        glGetIntegerv(GL_STENCIL_REF, &g_gl_state.stencil_ref);
+        glGetIntegerv(GL_STENCIL_VALUE_MASK, &g_gl_state.stencil_value_mask);
+        glGetIntegerv(GL_STENCIL_FAIL, &g_gl_state.stencil_fail);
+        glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, &g_gl_state.stencil_pass_depth_fail);
+        glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, &g_gl_state.stencil_pass_depth_pass);
+        glGetIntegerv(GL_STENCIL_CLEAR_VALUE, &g_gl_state.stencil_clear_value);
+        g_render_stats.state_queries += 7;
+        g_gl_state.stencil_valid = true;
+    }
+
+    /** Sets the GL scissor box, unless it is already set to the same box. */
+    void SetScissorBox(GLint x, GLint y, GLint width, GLint height)
+    {
+        if (g_curr_scissor_box[0] == x && g_curr_scissor_box[1] == y &&
+            g_curr_scissor_box[2] == width && g_curr_scissor_box[3] == height) {
+            ++g_render_stats.stalls_avoided;
+            return;
+        }
+        glScissor(x, y, width, height);
+        g_curr_scissor_box[0] = x;
+        g_curr_scissor_box[1] = y;
+        g_curr_scissor_box[2] = width;
+        g_curr_scissor_box[3] = height;
+    }
+
     /// whenever points on the unit circle are calculated with expensive sin() and cos() calls, the results are cached here
     std::map<int, std::valarray<double> > unit_circle_coords;
     /// this doesn't serve as a cache, but does allow us to prevent numerous constructions and destructions of Clr valarrays.
     std::map<int, std::valarray<Clr> > color_arrays;
 
+    /** Everything a CircleArc()'s geometry is built from.  The arc is built
+        in the unit circle, so its position is not part of it. */
+    struct ArcKey
+    {
+        int             width;
+        int             height;
+        unsigned int    bevel_thick;
+        double          theta1;
+        double          theta2;
+        boost::uint32_t color;
+        boost::uint32_t border_color1;
+        boost::uint32_t border_color2;
+
+        bool operator<(const ArcKey& rhs) const
+        {
+            if (width != rhs.width)
+                return width < rhs.width;
+            if (height != rhs.height)
+                return height < rhs.height;
+            if (bevel_thick != rhs.bevel_thick)
+                return bevel_thick < rhs.bevel_thick;
+            if (theta1 != rhs.theta1)
+                return theta1 < rhs.theta1;
+            if (theta2 != rhs.theta2)
+                return theta2 < rhs.theta2;
+            if (color != rhs.color)
+                return color < rhs.color;
+            if (border_color1 != rhs.border_color1)
+                return border_color1 < rhs.border_color1;
+            return border_color2 < rhs.border_color2;
+        }
+    };
+
+    struct CachedArc
+    {
+        CachedArc() : geometry(new RetainedGeometry), frame(0) {}
+        boost::shared_ptr<RetainedGeometry> geometry;
+        std::size_t                         frame; ///< the frame in which the arc was last drawn
+    };
+
+    /// the geometry of the arcs drawn by CircleArc(); see BeginGeometryCacheFrame()
+    typedef std::map<ArcKey, CachedArc> ArcCache;
+    ArcCache g_arc_cache;
+    std::size_t g_arc_cache_frame = 0;
+    const std::size_t MIN_CACHED_ARCS = 256; // arcs beyond this many are kept only as long as they are drawn every frame
+
+    bool EarlierFrame(ArcCache::iterator lhs, ArcCache::iterator rhs)
+    { return lhs->second.frame < rhs->second.frame; }
+
+    boost::uint32_t PackedColor(Clr color)
+    { return (color.r << 24) | (color.g << 16) | (color.b << 8) | color.a; }
+
+    Clr BevelColor(Clr color1, Clr color2, double x, double y)
+    {
+        // this is essentially the dot product of (x,y) with
+        // (sqrt2over2,sqrt2over2), the direction of the light source, scaled
+        // to the range [0,1]
+        double color_scale_factor = (SQRT2OVER2 * (x + y) + 1) / 2;
+        return Clr(GLubyte(color2.r * (1 - color_scale_factor) + color1.r * color_scale_factor),
+                   GLubyte(color2.g * (1 - color_scale_factor) + color1.g * color_scale_factor),
+                   GLubyte(color2.b * (1 - color_scale_factor) + color1.b * color_scale_factor),
+                   GLubyte(color2.a * (1 - color_scale_factor) + color1.a * color_scale_factor));
+    }
+
     void Rectangle(Pt ul, Pt lr, Clr color, Clr border_color1, Clr border_color2, unsigned int bevel_thick,
                    bool bevel_left, bool bevel_top, bool bevel_right, bool bevel_bottom)
     {
-        glDisable(GL_TEXTURE_2D);
+        CountedDisable(GL_TEXTURE_2D);
 
         X inner_x1 = ul.x + (bevel_left ? static_cast<int>(bevel_thick) : 0);
         Y inner_y1 = ul.y + (bevel_top ? static_cast<int>(bevel_thick) : 0);
@@ -76,19 +234,19 @@ namespace { // file-scope constants and functions
         if (bevel_thick && (border_color1 != CLR_ZERO || border_color2 != CLR_ZERO)) {
             glColor(border_color1);
             if (border_color1 == border_color2) {
-                glBegin(GL_QUAD_STRIP);
+                CountedBegin(GL_QUAD_STRIP);
                 for (int i = 0; i < 10; ++i) {
                     glVertex2i(vertices[i * 2 + 0], vertices[i * 2 + 1]);
                 }
                 glEnd();
             } else {
-                glBegin(GL_QUAD_STRIP);
+                CountedBegin(GL_QUAD_STRIP);
                 for (int i = 0; i < 6; ++i) {
                     glVertex2i(vertices[i * 2 + 0], vertices[i * 2 + 1]);
                 }
                 glEnd();
                 glColor(border_color2);
-                glBegin(GL_QUAD_STRIP);
+                CountedBegin(GL_QUAD_STRIP);
                 for (int i = 4; i < 10; ++i) {
                     glVertex2i(vertices[i * 2 + 0], vertices[i * 2 + 1]);
                 }
@@ -99,7 +257,7 @@ namespace { // file-scope constants and functions
         // draw interior of rectangle
         if (color != CLR_ZERO) {
             glColor(color);
-            glBegin(GL_QUADS);
+            CountedBegin(GL_QUADS);
             glVertex(inner_x2, inner_y1);
             glVertex(inner_x1, inner_y1);
             glVertex(inner_x1, inner_y2);
@@ -107,14 +265,14 @@ namespace { // file-scope constants and functions
             glEnd();
         }
 
-        glEnable(GL_TEXTURE_2D);
+        CountedEnable(GL_TEXTURE_2D);
     }
 
     void Check(Pt ul, Pt lr, Clr color1, Clr color2, Clr color3)
     {
         X wd = lr.x - ul.x;
         Y ht = lr.y - ul.y;
-        glDisable(GL_TEXTURE_2D);
+        CountedDisable(GL_TEXTURE_2D);
 
         // all vertices
         double verts[][2] = {{-0.2, 0.2}, {-0.6, -0.2}, {-0.6, 0.0}, {-0.2, 0.4}, {-0.8, 0.0},
@@ -129,12 +287,12 @@ namespace { // file-scope constants and functions
         glScaled(Value(wd / 2.0 * sf), Value(ht / 2.0 * sf), 1.0);
 
         glColor(color3);
-        glBegin(GL_TRIANGLES);
+        CountedBegin(GL_TRIANGLES);
         glVertex2dv(verts[1]);
         glVertex2dv(verts[4]);
         glVertex2dv(verts[2]);
         glEnd();
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex2dv(verts[8]);
         glVertex2dv(verts[0]);
         glVertex2dv(verts[3]);
@@ -142,7 +300,7 @@ namespace { // file-scope constants and functions
         glEnd();
 
         glColor(color2);
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex2dv(verts[2]);
         glVertex2dv(verts[4]);
         glVertex2dv(verts[5]);
@@ -154,26 +312,26 @@ namespace { // file-scope constants and functions
         glEnd();
 
         glColor(color1);
-        glBegin(GL_TRIANGLES);
+        CountedBegin(GL_TRIANGLES);
         glVertex2dv(verts[8]);
         glVertex2dv(verts[7]);
         glVertex2dv(verts[6]);
         glEnd();
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex2dv(verts[0]);
         glVertex2dv(verts[1]);
         glVertex2dv(verts[2]);
         glVertex2dv(verts[3]);
         glEnd();
         glPopMatrix();
-        glEnable(GL_TEXTURE_2D);
+        CountedEnable(GL_TEXTURE_2D);
     }
 
     void XMark(Pt ul, Pt lr, Clr color1, Clr color2, Clr color3)
     {
         X wd = lr.x - ul.x;
         Y ht = lr.y - ul.y;
-        glDisable(GL_TEXTURE_2D);
+        CountedDisable(GL_TEXTURE_2D);
 
         // all vertices
         double verts[][2] = {{-0.4, -0.6}, {-0.6, -0.4}, {-0.4, -0.4}, {-0.2, 0.0}, {-0.6, 0.4},
@@ -187,12 +345,12 @@ namespace { // file-scope constants and functions
         glScalef(Value(wd / 2.0 * sf), Value(ht / 2.0 * sf), 1.0); // map the range [-1,1] to the rectangle in both directions
 
         glColor(color1);
-        glBegin(GL_TRIANGLES);
+        CountedBegin(GL_TRIANGLES);
         glVertex2dv(verts[12]);
         glVertex2dv(verts[13]);
         glVertex2dv(verts[14]);
         glEnd();
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex2dv(verts[15]);
         glVertex2dv(verts[0]);
         glVertex2dv(verts[2]);
@@ -204,12 +362,12 @@ namespace { // file-scope constants and functions
         glEnd();
 
         glColor(color2);
-        glBegin(GL_TRIANGLES);
+        CountedBegin(GL_TRIANGLES);
         glVertex2dv(verts[0]);
         glVertex2dv(verts[1]);
         glVertex2dv(verts[2]);
         glEnd();
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex2dv(verts[13]);
         glVertex2dv(verts[15]);
         glVertex2dv(verts[16]);
@@ -221,7 +379,7 @@ namespace { // file-scope constants and functions
         glEnd();
 
         glColor(color3);
-        glBegin(GL_TRIANGLES);
+        CountedBegin(GL_TRIANGLES);
         glVertex2dv(verts[4]);
         glVertex2dv(verts[5]);
         glVertex2dv(verts[6]);
@@ -229,7 +387,7 @@ namespace { // file-scope constants and functions
         glVertex2dv(verts[9]);
         glVertex2dv(verts[10]);
         glEnd();
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex2dv(verts[14]);
         glVertex2dv(verts[16]);
         glVertex2dv(verts[11]);
@@ -248,14 +406,14 @@ namespace { // file-scope constants and functions
         glVertex2dv(verts[10]);
         glEnd();
         glPopMatrix();
-        glEnable(GL_TEXTURE_2D);
+        CountedEnable(GL_TEXTURE_2D);
     }
 
     void BubbleArc(Pt ul, Pt lr, Clr color1, Clr color2, Clr color3, double theta1, double theta2)
     {
         X wd = lr.x - ul.x;
         Y ht = lr.y - ul.y;
-        glDisable(GL_TEXTURE_2D);
+        CountedDisable(GL_TEXTURE_2D);
 
         // correct theta* values to range [0, 2pi)
         if (theta1 < 0)
@@ -300,7 +458,7 @@ namespace { // file-scope constants and functions
         glScalef(Value(wd / 2.0), Value(ht / 2.0), 1.0);                 // map the range [-1,1] to the rectangle in both (x- and y-) directions
 
         glColor(color1);
-        glBegin(GL_TRIANGLE_FAN);
+        CountedBegin(GL_TRIANGLE_FAN);
         glVertex2f(0, 0);
         // point on circle at angle theta1
         double x = cos(-theta1),
@@ -328,14 +486,14 @@ namespace { // file-scope constants and functions
         glVertex2f(x, y);
         glEnd();
         glPopMatrix();
-        glEnable(GL_TEXTURE_2D);
+        CountedEnable(GL_TEXTURE_2D);
     }
 
     void CircleArc(Pt ul, Pt lr, Clr color, Clr border_color1, Clr border_color2, unsigned int bevel_thick, double theta1, double theta2)
     {
         X wd = lr.x - ul.x;
         Y ht = lr.y - ul.y;
-        glDisable(GL_TEXTURE_2D);
+        CountedDisable(GL_TEXTURE_2D);
 
         // correct theta* values to range [0, 2pi)
         if (theta1 < 0)
@@ -347,80 +505,98 @@ namespace { // file-scope constants and functions
         else if (theta2 >= 2 * PI)
             theta2 -= int(theta2 / (2 * PI)) * 2 * PI;
 
-        const int      SLICES = std::min(3 + std::max(Value(wd), Value(ht)), 50);  // this is a good guess at how much to tesselate the circle coordinates (50 segments max)
-        const double   HORZ_THETA = (2 * PI) / SLICES;
-
-        std::valarray<double>& unit_vertices = unit_circle_coords[SLICES];
-        std::valarray<Clr>&    colors = color_arrays[SLICES];
-        bool calc_vertices = unit_vertices.size() == 0;
-        if (calc_vertices) {
-            unit_vertices.resize(2 * (SLICES + 1), 0.0);
-            double theta = 0.0f;
-            for (int j = 0; j <= SLICES; theta += HORZ_THETA, ++j) { // calculate x,y values for each point on a unit circle divided into SLICES arcs
-                unit_vertices[j*2] = cos(-theta);
-                unit_vertices[j*2+1] = sin(-theta);
+        ArcKey key;
+        key.width = Value(wd);
+        key.height = Value(ht);
+        key.bevel_thick = bevel_thick;
+        key.theta1 = theta1;
+        key.theta2 = theta2;
+        key.color = PackedColor(color);
+        key.border_color1 = PackedColor(border_color1);
+        key.border_color2 = PackedColor(border_color2);
+        CachedArc& cached = g_arc_cache[key];
+        cached.frame = g_arc_cache_frame;
+        RetainedGeometry& geometry = *cached.geometry;
+
+        if (geometry.Empty()) {
+            const int      SLICES = std::min(3 + std::max(Value(wd), Value(ht)), 50);  // this is a good guess at how much to tesselate the circle coordinates (50 segments max)
+            const double   HORZ_THETA = (2 * PI) / SLICES;
+
+            std::valarray<double>& unit_vertices = unit_circle_coords[SLICES];
+            if (unit_vertices.size() == 0) {
+                unit_vertices.resize(2 * (SLICES + 1), 0.0);
+                double theta = 0.0f;
+                for (int j = 0; j <= SLICES; theta += HORZ_THETA, ++j) { // calculate x,y values for each point on a unit circle divided into SLICES arcs
+                    unit_vertices[j*2] = cos(-theta);
+                    unit_vertices[j*2+1] = sin(-theta);
+                }
             }
-            colors.resize(SLICES + 1, Clr()); // create but don't initialize (this is essentially just scratch space, since the colors are different call-to-call)
-        }
-        int first_slice_idx = int(theta1 / HORZ_THETA + 1);
-        int last_slice_idx = int(theta2 / HORZ_THETA - 1);
-        if (theta1 >= theta2)
-            last_slice_idx += SLICES;
-        for (int j = first_slice_idx; j <= last_slice_idx; ++j) { // calculate the color value for each needed point
-            int X = (j > SLICES ? (j - SLICES) : j) * 2, Y = X + 1;
-            double color_scale_factor = (SQRT2OVER2 * (unit_vertices[X] + unit_vertices[Y]) + 1) / 2; // this is essentially the dot product of (x,y) with (sqrt2over2,sqrt2over2), the direction of the light source, scaled to the range [0,1]
-            colors[j] = Clr(GLubyte(border_color2.r * (1 - color_scale_factor) + border_color1.r * color_scale_factor),
-                            GLubyte(border_color2.g * (1 - color_scale_factor) + border_color1.g * color_scale_factor),
-                            GLubyte(border_color2.b * (1 - color_scale_factor) + border_color1.b * color_scale_factor),
-                            GLubyte(border_color2.a * (1 - color_scale_factor) + border_color1.a * color_scale_factor));
+            int first_slice_idx = int(theta1 / HORZ_THETA + 1);
+            int last_slice_idx = int(theta2 / HORZ_THETA - 1);
+            if (theta1 >= theta2)
+                last_slice_idx += SLICES;
+
+            double inner_radius = (std::min(Value(wd), Value(ht)) - 2.0 * bevel_thick) / std::min(Value(wd), Value(ht));
+            double theta1_x = cos(-theta1), theta1_y = sin(-theta1);
+            double theta2_x = cos(-theta2), theta2_y = sin(-theta2);
+
+            std::vector<GLfloat> vertices;
+            std::vector<Clr> colors;
+
+            // interior
+            vertices.push_back(0.0f);
+            vertices.push_back(0.0f);
+            // point on circle at angle theta1
+            vertices.push_back(theta1_x * inner_radius);
+            vertices.push_back(theta1_y * inner_radius);
+            // angles in between theta1 and theta2, if any
+            for (int i = first_slice_idx; i <= last_slice_idx; ++i) {
+                int X = (i > SLICES ? (i - SLICES) : i) * 2, Y = X + 1;
+                vertices.push_back(unit_vertices[X] * inner_radius);
+                vertices.push_back(unit_vertices[Y] * inner_radius);
+            }
+            // theta2
+            vertices.push_back(theta2_x * inner_radius);
+            vertices.push_back(theta2_y * inner_radius);
+            colors.resize(vertices.size() / 2, color);
+            geometry.Add(GL_TRIANGLE_FAN, vertices, colors);
+
+            // bevel
+            vertices.clear();
+            colors.clear();
+            Clr theta1_color = BevelColor(border_color1, border_color2, theta1_x, theta1_y);
+            vertices.push_back(theta1_x);
+            vertices.push_back(theta1_y);
+            vertices.push_back(theta1_x * inner_radius);
+            vertices.push_back(theta1_y * inner_radius);
+            colors.push_back(theta1_color);
+            colors.push_back(theta1_color);
+            for (int i = first_slice_idx; i <= last_slice_idx; ++i) {
+                int X = (i > SLICES ? (i - SLICES) : i) * 2, Y = X + 1;
+                Clr slice_color = BevelColor(border_color1, border_color2, unit_vertices[X], unit_vertices[Y]);
+                vertices.push_back(unit_vertices[X]);
+                vertices.push_back(unit_vertices[Y]);
+                vertices.push_back(unit_vertices[X] * inner_radius);
+                vertices.push_back(unit_vertices[Y] * inner_radius);
+                colors.push_back(slice_color);
+                colors.push_back(slice_color);
+            }
+            Clr theta2_color = BevelColor(border_color1, border_color2, theta2_x, theta2_y);
+            vertices.push_back(theta2_x);
+            vertices.push_back(theta2_y);
+            vertices.push_back(theta2_x * inner_radius);
+            vertices.push_back(theta2_y * inner_radius);
+            colors.push_back(theta2_color);
+            colors.push_back(theta2_color);
+            geometry.Add(GL_QUAD_STRIP, vertices, colors);
         }
 
         glPushMatrix();
         glTranslatef(Value(ul.x + wd / 2.0), Value(ul.y + ht / 2.0), 0.0);   // move origin to the center of the rectangle
         glScalef(Value(wd / 2.0), Value(ht / 2.0), 1.0);                 // map the range [-1,1] to the rectangle in both (x- and y-) directions
-
-        double inner_radius = (std::min(Value(wd), Value(ht)) - 2.0 * bevel_thick) / std::min(Value(wd), Value(ht));
-        glColor(color);
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex2f(0, 0);
-        // point on circle at angle theta1
-        double theta1_x = cos(-theta1), theta1_y = sin(-theta1);
-        glVertex2f(theta1_x * inner_radius, theta1_y * inner_radius);
-        // angles in between theta1 and theta2, if any
-        for (int i = first_slice_idx; i <= last_slice_idx; ++i) {
-            int X = (i > SLICES ? (i - SLICES) : i) * 2, Y = X + 1;
-            glVertex2f(unit_vertices[X] * inner_radius, unit_vertices[Y] * inner_radius);
-        }      // theta2
-        double theta2_x = cos(-theta2), theta2_y = sin(-theta2);
-        glVertex2f(theta2_x * inner_radius, theta2_y * inner_radius);
-        glEnd();
-        glBegin(GL_QUAD_STRIP);
-        // point on circle at angle theta1
-        double color_scale_factor = (SQRT2OVER2 * (theta1_x + theta1_y) + 1) / 2;
-        glColor4ub(GLubyte(border_color2.r * (1 - color_scale_factor) + border_color1.r * color_scale_factor),
-                   GLubyte(border_color2.g * (1 - color_scale_factor) + border_color1.g * color_scale_factor),
-                   GLubyte(border_color2.b * (1 - color_scale_factor) + border_color1.b * color_scale_factor),
-                   GLubyte(border_color2.a * (1 - color_scale_factor) + border_color1.a * color_scale_factor));
-        glVertex2f(theta1_x, theta1_y);
-        glVertex2f(theta1_x * inner_radius, theta1_y * inner_radius);
-        // angles in between theta1 and theta2, if any
-        for (int i = first_slice_idx; i <= last_slice_idx; ++i) {
-            int X = (i > SLICES ? (i - SLICES) : i) * 2, Y = X + 1;
-            glColor(colors[i]);
-            glVertex2f(unit_vertices[X], unit_vertices[Y]);
-            glVertex2f(unit_vertices[X] * inner_radius, unit_vertices[Y] * inner_radius);
-        }
-        // theta2
-        color_scale_factor = (SQRT2OVER2 * (theta2_x + theta2_y) + 1) / 2;
-        glColor4ub(GLubyte(border_color2.r * (1 - color_scale_factor) + border_color1.r * color_scale_factor),
-                   GLubyte(border_color2.g * (1 - color_scale_factor) + border_color1.g * color_scale_factor),
-                   GLubyte(border_color2.b * (1 - color_scale_factor) + border_color1.b * color_scale_factor),
-                   GLubyte(border_color2.a * (1 - color_scale_factor) + border_color1.a * color_scale_factor));
-        glVertex2f(theta2_x, theta2_y);
-        glVertex2f(theta2_x * inner_radius, theta2_y * inner_radius);
-        glEnd();
+        geometry.Render();
         glPopMatrix();
-        glEnable(GL_TEXTURE_2D);
+        CountedEnable(GL_TEXTURE_2D);
     }
 
     void RoundedRectangle(Pt ul, Pt lr, Clr color, Clr border_color1, Clr border_color2, unsigned int corner_radius, int thick)
@@ -431,7 +607,7 @@ namespace { // file-scope constants and functions
         CircleArc(Pt(ul.x, lr.y - circle_diameter), Pt(ul.x + circle_diameter, lr.y), color, border_color2, border_color1, thick, PI, 1.5 * PI); // ll corner
         CircleArc(Pt(lr.x - circle_diameter, lr.y - circle_diameter), Pt(lr.x, lr.y), color, border_color2, border_color1, thick, 1.5 * PI, 0);  // lr corner
 
-        glDisable(GL_TEXTURE_2D);
+        CountedDisable(GL_TEXTURE_2D);
 
         // top
         double color_scale_factor = (SQRT2OVER2 * (0 + 1) + 1) / 2;
@@ -439,7 +615,7 @@ namespace { // file-scope constants and functions
                    GLubyte(border_color2.g * (1 - color_scale_factor) + border_color1.g * color_scale_factor),
                    GLubyte(border_color2.b * (1 - color_scale_factor) + border_color1.b * color_scale_factor),
                    GLubyte(border_color2.a * (1 - color_scale_factor) + border_color1.a * color_scale_factor));
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex(lr.x - static_cast<int>(corner_radius), ul.y);
         glVertex(ul.x + static_cast<int>(corner_radius), ul.y);
         glVertex(ul.x + static_cast<int>(corner_radius), ul.y + thick);
@@ -447,7 +623,7 @@ namespace { // file-scope constants and functions
         glEnd();
 
         // left (uses color scale factor (SQRT2OVER2 * (1 + 0) + 1) / 2, which equals that of top
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex(ul.x + thick, ul.y + static_cast<int>(corner_radius));
         glVertex(ul.x, ul.y + static_cast<int>(corner_radius));
         glVertex(ul.x, lr.y - static_cast<int>(corner_radius));
@@ -460,7 +636,7 @@ namespace { // file-scope constants and functions
                    GLubyte(border_color2.g * (1 - color_scale_factor) + border_color1.g * color_scale_factor),
                    GLubyte(border_color2.b * (1 - color_scale_factor) + border_color1.b * color_scale_factor),
                    GLubyte(border_color2.a * (1 - color_scale_factor) + border_color1.a * color_scale_factor));
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex(lr.x, ul.y + static_cast<int>(corner_radius));
         glVertex(lr.x - thick, ul.y + static_cast<int>(corner_radius));
         glVertex(lr.x - thick, lr.y - static_cast<int>(corner_radius));
@@ -468,7 +644,7 @@ namespace { // file-scope constants and functions
         glEnd();
 
         // bottom (uses color scale factor (SQRT2OVER2 * (0 + -1) + 1) / 2, which equals that of left
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex(lr.x - static_cast<int>(corner_radius), lr.y - thick);
         glVertex(ul.x + static_cast<int>(corner_radius), lr.y - thick);
         glVertex(ul.x + static_cast<int>(corner_radius), lr.y);
@@ -477,7 +653,7 @@ namespace { // file-scope constants and functions
 
         // middle
         glColor(color);
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glVertex(lr.x - static_cast<int>(corner_radius), ul.y + thick);
         glVertex(ul.x + static_cast<int>(corner_radius), ul.y + thick);
         glVertex(ul.x + static_cast<int>(corner_radius), lr.y - thick);
@@ -493,7 +669,7 @@ namespace { // file-scope constants and functions
         glVertex(ul.x + static_cast<int>(corner_radius), lr.y - static_cast<int>(corner_radius));
         glVertex(ul.x + thick, lr.y - static_cast<int>(corner_radius));
         glEnd();
-        glEnable(GL_TEXTURE_2D);
+        CountedEnable(GL_TEXTURE_2D);
     }
 
     void BubbleRectangle(Pt ul, Pt lr, Clr color1, Clr color2, Clr color3, unsigned int corner_radius)
@@ -504,7 +680,7 @@ namespace { // file-scope constants and functions
         BubbleArc(Pt(ul.x, lr.y - circle_diameter), Pt(ul.x + circle_diameter, lr.y), color1, color3, color2, PI, 1.5 * PI); // ll corner
         BubbleArc(Pt(lr.x - circle_diameter, lr.y - circle_diameter), Pt(lr.x, lr.y), color1, color3, color2, 1.5 * PI, 0);  // lr corner
 
-        glDisable(GL_TEXTURE_2D);
+        CountedDisable(GL_TEXTURE_2D);
 
         // top
         double color_scale_factor = (SQRT2OVER2 * (0 + 1) + 1) / 2;
@@ -512,7 +688,7 @@ namespace { // file-scope constants and functions
                          GLubyte(color3.g * (1 - color_scale_factor) + color2.g * color_scale_factor),
                          GLubyte(color3.b * (1 - color_scale_factor) + color2.b * color_scale_factor),
                          GLubyte(color3.a * (1 - color_scale_factor) + color2.a * color_scale_factor));
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glColor(scaled_color);
         glVertex(lr.x - static_cast<int>(corner_radius), ul.y);
         glVertex(ul.x + static_cast<int>(corner_radius), ul.y);
@@ -522,7 +698,7 @@ namespace { // file-scope constants and functions
         glEnd();
 
         // left (uses color scale factor (SQRT2OVER2 * (1 + 0) + 1) / 2, which equals that of top
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glColor(scaled_color);
         glVertex(ul.x, ul.y + static_cast<int>(corner_radius));
         glVertex(ul.x, lr.y - static_cast<int>(corner_radius));
@@ -537,7 +713,7 @@ namespace { // file-scope constants and functions
                            GLubyte(color3.g * (1 - color_scale_factor) + color2.g * color_scale_factor),
                            GLubyte(color3.b * (1 - color_scale_factor) + color2.b * color_scale_factor),
                            GLubyte(color3.a * (1 - color_scale_factor) + color2.a * color_scale_factor));
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glColor(color1);
         glVertex(lr.x - static_cast<int>(corner_radius), ul.y + static_cast<int>(corner_radius));
         glVertex(lr.x - static_cast<int>(corner_radius), lr.y - static_cast<int>(corner_radius));
@@ -547,7 +723,7 @@ namespace { // file-scope constants and functions
         glEnd();
 
         // bottom (uses color scale factor (SQRT2OVER2 * (0 + -1) + 1) / 2, which equals that of left
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glColor(color1);
         glVertex(lr.x - static_cast<int>(corner_radius), lr.y - static_cast<int>(corner_radius));
         glVertex(ul.x + static_cast<int>(corner_radius), lr.y - static_cast<int>(corner_radius));
@@ -557,20 +733,41 @@ namespace { // file-scope constants and functions
         glEnd();
 
         // middle
-        glBegin(GL_QUADS);
+        CountedBegin(GL_QUADS);
         glColor(color1);
         glVertex(lr.x - static_cast<int>(corner_radius), ul.y + static_cast<int>(corner_radius));
         glVertex(ul.x + static_cast<int>(corner_radius), ul.y + static_cast<int>(corner_radius));
         glVertex(ul.x + static_cast<int>(corner_radius), lr.y - static_cast<int>(corner_radius));
         glVertex(lr.x - static_cast<int>(corner_radius), lr.y - static_cast<int>(corner_radius));
         glEnd();
-        glEnable(GL_TEXTURE_2D);
+        CountedEnable(GL_TEXTURE_2D);
     }
 } // namespace
 
 
 namespace GG {
 
+    RenderStats::RenderStats()
+    { Reset(); }
+
+    void RenderStats::Reset()
+    {
+        draw_calls = 0;
+        state_changes = 0;
+        texture_binds = 0;
+        scissor_pushes = 0;
+        stencil_pushes = 0;
+        windows_visited = 0;
+        windows_culled = 0;
+        windows_occluded = 0;
+        glyphs = 0;
+        state_queries = 0;
+        stalls_avoided = 0;
+    }
+
+    RenderStats& FrameRenderStats()
+    { return g_render_stats; }
+
     void glColor(Clr clr)
     { glColor4ub(clr.r, clr.g, clr.b, clr.a); }
 
@@ -619,11 +816,57 @@ namespace GG {
         return retval;
     }
 
+    void ResetGLStateCache()
+    { g_gl_state.valid = g_gl_state.stencil_valid = false; }
+
+    bool VerifyGLStateCache()
+    {
+        if (!g_gl_state.valid)
+            return true;
+
+        // the clipping functions always put the write masks back, but the
+        // scissor and stencil state are only known outside of any clipping
+        GLboolean color_writemask[4];
+        GLboolean depth_writemask;
+        glGetBooleanv(GL_COLOR_WRITEMASK, color_writemask);
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_writemask);
+        g_render_stats.state_queries += 2;
+        bool changed = !std::equal(color_writemask, color_writemask + 4, g_gl_state.color_writemask) ||
+            depth_writemask != g_gl_state.depth_writemask;
+        if (!changed && g_scissor_clipping_rects.empty() && !g_stencil_bit) {
+            GLboolean scissor_test;
+            GLboolean stencil_test;
+            GLint scissor_box[4];
+            glGetBooleanv(GL_SCISSOR_TEST, &scissor_test);
+            glGetBooleanv(GL_STENCIL_TEST, &stencil_test);
+            glGetIntegerv(GL_SCISSOR_BOX, scissor_box);
+            g_render_stats.state_queries += 3;
+            changed = scissor_test != g_gl_state.scissor_test || stencil_test != g_gl_state.stencil_test ||
+                !std::equal(scissor_box, scissor_box + 4, g_curr_scissor_box);
+        }
+        if (changed)
+            ResetGLStateCache();
+        return !changed;
+    }
+
+    bool ScissorClippingActive()
+    { return !g_scissor_clipping_rects.empty(); }
+
+    Rect ActiveScissorClippingRegion()
+    {
+        assert(!g_scissor_clipping_rects.empty());
+        return g_scissor_clipping_rects.back();
+    }
+
     void BeginScissorClipping(Pt ul, Pt lr)
     {
+        ++g_render_stats.scissor_pushes;
         if (g_scissor_clipping_rects.empty()) {
-            glPushAttrib(GL_SCISSOR_BIT);
-            glEnable(GL_SCISSOR_TEST);
+            FillGLStateCache();
+            if (!g_gl_state.scissor_test)
+                glEnable(GL_SCISSOR_TEST);
+            else
+                ++g_render_stats.stalls_avoided;
             if (g_stencil_bit)
                 glDisable(GL_STENCIL_TEST);
         } else {
@@ -633,8 +876,8 @@ namespace GG {
             lr.x = std::max(r.Left(), std::min(lr.x, r.Right()));
             lr.y = std::max(r.Top(), std::min(lr.y, r.Bottom()));
         }
-        glScissor(Value(ul.x), Value(GUI::GetGUI()->AppHeight() - lr.y),
-                  Value(lr.x - ul.x), Value(lr.y - ul.y));
+        SetScissorBox(Value(ul.x), Value(GUI::GetGUI()->AppHeight() - lr.y),
+                      Value(lr.x - ul.x), Value(lr.y - ul.y));
         g_scissor_clipping_rects.push_back(Rect(ul, lr));
     }
 
@@ -643,71 +886,73 @@ namespace GG {
         assert(!g_scissor_clipping_rects.empty());
         g_scissor_clipping_rects.pop_back();
         if (g_scissor_clipping_rects.empty()) {
-            glPopAttrib();
+            if (g_gl_state.scissor_test) {
+                SetScissorBox(g_gl_state.scissor_box[0], g_gl_state.scissor_box[1],
+                              g_gl_state.scissor_box[2], g_gl_state.scissor_box[3]);
+            } else {
+                glDisable(GL_SCISSOR_TEST);
+            }
             if (g_stencil_bit)
                 glEnable(GL_STENCIL_TEST);
         } else {
             const Rect& r = g_scissor_clipping_rects.back();
-            glScissor(Value(r.Left()), Value(GUI::GetGUI()->AppHeight() - r.Bottom()),
-                      Value(r.Width()), Value(r.Height()));
+            SetScissorBox(Value(r.Left()), Value(GUI::GetGUI()->AppHeight() - r.Bottom()),
+                          Value(r.Width()), Value(r.Height()));
         }
     }
 
     void BeginStencilClipping(Pt inner_ul, Pt inner_lr,
                               Pt outer_ul, Pt outer_lr)
     {
+        ++g_render_stats.stencil_pushes;
+        g_render_stats.draw_calls += 2;
         if (!g_stencil_bit) {
-            glPushAttrib(GL_STENCIL_BUFFER_BIT);
-            glClearStencil(0);
+            FillGLStateCache();
+            FillStencilStateCache();
+            if (g_gl_state.stencil_clear_value)
+                glClearStencil(0);
+            else
+                ++g_render_stats.stalls_avoided;
             glClear(GL_STENCIL_BUFFER_BIT);
-            glEnable(GL_STENCIL_TEST);
+            if (!g_gl_state.stencil_test)
+                glEnable(GL_STENCIL_TEST);
+            else
+                ++g_render_stats.stalls_avoided;
             if (!g_scissor_clipping_rects.empty())
                 glDisable(GL_SCISSOR_TEST);
         }
 
-        glGetBooleanv(GL_COLOR_WRITEMASK, g_prev_color_writemask);
-        glGetBooleanv(GL_DEPTH_WRITEMASK, &g_prev_depth_writemask);
-
         glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
         glDepthMask(GL_FALSE);
 
         GLuint mask = 1u << g_stencil_bit;
 
-        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
-        glEnableClientState(GL_VERTEX_ARRAY);
-
         glStencilFunc(GL_ALWAYS, mask, mask);
         glStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE);
-        GLint outer_vertices[] = {
-            Value(outer_ul.x), Value(outer_ul.y),
-            Value(outer_ul.x), Value(outer_lr.y),
-            Value(outer_lr.x), Value(outer_lr.y),
-            Value(outer_lr.x), Value(outer_ul.y)
-        };
-        glVertexPointer(2, GL_INT, 0, outer_vertices);
-        glDrawArrays(GL_QUADS, 0, 4);
+        glBegin(GL_QUADS);
+        glVertex(outer_ul.x, outer_ul.y);
+        glVertex(outer_ul.x, outer_lr.y);
+        glVertex(outer_lr.x, outer_lr.y);
+        glVertex(outer_lr.x, outer_ul.y);
+        glEnd();
 
         glStencilOp(GL_INVERT, GL_INVERT, GL_INVERT);
-        GLint inner_vertices[] = {
-            Value(inner_ul.x), Value(inner_ul.y),
-            Value(inner_ul.x), Value(inner_lr.y),
-            Value(inner_lr.x), Value(inner_lr.y),
-            Value(inner_lr.x), Value(inner_ul.y)
-        };
-        glVertexPointer(2, GL_INT, 0, inner_vertices);
-        glDrawArrays(GL_QUADS, 0, 4);
+        glBegin(GL_QUADS);
+        glVertex(inner_ul.x, inner_ul.y);
+        glVertex(inner_ul.x, inner_lr.y);
+        glVertex(inner_lr.x, inner_lr.y);
+        glVertex(inner_lr.x, inner_ul.y);
+        glEnd();
 
-        glColorMask(g_prev_color_writemask[0],
-                    g_prev_color_writemask[1],
-                    g_prev_color_writemask[2],
-                    g_prev_color_writemask[3]);
-        glDepthMask(g_prev_depth_writemask);
+        glColorMask(g_gl_state.color_writemask[0],
+                    g_gl_state.color_writemask[1],
+                    g_gl_state.color_writemask[2],
+                    g_gl_state.color_writemask[3]);
+        glDepthMask(g_gl_state.depth_writemask);
 
         glStencilFunc(GL_EQUAL, mask, mask);
         glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
         ++g_stencil_bit;
-
-        glPopClientAttrib();
     }
 
     void EndStencilClipping()
@@ -715,7 +960,14 @@ namespace GG {
         assert(g_stencil_bit);
         --g_stencil_bit;
         if (!g_stencil_bit) {
-            glPopAttrib();
+            glStencilFunc(g_gl_state.stencil_func, g_gl_state.stencil_ref, g_gl_state.stencil_value_mask);
+            glStencilOp(g_gl_state.stencil_fail, g_gl_state.stencil_pass_depth_fail, g_gl_state.stencil_pass_depth_pass);
+            if (g_gl_state.stencil_clear_value)
+                glClearStencil(g_gl_state.stencil_clear_value);
+            if (!g_gl_state.stencil_test)
+                glDisable(GL_STENCIL_TEST);
+            else
+                ++g_render_stats.stalls_avoided;
             if (!g_scissor_clipping_rects.empty())
                 glEnable(GL_SCISSOR_TEST);
         }
@@ -783,4 +1035,106 @@ namespace GG {
                           corner_radius);
     }
 
+
+    ////////////////////////////////////////
+    // class GG::RetainedGeometry
+    ////////////////////////////////////////
+    RetainedGeometry::RetainedGeometry() :
+        m_vertex_count(0),
+        m_display_list(0)
+    {}
+
+    RetainedGeometry::~RetainedGeometry()
+    { Clear(); }
+
+    bool RetainedGeometry::Empty() const
+    { return !m_vertex_count; }
+
+    std::size_t RetainedGeometry::Vertices() const
+    { return m_vertex_count; }
+
+    void RetainedGeometry::Add(GLenum mode, const std::vector<GLfloat>& vertices, const std::vector<Clr>& colors)
+    {
+        assert(vertices.size() == 2 * colors.size());
+        if (m_display_list) { // the compiled geometry is out of date, and is recompiled by the next Render()
+            glDeleteLists(m_display_list, 1);
+            m_display_list = 0;
+        }
+        Primitive primitive;
+        primitive.mode = mode;
+        primitive.first = m_colors.size();
+        primitive.count = colors.size();
+        m_primitives.push_back(primitive);
+        m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+        m_colors.insert(m_colors.end(), colors.begin(), colors.end());
+        m_vertex_count += colors.size();
+    }
+
+    void RetainedGeometry::Render()
+    {
+        if (!m_vertex_count)
+            return;
+
+        ++g_render_stats.draw_calls;
+
+        if (m_display_list) {
+            glCallList(m_display_list);
+            return;
+        }
+        if (m_primitives.empty() || m_colors.empty())
+            return;
+
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 0, &m_vertices[0]);
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, &m_colors[0]);
+
+        // the arrays are kept after the list is compiled, so that primitives
+        // added later are compiled along with the earlier ones; if no list
+        // can be had, the arrays are drawn directly each time
+        m_display_list = glGenLists(1);
+        if (m_display_list)
+            glNewList(m_display_list, GL_COMPILE_AND_EXECUTE);
+        for (std::size_t i = 0; i < m_primitives.size(); ++i) {
+            glDrawArrays(m_primitives[i].mode, m_primitives[i].first, m_primitives[i].count);
+        }
+        if (m_display_list)
+            glEndList();
+
+        glPopClientAttrib();
+    }
+
+    void RetainedGeometry::Clear()
+    {
+        if (m_display_list) {
+            glDeleteLists(m_display_list, 1);
+            m_display_list = 0;
+        }
+        m_vertices.clear();
+        m_colors.clear();
+        m_primitives.clear();
+        m_vertex_count = 0;
+    }
+
+    void BeginGeometryCacheFrame()
+    {
+        // every arc drawn in the last frame is kept, however many there
+        // were, so a frame's arcs never evict each other; beyond
+        // MIN_CACHED_ARCS, the arcs that went undrawn longest are dropped
+        if (MIN_CACHED_ARCS < g_arc_cache.size()) {
+            std::vector<ArcCache::iterator> stale;
+            for (ArcCache::iterator it = g_arc_cache.begin(); it != g_arc_cache.end(); ++it) {
+                if (it->second.frame != g_arc_cache_frame)
+                    stale.push_back(it);
+            }
+            std::size_t excess = std::min(g_arc_cache.size() - MIN_CACHED_ARCS, stale.size());
+            std::nth_element(stale.begin(), stale.begin() + excess, stale.end(), &EarlierFrame);
+            for (std::size_t i = 0; i < excess; ++i) {
+                g_arc_cache.erase(stale[i]);
+            }
+        }
+        ++g_arc_cache_frame;
+    }
+
 } // namespace GG
@@ -30,10 +30,12 @@
 #include <GG/GUI.h>
 #include <GG/DrawUtil.h>
 #include <GG/Texture.h>
+#include <GG/Timer.h>
 
 #include <boost/assign/list_of.hpp>
 
 #include <cmath>
+#include <set>
 
 
 using namespace GG;
@@ -48,6 +50,30 @@ namespace {
     };
 
     const double DEFAULT_FPS = 15.0;
+
+    /** Every DynamicGraphic in existence. */
+    std::set<DynamicGraphic*>& AllDynamicGraphics()
+    {
+        static std::set<DynamicGraphic*> dynamic_graphics;
+        return dynamic_graphics;
+    }
+
+    /** The Timer that advances all DynamicGraphics, once per frame.  It is
+        created along with the first DynamicGraphic, and destroyed along with
+        the last, unless that happens while the Timer is firing. */
+    Timer* g_animation_timer = 0;
+    bool g_advancing = false;
+
+    /** Returns true iff \a wnd would be drawn: it and all its ancestors are
+        visible, and its root is registered with the GUI. */
+    bool Showing(const Wnd* wnd)
+    {
+        for (; wnd->Parent(); wnd = wnd->Parent()) {
+            if (!wnd->Visible())
+                return false;
+        }
+        return wnd->Visible() && GUI::GetGUI() && GUI::GetGUI()->Registered(wnd);
+    }
 }
 
 const std::size_t DynamicGraphic::ALL_FRAMES = std::numeric_limits<std::size_t>::max();
@@ -79,12 +105,27 @@ DynamicGraphic::DynamicGraphic(X x, Y y, X w, Y h, bool loop, X frame_width, Y f
     AddFrames(textures, frames);
     m_last_frame_idx = m_frames - 1;
 
+    AllDynamicGraphics().insert(this);
+    if (!g_animation_timer) {
+        g_animation_timer = new Timer(0);
+        GG::Connect(g_animation_timer->FiredSignal, &DynamicGraphic::AdvanceAll);
+    }
+
     if (INSTRUMENT_ALL_SIGNALS) {
         Connect(StoppedSignal, SignalEcho("DynamicGraphic::StoppedSignal"));
         Connect(EndFrameSignal, SignalEcho("DynamicGraphic::EndFrameSignal"));
     }
 }
 
+DynamicGraphic::~DynamicGraphic()
+{
+    AllDynamicGraphics().erase(this);
+    if (AllDynamicGraphics().empty() && !g_advancing) {
+        delete g_animation_timer;
+        g_animation_timer = 0;
+    }
+}
+
 std::size_t DynamicGraphic::Frames() const       
 { return m_frames; }
 
@@ -124,54 +165,10 @@ Flags<GraphicStyle> DynamicGraphic::Style() const
 void DynamicGraphic::Render()
 {
     if (m_curr_texture < m_textures.size() && m_curr_subtexture < m_textures[m_curr_texture].frames) {
-        bool send_stopped_signal = false;
-        bool send_end_frame_signal = false;
-
-        // advance frames
-        std::size_t initial_frame_idx = (0.0 <= m_FPS ? m_first_frame_idx : m_last_frame_idx);
-        std::size_t final_frame_idx =   (0.0 <= m_FPS ? m_last_frame_idx : m_first_frame_idx);
-        if (m_playing) {
-            if (m_first_frame_time == INVALID_TIME) {
-                m_last_frame_time = m_first_frame_time = GUI::GetGUI()->Ticks();
-                if (m_FPS)
-                    m_first_frame_time -= static_cast<unsigned int>(1000.0 / m_FPS * m_curr_frame);
-            } else {
-                std::size_t old_frame = m_curr_frame;
-                std::size_t curr_time = GUI::GetGUI()->Ticks();
-                SetFrameIndex(initial_frame_idx +
-                              static_cast<std::size_t>((curr_time - m_first_frame_time) * m_FPS / 1000.0) %
-                              (m_last_frame_idx - m_first_frame_idx + 1));
-
-                // determine whether the final frame was passed
-                std::size_t frames_passed =
-                    static_cast<std::size_t>((curr_time - m_last_frame_time) * m_FPS / 1000.0);
-                if (m_frames <= frames_passed ||
-                    (0.0 <= m_FPS ? m_curr_frame < old_frame : old_frame < m_curr_frame)) {
-                    send_end_frame_signal = true;
-                    // if looping isn't allowed, stop at the last frame
-                    if (!m_looping) {
-                        m_playing = false;
-                        m_first_frame_time = INVALID_TIME;
-                        SetFrameIndex(final_frame_idx);
-                        send_stopped_signal = true;
-                    }
-                }
-                m_last_frame_time = curr_time;
-            }
-        }
-
         // render current frame
         Clr color_to_use = Disabled() ? DisabledColor(Color()) : Color();
         glColor(color_to_use);
 
-        const int INT_MARGIN = m_margin;
-        std::size_t cols =
-            Value(m_textures[m_curr_texture].texture->DefaultWidth() /
-                  (m_frame_width + INT_MARGIN));
-        X x = static_cast<int>(m_curr_subtexture % cols) * (m_frame_width + INT_MARGIN) + INT_MARGIN;
-        Y y = static_cast<int>(m_curr_subtexture / cols) * (m_frame_height + INT_MARGIN) + INT_MARGIN;
-        SubTexture st(m_textures[m_curr_texture].texture, x, y, x + m_frame_width, y + m_frame_height);
-
         Pt ul = UpperLeft(), lr = LowerRight();
         Pt window_sz(lr - ul);
         Pt graphic_sz(m_frame_width, m_frame_height);
@@ -220,12 +217,18 @@ void DynamicGraphic::Render()
         pt1.y += y_shift;
         pt2.y += y_shift;
 
-        st.OrthoBlit(pt1, pt2);
+        FrameSet& frame_set = m_textures[m_curr_texture];
+        if (frame_set.texture->Loading()) {
+            GetTextureManager().RenderPlaceholder(pt1, pt2);
+        } else {
+            if (frame_set.subtextures.empty()) {
+                frame_set.subtextures = GetTextureManager().GetAnimationFrames(
+                    frame_set.texture, m_frame_width, m_frame_height, m_margin, frame_set.frames);
+            }
+            if (m_curr_subtexture < frame_set.subtextures.size())
+                frame_set.subtextures[m_curr_subtexture].OrthoBlit(pt1, pt2);
+        }
 
-        if (send_end_frame_signal)
-            EndFrameSignal(final_frame_idx);
-        if (send_stopped_signal)
-            StoppedSignal(m_curr_frame);
     }
 }
 
@@ -468,3 +471,65 @@ void DynamicGraphic::ValidateStyle()
         m_style |= GRAPHIC_SHRINKFIT;
     }
 }
+
+void DynamicGraphic::Advance(unsigned int ticks)
+{
+    if (m_curr_texture < m_textures.size() && m_curr_subtexture < m_textures[m_curr_texture].frames) {
+        bool send_stopped_signal = false;
+        bool send_end_frame_signal = false;
+
+        // advance frames
+        std::size_t initial_frame_idx = (0.0 <= m_FPS ? m_first_frame_idx : m_last_frame_idx);
+        std::size_t final_frame_idx =   (0.0 <= m_FPS ? m_last_frame_idx : m_first_frame_idx);
+        if (m_playing) {
+            if (m_first_frame_time == INVALID_TIME) {
+                m_last_frame_time = m_first_frame_time = ticks;
+                if (m_FPS)
+                    m_first_frame_time -= static_cast<unsigned int>(1000.0 / m_FPS * m_curr_frame);
+            } else {
+                std::size_t old_frame = m_curr_frame;
+                std::size_t curr_time = ticks;
+                SetFrameIndex(initial_frame_idx +
+                              static_cast<std::size_t>((curr_time - m_first_frame_time) * m_FPS / 1000.0) %
+                              (m_last_frame_idx - m_first_frame_idx + 1));
+
+                // determine whether the final frame was passed
+                std::size_t frames_passed =
+                    static_cast<std::size_t>((curr_time - m_last_frame_time) * m_FPS / 1000.0);
+                if (m_frames <= frames_passed ||
+                    (0.0 <= m_FPS ? m_curr_frame < old_frame : old_frame < m_curr_frame)) {
+                    send_end_frame_signal = true;
+                    // if looping isn't allowed, stop at the last frame
+                    if (!m_looping) {
+                        m_playing = false;
+                        m_first_frame_time = INVALID_TIME;
+                        SetFrameIndex(final_frame_idx);
+                        send_stopped_signal = true;
+                    }
+                }
+                m_last_frame_time = curr_time;
+            }
+        }
+
+        if (send_end_frame_signal)
+            EndFrameSignal(final_frame_idx);
+        if (send_stopped_signal)
+            StoppedSignal(m_curr_frame);
+    }
+}
+
+void DynamicGraphic::AdvanceAll(unsigned int ticks, Timer* timer)
+{
+    // the signals emitted may create or destroy DynamicGraphics, so a copy
+    // of the set is iterated over, and each one is checked before use;
+    // DynamicGraphics that are not being drawn are left alone, and catch up
+    // to the current time when they are shown again
+    std::vector<DynamicGraphic*> dynamic_graphics(AllDynamicGraphics().begin(), AllDynamicGraphics().end());
+    g_advancing = true;
+    for (std::size_t i = 0; i < dynamic_graphics.size(); ++i) {
+        if (AllDynamicGraphics().count(dynamic_graphics[i]) && Showing(dynamic_graphics[i]))
+            dynamic_graphics[i]->Advance(ticks);
+    }
+    g_advancing = false;
+    timer->Reset(ticks);
+}
@@ -24,6 +24,7 @@
 
 #include <GG/EveGlue.h>
 
+#include <GG/DefinitionCache.h>
 #include <GG/DrawUtil.h>
 #include <GG/Filesystem.h>
 #include <GG/GUI.h>
@@ -34,7 +35,6 @@
 #include <GG/adobe/future/widgets/headers/platform_window.hpp>
 
 #include <boost/cast.hpp>
-#include <boost/filesystem/fstream.hpp>
 
 
 using namespace GG;
@@ -561,12 +561,8 @@ ModalDialogResult GG::ExecuteModalDialog(const boost::filesystem::path& eve_defi
 {
     boost::filesystem::path eve_definition = GUI::GetGUI()->FindResource(eve_definition_);
     boost::filesystem::path adam_definition = GUI::GetGUI()->FindResource(adam_definition_);
-    boost::filesystem::ifstream eve_stream(eve_definition);
-    boost::filesystem::ifstream adam_stream(adam_definition);
-    return ExecuteModalDialog(eve_stream,
-                              PathToUTF8(eve_definition),
-                              adam_stream,
-                              PathToUTF8(adam_definition),
+    return ExecuteModalDialog(GetDefinitionCache().Get(eve_definition, ParsedDefinition::EVE),
+                              GetDefinitionCache().Get(adam_definition, ParsedDefinition::ADAM),
                               dictionary_functions,
                               array_functions,
                               adam_functions,
@@ -605,6 +601,25 @@ ModalDialogResult GG::ExecuteModalDialog(std::istream& eve_definition,
                                          ButtonHandler button_handler,
                                          SignalHandler signal_handler/* = SignalHandler()*/,
                                          RowFactory row_factory/* = RowFactory()*/)
+{
+    return ExecuteModalDialog(GetDefinitionCache().Get(eve_definition, eve_filename, ParsedDefinition::EVE),
+                              GetDefinitionCache().Get(adam_definition, adam_filename, ParsedDefinition::ADAM),
+                              dictionary_functions,
+                              array_functions,
+                              adam_functions,
+                              button_handler,
+                              signal_handler,
+                              row_factory);
+}
+
+ModalDialogResult GG::ExecuteModalDialog(const ParsedDefinition& eve_definition,
+                                         const ParsedDefinition& adam_definition,
+                                         const DictionaryFunctions& dictionary_functions,
+                                         const ArrayFunctions& array_functions,
+                                         const AdamFunctions& adam_functions,
+                                         ButtonHandler button_handler,
+                                         SignalHandler signal_handler/* = SignalHandler()*/,
+                                         RowFactory row_factory/* = RowFactory()*/)
 {
     ModalDialogResult retval;
 
@@ -622,7 +637,7 @@ ModalDialogResult GG::ExecuteModalDialog(std::istream& eve_definition,
 
     AttachFunctions(dictionary_functions, array_functions, adam_functions, dialog.get());
 
-    std::auto_ptr<Wnd> w(dialog->init(eve_definition, eve_filename, adam_definition, adam_filename));
+    std::auto_ptr<Wnd> w(dialog->init(eve_definition, adam_definition));
     EveDialog* gg_dialog = boost::polymorphic_downcast<EveDialog*>(w.get());
     gg_dialog->SetKeyboard(dialog->keyboard());
     gg_dialog->MoveTo(
@@ -664,12 +679,8 @@ EveDialog* GG::MakeEveDialog(const boost::filesystem::path& eve_definition_,
 {
     boost::filesystem::path eve_definition = GUI::GetGUI()->FindResource(eve_definition_);
     boost::filesystem::path adam_definition = GUI::GetGUI()->FindResource(adam_definition_);
-    boost::filesystem::ifstream eve_stream(eve_definition);
-    boost::filesystem::ifstream adam_stream(adam_definition);
-    return MakeEveDialog(eve_stream,
-                         PathToUTF8(eve_definition),
-                         adam_stream,
-                         PathToUTF8(adam_definition),
+    return MakeEveDialog(GetDefinitionCache().Get(eve_definition, ParsedDefinition::EVE),
+                         GetDefinitionCache().Get(adam_definition, ParsedDefinition::ADAM),
                          dictionary_functions,
                          array_functions,
                          adam_functions,
@@ -708,6 +719,25 @@ EveDialog* GG::MakeEveDialog(std::istream& eve_definition,
                              ButtonHandler button_handler,
                              SignalHandler signal_handler/* = SignalHandler()*/,
                              RowFactory row_factory/* = RowFactory()*/)
+{
+    return MakeEveDialog(GetDefinitionCache().Get(eve_definition, eve_filename, ParsedDefinition::EVE),
+                         GetDefinitionCache().Get(adam_definition, adam_filename, ParsedDefinition::ADAM),
+                         dictionary_functions,
+                         array_functions,
+                         adam_functions,
+                         button_handler,
+                         signal_handler,
+                         row_factory);
+}
+
+EveDialog* GG::MakeEveDialog(const ParsedDefinition& eve_definition,
+                             const ParsedDefinition& adam_definition,
+                             const DictionaryFunctions& dictionary_functions,
+                             const ArrayFunctions& array_functions,
+                             const AdamFunctions& adam_functions,
+                             ButtonHandler button_handler,
+                             SignalHandler signal_handler/* = SignalHandler()*/,
+                             RowFactory row_factory/* = RowFactory()*/)
 {
     EveDialog* retval = 0;
 
@@ -725,7 +755,7 @@ EveDialog* GG::MakeEveDialog(std::istream& eve_definition,
 
     AttachFunctions(dictionary_functions, array_functions, adam_functions, dialog.get());
 
-    Wnd* w = dialog->init(eve_definition, eve_filename, adam_definition, adam_filename);
+    Wnd* w = dialog->init(eve_definition, adam_definition);
     retval = boost::polymorphic_downcast<EveDialog*>(w);
 
     retval->SetKeyboard(dialog->keyboard());
@@ -24,6 +24,7 @@
 
 #include <GG/EventPump.h>
 
+#include <GG/Profiler.h>
 #include <GG/WndEvent.h>
 
 #include <boost/tuple/tuple.hpp>
@@ -53,17 +54,25 @@ EventPumpState::EventPumpState() :
 
 void EventPumpBase::LoopBody(GUI* gui, EventPumpState& state, bool do_non_rendering, bool do_rendering)
 {
+    GG_PROFILE_FRAME();
+
     if (do_non_rendering) {
         int time = gui->Ticks();
 
-        while (!GGEventQueue().empty()) {
-            const QueuedEventTuple& event = GGEventQueue().front();
-            gui->HandleGGEvent(event.get<0>(), event.get<1>(), event.get<2>(), event.get<3>(), event.get<4>(), event.get<5>());
-            GGEventQueue().pop_front();
+        {
+            GG_PROFILE_ZONE("EventPump::EventDrain");
+            while (!GGEventQueue().empty()) {
+                const QueuedEventTuple& event = GGEventQueue().front();
+                gui->HandleGGEvent(event.get<0>(), event.get<1>(), event.get<2>(), event.get<3>(), event.get<4>(), event.get<5>());
+                GGEventQueue().pop_front();
+            }
         }
 
         // send an idle message, so that the gui has timely updates for triggering browse info windows, etc.
-        gui->HandleGGEvent(GUI::IDLE, GGK_UNKNOWN, 0, gui->ModKeys(), gui->MousePosition(), Pt());
+        {
+            GG_PROFILE_ZONE("EventPump::Idle");
+            gui->HandleGGEvent(GUI::IDLE, GGK_UNKNOWN, 0, gui->ModKeys(), gui->MousePosition(), Pt());
+        }
 
         // govern FPS speed if needed
         if (double max_FPS = gui->MaxFPS()) {
@@ -89,9 +98,18 @@ void EventPumpBase::LoopBody(GUI* gui, EventPumpState& state, bool do_non_render
 
     if (do_rendering) {
         // do one iteration of the render loop
-        gui->RenderBegin();
-        gui->Render();
-        gui->RenderEnd();
+        {
+            GG_PROFILE_ZONE("GUI::RenderBegin");
+            gui->RenderBegin();
+        }
+        {
+            GG_PROFILE_ZONE("GUI::Render");
+            gui->Render();
+        }
+        {
+            GG_PROFILE_ZONE("GUI::RenderEnd");
+            gui->RenderEnd();
+        }
     }
 }
 
@@ -28,6 +28,7 @@
 #include <GG/Base.h>
 #include <GG/DrawUtil.h>
 #include <GG/Filesystem.h>
+#include <GG/Profiler.h>
 #include <GG/StyleFactory.h>
 #include <GG/utf8/checked.h>
 
@@ -784,6 +785,8 @@ Pt Font::DetermineLinesImpl(const std::string& text,
                             std::vector<LineData>& line_data,
                             std::vector<boost::shared_ptr<TextElement> >* text_elements_ptr) const
 {
+    GG_PROFILE_ZONE("Font::DetermineLines");
+
     ValidateFormat(format);
 
 #if DEBUG_DETERMINELINES
@@ -1394,8 +1397,12 @@ void Font::ValidateFormat(Flags<TextFormat>& format) const
 
 X Font::RenderGlyph(const Pt& pt, const Glyph& glyph, const Font::RenderState* render_state) const
 {
+    RenderStats& stats = FrameRenderStats();
+    ++stats.glyphs;
     if (render_state && render_state->use_italics) {
         // render subtexture to rhombus instead of rectangle
+        ++stats.texture_binds;
+        ++stats.draw_calls;
         glBindTexture(GL_TEXTURE_2D, glyph.sub_texture.GetTexture()->OpenGLId());
         glBegin(GL_TRIANGLE_STRIP);
         glTexCoord2f(glyph.sub_texture.TexCoords()[0], glyph.sub_texture.TexCoords()[1]);
@@ -1416,6 +1423,8 @@ X Font::RenderGlyph(const Pt& pt, const Glyph& glyph, const Font::RenderState* r
         Y_d y1 = pt.y + m_height + m_descent - m_underline_offset;
         X x2 = x1 + glyph.advance;
         Y_d y2 = y1 + m_underline_height;
+        ++stats.draw_calls;
+        stats.state_changes += 2;
         glDisable(GL_TEXTURE_2D);
         glBegin(GL_QUADS);
         glVertex(x1, y2);
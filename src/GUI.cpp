@@ -25,12 +25,15 @@
 #include <GG/GUI.h>
 
 #include <GG/BrowseInfoWnd.h>
+#include <GG/ClrConstants.h>
 #include <GG/Config.h>
 #include <GG/Control.h>
 #include <GG/Cursor.h>
+#include <GG/DrawUtil.h>
 #include <GG/EventPump.h>
 #include <GG/Layout.h>
 #include <GG/PluginInterface.h>
+#include <GG/Profiler.h>
 #include <GG/StyleFactory.h>
 #include <GG/Timer.h>
 #include <GG/ZList.h>
@@ -46,6 +49,7 @@
 #include <boost/thread.hpp>
 #include <boost/xpressive/xpressive.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <fstream>
@@ -101,6 +105,36 @@ namespace {
     const word_regex DEFAULT_WORD_REGEX =
         +boost::xpressive::set[boost::xpressive::_w | WIDE_DASH];
 
+    /** Returns the part of \a rect that is also in \a clip_rect.  The
+        result has zero area if they do not intersect. */
+    Rect ClipRect(const Rect& rect, const Rect& clip_rect)
+    {
+        Pt ul(std::max(rect.Left(), clip_rect.Left()), std::max(rect.Top(), clip_rect.Top()));
+        Pt lr(std::min(rect.Right(), clip_rect.Right()), std::min(rect.Bottom(), clip_rect.Bottom()));
+        return Rect(ul, Pt(std::max(ul.x, lr.x), std::max(ul.y, lr.y)));
+    }
+
+    /** Returns true iff \a rect lies entirely within \a outer. */
+    bool RectContains(const Rect& outer, const Rect& rect)
+    {
+        return
+            outer.Left() <= rect.Left() && rect.Right() <= outer.Right() &&
+            outer.Top() <= rect.Top() && rect.Bottom() <= outer.Bottom();
+    }
+
+    /** Returns true iff \a wnd, and any children it has, lie entirely
+        outside \a clip_rect, so that nothing they draw could be seen. */
+    bool ClippedOut(const Wnd* wnd, const Rect& clip_rect)
+    {
+        // children of a Wnd that does not clip them may extend beyond it
+        if (wnd->GetChildClippingMode() == Wnd::DontClip && !wnd->Children().empty())
+            return false;
+        Pt ul = wnd->UpperLeft(), lr = wnd->LowerRight();
+        return
+            lr.x <= clip_rect.Left() || clip_rect.Right() <= ul.x ||
+            lr.y <= clip_rect.Top() || clip_rect.Bottom() <= ul.y;
+    }
+
     void WriteWndToPNG(const Wnd* wnd, const std::string& filename)
     {
 #if GG_HAVE_LIBPNG
@@ -198,6 +232,8 @@ struct GG::GUIImpl
         m_FPS(-1.0),
         m_calc_FPS(false),
         m_max_FPS(0.0),
+        m_last_frame_render_stats(),
+        m_render_stats_overlay(false),
         m_double_click_wnd(0),
         m_double_click_start_time(-1),
         m_double_click_time(-1),
@@ -270,6 +306,8 @@ struct GG::GUIImpl
     double       m_FPS;                   // the most recent calculation of the frames per second rendering speed (-1.0 if calcs are disabled)
     bool         m_calc_FPS;              // true iff FPS calcs are to be done
     double       m_max_FPS;               // the maximum allowed frames per second rendering speed
+    RenderStats  m_last_frame_render_stats; // the rendering statistics gathered during the most recently completed frame
+    bool         m_render_stats_overlay;  // true iff the FPS and render statistics are drawn each frame
 
     Wnd*         m_double_click_wnd;      // GUI window most recently clicked
     unsigned int m_double_click_button;   // the index of the mouse button used in the last click
@@ -604,6 +642,24 @@ std::string GUI::FPSString() const
 double GUI::MaxFPS() const
 { return s_impl->m_max_FPS; }
 
+const RenderStats& GUI::LastFrameRenderStats() const
+{ return s_impl->m_last_frame_render_stats; }
+
+std::string GUI::RenderStatsString() const
+{
+    const RenderStats& stats = s_impl->m_last_frame_render_stats;
+    return boost::io::str(boost::format("%u draw calls, %u state changes, %u texture binds, %u/%u scissor/stencil clips, "
+                                        "%u wnds rendered, %u wnds culled, %u wnds occluded, %u glyphs, "
+                                        "%u GL state queries, %u stalls avoided")
+                          % stats.draw_calls % stats.state_changes % stats.texture_binds
+                          % stats.scissor_pushes % stats.stencil_pushes
+                          % stats.windows_visited % stats.windows_culled % stats.windows_occluded % stats.glyphs
+                          % stats.state_queries % stats.stalls_avoided);
+}
+
+bool GUI::RenderStatsOverlayEnabled() const
+{ return s_impl->m_render_stats_overlay; }
+
 unsigned int GUI::ButtonDownRepeatDelay() const
 { return s_impl->m_button_down_repeat_delay; }
 
@@ -622,6 +678,17 @@ unsigned int GUI::MinDragDistance() const
 bool GUI::DragDropWnd(const Wnd* wnd) const
 { return s_impl->m_drag_drop_wnds.find(const_cast<Wnd*>(wnd)) != s_impl->m_drag_drop_wnds.end(); }
 
+bool GUI::Registered(const Wnd* wnd) const
+{
+    if (std::find(s_impl->m_zlist.begin(), s_impl->m_zlist.end(), wnd) != s_impl->m_zlist.end())
+        return true;
+    for (std::list<std::pair<Wnd*, Wnd*> >::const_iterator it = s_impl->m_modal_wnds.begin(); it != s_impl->m_modal_wnds.end(); ++it) {
+        if (it->first == wnd)
+            return true;
+    }
+    return DragDropWnd(wnd);
+}
+
 bool GUI::AcceptedDragDropWnd(const Wnd* wnd) const
 {
     std::map<const Wnd*, bool>::const_iterator it = s_impl->m_drag_drop_wnds_acceptable.find(wnd);
@@ -936,6 +1003,9 @@ void GUI::SetMaxFPS(double max)
     s_impl->m_max_FPS = max;
 }
 
+void GUI::EnableRenderStatsOverlay(bool b/* = true*/)
+{ s_impl->m_render_stats_overlay = b; }
+
 void GUI::MoveUp(Wnd* wnd)
 { if (wnd) s_impl->m_zlist.MoveUp(wnd); }
 
@@ -1048,6 +1118,12 @@ boost::shared_ptr<Texture> GUI::StoreTexture(const boost::shared_ptr<Texture>& t
 boost::shared_ptr<Texture> GUI::GetTexture(const std::string& name, bool mipmap/* = false*/)
 { return GetTextureManager().GetTexture(name, mipmap); }
 
+SubTexture GUI::GetSubTexture(const std::string& name)
+{ return GetTextureManager().GetSubTexture(name); }
+
+boost::shared_ptr<Texture> GUI::GetTextureAsync(const std::string& name, bool mipmap/* = false*/)
+{ return GetTextureManager().GetTextureAsync(name, mipmap); }
+
 void GUI::FreeTexture(const std::string& name)
 { GetTextureManager().FreeTexture(name); }
 
@@ -1071,19 +1147,50 @@ GUI* GUI::GetGUI()
 { return s_gui; }
 
 void GUI::RenderWindow(Wnd* wnd)
+{
+    Rect clip_rect(Pt(X0, Y0), Pt(s_gui->AppWidth(), s_gui->AppHeight()));
+    if (ScissorClippingActive())
+        clip_rect = ClipRect(clip_rect, ActiveScissorClippingRegion());
+    if (wnd && wnd->Visible() && wnd != s_impl->m_save_as_png_wnd && ClippedOut(wnd, clip_rect)) {
+        ++FrameRenderStats().windows_culled;
+        return;
+    }
+    RenderWindow(wnd, clip_rect);
+}
+
+void GUI::RenderWindow(Wnd* wnd, const Rect& clip_rect)
 {
     if (wnd && wnd->Visible()) {
+        GG_PROFILE_ZONE_DETAIL("GUI::RenderWindow", wnd->Name());
+
+        ++FrameRenderStats().windows_visited;
         wnd->Render();
+#if GG_VERIFY_GL_STATE_CACHE
+        // catches Render() overrides that change clipping state behind GG's back
+        bool gl_state_cache_valid = VerifyGLStateCache();
+        assert(gl_state_cache_valid &&
+               "GL write mask, scissor or stencil state was changed outside of the clipping functions "
+               "without a call to ResetGLStateCache()");
+        (void)gl_state_cache_valid;
+#endif
 
         Wnd::ChildClippingMode clip_mode = wnd->GetChildClippingMode();
+        Rect window_clip_rect = ClipRect(Rect(wnd->UpperLeft(), wnd->LowerRight()), clip_rect);
+        Rect client_clip_rect = ClipRect(Rect(wnd->ClientUpperLeft(), wnd->ClientLowerRight()), clip_rect);
 
         if (clip_mode != Wnd::ClipToClientAndWindowSeparately) {
             bool clip = clip_mode != Wnd::DontClip;
+            const Rect& children_clip_rect =
+                clip_mode == Wnd::DontClip ? clip_rect : (clip_mode == Wnd::ClipToWindow ? window_clip_rect : client_clip_rect);
             if (clip)
                 wnd->BeginClipping();
             for (std::list<Wnd*>::iterator it = wnd->m_children.begin(); it != wnd->m_children.end(); ++it) {
-                if ((*it)->Visible())
-                    RenderWindow(*it);
+                if (!(*it)->Visible())
+                    continue;
+                if (ClippedOut(*it, children_clip_rect))
+                    ++FrameRenderStats().windows_culled;
+                else
+                    RenderWindow(*it, children_clip_rect);
             }
             if (clip)
                 wnd->EndClipping();
@@ -1096,8 +1203,12 @@ void GUI::RenderWindow(Wnd* wnd)
             if (children_copy.begin() != client_child_begin) {
                 wnd->BeginNonclientClipping();
                 for (std::vector<Wnd*>::iterator it = children_copy.begin(); it != client_child_begin; ++it) {
-                    if ((*it)->Visible())
-                        RenderWindow(*it);
+                    if (!(*it)->Visible())
+                        continue;
+                    if (ClippedOut(*it, window_clip_rect))
+                        ++FrameRenderStats().windows_culled;
+                    else
+                        RenderWindow(*it, window_clip_rect);
                 }
                 wnd->EndNonclientClipping();
             }
@@ -1105,8 +1216,12 @@ void GUI::RenderWindow(Wnd* wnd)
             if (client_child_begin != children_copy.end()) {
                 wnd->BeginClipping();
                 for (std::vector<Wnd*>::iterator it = client_child_begin; it != children_copy.end(); ++it) {
-                    if ((*it)->Visible())
-                        RenderWindow(*it);
+                    if (!(*it)->Visible())
+                        continue;
+                    if (ClippedOut(*it, client_clip_rect))
+                        ++FrameRenderStats().windows_culled;
+                    else
+                        RenderWindow(*it, client_clip_rect);
                 }
                 wnd->EndClipping();
             }
@@ -1134,20 +1249,62 @@ void GUI::ProcessBrowseInfo()
 
 void GUI::Render()
 {
+    FrameRenderStats().Reset();
+    ResetGLStateCache();
+    BeginGeometryCacheFrame();
+
     // handle timers
-    int ticks = Ticks();
-    for (std::set<Timer*>::iterator it = s_impl->m_timers.begin(); it != s_impl->m_timers.end(); ++it) {
-        (*it)->Update(ticks);
+    {
+        GG_PROFILE_ZONE("GUI::UpdateTimers");
+        int ticks = Ticks();
+        for (std::set<Timer*>::iterator it = s_impl->m_timers.begin(); it != s_impl->m_timers.end(); ++it) {
+            (*it)->Update(ticks);
+        }
     }
 
-    Enter2DMode();
-    // render normal windows back-to-front
-    for (ZList::reverse_iterator it = s_impl->m_zlist.rbegin(); it != s_impl->m_zlist.rend(); ++it) {
-        RenderWindow(*it);
+    {
+        GG_PROFILE_ZONE("TextureManager::UploadPendingTextures");
+        GetTextureManager().UploadPendingTextures();
     }
-    // render modal windows back-to-front
+
+    // gather the normal windows and then the modal windows, back-to-front
+    std::vector<Wnd*> windows(s_impl->m_zlist.rbegin(), s_impl->m_zlist.rend());
     for (std::list<std::pair<Wnd*, Wnd*> >::iterator it = s_impl->m_modal_wnds.begin(); it != s_impl->m_modal_wnds.end(); ++it) {
-        RenderWindow(it->first);
+        windows.push_back(it->first);
+    }
+
+    // working front-to-back, find the windows that lie entirely behind an
+    // opaque window
+    std::vector<bool> occluded(windows.size(), false);
+    {
+        GG_PROFILE_ZONE("GUI::FindOccludedWindows");
+        const Rect screen(Pt(X0, Y0), Pt(AppWidth(), AppHeight()));
+        std::vector<Rect> opaque_rects;
+        for (std::size_t i = windows.size(); 0 < i; --i) {
+            Wnd* wnd = windows[i - 1];
+            if (!wnd->Visible())
+                continue;
+            Rect rect = ClipRect(Rect(wnd->UpperLeft(), wnd->LowerRight()), screen);
+            // children of a window that does not clip them may extend beyond it
+            bool contained = wnd->GetChildClippingMode() != Wnd::DontClip || wnd->Children().empty();
+            for (std::size_t j = 0; contained && j < opaque_rects.size(); ++j) {
+                if (RectContains(opaque_rects[j], rect)) {
+                    occluded[i - 1] = wnd != s_impl->m_save_as_png_wnd;
+                    break;
+                }
+            }
+            if (!occluded[i - 1] && wnd->Opaque())
+                opaque_rects.push_back(rect);
+        }
+    }
+
+    Enter2DMode();
+    // render normal and modal windows back-to-front
+    for (std::size_t i = 0; i < windows.size(); ++i) {
+        if (occluded[i])
+            ++FrameRenderStats().windows_occluded;
+        else
+            RenderWindow(windows[i]);
     }
     // render the active browse info window, if any
     if (s_impl->m_browse_info_wnd) {
@@ -1177,6 +1334,17 @@ void GUI::Render()
             it->first->Hide();
     }
     s_impl->m_rendering_drag_drop_wnds = false;
+    s_impl->m_last_frame_render_stats = FrameRenderStats();
+    if (s_impl->m_render_stats_overlay) {
+        boost::shared_ptr<Font> font = GetStyleFactory()->DefaultFont();
+        Pt pt(X(4), Y(4));
+        glColor(CLR_WHITE);
+        if (s_impl->m_calc_FPS) {
+            font->RenderText(pt, FPSString());
+            pt.y += font->Lineskip();
+        }
+        font->RenderText(pt, RenderStatsString());
+    }
     boost::shared_ptr<Cursor> cursor;
     if (s_impl->m_render_cursor && (cursor = GetCursor()))
         cursor->Render(s_impl->m_mouse_pos);
@@ -0,0 +1,281 @@
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+   
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+    
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+    
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+
+#include <GG/Headless/HeadlessGUI.h>
+#include <GG/EventPump.h>
+
+#include <GL/osmesa.h>
+
+#include <algorithm>
+#include <iostream>
+
+
+using namespace GG;
+
+namespace {
+    struct EarlierThan
+    {
+        bool operator()(const HeadlessGUI::ScriptedEvent& lhs, const HeadlessGUI::ScriptedEvent& rhs) const
+        { return lhs.ticks < rhs.ticks; }
+    };
+}
+
+///////////////////////////////////////
+// struct GG::HeadlessGUI::ScriptedEvent
+///////////////////////////////////////
+HeadlessGUI::ScriptedEvent::ScriptedEvent() :
+    ticks(0),
+    event(MOUSEMOVE),
+    key(GGK_UNKNOWN),
+    key_code_point(0)
+{}
+
+HeadlessGUI::ScriptedEvent::ScriptedEvent(unsigned int ticks_, EventType event_, Key key_, boost::uint32_t key_code_point_,
+                                          Flags<ModKey> mod_keys_, const Pt& pos_, const Pt& rel_) :
+    ticks(ticks_),
+    event(event_),
+    key(key_),
+    key_code_point(key_code_point_),
+    mod_keys(mod_keys_),
+    pos(pos_),
+    rel(rel_)
+{}
+
+
+///////////////////////////////////////
+// class GG::HeadlessGUI
+///////////////////////////////////////
+HeadlessGUI::HeadlessGUI(int w/* = 1024*/, int h/* = 768*/, const std::string& app_name/* = "GG"*/) :
+    GUI(app_name),
+    m_app_width(w),
+    m_app_height(h),
+    m_ticks(0),
+    m_frame_ticks(16),
+    m_max_frames(0),
+    m_frames_rendered(0),
+    m_done(false),
+    m_context(0)
+{}
+
+HeadlessGUI::~HeadlessGUI()
+{ HeadlessQuit(); }
+
+X HeadlessGUI::AppWidth() const
+{ return m_app_width; }
+
+Y HeadlessGUI::AppHeight() const
+{ return m_app_height; }
+
+unsigned int HeadlessGUI::Ticks() const
+{ return m_ticks; }
+
+unsigned int HeadlessGUI::FrameTicks() const
+{ return m_frame_ticks; }
+
+std::size_t HeadlessGUI::MaxFrames() const
+{ return m_max_frames; }
+
+std::size_t HeadlessGUI::FramesRendered() const
+{ return m_frames_rendered; }
+
+std::size_t HeadlessGUI::PendingScriptedEvents() const
+{ return m_scripted_events.size(); }
+
+void HeadlessGUI::operator()()
+{ GUI::operator()(); }
+
+void HeadlessGUI::Exit(int code)
+{
+    if (code)
+        std::cerr << "Initiating Exit (code " << code << " - error termination)";
+    HeadlessQuit();
+    exit(code);
+}
+
+void HeadlessGUI::Wait(unsigned int ms)
+{ AdvanceTicks(ms); }
+
+void HeadlessGUI::Enter2DMode()
+{
+    glPushAttrib(GL_ENABLE_BIT | GL_PIXEL_MODE_BIT | GL_TEXTURE_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_TEXTURE_2D);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glViewport(0, 0, Value(AppWidth()), Value(AppHeight()));
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glOrtho(0.0, Value(AppWidth()), Value(AppHeight()), 0.0, 0.0, Value(AppWidth()));
+
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+}
+
+void HeadlessGUI::Exit2DMode()
+{
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glPopAttrib();
+}
+
+void HeadlessGUI::SetTicks(unsigned int ticks)
+{ m_ticks = ticks; }
+
+void HeadlessGUI::AdvanceTicks(unsigned int ticks)
+{ m_ticks += ticks; }
+
+void HeadlessGUI::SetFrameTicks(unsigned int ticks)
+{ m_frame_ticks = ticks; }
+
+void HeadlessGUI::SetMaxFrames(std::size_t frames)
+{ m_max_frames = frames; }
+
+void HeadlessGUI::ScriptEvent(const ScriptedEvent& event)
+{
+    // upper_bound keeps events with equal time stamps in FIFO order
+    m_scripted_events.insert(
+        std::upper_bound(m_scripted_events.begin(), m_scripted_events.end(), event, EarlierThan()),
+        event);
+}
+
+void HeadlessGUI::ScriptEvent(unsigned int ticks, EventType event, const Pt& pos, Flags<ModKey> mod_keys/* = Flags<ModKey>()*/)
+{ ScriptEvent(ScriptedEvent(ticks, event, GGK_UNKNOWN, 0, mod_keys, pos, Pt())); }
+
+void HeadlessGUI::ClearScriptedEvents()
+{ m_scripted_events.clear(); }
+
+HeadlessGUI* HeadlessGUI::GetGUI()
+{ return dynamic_cast<HeadlessGUI*>(GUI::GetGUI()); }
+
+void HeadlessGUI::SetAppSize(const Pt& size)
+{
+    m_app_width = size.x;
+    m_app_height = size.y;
+}
+
+void HeadlessGUI::HeadlessInit()
+{
+    // 24 depth bits and 8 stencil bits, so that stencil clipping works as it
+    // does in the windowed drivers
+    m_context = OSMesaCreateContextExt(OSMESA_RGBA, 24, 8, 0, 0);
+    if (!m_context) {
+        std::cerr << "OSMesa context creation failed.";
+        Exit(1);
+    }
+
+    m_color_buffer.resize(Value(m_app_width) * Value(m_app_height) * 4);
+    if (!OSMesaMakeCurrent(m_context, &m_color_buffer[0], GL_UNSIGNED_BYTE, Value(m_app_width), Value(m_app_height))) {
+        std::cerr << "Could not make the OSMesa context current.";
+        Exit(1);
+    }
+    // GL expects the bottom row first, just as with an on-screen frame buffer
+    OSMesaPixelStore(OSMESA_Y_UP, 1);
+
+    GLInit();
+}
+
+void HeadlessGUI::GLInit()
+{
+    double ratio = Value(m_app_width * 1.0) / Value(m_app_height);
+
+    glEnable(GL_BLEND);
+    glEnable(GL_CULL_FACE);
+    glEnable(GL_DEPTH_TEST);
+    glShadeModel(GL_SMOOTH);
+    glClearColor(0, 0, 0, 0);
+    glViewport(0, 0, Value(m_app_width), Value(m_app_height));
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluPerspective(50.0, ratio, 1.0, 10.0);
+    // leave the modelview matrix current, so Wnd transforms do not land on
+    // the projection matrix
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+}
+
+void HeadlessGUI::Initialize()
+{}
+
+void HeadlessGUI::HandleSystemEvents()
+{
+    while (!m_scripted_events.empty() && m_scripted_events.front().ticks <= m_ticks) {
+        // copy, since HandleGGEvent() may script further events
+        ScriptedEvent event = m_scripted_events.front();
+        m_scripted_events.pop_front();
+        HandleGGEvent(event.event, event.key, event.key_code_point, event.mod_keys, event.pos, event.rel);
+    }
+}
+
+void HeadlessGUI::RenderBegin()
+{ glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT); }
+
+void HeadlessGUI::RenderEnd()
+{
+    glFinish();
+    m_ticks += m_frame_ticks;
+    if (++m_frames_rendered == m_max_frames)
+        m_done = true;
+}
+
+void HeadlessGUI::FinalCleanup()
+{}
+
+void HeadlessGUI::HeadlessQuit()
+{
+    FinalCleanup();
+    if (m_context) {
+        OSMesaDestroyContext(m_context);
+        m_context = 0;
+    }
+}
+
+void HeadlessGUI::Run()
+{
+    try {
+        HeadlessInit();
+        Initialize();
+        ModalEventPump pump(m_done);
+        pump();
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "std::invalid_argument exception caught in GUI::Run(): " << e.what();
+        Exit(1);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "std::runtime_error exception caught in GUI::Run(): " << e.what();
+        Exit(1);
+    } catch (const ExceptionBase& e) {
+        std::cerr << "GG exception (subclass " << e.type() << ") caught in GUI::Run(): " << e.what();
+        Exit(1);
+    }
+}
@@ -26,6 +26,7 @@
 
 #include <GG/ClrConstants.h>
 #include <GG/DrawUtil.h>
+#include <GG/Profiler.h>
 #include <GG/TextControl.h>
 #include <GG/WndEvent.h>
 
@@ -206,6 +207,8 @@ void Layout::SizeMove(const Pt& ul, const Pt& lr)
     if (m_ignore_parent_resize)
         return;
 
+    GG_PROFILE_ZONE_DETAIL("Layout::SizeMove", Name());
+
     // these hold values used to calculate m_min_usable_size
     std::vector<unsigned int> row_effective_min_usable_sizes(m_row_params.size());
     std::vector<unsigned int> column_effective_min_usable_sizes(m_column_params.size());
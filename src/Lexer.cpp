@@ -34,22 +34,27 @@ namespace GG {
 }
 
 using namespace GG;
+using detail::LexerTokenID;
 
+// The token patterns below are not compiled into a DFA; detail::table_lexer
+// matches each token with the hand-written matcher for the LexerTokenKind in
+// its id, so a pattern changed here must also be changed in that matcher
+// (see TableLexer.h).
 lexer::lexer(const adobe::name_t* first_keyword,
              const adobe::name_t* last_keyword) :
     keyword_true_false("true|false"),
     keyword_empty("empty"),
-    identifier("[a-zA-Z]\\w*"),
-    lead_comment("\\/\\*[^*]*\\*+([^/*][^*]*\\*+)*\\/"),
-    trail_comment("\\/\\/.*$"),
-    quoted_string("\\\"[^\\\"]*\\\"|'[^']*'"),
-    number("\\d+(\\.\\d*)?"),
-    eq_op("==|!="),
-    rel_op("<|>|<=|>="),
-    mul_op("\\*|\\/|%"),
-    define("<=="),
-    or_("\"||\""),
-    and_("&&")
+    identifier("[a-zA-Z]\\w*", LexerTokenID(detail::LEXER_WORD)),
+    lead_comment("\\/\\*[^*]*\\*+([^/*][^*]*\\*+)*\\/", LexerTokenID(detail::LEXER_LEAD_COMMENT)),
+    trail_comment("\\/\\/.*$", LexerTokenID(detail::LEXER_TRAIL_COMMENT)),
+    quoted_string("\\\"[^\\\"]*\\\"|'[^']*'", LexerTokenID(detail::LEXER_QUOTED_STRING)),
+    number("\\d+(\\.\\d*)?", LexerTokenID(detail::LEXER_NUMBER)),
+    eq_op("==|!=", LexerTokenID(detail::LEXER_EQ_OP)),
+    rel_op("<|>|<=|>=", LexerTokenID(detail::LEXER_REL_OP)),
+    mul_op("\\*|\\/|%", LexerTokenID(detail::LEXER_MUL_OP)),
+    define("<==", LexerTokenID(detail::LEXER_DEFINE)),
+    or_("\"||\"", LexerTokenID(detail::LEXER_OR)),
+    and_("&&", LexerTokenID(detail::LEXER_AND))
 {
     namespace lex = boost::spirit::lex;
 
@@ -95,5 +100,5 @@ lexer::lexer(const adobe::name_t* first_keyword,
         |     ';'
         ;
 
-    self("WS") = lex::token_def<>("\\s+");
+    self("WS") = lex::token_def<>("\\s+", LexerTokenID(detail::LEXER_WHITESPACE));
 }
@@ -0,0 +1,722 @@
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+#include <GG/ParsedDefinition.h>
+
+#include <GG/AdamParser.h>
+#include <GG/EveParser.h>
+#include <GG/Filesystem.h>
+#include <GG/adobe/adam_parser.hpp>
+#include <GG/adobe/dictionary.hpp>
+#include <GG/adobe/eve_parser.hpp>
+#include <GG/adobe/string.hpp>
+
+#include <boost/any.hpp>
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <cstring>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+
+using namespace GG;
+
+namespace {
+    // The precompiled format is:
+    //   header:  MAGIC, a version byte, a language byte, BYTE_ORDER_MARK as a
+    //            native uint16
+    //   names:   a uint32 count, then each name's characters and a '\0'
+    //   records: one value, the array of records
+    // where a value is a tag byte followed by its payload; see ValueTag.
+    // Integers and doubles are stored in native byte order.
+    const char MAGIC[4] = { 'G', 'G', 'P', 'D' };
+    const unsigned char VERSION = 1;
+    const boost::uint16_t BYTE_ORDER_MARK = 0x0102;
+    const std::size_t HEADER_SIZE = sizeof(MAGIC) + 2 + sizeof(BYTE_ORDER_MARK);
+
+    enum ValueTag {
+        EMPTY_TAG,
+        FALSE_TAG,
+        TRUE_TAG,
+        NUMBER_TAG,     // a double
+        STRING_TAG,     // a uint32 length, then the characters
+        NAME_TAG,       // a uint32 index into the names
+        ARRAY_TAG,      // a uint32 size, then the elements
+        DICTIONARY_TAG  // a uint32 size, then the name index and value of each element
+    };
+
+    enum RecordType {
+        ADAM_CELL_RECORD,      // type, name, position, expression or initializer, brief, detailed
+        ADAM_RELATION_RECORD,  // position, conditional, relations, brief, detailed
+        ADAM_INTERFACE_RECORD, // name, linked, position, initializer, position, expression, brief, detailed
+        EVE_VIEW_RECORD,       // parent view index (-1 for the top level), position, name, parameters, brief, detailed
+        EVE_CELL_RECORD        // type, name, position, initializer, brief, detailed
+    };
+
+    adobe::any_regular_t PositionValue(const adobe::line_position_t& position)
+    {
+        adobe::array_t retval;
+        retval.push_back(adobe::any_regular_t(adobe::name_t(position.stream_name())));
+        retval.push_back(adobe::any_regular_t(position.line_number_m));
+        retval.push_back(adobe::any_regular_t(static_cast<double>(std::streamoff(position.line_start_m))));
+        retval.push_back(adobe::any_regular_t(static_cast<double>(std::streamoff(position.position_m))));
+        return adobe::any_regular_t(retval);
+    }
+
+    adobe::line_position_t Position(const adobe::any_regular_t& value)
+    {
+        const adobe::array_t& array = value.cast<adobe::array_t>();
+        return adobe::line_position_t(array[0].cast<adobe::name_t>(),
+                                      adobe::line_position_t::getline_proc_t(),
+                                      static_cast<int>(array[1].cast<double>()),
+                                      static_cast<std::streamoff>(array[2].cast<double>()),
+                                      static_cast<std::streamoff>(array[3].cast<double>()));
+    }
+
+    std::string String(const adobe::any_regular_t& value)
+    { return value.cast<adobe::string_t>(); }
+
+    struct Recorder
+    {
+        explicit Recorder(adobe::array_t& records) :
+            m_records(records),
+            m_views(0)
+            {}
+
+        void AddAdamCell(adobe::adam_callback_suite_t::cell_type_t type,
+                         adobe::name_t name,
+                         const adobe::line_position_t& position,
+                         const adobe::array_t& expr_or_init,
+                         const std::string& brief,
+                         const std::string& detailed)
+            {
+                adobe::array_t record;
+                record.push_back(adobe::any_regular_t(static_cast<double>(ADAM_CELL_RECORD)));
+                record.push_back(adobe::any_regular_t(static_cast<double>(type)));
+                record.push_back(adobe::any_regular_t(name));
+                record.push_back(PositionValue(position));
+                record.push_back(adobe::any_regular_t(expr_or_init));
+                record.push_back(adobe::any_regular_t(brief));
+                record.push_back(adobe::any_regular_t(detailed));
+                m_records.push_back(adobe::any_regular_t(record));
+            }
+
+        void AddAdamRelation(const adobe::line_position_t& position,
+                             const adobe::array_t& conditional,
+                             const adobe::adam_callback_suite_t::relation_t* first,
+                             const adobe::adam_callback_suite_t::relation_t* last,
+                             const std::string& brief,
+                             const std::string& detailed)
+            {
+                adobe::array_t relations;
+                for (; first != last; ++first) {
+                    adobe::array_t relation;
+                    relation.push_back(adobe::any_regular_t(first->name_m));
+                    relation.push_back(PositionValue(first->position_m));
+                    relation.push_back(adobe::any_regular_t(first->expression_m));
+                    relation.push_back(adobe::any_regular_t(first->detailed_m));
+                    relation.push_back(adobe::any_regular_t(first->brief_m));
+                    relations.push_back(adobe::any_regular_t(relation));
+                }
+                adobe::array_t record;
+                record.push_back(adobe::any_regular_t(static_cast<double>(ADAM_RELATION_RECORD)));
+                record.push_back(PositionValue(position));
+                record.push_back(adobe::any_regular_t(conditional));
+                record.push_back(adobe::any_regular_t(relations));
+                record.push_back(adobe::any_regular_t(brief));
+                record.push_back(adobe::any_regular_t(detailed));
+                m_records.push_back(adobe::any_regular_t(record));
+            }
+
+        void AddAdamInterface(adobe::name_t name,
+                              bool linked,
+                              const adobe::line_position_t& position1,
+                              const adobe::array_t& initializer,
+                              const adobe::line_position_t& position2,
+                              const adobe::array_t& expression,
+                              const std::string& brief,
+                              const std::string& detailed)
+            {
+                adobe::array_t record;
+                record.push_back(adobe::any_regular_t(static_cast<double>(ADAM_INTERFACE_RECORD)));
+                record.push_back(adobe::any_regular_t(name));
+                record.push_back(adobe::any_regular_t(linked));
+                record.push_back(PositionValue(position1));
+                record.push_back(adobe::any_regular_t(initializer));
+                record.push_back(PositionValue(position2));
+                record.push_back(adobe::any_regular_t(expression));
+                record.push_back(adobe::any_regular_t(brief));
+                record.push_back(adobe::any_regular_t(detailed));
+                m_records.push_back(adobe::any_regular_t(record));
+            }
+
+        boost::any AddEveView(const boost::any& parent,
+                              const adobe::line_position_t& position,
+                              adobe::name_t name,
+                              const adobe::array_t& parameters,
+                              const std::string& brief,
+                              const std::string& detailed)
+            {
+                adobe::array_t record;
+                record.push_back(adobe::any_regular_t(static_cast<double>(EVE_VIEW_RECORD)));
+                record.push_back(adobe::any_regular_t(parent.empty() ? -1.0 : boost::any_cast<std::size_t>(parent)));
+                record.push_back(PositionValue(position));
+                record.push_back(adobe::any_regular_t(name));
+                record.push_back(adobe::any_regular_t(parameters));
+                record.push_back(adobe::any_regular_t(brief));
+                record.push_back(adobe::any_regular_t(detailed));
+                m_records.push_back(adobe::any_regular_t(record));
+                return boost::any(m_views++);
+            }
+
+        void AddEveCell(adobe::eve_callback_suite_t::cell_type_t type,
+                        adobe::name_t name,
+                        const adobe::line_position_t& position,
+                        const adobe::array_t& initializer,
+                        const std::string& brief,
+                        const std::string& detailed)
+            {
+                adobe::array_t record;
+                record.push_back(adobe::any_regular_t(static_cast<double>(EVE_CELL_RECORD)));
+                record.push_back(adobe::any_regular_t(static_cast<double>(type)));
+                record.push_back(adobe::any_regular_t(name));
+                record.push_back(PositionValue(position));
+                record.push_back(adobe::any_regular_t(initializer));
+                record.push_back(adobe::any_regular_t(brief));
+                record.push_back(adobe::any_regular_t(detailed));
+                m_records.push_back(adobe::any_regular_t(record));
+            }
+
+        adobe::array_t& m_records;
+        std::size_t m_views;
+    };
+
+    class Writer
+    {
+    public:
+        explicit Writer(std::ostream& os) :
+            m_os(os)
+            {}
+
+        void CollectNames(const adobe::any_regular_t& value)
+            {
+                if (value.type_info() == adobe::type_info<adobe::name_t>()) {
+                    NameIndex(value.cast<adobe::name_t>());
+                } else if (value.type_info() == adobe::type_info<adobe::array_t>()) {
+                    const adobe::array_t& array = value.cast<adobe::array_t>();
+                    for (adobe::array_t::const_iterator it = array.begin(); it != array.end(); ++it) {
+                        CollectNames(*it);
+                    }
+                } else if (value.type_info() == adobe::type_info<adobe::dictionary_t>()) {
+                    const adobe::dictionary_t& dictionary = value.cast<adobe::dictionary_t>();
+                    for (adobe::dictionary_t::const_iterator it = dictionary.begin(); it != dictionary.end(); ++it) {
+                        NameIndex(it->first);
+                        CollectNames(it->second);
+                    }
+                }
+            }
+
+        void WriteNames()
+            {
+                WriteUInt32(m_names.size());
+                for (std::size_t i = 0; i < m_names.size(); ++i) {
+                    m_os.write(m_names[i].c_str(), std::strlen(m_names[i].c_str()) + 1);
+                }
+            }
+
+        void WriteValue(const adobe::any_regular_t& value)
+            {
+                if (value.type_info() == adobe::type_info<adobe::empty_t>()) {
+                    WriteTag(EMPTY_TAG);
+                } else if (value.type_info() == adobe::type_info<bool>()) {
+                    WriteTag(value.cast<bool>() ? TRUE_TAG : FALSE_TAG);
+                } else if (value.type_info() == adobe::type_info<double>()) {
+                    WriteTag(NUMBER_TAG);
+                    double number = value.cast<double>();
+                    m_os.write(reinterpret_cast<const char*>(&number), sizeof(number));
+                } else if (value.type_info() == adobe::type_info<adobe::string_t>()) {
+                    const adobe::string_t& str = value.cast<adobe::string_t>();
+                    WriteTag(STRING_TAG);
+                    WriteUInt32(str.size());
+                    m_os.write(str.c_str(), str.size());
+                } else if (value.type_info() == adobe::type_info<adobe::name_t>()) {
+                    WriteTag(NAME_TAG);
+                    WriteUInt32(NameIndex(value.cast<adobe::name_t>()));
+                } else if (value.type_info() == adobe::type_info<adobe::array_t>()) {
+                    const adobe::array_t& array = value.cast<adobe::array_t>();
+                    WriteTag(ARRAY_TAG);
+                    WriteUInt32(array.size());
+                    for (adobe::array_t::const_iterator it = array.begin(); it != array.end(); ++it) {
+                        WriteValue(*it);
+                    }
+                } else if (value.type_info() == adobe::type_info<adobe::dictionary_t>()) {
+                    const adobe::dictionary_t& dictionary = value.cast<adobe::dictionary_t>();
+                    WriteTag(DICTIONARY_TAG);
+                    WriteUInt32(dictionary.size());
+                    for (adobe::dictionary_t::const_iterator it = dictionary.begin(); it != dictionary.end(); ++it) {
+                        WriteUInt32(NameIndex(it->first));
+                        WriteValue(it->second);
+                    }
+                } else {
+                    throw std::runtime_error("ParsedDefinition::Write() : A definition contains a value of a type "
+                                             "that cannot be precompiled.");
+                }
+            }
+
+    private:
+        boost::uint32_t NameIndex(adobe::name_t name)
+            {
+                std::map<adobe::name_t, boost::uint32_t>::iterator it = m_name_indices.find(name);
+                if (it == m_name_indices.end()) {
+                    it = m_name_indices.insert(std::make_pair(name, m_names.size())).first;
+                    m_names.push_back(name);
+                }
+                return it->second;
+            }
+
+        void WriteTag(ValueTag tag)
+            { m_os.put(static_cast<char>(tag)); }
+
+        void WriteUInt32(std::size_t n)
+            {
+                boost::uint32_t n_32 = static_cast<boost::uint32_t>(n);
+                m_os.write(reinterpret_cast<const char*>(&n_32), sizeof(n_32));
+            }
+
+        std::ostream&                            m_os;
+        std::map<adobe::name_t, boost::uint32_t> m_name_indices;
+        std::vector<adobe::name_t>               m_names;
+    };
+
+    class Reader
+    {
+    public:
+        Reader(const char* first, const char* last) :
+            m_it(first),
+            m_last(last)
+            {}
+
+        void ReadNames()
+            {
+                boost::uint32_t count = ReadUInt32();
+                m_names.reserve((std::min)(count, static_cast<boost::uint32_t>(m_last - m_it)));
+                for (boost::uint32_t i = 0; i < count; ++i) {
+                    const char* end = static_cast<const char*>(std::memchr(m_it, '\0', m_last - m_it));
+                    if (!end)
+                        Fail();
+                    m_names.push_back(adobe::name_t(m_it));
+                    m_it = end + 1;
+                }
+            }
+
+        adobe::any_regular_t ReadValue()
+            {
+                Require(1);
+                switch (*m_it++) {
+                case EMPTY_TAG: return adobe::any_regular_t();
+                case FALSE_TAG: return adobe::any_regular_t(false);
+                case TRUE_TAG:  return adobe::any_regular_t(true);
+                case NUMBER_TAG: {
+                    double number;
+                    Require(sizeof(number));
+                    std::memcpy(&number, m_it, sizeof(number));
+                    m_it += sizeof(number);
+                    return adobe::any_regular_t(number);
+                }
+                case STRING_TAG: {
+                    boost::uint32_t size = ReadUInt32();
+                    Require(size);
+                    adobe::string_t str(m_it, m_it + size);
+                    m_it += size;
+                    return adobe::any_regular_t(str);
+                }
+                case NAME_TAG:
+                    return adobe::any_regular_t(Name());
+                case ARRAY_TAG: {
+                    boost::uint32_t size = ReadUInt32();
+                    adobe::array_t array;
+                    array.reserve((std::min)(size, static_cast<boost::uint32_t>(m_last - m_it)));
+                    for (boost::uint32_t i = 0; i < size; ++i) {
+                        array.push_back(ReadValue());
+                    }
+                    return adobe::any_regular_t(array);
+                }
+                case DICTIONARY_TAG: {
+                    boost::uint32_t size = ReadUInt32();
+                    adobe::dictionary_t dictionary;
+                    for (boost::uint32_t i = 0; i < size; ++i) {
+                        adobe::name_t name = Name();
+                        dictionary[name] = ReadValue();
+                    }
+                    return adobe::any_regular_t(dictionary);
+                }
+                default:
+                    Fail();
+                }
+                return adobe::any_regular_t();
+            }
+
+        bool AtEnd() const
+            { return m_it == m_last; }
+
+    private:
+        adobe::name_t Name()
+            {
+                boost::uint32_t index = ReadUInt32();
+                if (m_names.size() <= index)
+                    Fail();
+                return m_names[index];
+            }
+
+        boost::uint32_t ReadUInt32()
+            {
+                boost::uint32_t retval;
+                Require(sizeof(retval));
+                std::memcpy(&retval, m_it, sizeof(retval));
+                m_it += sizeof(retval);
+                return retval;
+            }
+
+        void Require(std::size_t size)
+            {
+                if (static_cast<std::size_t>(m_last - m_it) < size)
+                    Fail();
+            }
+
+        static void Fail()
+            { throw std::runtime_error("ParsedDefinition::Read() : Corrupt precompiled definition."); }
+
+        const char*                m_it;
+        const char*                m_last;
+        std::vector<adobe::name_t> m_names;
+    };
+
+    bool Matches(const adobe::any_regular_t& value, const char* types);
+
+    bool IsRelations(const adobe::any_regular_t& value)
+    {
+        if (value.type_info() != adobe::type_info<adobe::array_t>())
+            return false;
+        const adobe::array_t& relations = value.cast<adobe::array_t>();
+        for (adobe::array_t::const_iterator it = relations.begin(); it != relations.end(); ++it) {
+            if (!Matches(*it, "npass"))
+                return false;
+        }
+        return true;
+    }
+
+    /** Returns true iff \a value is an array with one element for each
+        character in \a types, of the type it names: 'd' a number, 'b' a
+        bool, 'n' a name, 's' a string, 'a' an array, 'p' a position and 'r'
+        the relations of an Adam relation record. */
+    bool Matches(const adobe::any_regular_t& value, const char* types)
+    {
+        if (value.type_info() != adobe::type_info<adobe::array_t>())
+            return false;
+        const adobe::array_t& array = value.cast<adobe::array_t>();
+        if (array.size() != std::strlen(types))
+            return false;
+        for (std::size_t i = 0; i < array.size(); ++i) {
+            const adobe::any_regular_t& element = array[i];
+            bool match = false;
+            switch (types[i]) {
+            case 'd': match = element.type_info() == adobe::type_info<double>(); break;
+            case 'b': match = element.type_info() == adobe::type_info<bool>(); break;
+            case 'n': match = element.type_info() == adobe::type_info<adobe::name_t>(); break;
+            case 's': match = element.type_info() == adobe::type_info<adobe::string_t>(); break;
+            case 'a': match = element.type_info() == adobe::type_info<adobe::array_t>(); break;
+            case 'p': match = Matches(element, "nddd"); break;
+            case 'r': match = IsRelations(element); break;
+            }
+            if (!match)
+                return false;
+        }
+        return true;
+    }
+
+    bool IsIndex(double value, double size)
+    { return 0.0 <= value && value < size && value == static_cast<double>(static_cast<std::size_t>(value)); }
+
+    /** Returns true iff \a record is a well-formed record of \a language,
+        which Replay() can replay; \a views is the number of Eve views in
+        the records before it, and is incremented if it is one. */
+    bool ValidRecord(const adobe::any_regular_t& record, ParsedDefinition::Language language, std::size_t& views)
+    {
+        if (record.type_info() != adobe::type_info<adobe::array_t>() ||
+            record.cast<adobe::array_t>().empty() ||
+            record.cast<adobe::array_t>()[0].type_info() != adobe::type_info<double>()) {
+            return false;
+        }
+        const adobe::array_t& values = record.cast<adobe::array_t>();
+        const double type = values[0].cast<double>();
+        if (language == ParsedDefinition::ADAM) {
+            if (type == ADAM_CELL_RECORD)
+                return Matches(record, "ddnpass") && IsIndex(values[1].cast<double>(), adobe::adam_callback_suite_t::invariant_k + 1);
+            if (type == ADAM_RELATION_RECORD)
+                return Matches(record, "dparss");
+            if (type == ADAM_INTERFACE_RECORD)
+                return Matches(record, "dnbpapass");
+        } else {
+            if (type == EVE_VIEW_RECORD) {
+                if (!Matches(record, "ddpnass"))
+                    return false;
+                const double parent_index = values[1].cast<double>();
+                if (parent_index != -1.0 && !IsIndex(parent_index, views))
+                    return false;
+                ++views;
+                return true;
+            }
+            if (type == EVE_CELL_RECORD)
+                return Matches(record, "ddnpass") && IsIndex(values[1].cast<double>(), adobe::eve_callback_suite_t::interface_k + 1);
+        }
+        return false;
+    }
+}
+
+
+///////////////////////////////////////
+// class GG::ParsedDefinition
+///////////////////////////////////////
+ParsedDefinition::ParsedDefinition() :
+    m_language(ADAM),
+    m_records(new adobe::array_t)
+{}
+
+ParsedDefinition::Language ParsedDefinition::GetLanguage() const
+{ return m_language; }
+
+bool ParsedDefinition::Empty() const
+{ return m_records->empty(); }
+
+const adobe::array_t& ParsedDefinition::Records() const
+{ return *m_records; }
+
+void ParsedDefinition::Replay(const adobe::adam_callback_suite_t& callbacks) const
+{
+    if (m_language != ADAM)
+        throw std::logic_error("ParsedDefinition::Replay() : Attempted to replay an Eve definition as Adam.");
+
+    for (adobe::array_t::const_iterator it = m_records->begin(); it != m_records->end(); ++it) {
+        const adobe::array_t& record = it->cast<adobe::array_t>();
+        switch (static_cast<int>(record[0].cast<double>())) {
+        case ADAM_CELL_RECORD:
+            callbacks.add_cell_proc_m(
+                static_cast<adobe::adam_callback_suite_t::cell_type_t>(static_cast<int>(record[1].cast<double>())),
+                record[2].cast<adobe::name_t>(),
+                Position(record[3]),
+                record[4].cast<adobe::array_t>(),
+                String(record[5]),
+                String(record[6]));
+            break;
+        case ADAM_RELATION_RECORD: {
+            const adobe::array_t& relation_values = record[3].cast<adobe::array_t>();
+            std::vector<adobe::adam_callback_suite_t::relation_t> relations(relation_values.size());
+            for (std::size_t i = 0; i < relations.size(); ++i) {
+                const adobe::array_t& relation = relation_values[i].cast<adobe::array_t>();
+                relations[i].name_m = relation[0].cast<adobe::name_t>();
+                relations[i].position_m = Position(relation[1]);
+                relations[i].expression_m = relation[2].cast<adobe::array_t>();
+                relations[i].detailed_m = String(relation[3]);
+                relations[i].brief_m = String(relation[4]);
+            }
+            const adobe::adam_callback_suite_t::relation_t* first = relations.empty() ? 0 : &relations[0];
+            callbacks.add_relation_proc_m(Position(record[1]),
+                                          record[2].cast<adobe::array_t>(),
+                                          first,
+                                          first + relations.size(),
+                                          String(record[4]),
+                                          String(record[5]));
+            break;
+        }
+        case ADAM_INTERFACE_RECORD:
+            callbacks.add_interface_proc_m(record[1].cast<adobe::name_t>(),
+                                           record[2].cast<bool>(),
+                                           Position(record[3]),
+                                           record[4].cast<adobe::array_t>(),
+                                           Position(record[5]),
+                                           record[6].cast<adobe::array_t>(),
+                                           String(record[7]),
+                                           String(record[8]));
+            break;
+        default:
+            throw std::logic_error("ParsedDefinition::Replay() : Unknown Adam record.");
+        }
+    }
+}
+
+void ParsedDefinition::Replay(const boost::any& parent, const adobe::eve_callback_suite_t& callbacks) const
+{
+    if (m_language != EVE)
+        throw std::logic_error("ParsedDefinition::Replay() : Attempted to replay an Adam definition as Eve.");
+
+    std::vector<boost::any> views;
+    for (adobe::array_t::const_iterator it = m_records->begin(); it != m_records->end(); ++it) {
+        const adobe::array_t& record = it->cast<adobe::array_t>();
+        switch (static_cast<int>(record[0].cast<double>())) {
+        case EVE_VIEW_RECORD: {
+            const double parent_index = record[1].cast<double>();
+            if (parent_index >= views.size())
+                throw std::logic_error("ParsedDefinition::Replay() : Eve view added to an unknown parent.");
+            views.push_back(
+                callbacks.add_view_proc_m(parent_index < 0.0 ? parent : views[static_cast<std::size_t>(parent_index)],
+                                          Position(record[2]),
+                                          record[3].cast<adobe::name_t>(),
+                                          record[4].cast<adobe::array_t>(),
+                                          String(record[5]),
+                                          String(record[6])));
+            break;
+        }
+        case EVE_CELL_RECORD:
+            callbacks.add_cell_proc_m(
+                static_cast<adobe::eve_callback_suite_t::cell_type_t>(static_cast<int>(record[1].cast<double>())),
+                record[2].cast<adobe::name_t>(),
+                Position(record[3]),
+                record[4].cast<adobe::array_t>(),
+                String(record[5]),
+                String(record[6]));
+            break;
+        default:
+            throw std::logic_error("ParsedDefinition::Replay() : Unknown Eve record.");
+        }
+    }
+}
+
+void ParsedDefinition::Write(std::ostream& os) const
+{
+    adobe::any_regular_t records(*m_records);
+    Writer writer(os);
+    writer.CollectNames(records);
+    os.write(MAGIC, sizeof(MAGIC));
+    os.put(static_cast<char>(VERSION));
+    os.put(static_cast<char>(m_language));
+    os.write(reinterpret_cast<const char*>(&BYTE_ORDER_MARK), sizeof(BYTE_ORDER_MARK));
+    writer.WriteNames();
+    writer.WriteValue(records);
+}
+
+bool ParsedDefinition::Parse(Language language, const std::string& text, const std::string& filename)
+{
+    boost::shared_ptr<adobe::array_t> records(new adobe::array_t);
+    Recorder recorder(*records);
+    bool success = false;
+    if (language == ADAM) {
+        adobe::adam_callback_suite_t callbacks;
+        callbacks.add_cell_proc_m = boost::bind(&Recorder::AddAdamCell, &recorder, _1, _2, _3, _4, _5, _6);
+        callbacks.add_relation_proc_m = boost::bind(&Recorder::AddAdamRelation, &recorder, _1, _2, _3, _4, _5, _6);
+        callbacks.add_interface_proc_m =
+            boost::bind(&Recorder::AddAdamInterface, &recorder, _1, _2, _3, _4, _5, _6, _7, _8);
+        success = GG::Parse(text, filename, callbacks);
+    } else {
+        adobe::eve_callback_suite_t callbacks;
+        callbacks.add_view_proc_m = boost::bind(&Recorder::AddEveView, &recorder, _1, _2, _3, _4, _5, _6);
+        callbacks.add_cell_proc_m = boost::bind(&Recorder::AddEveCell, &recorder, _1, _2, _3, _4, _5, _6);
+        success = GG::Parse(text, filename, boost::any(), callbacks);
+    }
+    m_language = language;
+    if (success)
+        m_records = records;
+    else
+        m_records.reset(new adobe::array_t);
+    return success;
+}
+
+void ParsedDefinition::Read(const char* data, std::size_t size)
+{
+    if (!IsPrecompiled(data, size))
+        throw std::runtime_error("ParsedDefinition::Read() : Data are not a precompiled definition.");
+    if (data[sizeof(MAGIC)] != VERSION)
+        throw std::runtime_error("ParsedDefinition::Read() : Unsupported precompiled definition version.");
+    boost::uint16_t byte_order_mark;
+    std::memcpy(&byte_order_mark, data + sizeof(MAGIC) + 2, sizeof(byte_order_mark));
+    if (byte_order_mark != BYTE_ORDER_MARK)
+        throw std::runtime_error("ParsedDefinition::Read() : Precompiled definition has the wrong byte order.");
+    const char language = data[sizeof(MAGIC) + 1];
+    if (language != ADAM && language != EVE)
+        throw std::runtime_error("ParsedDefinition::Read() : Corrupt precompiled definition.");
+
+    Reader reader(data + HEADER_SIZE, data + size);
+    reader.ReadNames();
+    adobe::any_regular_t records = reader.ReadValue();
+    if (records.type_info() != adobe::type_info<adobe::array_t>() || !reader.AtEnd())
+        throw std::runtime_error("ParsedDefinition::Read() : Corrupt precompiled definition.");
+
+    // check every record up front, so that Replay() can index and cast them without checking
+    const adobe::array_t& records_array = records.cast<adobe::array_t>();
+    std::size_t views = 0;
+    for (std::size_t i = 0; i < records_array.size(); ++i) {
+        if (!ValidRecord(records_array[i], static_cast<Language>(language), views)) {
+            throw std::runtime_error("ParsedDefinition::Read() : Corrupt record " +
+                                     boost::lexical_cast<std::string>(i) + " in precompiled definition.");
+        }
+    }
+
+    m_language = static_cast<Language>(language);
+    m_records.reset(new adobe::array_t(records.cast<adobe::array_t>()));
+}
+
+bool ParsedDefinition::IsPrecompiled(const char* data, std::size_t size)
+{ return HEADER_SIZE <= size && !std::memcmp(data, MAGIC, sizeof(MAGIC)); }
+
+
+///////////////////////////////////////
+// free functions
+///////////////////////////////////////
+ParsedDefinition GG::LoadDefinition(const boost::filesystem::path& path, ParsedDefinition::Language language)
+{
+    namespace ip = boost::interprocess;
+
+    ip::mapped_region mapping;
+    const char* data = "";
+    std::size_t size = 0;
+    try {
+        if (boost::filesystem::file_size(path)) {
+            ip::file_mapping file(path.string().c_str(), ip::read_only);
+            ip::mapped_region region(file, ip::read_only);
+            mapping.swap(region);
+            data = static_cast<const char*>(mapping.get_address());
+            size = mapping.get_size();
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Could not map definition file \"" + PathToUTF8(path) + "\": " + e.what());
+    }
+
+    ParsedDefinition retval;
+    if (ParsedDefinition::IsPrecompiled(data, size)) {
+        retval.Read(data, size);
+        if (retval.GetLanguage() != language) {
+            throw std::runtime_error("Precompiled definition file \"" + PathToUTF8(path) +
+                                     "\" was not precompiled from " + (language == ParsedDefinition::ADAM ? "Adam." : "Eve."));
+        }
+    } else if (!retval.Parse(language, std::string(data, data + size), PathToUTF8(path))) {
+        throw std::logic_error(language == ParsedDefinition::ADAM ? "Adam parse failed." : "Eve parse failed.");
+    }
+    return retval;
+}
@@ -0,0 +1,277 @@
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+#include <GG/Profiler.h>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+
+
+using namespace GG;
+
+namespace {
+    const std::size_t DEFAULT_FRAME_CAPACITY = 120;
+
+    boost::uint64_t Microseconds()
+    {
+        using namespace boost::posix_time;
+        static const ptime EPOCH(microsec_clock::universal_time());
+        return (microsec_clock::universal_time() - EPOCH).total_microseconds();
+    }
+
+    void WriteJSONString(std::ostream& os, const char* str)
+    {
+        os << '"';
+        for (const char* c = str; *c; ++c) {
+            switch (*c) {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\r': os << "\\r"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(*c) < 0x20) {
+                    char buf[8];
+                    std::sprintf(buf, "\\u%04x", static_cast<unsigned int>(*c));
+                    os << buf;
+                } else {
+                    os << *c;
+                }
+            }
+        }
+        os << '"';
+    }
+}
+
+///////////////////////////////////////
+// struct GG::Profiler::Zone
+///////////////////////////////////////
+const std::size_t Profiler::Zone::DETAIL_SIZE;
+
+Profiler::Zone::Zone() :
+    name(""),
+    begin(0),
+    end(0),
+    depth(0)
+{ detail[0] = '\0'; }
+
+Profiler::Zone::Zone(const char* name_, const char* detail_, boost::uint64_t begin_, std::size_t depth_) :
+    name(name_),
+    begin(begin_),
+    end(begin_),
+    depth(depth_)
+{
+    std::size_t i = 0;
+    for (; detail_ && detail_[i] && i < DETAIL_SIZE - 1; ++i) {
+        detail[i] = detail_[i];
+    }
+    detail[i] = '\0';
+}
+
+
+///////////////////////////////////////
+// struct GG::Profiler::Frame
+///////////////////////////////////////
+Profiler::Frame::Frame() :
+    number(0),
+    begin(0),
+    end(0)
+{}
+
+
+///////////////////////////////////////
+// class GG::Profiler
+///////////////////////////////////////
+const std::size_t Profiler::INVALID_ZONE = static_cast<std::size_t>(-1);
+
+Profiler::Profiler() :
+    m_enabled(true),
+    m_frames(DEFAULT_FRAME_CAPACITY),
+    m_current_frame(0),
+    m_frames_recorded(0),
+    m_frame_number(0),
+    m_in_frame(false),
+    m_depth(0),
+    m_start_time(Microseconds())
+{}
+
+bool Profiler::Enabled() const
+{ return m_enabled; }
+
+std::size_t Profiler::Capacity() const
+{ return m_frames.size(); }
+
+std::size_t Profiler::FramesRecorded() const
+{ return m_frames_recorded; }
+
+const Profiler::Frame& Profiler::RecordedFrame(std::size_t frames_ago/* = 0*/) const
+{
+    assert(frames_ago < m_frames_recorded);
+    // m_current_frame is always one past the most recent complete frame
+    std::size_t newest = m_current_frame + m_frames.size() - 1;
+    return m_frames[(newest - frames_ago) % m_frames.size()];
+}
+
+boost::uint64_t Profiler::Now() const
+{ return Microseconds() - m_start_time; }
+
+void Profiler::WriteChromeTrace(std::ostream& os) const
+{
+    os << "{\"traceEvents\":[";
+    bool first_event = true;
+    for (std::size_t i = m_frames_recorded; 0 < i; --i) {
+        const Frame& frame = RecordedFrame(i - 1);
+        os << (first_event ? "\n" : ",\n")
+           << "{\"name\":\"frame\",\"cat\":\"GG\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+           << ",\"ts\":" << frame.begin
+           << ",\"dur\":" << (frame.end - frame.begin)
+           << ",\"args\":{\"number\":" << frame.number << "}}";
+        first_event = false;
+        for (std::size_t j = 0; j < frame.zones.size(); ++j) {
+            const Zone& zone = frame.zones[j];
+            os << ",\n{\"name\":";
+            WriteJSONString(os, zone.name);
+            os << ",\"cat\":\"GG\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+               << ",\"ts\":" << zone.begin
+               << ",\"dur\":" << (zone.end - zone.begin);
+            if (zone.detail[0]) {
+                os << ",\"args\":{\"detail\":";
+                WriteJSONString(os, zone.detail);
+                os << "}";
+            }
+            os << "}";
+        }
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void Profiler::WriteChromeTrace(const std::string& filename) const
+{
+    std::ofstream ofs(filename.c_str());
+    WriteChromeTrace(ofs);
+}
+
+void Profiler::Enable(bool b/* = true*/)
+{ m_enabled = b; }
+
+void Profiler::SetCapacity(std::size_t frames)
+{
+    assert(0 < frames);
+    m_frames.clear();
+    m_frames.resize(frames);
+    Clear();
+}
+
+void Profiler::Clear()
+{
+    for (std::size_t i = 0; i < m_frames.size(); ++i) {
+        m_frames[i].zones.clear();
+    }
+    m_current_frame = 0;
+    m_frames_recorded = 0;
+    m_in_frame = false;
+    m_depth = 0;
+}
+
+void Profiler::BeginFrame()
+{
+    if (!m_enabled)
+        return;
+    if (m_in_frame)
+        EndFrame();
+    if (m_frames_recorded == m_frames.size())
+        --m_frames_recorded; // the oldest frame is about to be overwritten
+    Frame& frame = m_frames[m_current_frame];
+    frame.number = m_frame_number++;
+    frame.begin = frame.end = Now();
+    frame.zones.clear(); // keeps the capacity, so steady-state frames do not allocate
+    m_in_frame = true;
+    m_depth = 0;
+}
+
+void Profiler::EndFrame()
+{
+    if (!m_in_frame)
+        return;
+    m_frames[m_current_frame].end = Now();
+    m_current_frame = (m_current_frame + 1) % m_frames.size();
+    if (m_frames_recorded < m_frames.size())
+        ++m_frames_recorded;
+    m_in_frame = false;
+}
+
+std::size_t Profiler::BeginZone(const char* name, const char* detail/* = 0*/)
+{
+    if (!m_enabled || !m_in_frame)
+        return INVALID_ZONE;
+    std::vector<Zone>& zones = m_frames[m_current_frame].zones;
+    zones.push_back(Zone(name, detail, Now(), m_depth++));
+    return zones.size() - 1;
+}
+
+void Profiler::EndZone(std::size_t zone)
+{
+    if (zone == INVALID_ZONE || !m_in_frame)
+        return;
+    std::vector<Zone>& zones = m_frames[m_current_frame].zones;
+    if (zone < zones.size()) {
+        zones[zone].end = Now();
+        m_depth = zones[zone].depth;
+    }
+}
+
+Profiler& Profiler::Instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+
+///////////////////////////////////////
+// class GG::ScopedProfileZone
+///////////////////////////////////////
+ScopedProfileZone::ScopedProfileZone(const char* name) :
+    m_zone(Profiler::Instance().BeginZone(name))
+{}
+
+ScopedProfileZone::ScopedProfileZone(const char* name, const std::string& detail) :
+    m_zone(Profiler::Instance().BeginZone(name, detail.c_str()))
+{}
+
+ScopedProfileZone::~ScopedProfileZone()
+{ Profiler::Instance().EndZone(m_zone); }
+
+
+///////////////////////////////////////
+// class GG::ScopedProfileFrame
+///////////////////////////////////////
+ScopedProfileFrame::ScopedProfileFrame()
+{ Profiler::Instance().BeginFrame(); }
+
+ScopedProfileFrame::~ScopedProfileFrame()
+{ Profiler::Instance().EndFrame(); }
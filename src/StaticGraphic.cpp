@@ -76,8 +76,12 @@ StaticGraphic::StaticGraphic(X x, Y y, X w, Y h, const boost::shared_ptr<Texture
     Control(x, y, w, h, flags),
     m_style(style)
 {
-    if (texture)
+    if (texture && texture->Loading()) {
+        Init(SubTexture());
+        m_loading_texture = texture;
+    } else if (texture) {
         Init(SubTexture(texture));
+    }
 }
 
 StaticGraphic::StaticGraphic(X x, Y y, X w, Y h, const SubTexture& subtexture, Flags<GraphicStyle> style/* = GRAPHIC_NONE*/,
@@ -93,7 +97,9 @@ Rect StaticGraphic::RenderedArea() const
 {
     Pt ul = UpperLeft(), lr = LowerRight();
     Pt window_sz(lr - ul);
-    Pt graphic_sz(m_graphic.Width(), m_graphic.Height());
+    Pt graphic_sz = m_loading_texture ?
+        Pt(m_loading_texture->DefaultWidth(), m_loading_texture->DefaultHeight()) :
+        Pt(m_graphic.Width(), m_graphic.Height());
     Pt pt1, pt2(graphic_sz); // (unscaled) default graphic size
     if (m_style & GRAPHIC_FITGRAPHIC) {
         if (m_style & GRAPHIC_PROPSCALE) {
@@ -147,6 +153,16 @@ const SubTexture& StaticGraphic::GetSubTexture() const
 
 void StaticGraphic::Render()
 {
+    if (m_loading_texture) {
+        if (m_loading_texture->Loading()) {
+            Rect rendered_area = RenderedArea();
+            GetTextureManager().RenderPlaceholder(rendered_area.ul, rendered_area.lr);
+            return;
+        }
+        m_graphic = SubTexture(m_loading_texture);
+        m_loading_texture.reset();
+    }
+
     if (!m_graphic.Empty()) {
         Clr color_to_use = Disabled() ? DisabledColor(Color()) : Color();
         glColor(color_to_use);
@@ -166,6 +182,7 @@ void StaticGraphic::Init(const SubTexture& subtexture)
     ValidateStyle();  // correct any disagreements in the style flags
     SetColor(CLR_WHITE);
     m_graphic = subtexture;
+    m_loading_texture.reset();
 }
 
 void StaticGraphic::ValidateStyle()
@@ -0,0 +1,389 @@
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+#include "StreamingImageDecoder.h"
+
+#include <GG/Config.h>
+#include <GG/Texture.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cctype>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+
+#if GG_HAVE_LIBPNG
+# include <png.h>
+#endif
+#if GG_HAVE_LIBJPEG
+extern "C" {
+# include <jpeglib.h>
+}
+#endif
+
+
+using namespace GG;
+using namespace GG::detail;
+
+///////////////////////////////////////
+// struct GG::detail::StreamingImageDecoder::Impl
+///////////////////////////////////////
+struct StreamingImageDecoder::Impl
+{
+    explicit Impl(const std::string& path_name_) :
+        path_name(path_name_),
+        data(0),
+        size(0),
+        supported(true),
+        width(0),
+        height(0),
+        bytes_pp(0)
+    {
+        namespace ip = boost::interprocess;
+        try {
+            ip::file_mapping file(path_name.c_str(), ip::read_only);
+            ip::mapped_region region(file, ip::read_only);
+            mapping.swap(region);
+        } catch (const ip::interprocess_exception& e) {
+            throw Texture::BadFile("Could not map image file \"" + path_name + "\": " + e.what());
+        }
+        data = static_cast<const unsigned char*>(mapping.get_address());
+        size = mapping.get_size();
+    }
+
+    virtual ~Impl() {}
+
+    virtual void ReadRows(unsigned char* buffer, int rows) = 0;
+
+    void Fail(const char* message) const
+    { throw Texture::BadFile("Could not decode image file \"" + path_name + "\": " + message); }
+
+    std::string                        path_name;
+    boost::interprocess::mapped_region mapping;
+    const unsigned char*               data;
+    std::size_t                        size;
+
+    bool                               supported;
+    int                                width;
+    int                                height;
+    unsigned int                       bytes_pp;
+};
+
+namespace {
+#if GG_HAVE_LIBPNG
+    // The functions that call into libpng must not have any objects with
+    // destructors on the stack, since libpng reports errors by longjmp()ing
+    // out of them.
+    struct PNGImpl : StreamingImageDecoder::Impl
+    {
+        PNGImpl(const std::string& path_name) :
+            Impl(path_name),
+            png(0),
+            info(0),
+            position(0)
+        {
+            error[0] = '\0';
+            png = png_create_read_struct(PNG_LIBPNG_VER_STRING, this, &PNGImpl::Error, &PNGImpl::Warning);
+            if (png)
+                info = png_create_info_struct(png);
+            if (!png || !info) {
+                png_destroy_read_struct(&png, &info, 0);
+                throw Texture::BadFile("Could not allocate a PNG decoder for \"" + path_name + "\"");
+            }
+            if (!ReadHeader()) {
+                png_destroy_read_struct(&png, &info, 0);
+                Fail(error);
+            }
+        }
+
+        virtual ~PNGImpl()
+        { png_destroy_read_struct(&png, &info, 0); }
+
+        virtual void ReadRows(unsigned char* buffer, int rows)
+        {
+            if (!DecodeRows(buffer, rows))
+                Fail(error);
+        }
+
+        bool ReadHeader()
+        {
+            if (setjmp(png_jmpbuf(png)))
+                return false;
+            png_set_read_fn(png, this, &PNGImpl::Read);
+            png_read_info(png, info);
+            png_uint_32 png_width, png_height;
+            int bit_depth, color_type, interlace;
+            png_get_IHDR(png, info, &png_width, &png_height, &bit_depth, &color_type, &interlace, 0, 0);
+            if (interlace != PNG_INTERLACE_NONE) {
+                supported = false;
+                return true;
+            }
+            if (color_type == PNG_COLOR_TYPE_PALETTE)
+                png_set_palette_to_rgb(png);
+            if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
+                png_set_expand_gray_1_2_4_to_8(png);
+            if (png_get_valid(png, info, PNG_INFO_tRNS))
+                png_set_tRNS_to_alpha(png);
+            if (bit_depth == 16)
+                png_set_strip_16(png);
+            png_read_update_info(png, info);
+            width = png_width;
+            height = png_height;
+            bytes_pp = png_get_channels(png, info);
+            return true;
+        }
+
+        bool DecodeRows(unsigned char* buffer, int rows)
+        {
+            if (setjmp(png_jmpbuf(png)))
+                return false;
+            for (int i = 0; i < rows; ++i) {
+                png_read_row(png, buffer + i * width * bytes_pp, 0);
+            }
+            return true;
+        }
+
+        static void Read(png_structp png, png_bytep out, png_size_t length)
+        {
+            PNGImpl* impl = static_cast<PNGImpl*>(png_get_io_ptr(png));
+            if (impl->size - impl->position < length)
+                png_error(png, "unexpected end of file");
+            std::memcpy(out, impl->data + impl->position, length);
+            impl->position += length;
+        }
+
+        static void Error(png_structp png, png_const_charp message)
+        {
+            PNGImpl* impl = static_cast<PNGImpl*>(png_get_error_ptr(png));
+            std::strncpy(impl->error, message, sizeof(impl->error) - 1);
+            impl->error[sizeof(impl->error) - 1] = '\0';
+            longjmp(png_jmpbuf(png), 1);
+        }
+
+        static void Warning(png_structp, png_const_charp)
+        {}
+
+        png_structp png;
+        png_infop   info;
+        std::size_t position;
+        char        error[256];
+    };
+#endif
+
+#if GG_HAVE_LIBJPEG
+    // As with libpng, libjpeg errors longjmp() out of the functions that
+    // call into libjpeg.
+    struct JPEGImpl : StreamingImageDecoder::Impl
+    {
+        struct ErrorManager
+        {
+            jpeg_error_mgr pub;
+            std::jmp_buf   jump;
+            char           message[JMSG_LENGTH_MAX];
+        };
+
+        JPEGImpl(const std::string& path_name) :
+            Impl(path_name),
+            started(false)
+        {
+            cinfo.err = jpeg_std_error(&error_manager.pub);
+            error_manager.pub.error_exit = &JPEGImpl::ErrorExit;
+            error_manager.pub.output_message = &JPEGImpl::OutputMessage;
+            error_manager.message[0] = '\0';
+            if (!ReadHeader()) {
+                jpeg_destroy_decompress(&cinfo);
+                Fail(error_manager.message);
+            }
+        }
+
+        virtual ~JPEGImpl()
+        {
+            if (started)
+                jpeg_abort_decompress(&cinfo);
+            jpeg_destroy_decompress(&cinfo);
+        }
+
+        virtual void ReadRows(unsigned char* buffer, int rows)
+        {
+            if (!DecodeRows(buffer, rows))
+                Fail(error_manager.message);
+        }
+
+        bool ReadHeader()
+        {
+            if (setjmp(error_manager.jump))
+                return false;
+            jpeg_create_decompress(&cinfo);
+
+            source.next_input_byte = data;
+            source.bytes_in_buffer = size;
+            source.init_source = &JPEGImpl::InitSource;
+            source.fill_input_buffer = &JPEGImpl::FillInputBuffer;
+            source.skip_input_data = &JPEGImpl::SkipInputData;
+            source.resync_to_restart = jpeg_resync_to_restart;
+            source.term_source = &JPEGImpl::TermSource;
+            cinfo.src = &source;
+
+            jpeg_read_header(&cinfo, TRUE);
+            if (cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK) {
+                supported = false;
+                return true;
+            }
+            cinfo.out_color_space = cinfo.jpeg_color_space == JCS_GRAYSCALE ? JCS_GRAYSCALE : JCS_RGB;
+            jpeg_start_decompress(&cinfo);
+            started = true;
+            width = cinfo.output_width;
+            height = cinfo.output_height;
+            bytes_pp = cinfo.output_components;
+            return true;
+        }
+
+        bool DecodeRows(unsigned char* buffer, int rows)
+        {
+            if (setjmp(error_manager.jump))
+                return false;
+            for (int i = 0; i < rows; ++i) {
+                JSAMPROW row = buffer + i * width * bytes_pp;
+                jpeg_read_scanlines(&cinfo, &row, 1);
+            }
+            return true;
+        }
+
+        static void ErrorExit(j_common_ptr cinfo)
+        {
+            ErrorManager* manager = reinterpret_cast<ErrorManager*>(cinfo->err);
+            (*cinfo->err->format_message)(cinfo, manager->message);
+            std::longjmp(manager->jump, 1);
+        }
+
+        static void OutputMessage(j_common_ptr)
+        {}
+
+        static void InitSource(j_decompress_ptr)
+        {}
+
+        static boolean FillInputBuffer(j_decompress_ptr cinfo)
+        {
+            // the whole file is already in the buffer, so running out of
+            // data means the file is truncated; end the image cleanly
+            static const JOCTET END_OF_IMAGE[2] = { 0xFF, JPEG_EOI };
+            cinfo->src->next_input_byte = END_OF_IMAGE;
+            cinfo->src->bytes_in_buffer = 2;
+            return TRUE;
+        }
+
+        static void SkipInputData(j_decompress_ptr cinfo, long bytes)
+        {
+            if (bytes <= 0)
+                return;
+            if (cinfo->src->bytes_in_buffer < static_cast<std::size_t>(bytes)) {
+                FillInputBuffer(cinfo);
+            } else {
+                cinfo->src->next_input_byte += bytes;
+                cinfo->src->bytes_in_buffer -= bytes;
+            }
+        }
+
+        static void TermSource(j_decompress_ptr)
+        {}
+
+        jpeg_decompress_struct cinfo;
+        ErrorManager           error_manager;
+        jpeg_source_mgr        source;
+        bool                   started;
+    };
+#endif
+
+    std::string Extension(const std::string& path_name)
+    {
+        std::string::size_type dot = path_name.find_last_of('.');
+        std::string retval = dot == std::string::npos ? "" : path_name.substr(dot);
+        for (std::size_t i = 0; i < retval.size(); ++i) {
+            retval[i] = std::tolower(retval[i]);
+        }
+        return retval;
+    }
+}
+
+
+///////////////////////////////////////
+// class GG::detail::StreamingImageDecoder
+///////////////////////////////////////
+StreamingImageDecoder::StreamingImageDecoder(const std::string& path_name)
+{
+    std::string extension = Extension(path_name);
+#if GG_HAVE_LIBPNG
+    if (extension == ".png")
+        m_impl.reset(new PNGImpl(path_name));
+#endif
+#if GG_HAVE_LIBJPEG
+    if (extension == ".jpg" || extension == ".jpe" || extension == ".jpeg")
+        m_impl.reset(new JPEGImpl(path_name));
+#endif
+    if (!m_impl)
+        throw Texture::BadFile("Image file \"" + path_name + "\" cannot be decoded incrementally");
+}
+
+StreamingImageDecoder::~StreamingImageDecoder()
+{}
+
+bool StreamingImageDecoder::Supported() const
+{ return m_impl->supported; }
+
+X StreamingImageDecoder::Width() const
+{ return X(m_impl->width); }
+
+Y StreamingImageDecoder::Height() const
+{ return Y(m_impl->height); }
+
+unsigned int StreamingImageDecoder::BytesPP() const
+{ return m_impl->bytes_pp; }
+
+GLenum StreamingImageDecoder::Format() const
+{
+    switch (m_impl->bytes_pp) {
+    case 1:  return GL_LUMINANCE;
+    case 2:  return GL_LUMINANCE_ALPHA;
+    case 3:  return GL_RGB;
+    default: return GL_RGBA;
+    }
+}
+
+void StreamingImageDecoder::ReadRows(unsigned char* buffer, Y rows)
+{ m_impl->ReadRows(buffer, Value(rows)); }
+
+bool StreamingImageDecoder::CanDecode(const std::string& extension)
+{
+#if GG_HAVE_LIBPNG
+    if (extension == ".png")
+        return true;
+#endif
+#if GG_HAVE_LIBJPEG
+    if (extension == ".jpg" || extension == ".jpe" || extension == ".jpeg")
+        return true;
+#endif
+    return false;
+}
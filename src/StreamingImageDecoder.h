@@ -0,0 +1,82 @@
+// -*- C++ -*-
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+
+   Zach Laine
+   whatwasthataddress@gmail.com
+*/
+
+#ifndef _StreamingImageDecoder_h_
+#define _StreamingImageDecoder_h_
+
+#include <GG/Base.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <string>
+
+
+namespace GG { namespace detail {
+
+    /** Decodes a PNG or JPEG file a few rows at a time, so that a texture
+        can be filled from a small staging buffer instead of a decoded copy
+        of the whole image.  The file is memory-mapped rather than read, so
+        the compressed data is not copied either.  Rows are produced top to
+        bottom, which is the order GG::Texture stores them in, so no flip is
+        needed.  This does not touch any OpenGL or GUI state. */
+    class StreamingImageDecoder : boost::noncopyable
+    {
+    public:
+        /** Maps the file \a path_name and reads its header.  \throw
+            GG::Texture::BadFile Throws if the file cannot be mapped, or is
+            corrupt. */
+        explicit StreamingImageDecoder(const std::string& path_name);
+        ~StreamingImageDecoder();
+
+        /** Returns true iff the file can be decoded row by row; interlaced
+            PNGs and CMYK JPEGs cannot, and must be decoded another way. */
+        bool         Supported() const;
+
+        X            Width() const;
+        Y            Height() const;
+        unsigned int BytesPP() const;
+        GLenum       Format() const;    ///< GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB or GL_RGBA
+
+        /** Decodes the next \a rows rows into \a buffer, which must have room
+            for \a rows * Width() * BytesPP() bytes.  \throw
+            GG::Texture::BadFile Throws if the file is corrupt. */
+        void         ReadRows(unsigned char* buffer, Y rows);
+
+        /** Returns true iff files with extension \a extension (lowercase,
+            including the leading '.') can be decoded by this class in this
+            build of GG. */
+        static bool  CanDecode(const std::string& extension);
+
+        struct Impl;
+
+    private:
+        boost::scoped_ptr<Impl> m_impl;
+    };
+
+} }
+
+#endif
@@ -55,19 +55,19 @@ using namespace GG;
 
 namespace {
 
-    boost::shared_ptr<Texture> CursorTexture()
-    { return GUI::GetGUI()->GetTexture(CursorsFilename()); }
+    SubTexture CursorTexture()
+    { return GUI::GetGUI()->GetSubTexture(CursorsFilename()); }
 
     boost::shared_ptr<Cursor> GetCursor(unsigned int row,
                                         unsigned int column,
                                         unsigned int hotspot_x,
                                         unsigned int hotspot_y)
     {
-        boost::shared_ptr<Texture> texture = CursorTexture();
+        SubTexture cursors = CursorTexture();
         const unsigned int cursor_size = 32u;
         return boost::shared_ptr<Cursor>(
             new TextureCursor(
-                SubTexture(texture,
+                SubTexture(cursors,
                            X(column * cursor_size),
                            Y(row * cursor_size),
                            X((column + 1) * cursor_size),
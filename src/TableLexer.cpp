@@ -0,0 +1,231 @@
+/* GG is a GUI for SDL and OpenGL.
+   Copyright (C) 2003-2008 T. Zachary Laine
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1
+   of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307 USA
+
+   If you do not wish to comply with the terms of the LGPL please
+   contact the author as other terms are available for a fee.
+
+   Zach Laine
+   whatwasthataddress@gmail.com */
+
+#include <GG/TableLexer.h>
+
+#include <cstring>
+
+
+using namespace GG;
+using namespace GG::detail;
+
+namespace {
+    // The number of hash seeds to try before doubling the size of a keyword
+    // hash table.
+    const boost::uint32_t KEYWORD_SEEDS = 64;
+
+    bool IsLetter(char c)
+    { return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z'); }
+
+    bool IsWord(const std::string& str)
+    {
+        if (str.empty() || !IsLetter(str[0]))
+            return false;
+        for (std::size_t i = 1; i < str.size(); ++i) {
+            if (!IsLetter(str[i]) && !('0' <= str[i] && str[i] <= '9') && str[i] != '_')
+                return false;
+        }
+        return true;
+    }
+
+    /** Splits \a pattern into the words it matches, if it is a keyword or
+        an alternation of keywords, like "true|false".  Returns false if it
+        is not. */
+    bool KeywordPatternWords(const std::string& pattern, std::vector<std::string>& words)
+    {
+        std::string::size_type position = 0;
+        while (true) {
+            std::string::size_type bar = pattern.find('|', position);
+            std::string word = pattern.substr(position, bar == std::string::npos ? bar : bar - position);
+            if (!IsWord(word))
+                return false;
+            words.push_back(word);
+            if (bar == std::string::npos)
+                return true;
+            position = bar + 1;
+        }
+    }
+}
+
+///////////////////////////////////////
+// class GG::detail::LexerTables
+///////////////////////////////////////
+LexerTables::Rule::Rule() :
+    m_id(boost::lexer::npos),
+    m_unique_id(boost::lexer::npos),
+    m_target(boost::lexer::npos)
+{}
+
+LexerTables::Rule::Rule(std::size_t id, std::size_t unique_id, std::size_t target) :
+    m_id(id),
+    m_unique_id(unique_id),
+    m_target(target)
+{}
+
+LexerTables::State::State() :
+    m_num_rules(0),
+    m_keyword_seed(0)
+{ std::memset(m_first_chars, 0, sizeof(m_first_chars)); }
+
+LexerTables::LexerTables()
+{ AddState("INITIAL"); }
+
+std::size_t LexerTables::NumStates() const
+{ return m_states.size(); }
+
+std::size_t LexerTables::StateID(const char* name) const
+{
+    for (std::size_t i = 0; i < m_states.size(); ++i) {
+        if (m_states[i].m_name == name)
+            return i;
+    }
+    return boost::lexer::npos;
+}
+
+const char* LexerTables::StateName(std::size_t state) const
+{ return m_states[state].m_name.c_str(); }
+
+std::size_t LexerTables::AddState(const char* name)
+{
+    std::size_t retval = StateID(name);
+    if (retval == boost::lexer::npos) {
+        retval = m_states.size();
+        m_states.push_back(State());
+        m_states.back().m_name = name;
+    }
+    return retval;
+}
+
+std::size_t LexerTables::AddToken(std::size_t state, char c, std::size_t id, std::size_t target)
+{
+    State& current = m_states[state];
+    Rule& rule = current.m_chars[static_cast<unsigned char>(c)];
+    // as with lexertl, the rule defined first wins
+    if (rule.m_id == boost::lexer::npos)
+        rule = Rule(id, current.m_num_rules, target);
+    return current.m_num_rules++;
+}
+
+std::size_t LexerTables::AddToken(std::size_t state, const std::string& pattern, std::size_t id, std::size_t target)
+{
+    State& current = m_states[state];
+    LexerTokenKind kind = LexerTokenKindOfID(id);
+    if (kind != LEXER_NONE) {
+        Rule& rule = current.m_kinds[kind];
+        if (rule.m_id == boost::lexer::npos)
+            rule = Rule(id, current.m_num_rules, target);
+    } else {
+        std::vector<std::string> words;
+        if (!KeywordPatternWords(pattern, words))
+            throw std::logic_error("GG::detail::table_lexer cannot match the token pattern \"" + pattern +
+                                   "\"; only keywords, and tokens with the id of a LexerTokenKind, can be matched");
+        for (std::size_t i = 0; i < words.size(); ++i) {
+            bool defined = false;
+            for (std::size_t j = 0; j < current.m_keywords.size() && !defined; ++j) {
+                defined = current.m_keywords[j].m_text == words[i];
+            }
+            if (defined)
+                continue;
+            current.m_keywords.push_back(Keyword());
+            current.m_keywords.back().m_text = words[i];
+            current.m_keywords.back().m_rule = Rule(id, current.m_num_rules, target);
+        }
+        BuildKeywordHash(current);
+    }
+    UpdateFirstChars(current);
+    return current.m_num_rules++;
+}
+
+void LexerTables::Clear(std::size_t state)
+{
+    std::string name = m_states[state].m_name;
+    m_states[state] = State();
+    m_states[state].m_name = name;
+}
+
+void LexerTables::UpdateFirstChars(State& state)
+{
+    for (unsigned int c = 0; c < 256; ++c) {
+        unsigned int kinds = 0;
+        for (int kind = 0; kind < NUM_LEXER_TOKEN_KINDS; ++kind) {
+            bool defined =
+                state.m_kinds[kind].m_id != boost::lexer::npos ||
+                (kind == LEXER_WORD && !state.m_keywords.empty());
+            if (defined && StartsKind(LexerTokenKind(kind), c))
+                kinds |= 1u << kind;
+        }
+        state.m_first_chars[c] = kinds;
+    }
+}
+
+void LexerTables::BuildKeywordHash(State& state)
+{
+    // Find a table size and seed for which no two keywords hash to the same
+    // slot, so that a lookup needs only one comparison.
+    std::size_t size = 1;
+    while (size < 2 * state.m_keywords.size()) {
+        size *= 2;
+    }
+    for (;; size *= 2) {
+        for (boost::uint32_t i = 0; i < KEYWORD_SEEDS; ++i) {
+            boost::uint32_t seed = 2166136261u + i * 2654435769u;
+            std::vector<std::size_t> slots(size, boost::lexer::npos);
+            bool perfect = true;
+            for (std::size_t j = 0; j < state.m_keywords.size() && perfect; ++j) {
+                const std::string& text = state.m_keywords[j].m_text;
+                boost::uint32_t hash = seed;
+                for (std::size_t k = 0; k < text.size(); ++k) {
+                    hash = Hash(hash, text[k]);
+                }
+                std::size_t& slot = slots[hash & (size - 1)];
+                perfect = slot == boost::lexer::npos;
+                slot = j;
+            }
+            if (perfect) {
+                state.m_keyword_slots.swap(slots);
+                state.m_keyword_seed = seed;
+                return;
+            }
+        }
+    }
+}
+
+bool LexerTables::StartsKind(LexerTokenKind kind, unsigned char c)
+{
+    switch (kind) {
+    case LEXER_WORD:          return IsLetter(c);
+    case LEXER_LEAD_COMMENT:  return c == '/';
+    case LEXER_TRAIL_COMMENT: return c == '/';
+    case LEXER_QUOTED_STRING: return c == '"' || c == '\'';
+    case LEXER_NUMBER:        return '0' <= c && c <= '9';
+    case LEXER_EQ_OP:         return c == '=' || c == '!';
+    case LEXER_REL_OP:        return c == '<' || c == '>';
+    case LEXER_MUL_OP:        return c == '*' || c == '/' || c == '%';
+    case LEXER_DEFINE:        return c == '<';
+    case LEXER_OR:            return c == '|';
+    case LEXER_AND:           return c == '&';
+    case LEXER_WHITESPACE:    return IsSpace(c);
+    default:                  return false;
+    }
+}
@@ -24,16 +24,19 @@
 
 #include <GG/Texture.h>
 
+#include <GG/ClrConstants.h>
 #include <GG/GUI.h>
 #include <GG/Config.h>
 #include <GG/DrawUtil.h>
 #include <GG/Filesystem.h>
 
+#include "CompressedImage.h"
+#include "StreamingImageDecoder.h"
+
 #if GG_USE_DEVIL_IMAGE_LOAD_LIBRARY
 # include <IL/il.h>
 # include <IL/ilu.h>
 #else
-# include <boost/filesystem/operations.hpp>
 # include "GIL/extension/dynamic_image/any_image.hpp"
 # if GG_HAVE_LIBJPEG
 #  include "GIL/extension/io/jpeg_dynamic_io.hpp"
@@ -44,12 +47,30 @@
 # if GG_HAVE_LIBTIFF
 #  include "GIL/extension/io/tiff_dynamic_io.hpp"
 # endif
-# include <boost/algorithm/string/case_conv.hpp>
 #endif
 
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <iostream>
 #include <iomanip>
 
+#if defined(_WIN32)
+# include <windows.h>
+#elif !(defined(__APPLE__) && defined(__MACH__))
+// declared here rather than through GL/glx.h, which drags in Xlib's macros
+extern "C" void (*glXGetProcAddressARB(const GLubyte* proc_name))();
+#endif
+
 
 using namespace GG;
 
@@ -65,6 +86,22 @@ namespace {
         return value;
     }
 
+    /** Returns true iff \a extension appears as a whole word in the
+        space-separated list \a extensions. */
+    bool ExtensionInList(const char* extensions, const char* extension)
+    {
+        if (!extensions)
+            return false;
+        const std::size_t length = std::strlen(extension);
+        for (const char* pos = std::strstr(extensions, extension); pos; pos = std::strstr(pos + length, extension)) {
+            bool starts_word = pos == extensions || pos[-1] == ' ';
+            bool ends_word = pos[length] == ' ' || pos[length] == '\0';
+            if (starts_word && ends_word)
+                return true;
+        }
+        return false;
+    }
+
 #if GG_USE_DEVIL_IMAGE_LOAD_LIBRARY
     void CheckILErrors(const std::string& function_call)
     {
@@ -112,7 +149,327 @@ namespace {
             g_il_initialized = true;
         }
     }
+#else
+    namespace gil = boost::gil;
+
+    typedef boost::mpl::vector4<
+        gil::gray8_image_t,
+        gil::gray_alpha8_image_t,
+        gil::rgb8_image_t,
+        gil::rgba8_image_t
+    > ImageTypes;
+    typedef gil::any_image<ImageTypes> ImageType;
+
+    void CheckImageFile(const boost::filesystem::path& path)
+    {
+        std::string path_name = PathToUTF8(path);
+        if (!boost::filesystem::exists(path))
+            throw Texture::BadFile("Texture file \"" + path_name + "\" does not exist");
+        if (!boost::filesystem::is_regular_file(path))
+            throw Texture::BadFile("Texture \"file\" \"" + path_name + "\" is not a file");
+    }
+
+    std::string ImageExtension(const boost::filesystem::path& path)
+    { return boost::algorithm::to_lower_copy(PathToUTF8(path.extension())); }
+
+    /** Reads only the header of the image file at \a path, and returns its
+        dimensions. */
+    Pt ReadImageDimensions(const boost::filesystem::path& path)
+    {
+        CheckImageFile(path);
+        std::string path_name = PathToUTF8(path);
+        std::string extension = ImageExtension(path);
+        gil::point2<std::ptrdiff_t> dimensions;
+#if GG_HAVE_LIBJPEG
+        if (extension == ".jpg" || extension == ".jpe" || extension == ".jpeg")
+            dimensions = gil::jpeg_read_dimensions(path_name);
+        else
+#endif
+#if GG_HAVE_LIBPNG
+        if (extension == ".png")
+            dimensions = gil::png_read_dimensions(path_name);
+        else
+#endif
+#if GG_HAVE_LIBTIFF
+        if (extension == ".tif" || extension == ".tiff")
+            dimensions = gil::tiff_read_dimensions(path_name);
+        else
+#endif
+            throw Texture::BadFile("Texture file \"" + path_name + "\" does not have a supported file extension");
+        return Pt(X(static_cast<int>(dimensions.x)), Y(static_cast<int>(dimensions.y)));
+    }
+
+    /** Reads the image file at \a path into \a image.  This does not touch
+        any OpenGL or GUI state, so it may be called from any thread. */
+    void ReadImage(const boost::filesystem::path& path, ImageType& image)
+    {
+        CheckImageFile(path);
+        std::string path_name = PathToUTF8(path);
+        std::string extension = ImageExtension(path);
+        try {
+            // First attempt -- try just to read the file in one of the default
+            // formats above.
+#if GG_HAVE_LIBJPEG
+            if (extension == ".jpg" || extension == ".jpe" || extension == ".jpeg")
+                gil::jpeg_read_image(path_name, image);
+            else
+#endif
+#if GG_HAVE_LIBPNG
+            if (extension == ".png")
+                gil::png_read_image(path_name, image);
+            else
+#endif
+#if GG_HAVE_LIBTIFF
+            if (extension == ".tif" || extension == ".tiff")
+                gil::tiff_read_image(path_name, image);
+            else
+#endif
+                throw Texture::BadFile("Texture file \"" + path_name + "\" does not have a supported file extension");
+        } catch (const std::ios_base::failure &) {
+            // Second attempt -- If *_read_image() throws, see if we can convert
+            // the image to RGBA.  This is needed for color-indexed images.
+#if GG_HAVE_LIBJPEG
+            if (extension == ".jpg" || extension == ".jpe" || extension == ".jpeg") {
+                gil::rgba8_image_t rgba_image;
+                gil::jpeg_read_and_convert_image(path_name, rgba_image);
+                image.move_in(rgba_image);
+            }
+#endif
+#if GG_HAVE_LIBPNG
+            if (extension == ".png") {
+                gil::rgba8_image_t rgba_image;
+                gil::png_read_and_convert_image(path_name, rgba_image);
+                image.move_in(rgba_image);
+            }
+#endif
+#if GG_HAVE_LIBTIFF
+            if (extension == ".tif" || extension == ".tiff") {
+                gil::rgba8_image_t rgba_image;
+                gil::tiff_read_and_convert_image(path_name, rgba_image);
+                image.move_in(rgba_image);
+            }
+#endif
+        }
+    }
+
+    /** Returns the pixels of \a image, and sets \a bytes_pp and \a format
+        to describe them. */
+    const unsigned char* ImageData(const ImageType& image, const std::string& path_name,
+                                   unsigned int& bytes_pp, GLenum& format)
+    {
+        BOOST_STATIC_ASSERT((sizeof(gil::gray8_pixel_t) == 1));
+        BOOST_STATIC_ASSERT((sizeof(gil::gray_alpha8_pixel_t) == 2));
+        BOOST_STATIC_ASSERT((sizeof(gil::rgb8_pixel_t) == 3));
+        BOOST_STATIC_ASSERT((sizeof(gil::rgba8_pixel_t) == 4));
+
+#define IF_IMAGE_TYPE_IS(image_prefix)                                  \
+        if (image.current_type_is<image_prefix ## _image_t>()) {        \
+            bytes_pp = sizeof(image_prefix ## _pixel_t);                \
+            image_data = interleaved_view_get_raw_data(                 \
+                const_view(image._dynamic_cast<image_prefix ## _image_t>())); \
+        }
+
+        const unsigned char* image_data = 0;
+
+        IF_IMAGE_TYPE_IS(gil::gray8)
+        else IF_IMAGE_TYPE_IS(gil::gray_alpha8)
+        else IF_IMAGE_TYPE_IS(gil::rgb8)
+        else IF_IMAGE_TYPE_IS(gil::rgba8)
+
+#undef IF_IMAGE_TYPE_IS
+
+        switch (bytes_pp) {
+        case 1:  format = GL_LUMINANCE; break;
+        case 2:  format = GL_LUMINANCE_ALPHA; break;
+        case 3:  format = GL_RGB; break;
+        case 4:  format = GL_RGBA; break;
+        default: throw Texture::BadFile("Texture file \"" + path_name + "\" does not have a supported number of color channels (1-4)");
+        }
+
+        assert(image_data);
+        return image_data;
+    }
+#endif
+
+    bool IsCompressedImageFile(const boost::filesystem::path& path)
+    { return detail::IsCompressedImageExtension(boost::algorithm::to_lower_copy(PathToUTF8(path.extension()))); }
+
+    /** Returns true iff the OpenGL major version is at least \a major, and
+        the minor version is at least \a minor if the major version is equal
+        to \a major. */
+    bool GLVersionAtLeast(int major, int minor)
+    {
+        const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+        if (!version)
+            return false;
+        int version_major = std::atoi(version);
+        const char* dot = std::strchr(version, '.');
+        int version_minor = dot ? std::atoi(dot + 1) : 0;
+        return major < version_major || (major == version_major && minor <= version_minor);
+    }
+
+    bool GLExtensionSupported(const char* extension)
+    { return ExtensionInList(reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS)), extension); }
+
+    /** Returns true iff the current OpenGL context can store textures in
+        \a internal_format directly. */
+    bool CompressedFormatSupported(GLenum internal_format)
+    {
+        switch (internal_format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            return GLExtensionSupported("GL_EXT_texture_compression_s3tc");
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+            return GLVersionAtLeast(4, 3) || GLExtensionSupported("GL_ARB_ES3_compatibility");
+        default:
+            return false;
+        }
+    }
+
+    /** Returns glCompressedTexImage2D, or null if the OpenGL implementation
+        does not provide it.  It is a GL 1.3 entry point, which opengl32.dll
+        on Windows does not export, so it is looked up at run time
+        everywhere but Mac OS X, where the OpenGL framework exports it. */
+    PFNGLCOMPRESSEDTEXIMAGE2DPROC CompressedTexImage2DFunction()
+    {
+        static bool detected = false;
+        static PFNGLCOMPRESSEDTEXIMAGE2DPROC function = 0;
+        if (!detected) {
+            if (!glGetString(GL_VERSION)) // there is no current OpenGL context to ask yet
+                return 0;
+#if defined(__APPLE__) && defined(__MACH__)
+            function = &glCompressedTexImage2D;
+#else
+            const char* const NAMES[] = { "glCompressedTexImage2D", "glCompressedTexImage2DARB" };
+            for (std::size_t i = 0; i < sizeof(NAMES) / sizeof(NAMES[0]) && !function; ++i) {
+# if defined(_WIN32)
+                function = reinterpret_cast<PFNGLCOMPRESSEDTEXIMAGE2DPROC>(wglGetProcAddress(NAMES[i]));
+# else
+                function = reinterpret_cast<PFNGLCOMPRESSEDTEXIMAGE2DPROC>(
+                    glXGetProcAddressARB(reinterpret_cast<const GLubyte*>(NAMES[i])));
+# endif
+            }
 #endif
+            detected = true;
+        }
+        return function;
+    }
+
+    /** Returns true iff the current OpenGL context can generate mipmaps
+        itself, through GL_GENERATE_MIPMAP. */
+    bool HardwareMipmapGeneration()
+    {
+        static bool detected = false;
+        static bool supported = false;
+        if (!detected) {
+            if (!glGetString(GL_VERSION)) // there is no current OpenGL context to ask yet
+                return false;
+            supported = GLVersionAtLeast(1, 4) || GLExtensionSupported("GL_SGIS_generate_mipmap");
+            detected = true;
+        }
+        return supported;
+    }
+
+    const int PARALLEL_DOWNSAMPLE_PIXELS = 512 * 512; // smaller levels are not worth starting threads for
+    const unsigned int MAX_DOWNSAMPLE_THREADS = 8;
+
+    struct MipmapLevel
+    {
+        X                          width;
+        Y                          height;
+        std::vector<unsigned char> data;
+    };
+
+    /** Box-filters rows [\a first_row, \a last_row) of the \a dst_width
+        wide level \a dst from the \a src_width x \a src_height level \a
+        src above it. */
+    void DownsampleRows(const unsigned char* src, int src_width, int src_height, unsigned char* dst, int dst_width,
+                        int first_row, int last_row, unsigned int bytes_pp)
+    {
+        const int x_step = 1 < src_width ? 2 : 1;
+        const int y_step = 1 < src_height ? 2 : 1;
+        const int src_row_bytes = src_width * bytes_pp;
+        for (int y = first_row; y < last_row; ++y) {
+            const unsigned char* row_0 = src + y * y_step * src_row_bytes;
+            const unsigned char* row_1 = row_0 + (y_step - 1) * src_row_bytes;
+            unsigned char* out = dst + y * dst_width * bytes_pp;
+            for (int x = 0; x < dst_width; ++x) {
+                const unsigned char* p_00 = row_0 + x * x_step * bytes_pp;
+                const unsigned char* p_01 = p_00 + (x_step - 1) * bytes_pp;
+                const unsigned char* p_10 = row_1 + x * x_step * bytes_pp;
+                const unsigned char* p_11 = p_10 + (x_step - 1) * bytes_pp;
+                for (unsigned int c = 0; c < bytes_pp; ++c) {
+                    *out++ = static_cast<unsigned char>((p_00[c] + p_01[c] + p_10[c] + p_11[c] + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    /** Fills \a levels with the mipmap levels below the \a width x \a
+        height, 8-bit-per-channel level-0 image \a image, by repeated 2x2
+        box filtering.  Large levels are split across several threads.  This
+        does not touch any OpenGL state, so it may be called from any
+        thread. */
+    void BuildMipmapLevels(const unsigned char* image, X width, Y height, unsigned int bytes_pp,
+                           std::vector<MipmapLevel>& levels)
+    {
+        int w = Value(width);
+        int h = Value(height);
+        std::size_t level_count = 0;
+        for (int size = std::max(w, h); 1 < size; size /= 2) {
+            ++level_count;
+        }
+        levels.clear();
+        levels.reserve(level_count); // src below must not be invalidated by reallocation
+
+        const unsigned char* src = image;
+        while (1 < w || 1 < h) {
+            int dst_w = std::max(1, w / 2);
+            int dst_h = std::max(1, h / 2);
+            levels.push_back(MipmapLevel());
+            MipmapLevel& level = levels.back();
+            level.width = X(dst_w);
+            level.height = Y(dst_h);
+            level.data.resize(dst_w * dst_h * bytes_pp);
+
+            unsigned int threads = 1;
+            if (PARALLEL_DOWNSAMPLE_PIXELS <= dst_w * dst_h)
+                threads = std::min(std::max(boost::thread::hardware_concurrency(), 1u), MAX_DOWNSAMPLE_THREADS);
+            if (threads == 1) {
+                DownsampleRows(src, w, h, &level.data[0], dst_w, 0, dst_h, bytes_pp);
+            } else {
+                boost::thread_group group;
+                for (unsigned int i = 0; i < threads; ++i) {
+                    group.create_thread(boost::bind(&DownsampleRows, src, w, h, &level.data[0], dst_w,
+                                                    dst_h * i / threads, dst_h * (i + 1) / threads, bytes_pp));
+                }
+                group.join_all();
+            }
+
+            src = &level.data[0];
+            w = dst_w;
+            h = dst_h;
+        }
+    }
+
+    const std::size_t DEFAULT_ASYNC_LOAD_THREADS = 2;
+    const unsigned int DEFAULT_UPLOAD_TIME_SLICE = 4000; // microseconds
+    const std::size_t UPLOAD_BYTES_PER_PIECE = 256 * 1024;
+    const Clr PLACEHOLDER_COLOR(127, 127, 127, 95);
+
+    const int ATLAS_PAGE_SIZE = 1024;
+    const int ATLAS_MAX_IMAGE_SIZE = 256; // larger images get their own textures
+    const int ATLAS_GUTTER = 1;           // pixels around each atlased image, which repeat its edge texels
+
+    boost::uint64_t Microseconds()
+    {
+        using namespace boost::posix_time;
+        static const ptime EPOCH(microsec_clock::universal_time());
+        return (microsec_clock::universal_time() - EPOCH).total_microseconds();
+    }
 }
 
 ///////////////////////////////////////
@@ -132,7 +489,8 @@ Texture::Texture() :
     m_type(GL_INVALID_ENUM),
     m_tex_coords(),
     m_default_width(0),
-    m_default_height(0)
+    m_default_height(0),
+    m_loading(false)
 { Clear(); }
 
 Texture::~Texture()
@@ -177,12 +535,19 @@ X Texture::DefaultWidth() const
 Y Texture::DefaultHeight() const
 { return m_default_height; }
 
+bool Texture::Loading() const
+{ return m_loading; }
+
 void Texture::OrthoBlit(const Pt& pt1, const Pt& pt2, const GLfloat* tex_coords/* = 0*/) const
 {
     if (m_opengl_id) {
         if (!tex_coords) // use default texture coords when not given any others
             tex_coords = m_tex_coords;
 
+        RenderStats& stats = FrameRenderStats();
+        ++stats.texture_binds;
+        ++stats.draw_calls;
+
         glBindTexture(GL_TEXTURE_2D, m_opengl_id);
 
         // HACK! This code ensures that unscaled textures are reproduced exactly, even
@@ -190,6 +555,7 @@ void Texture::OrthoBlit(const Pt& pt1, const Pt& pt2, const GLfloat* tex_coords/
         bool render_scaled = (pt2.x - pt1.x) != m_default_width || (pt2.y - pt1.y) != m_default_height;
         bool need_min_filter_change = !render_scaled && m_min_filter != GL_NEAREST;
         bool need_mag_filter_change = !render_scaled && m_mag_filter != GL_NEAREST;
+        stats.state_changes += 2 * (need_min_filter_change + need_mag_filter_change);
         if (need_min_filter_change)
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         if (need_mag_filter_change)
@@ -221,12 +587,18 @@ void Texture::Load(const std::string& filename, bool mipmap/* = false*/)
 {
     if (m_opengl_id)
         Clear();
+    m_loading = false;
 
     namespace fs = boost::filesystem;
 
     fs::path path(GUI::GetGUI()->FindResource(UTF8ToPath(filename)));
     std::string path_name = PathToUTF8(path);
 
+    if (IsCompressedImageFile(path)) {
+        LoadCompressed(path_name, mipmap);
+        return;
+    }
+
 #if GG_USE_DEVIL_IMAGE_LOAD_LIBRARY
 
     InitDevIL();
@@ -275,113 +647,119 @@ void Texture::Load(const std::string& filename, bool mipmap/* = false*/)
 
 #else
 
-    namespace gil = boost::gil;
-
-    BOOST_STATIC_ASSERT((sizeof(gil::gray8_pixel_t) == 1));
-    BOOST_STATIC_ASSERT((sizeof(gil::gray_alpha8_pixel_t) == 2));
-    BOOST_STATIC_ASSERT((sizeof(gil::rgb8_pixel_t) == 3));
-    BOOST_STATIC_ASSERT((sizeof(gil::rgba8_pixel_t) == 4));
-
-    typedef boost::mpl::vector4<
-        gil::gray8_image_t,
-        gil::gray_alpha8_image_t,
-        gil::rgb8_image_t,
-        gil::rgba8_image_t
-    > ImageTypes;
-    typedef gil::any_image<ImageTypes> ImageType;
+    if (detail::StreamingImageDecoder::CanDecode(ImageExtension(path)) && LoadStreaming(path_name, mipmap))
+        return;
 
-    if (!fs::exists(path))
-        throw BadFile("Texture file \"" + path_name + "\" does not exist");
+    ImageType image;
+    ReadImage(path, image);
 
-    if (!fs::is_regular_file(path))
-        throw BadFile("Texture \"file\" \"" + path_name + "\" is not a file");
+    m_filename = path_name;
+    m_default_width = X(image.width());
+    m_default_height = Y(image.height());
+    m_type = GL_UNSIGNED_BYTE;
 
-    std::string extension = boost::algorithm::to_lower_copy(PathToUTF8(path.extension()));
+    const unsigned char* image_data = ImageData(image, path_name, m_bytes_pp, m_format);
+    Init(m_default_width, m_default_height, image_data, m_format, m_type, m_bytes_pp, mipmap);
 
-    ImageType image;
-    try {
-        // First attempt -- try just to read the file in one of the default
-        // formats above.
-#if GG_HAVE_LIBJPEG
-        if (extension == ".jpg" || extension == ".jpe" || extension == ".jpeg")
-            gil::jpeg_read_image(path_name, image);
-        else
-#endif
-#if GG_HAVE_LIBPNG
-        if (extension == ".png")
-            gil::png_read_image(path_name, image);
-        else
-#endif
-#if GG_HAVE_LIBTIFF
-        if (extension == ".tif" || extension == ".tiff")
-            gil::tiff_read_image(path_name, image);
-        else
-#endif
-            throw BadFile("Texture file \"" + path_name + "\" does not have a supported file extension");
-    } catch (const std::ios_base::failure &) {
-        // Second attempt -- If *_read_image() throws, see if we can convert
-        // the image to RGBA.  This is needed for color-indexed images.
-#if GG_HAVE_LIBJPEG
-        if (extension == ".jpg" || extension == ".jpe" || extension == ".jpeg") {
-            gil::rgba8_image_t rgba_image;
-            gil::jpeg_read_and_convert_image(path_name, rgba_image);
-            image.move_in(rgba_image);
-        }
-#endif
-#if GG_HAVE_LIBPNG
-        if (extension == ".png") {
-            gil::rgba8_image_t rgba_image;
-            gil::png_read_and_convert_image(path_name, rgba_image);
-            image.move_in(rgba_image);
-        }
 #endif
-#if GG_HAVE_LIBTIFF
-        if (extension == ".tif" || extension == ".tiff") {
-            gil::rgba8_image_t rgba_image;
-            gil::tiff_read_and_convert_image(path_name, rgba_image);
-            image.move_in(rgba_image);
+}
+
+void Texture::LoadCompressed(const std::string& path_name, bool mipmap)
+{
+    detail::CompressedImage image;
+    detail::ReadCompressedImage(path_name, image);
+    const detail::CompressedImage::Level& base_level = image.levels.front();
+    const bool power_of_two = PowerOfTwo(base_level.width) == base_level.width &&
+        PowerOfTwo(base_level.height) == base_level.height;
+
+    PFNGLCOMPRESSEDTEXIMAGE2DPROC compressed_tex_image_2d = CompressedTexImage2DFunction();
+    if (!compressed_tex_image_2d || !CompressedFormatSupported(image.internal_format) ||
+        (!power_of_two && !NonPowerOfTwoSupported())) {
+        // decode in software; mipmaps are generated if the file has none
+        const bool use_file_mipmaps = mipmap && 1 < image.levels.size() && (power_of_two || NonPowerOfTwoSupported());
+        std::vector<unsigned char> rgba;
+        detail::DecompressImageLevel(image, 0, rgba);
+        Init(base_level.width, base_level.height, &rgba[0], GL_RGBA, GL_UNSIGNED_BYTE, 4, mipmap && !use_file_mipmaps);
+        if (use_file_mipmaps) {
+            glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glBindTexture(GL_TEXTURE_2D, m_opengl_id);
+            for (std::size_t i = 1; i < image.levels.size(); ++i) {
+                detail::DecompressImageLevel(image, i, rgba);
+                glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, Value(image.levels[i].width), Value(image.levels[i].height), 0,
+                             GL_RGBA, GL_UNSIGNED_BYTE, &rgba[0]);
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levels.size() - 1);
+            glPopClientAttrib();
+            m_mipmaps = true;
         }
-#endif
+        m_filename = path_name;
+        return;
     }
 
-    m_filename = path_name;
-    m_default_width = X(image.width());
-    m_default_height = Y(image.height());
-    m_type = GL_UNSIGNED_BYTE;
+    glGenTextures(1, &m_opengl_id);
+    glBindTexture(GL_TEXTURE_2D, m_opengl_id);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_min_filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_mag_filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_wrap_s);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_wrap_t);
 
-#define IF_IMAGE_TYPE_IS(image_prefix)                                  \
-    if (image.current_type_is<image_prefix ## _image_t>()) {            \
-        m_bytes_pp = sizeof(image_prefix ## _pixel_t);                  \
-        image_data = interleaved_view_get_raw_data(                     \
-            const_view(image._dynamic_cast<image_prefix ## _image_t>())); \
+    // mipmaps cannot be generated from compressed data, so only the levels
+    // in the file are used
+    const std::size_t levels = mipmap ? image.levels.size() : 1;
+    for (std::size_t i = 0; i < levels; ++i) {
+        const detail::CompressedImage::Level& level = image.levels[i];
+        compressed_tex_image_2d(GL_TEXTURE_2D, i, image.internal_format, Value(level.width), Value(level.height), 0,
+                                level.size, &image.data[level.offset]);
     }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
 
-    const unsigned char* image_data = 0;
+    m_filename = path_name;
+    m_mipmaps = 1 < levels;
+    m_default_width = m_width = base_level.width;
+    m_default_height = m_height = base_level.height;
+    // GetRawBytes() reads compressed textures back decompressed
+    m_bytes_pp = 4;
+    m_format = GL_RGBA;
+    m_type = GL_UNSIGNED_BYTE;
+    m_tex_coords[2] = m_tex_coords[3] = 1.0f;
+}
 
-    IF_IMAGE_TYPE_IS(gil::gray8)
-    else IF_IMAGE_TYPE_IS(gil::gray_alpha8)
-    else IF_IMAGE_TYPE_IS(gil::rgb8)
-    else IF_IMAGE_TYPE_IS(gil::rgba8)
+bool Texture::LoadStreaming(const std::string& path_name, bool mipmap)
+{
+    detail::StreamingImageDecoder decoder(path_name);
+    if (!decoder.Supported())
+        return false;
 
-#undef IF_IMAGE_TYPE_IS
+    const X width = decoder.Width();
+    const Y height = decoder.Height();
+    const int row_bytes = std::max(1, Value(width) * static_cast<int>(decoder.BytesPP()));
+    const Y rows_per_piece = std::min(Y(std::max(1, static_cast<int>(UPLOAD_BYTES_PER_PIECE) / row_bytes)), height);
+    std::vector<unsigned char> staging(Value(rows_per_piece) * row_bytes);
 
-    switch (m_bytes_pp) {
-    case 1:  m_format = GL_LUMINANCE; break;
-    case 2:  m_format = GL_LUMINANCE_ALPHA; break;
-    case 3:  m_format = GL_RGB; break;
-    case 4:  m_format = GL_RGBA; break;
-    default: throw BadFile("Texture file \"" + path_name + "\" does not have a supported number of color channels (1-4)");
+    try {
+        InitStorage(width, height, 0, decoder.Format(), GL_UNSIGNED_BYTE, decoder.BytesPP(), mipmap);
+        for (Y row = Y0; row < height; row += rows_per_piece) {
+            Y rows = std::min(rows_per_piece, height - row);
+            decoder.ReadRows(&staging[0], rows);
+            UploadRows(&staging[0], row, rows);
+        }
+        FinishInit(0);
+    } catch (...) {
+        Clear();
+        throw;
     }
 
-    assert(image_data);
-    Init(m_default_width, m_default_height, image_data, m_format, m_type, m_bytes_pp, mipmap);
-
-#endif
+    m_filename = path_name;
+    return true;
 }
 
 void Texture::Init(X x, Y y, X width, Y height, X image_width, const unsigned char* image,
                    GLenum format, GLenum type, unsigned int bytes_per_pixel, bool mipmap/* = false*/)
 {
+    m_loading = false;
     glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
     glPixelStorei(GL_UNPACK_SWAP_BYTES, false);
     glPixelStorei(GL_UNPACK_LSB_FIRST, false);
@@ -391,7 +769,10 @@ void Texture::Init(X x, Y y, X width, Y height, X image_width, const unsigned ch
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
     try {
-        InitFromRawData(width, height, image, format, type, bytes_per_pixel, mipmap);
+        if (image) {
+            InitStorage(width, height, image, format, type, bytes_per_pixel, mipmap);
+            FinishInit(image);
+        }
     } catch (...) {
         glPopClientAttrib();
         throw;
@@ -403,6 +784,7 @@ void Texture::Init(X x, Y y, X width, Y height, X image_width, const unsigned ch
 void Texture::Init(X width, Y height, const unsigned char* image, GLenum format, GLenum type,
                    unsigned int bytes_per_pixel, bool mipmap/* = false*/)
 {
+    m_loading = false;
     glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
     glPixelStorei(GL_UNPACK_SWAP_BYTES, false);
     glPixelStorei(GL_UNPACK_LSB_FIRST, false);
@@ -412,7 +794,10 @@ void Texture::Init(X width, Y height, const unsigned char* image, GLenum format,
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
     try {
-        InitFromRawData(width, height, image, format, type, bytes_per_pixel, mipmap);
+        if (image) {
+            InitStorage(width, height, image, format, type, bytes_per_pixel, mipmap);
+            FinishInit(image);
+        }
     } catch (...) {
         glPopClientAttrib();
         throw;
@@ -465,19 +850,19 @@ void Texture::Clear()
 
     m_tex_coords[0] = m_tex_coords[1] = 0.0f;   // min x, y
     m_tex_coords[2] = m_tex_coords[3] = 1.0f;   // max x, y
+
+    m_loading = false; // this also abandons any asynchronous load in progress
 }
 
-void Texture::InitFromRawData(X width, Y height, const unsigned char* image, GLenum format, GLenum type,
-                              unsigned int bytes_per_pixel, bool mipmap)
+void Texture::InitStorage(X width, Y height, const unsigned char* image, GLenum format, GLenum type,
+                          unsigned int bytes_per_pixel, bool mipmap)
 {
-    if (!image)
-        return;
-
     if (m_opengl_id)
         Clear();
 
-    X GL_texture_width = PowerOfTwo(width);
-    Y GL_texture_height = PowerOfTwo(height);
+    const bool exact_size = NonPowerOfTwoSupported();
+    X GL_texture_width = exact_size ? width : PowerOfTwo(width);
+    Y GL_texture_height = exact_size ? height : PowerOfTwo(height);
 
     glGenTextures(1, &m_opengl_id);
     glBindTexture(GL_TEXTURE_2D, m_opengl_id);
@@ -486,25 +871,32 @@ void Texture::InitFromRawData(X width, Y height, const unsigned char* image, GLe
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_mag_filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_wrap_s);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_wrap_t);
+    // set before level 0 is uploaded, so GL builds the mipmaps from the
+    // uploads themselves and FinishInit() has nothing to read back
+    if (mipmap && HardwareMipmapGeneration())
+        glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
 
-    glTexImage2D(GL_PROXY_TEXTURE_2D, 0, format, Value(GL_texture_width), Value(GL_texture_height), 0, format, type, image);
+    glTexImage2D(GL_PROXY_TEXTURE_2D, 0, format, Value(GL_texture_width), Value(GL_texture_height), 0, format, type, 0);
     GLint checked_format;
     glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &checked_format);
     if (!checked_format)
         throw InsufficientResources("Insufficient resources to create requested OpenGL texture");
-    bool image_is_power_of_two = width == GL_texture_width && height == GL_texture_height;
-    if (image_is_power_of_two) {
+    bool image_fills_texture = width == GL_texture_width && height == GL_texture_height;
+    if (image_fills_texture) {
         glTexImage2D(GL_TEXTURE_2D, 0, format, Value(width), Value(height), 0, format, type, image);
     } else {
         std::vector<unsigned char> zero_data(bytes_per_pixel * Value(GL_texture_width) * Value(GL_texture_height));
         glTexImage2D(GL_TEXTURE_2D, 0, format, Value(GL_texture_width), Value(GL_texture_height), 0, format, type, &zero_data[0]);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Value(width), Value(height), format, type, image);
+        if (image)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Value(width), Value(height), format, type, image);
     }
 
     m_mipmaps = mipmap;
     m_default_width = width;
     m_default_height = height;
     m_bytes_pp = bytes_per_pixel;
+    m_format = format;
+    m_type = type;
     {
         GLint w, h;
         glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
@@ -514,25 +906,100 @@ void Texture::InitFromRawData(X width, Y height, const unsigned char* image, GLe
     }
     m_tex_coords[2] = Value(1.0 * m_default_width / m_width);
     m_tex_coords[3] = Value(1.0 * m_default_height / m_height);
+}
 
-    if (mipmap) {
-        boost::scoped_array<unsigned char> image_copy;
-        if (!image_is_power_of_two)
-            image_copy.reset(GetRawBytes());
-        unsigned char* image_to_use = image_copy ? image_copy.get() : const_cast<unsigned char*>(image);
-        gluBuild2DMipmaps(GL_PROXY_TEXTURE_2D, format, Value(GL_texture_width), Value(GL_texture_height), format, type, image_to_use);
-        GLint checked_format;
-        glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &checked_format);
-        if (!checked_format)
-            throw InsufficientResources("Insufficient resources to create requested mipmapped OpenGL texture");
-        gluBuild2DMipmaps(GL_TEXTURE_2D, format, Value(GL_texture_width), Value(GL_texture_height), format, type, image_to_use);
-    } else {
+void Texture::UploadRows(const unsigned char* rows_data, Y first_row, Y rows)
+{
+    glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+    glPixelStorei(GL_UNPACK_SWAP_BYTES, false);
+    glPixelStorei(GL_UNPACK_LSB_FIRST, false);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glBindTexture(GL_TEXTURE_2D, m_opengl_id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, Value(first_row), Value(m_default_width), Value(rows), m_format, m_type, rows_data);
+
+    glPopClientAttrib();
+}
+
+void Texture::FinishInit(const unsigned char* image)
+{
+    glBindTexture(GL_TEXTURE_2D, m_opengl_id);
+    if (!m_mipmaps) {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        return;
+    }
+
+    if (HardwareMipmapGeneration()) {
+        // InitStorage() turned GL_GENERATE_MIPMAP on before uploading, so
+        // the mipmaps are already complete
+        glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_FALSE);
+        return;
+    }
+
+    // the mipmaps are built from the whole texture, including any padding
+    bool image_fills_texture = m_width == m_default_width && m_height == m_default_height;
+    boost::scoped_array<unsigned char> image_copy;
+    if (!image_fills_texture || !image)
+        image_copy.reset(GetRawBytes());
+    const unsigned char* level_0 = image_copy ? image_copy.get() : image;
+
+    glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+    glPixelStorei(GL_UNPACK_SWAP_BYTES, false);
+    glPixelStorei(GL_UNPACK_LSB_FIRST, false);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (m_type == GL_UNSIGNED_BYTE) {
+        std::vector<MipmapLevel> levels;
+        BuildMipmapLevels(level_0, m_width, m_height, m_bytes_pp, levels);
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            glTexImage2D(GL_TEXTURE_2D, i + 1, m_format, Value(levels[i].width), Value(levels[i].height), 0,
+                         m_format, m_type, &levels[i].data[0]);
+        }
+    } else {
+        gluBuild2DMipmaps(GL_TEXTURE_2D, m_format, Value(m_width), Value(m_height), m_format, m_type, level_0);
+    }
+
+    glPopClientAttrib();
+}
+
+void Texture::UploadMipmapLevel(unsigned int level, X width, Y height, const unsigned char* data)
+{
+    glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+    glPixelStorei(GL_UNPACK_SWAP_BYTES, false);
+    glPixelStorei(GL_UNPACK_LSB_FIRST, false);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glBindTexture(GL_TEXTURE_2D, m_opengl_id);
+    glTexImage2D(GL_TEXTURE_2D, level, m_format, Value(width), Value(height), 0, m_format, m_type, data);
+
+    glPopClientAttrib();
+}
+
+bool Texture::NonPowerOfTwoSupported()
+{
+    static bool detected = false;
+    static bool supported = false;
+    if (!detected) {
+        const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+        if (!version) // there is no current OpenGL context to ask yet
+            return false;
+        supported = GLVersionAtLeast(2, 0) || GLExtensionSupported("GL_ARB_texture_non_power_of_two");
+        detected = true;
     }
+    return supported;
 }
 
-unsigned char* Texture::GetRawBytes()
+unsigned char* Texture::GetRawBytes() const
 {
     unsigned char* retval = 0;
     glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
@@ -594,6 +1061,26 @@ SubTexture::SubTexture(const boost::shared_ptr<const Texture>& texture, X x1, Y
     }
 }
 
+SubTexture::SubTexture(const SubTexture& subtexture, X x1, Y y1, X x2, Y y2) :
+    m_texture(subtexture.m_texture),
+    m_width(x2 - x1),
+    m_height(y2 - y1),
+    m_tex_coords()
+{
+    if (x2 < x1 || y2 < y1 || x1 < X0 || y1 < Y0 || subtexture.m_width < x2 || subtexture.m_height < y2)
+        throw InvalidTextureCoordinates("Attempted to contruct subtexture from invalid coordinates");
+
+    if (m_texture) {
+        const GLfloat* tex_coords = subtexture.m_tex_coords;
+        double x_scale = subtexture.m_width ? (tex_coords[2] - tex_coords[0]) / Value(subtexture.m_width) : 0.0;
+        double y_scale = subtexture.m_height ? (tex_coords[3] - tex_coords[1]) / Value(subtexture.m_height) : 0.0;
+        m_tex_coords[0] = static_cast<GLfloat>(tex_coords[0] + Value(x1) * x_scale);
+        m_tex_coords[1] = static_cast<GLfloat>(tex_coords[1] + Value(y1) * y_scale);
+        m_tex_coords[2] = static_cast<GLfloat>(tex_coords[0] + Value(x2) * x_scale);
+        m_tex_coords[3] = static_cast<GLfloat>(tex_coords[1] + Value(y2) * y_scale);
+    }
+}
+
 SubTexture::~SubTexture()
 {}
 
@@ -654,12 +1141,231 @@ bool SubTexture::operator!=(const SubTexture& rhs) const
 ///////////////////////////////////////
 // class GG::TextureManager
 ///////////////////////////////////////
+/** The state shared between the GUI thread and the threads that decode
+    images requested via GetTextureAsync().  The worker threads only touch
+    the Jobs in m_to_decode and m_decoded; the Textures themselves are only
+    touched by the GUI thread. */
+struct TextureManager::AsyncLoader
+{
+    struct Job
+    {
+        Job() :
+            mipmap(false),
+            build_mipmaps(false),
+            width(X0),
+            height(Y0),
+            data(0),
+            bytes_pp(0),
+            format(GL_INVALID_ENUM),
+            storage_created(false),
+            rows_uploaded(0),
+            levels_uploaded(0)
+        {}
+
+        boost::shared_ptr<Texture> texture;
+        boost::filesystem::path    path;
+        bool                       mipmap;
+        bool                       build_mipmaps; ///< true iff the worker thread should build the mipmap levels
+        X                          width;         ///< the image's dimensions, copied so the worker thread need not touch the Texture
+        Y                          height;
+#if !GG_USE_DEVIL_IMAGE_LOAD_LIBRARY
+        ImageType                  image;
+#endif
+        const unsigned char*       data;
+        unsigned int               bytes_pp;
+        GLenum                     format;
+        std::vector<MipmapLevel>   mipmap_levels;
+        std::string                error;
+
+        bool                       storage_created;
+        Y                          rows_uploaded;
+        std::size_t                levels_uploaded;
+    };
+
+    explicit AsyncLoader(std::size_t threads);
+    ~AsyncLoader();
+
+    void Enqueue(const boost::shared_ptr<Job>& job);
+    void WorkerLoop();
+
+    mutable boost::mutex                m_mutex;
+    boost::condition_variable           m_condition;
+    bool                                m_stop;
+    std::deque<boost::shared_ptr<Job> > m_to_decode;  ///< guarded by m_mutex
+    std::deque<boost::shared_ptr<Job> > m_decoded;    ///< guarded by m_mutex
+    std::deque<boost::shared_ptr<Job> > m_uploading;  ///< only used by the GUI thread
+    boost::thread_group                 m_threads;
+};
+
+TextureManager::AsyncLoader::AsyncLoader(std::size_t threads) :
+    m_stop(false)
+{
+    for (std::size_t i = 0; i < threads; ++i) {
+        m_threads.create_thread(boost::bind(&AsyncLoader::WorkerLoop, this));
+    }
+}
+
+TextureManager::AsyncLoader::~AsyncLoader()
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_threads.join_all();
+}
+
+void TextureManager::AsyncLoader::Enqueue(const boost::shared_ptr<Job>& job)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_to_decode.push_back(job);
+    }
+    m_condition.notify_one();
+}
+
+void TextureManager::AsyncLoader::WorkerLoop()
+{
+    while (true) {
+        boost::shared_ptr<Job> job;
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            while (!m_stop && m_to_decode.empty()) {
+                m_condition.wait(lock);
+            }
+            if (m_stop)
+                return;
+            job = m_to_decode.front();
+            m_to_decode.pop_front();
+        }
+
+#if !GG_USE_DEVIL_IMAGE_LOAD_LIBRARY
+        try {
+            ReadImage(job->path, job->image);
+            job->data = ImageData(job->image, PathToUTF8(job->path), job->bytes_pp, job->format);
+            if (job->build_mipmaps) {
+                BuildMipmapLevels(job->data, job->width, job->height, job->bytes_pp, job->mipmap_levels);
+            }
+        } catch (const std::exception& e) {
+            job->error = e.what();
+        } catch (...) {
+            job->error = "unknown error";
+        }
+#endif
+
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_decoded.push_back(job);
+    }
+}
+
+/** A shared texture into which small images are packed.  Images are placed
+    on horizontal shelves, each as tall as the first image placed on it; a
+    new shelf is opened below the last one when no existing shelf has room. */
+struct TextureManager::AtlasPage
+{
+    struct Shelf
+    {
+        Shelf(Y y_, Y height_) : y(y_), height(height_), used(X0) {}
+        Y y;
+        Y height;
+        X used;
+    };
+
+    /** Creates an empty page, using \a filter for both minification and
+        magnification. */
+    explicit AtlasPage(GLenum filter);
+
+    /** Finds room for a \a width x \a height image and the ATLAS_GUTTER
+        pixels around it, and returns the image's upper left corner in \a
+        position.  Returns false if the page is full. */
+    bool Allocate(X width, Y height, Pt& position);
+
+    boost::shared_ptr<Texture> texture;
+    std::vector<Shelf>         shelves;
+    Y                          used_height;
+};
+
+TextureManager::AtlasPage::AtlasPage(GLenum filter) :
+    texture(new Texture()),
+    used_height(Y0)
+{
+    std::vector<unsigned char> zero_data(4 * ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE);
+    texture->SetFilters(filter, filter);
+    texture->SetWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+    texture->Init(X(ATLAS_PAGE_SIZE), Y(ATLAS_PAGE_SIZE), &zero_data[0], GL_RGBA, GL_UNSIGNED_BYTE, 4);
+}
+
+bool TextureManager::AtlasPage::Allocate(X width, Y height, Pt& position)
+{
+    const X padded_width = width + 2 * ATLAS_GUTTER;
+    const Y padded_height = height + 2 * ATLAS_GUTTER;
+
+    // use the shortest shelf that is tall enough and has room
+    Shelf* best = 0;
+    for (std::size_t i = 0; i < shelves.size(); ++i) {
+        Shelf& shelf = shelves[i];
+        if (padded_height <= shelf.height && shelf.used + padded_width <= ATLAS_PAGE_SIZE &&
+            (!best || shelf.height < best->height)) {
+            best = &shelf;
+        }
+    }
+
+    if (!best) {
+        if (ATLAS_PAGE_SIZE < used_height + padded_height || ATLAS_PAGE_SIZE < padded_width)
+            return false;
+        shelves.push_back(Shelf(used_height, padded_height));
+        used_height += padded_height;
+        best = &shelves.back();
+    }
+
+    position = Pt(best->used + ATLAS_GUTTER, best->y + ATLAS_GUTTER);
+    best->used += padded_width;
+    return true;
+}
+
+
 // static member(s)
 bool TextureManager::s_il_initialized = false;
 
-TextureManager::TextureManager()
+TextureManager::TextureManager() :
+    m_async_load_threads(DEFAULT_ASYNC_LOAD_THREADS),
+    m_upload_time_slice(DEFAULT_UPLOAD_TIME_SLICE),
+    m_atlas_enabled(true)
+{}
+
+TextureManager::~TextureManager()
 {}
 
+std::size_t TextureManager::PendingTextures() const
+{
+    if (!m_async_loader)
+        return 0;
+    boost::mutex::scoped_lock lock(m_async_loader->m_mutex);
+    return m_async_loader->m_to_decode.size() + m_async_loader->m_decoded.size() + m_async_loader->m_uploading.size();
+}
+
+unsigned int TextureManager::UploadTimeSlice() const
+{ return m_upload_time_slice; }
+
+const SubTexture& TextureManager::Placeholder() const
+{ return m_placeholder; }
+
+bool TextureManager::AtlasEnabled() const
+{ return m_atlas_enabled; }
+
+std::size_t TextureManager::AtlasPages() const
+{ return m_atlas_pages.size() + m_animation_atlas_pages.size(); }
+
+void TextureManager::RenderPlaceholder(const Pt& pt1, const Pt& pt2) const
+{
+    if (m_placeholder.Empty()) {
+        FlatRectangle(pt1, pt2, PLACEHOLDER_COLOR, CLR_ZERO, 0);
+    } else {
+        glColor(CLR_WHITE);
+        m_placeholder.OrthoBlit(pt1, pt2);
+    }
+}
+
 boost::shared_ptr<Texture> TextureManager::StoreTexture(Texture* texture, const std::string& texture_name)
 {
     boost::shared_ptr<Texture> temp(texture);
@@ -679,11 +1385,226 @@ boost::shared_ptr<Texture> TextureManager::GetTexture(const std::string& name, b
     }
 }
 
+boost::shared_ptr<Texture> TextureManager::GetTextureAsync(const std::string& name, bool mipmap/* = false*/)
+{
+#if GG_USE_DEVIL_IMAGE_LOAD_LIBRARY
+    // DevIL keeps global state, so images cannot be decoded off the GUI
+    // thread
+    return GetTexture(name, mipmap);
+#else
+    std::map<std::string, boost::shared_ptr<Texture> >::iterator it = m_textures.find(name);
+    if (it != m_textures.end())
+        return it->second;
+
+    boost::shared_ptr<AsyncLoader::Job> job(new AsyncLoader::Job);
+    job->path = GUI::GetGUI()->FindResource(UTF8ToPath(name));
+    job->mipmap = mipmap;
+
+    // compressed images need no decoding, and are cheap to load directly
+    if (IsCompressedImageFile(job->path))
+        return GetTexture(name, mipmap);
+
+    Pt dimensions = ReadImageDimensions(job->path);
+    job->texture.reset(new Texture());
+    job->texture->m_filename = PathToUTF8(job->path);
+    job->width = dimensions.x;
+    job->height = dimensions.y;
+    job->texture->m_default_width = job->width;
+    job->texture->m_default_height = job->height;
+    job->texture->m_loading = true;
+
+    // the mipmaps are built on the worker thread too, unless GL can build
+    // them, or the texture will be padded and they must include the padding
+    bool exact_size = Texture::NonPowerOfTwoSupported() ||
+        (PowerOfTwo(dimensions.x) == dimensions.x && PowerOfTwo(dimensions.y) == dimensions.y);
+    job->build_mipmaps = mipmap && exact_size && !HardwareMipmapGeneration();
+
+    if (!m_async_loader)
+        m_async_loader.reset(new AsyncLoader(std::max(m_async_load_threads, std::size_t(1))));
+    m_async_loader->Enqueue(job);
+
+    return (m_textures[name] = job->texture);
+#endif
+}
+
+SubTexture TextureManager::GetSubTexture(const std::string& name)
+{
+    std::map<std::string, SubTexture>::iterator it = m_atlas_images.find(name);
+    if (it != m_atlas_images.end())
+        return it->second;
+
+#if !GG_USE_DEVIL_IMAGE_LOAD_LIBRARY
+    // an image that is already resident as its own texture is not loaded again
+    boost::filesystem::path path = GUI::GetGUI()->FindResource(UTF8ToPath(name));
+    if (m_atlas_enabled && m_textures.find(name) == m_textures.end() && !IsCompressedImageFile(path)) {
+        Pt dimensions = ReadImageDimensions(path);
+        if (dimensions.x <= ATLAS_MAX_IMAGE_SIZE && dimensions.y <= ATLAS_MAX_IMAGE_SIZE) {
+            ImageType image;
+            ReadImage(path, image);
+            unsigned int bytes_pp = 0;
+            GLenum format = GL_INVALID_ENUM;
+            const unsigned char* image_data = ImageData(image, PathToUTF8(path), bytes_pp, format);
+            return (m_atlas_images[name] = AtlasImage(m_atlas_pages, GL_NEAREST, X(image.width()), Y(image.height()),
+                                                      image_data, format, bytes_pp));
+        }
+    }
+#endif
+
+    return SubTexture(GetTexture(name));
+}
+
+std::vector<SubTexture> TextureManager::GetAnimationFrames(const boost::shared_ptr<const Texture>& texture,
+                                                           X frame_width, Y frame_height, unsigned int margin,
+                                                           std::size_t frames)
+{
+    std::vector<SubTexture> retval;
+    if (!texture || texture->Loading() || !texture->OpenGLId())
+        return retval;
+
+    // forget the frames of sprite sheets that no longer exist, so a new
+    // Texture at the same address is not mistaken for an old one
+    for (std::size_t i = 0; i < m_animation_frames.size(); ) {
+        if (m_animation_frames[i].texture.expired()) {
+            m_animation_frames.erase(m_animation_frames.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+    for (std::size_t i = 0; i < m_animation_frames.size(); ++i) {
+        const AnimationFrames& cached = m_animation_frames[i];
+        if (cached.texture.lock() == texture && cached.frame_width == frame_width &&
+            cached.frame_height == frame_height && cached.margin == margin && frames <= cached.frames.size()) {
+            return std::vector<SubTexture>(cached.frames.begin(), cached.frames.begin() + frames);
+        }
+    }
+
+    const int INT_MARGIN = margin;
+    const std::size_t cols = std::max(1, Value(texture->DefaultWidth() / (frame_width + INT_MARGIN)));
+    const bool use_atlas = m_atlas_enabled && !texture->MipMapped() && texture->m_type == GL_UNSIGNED_BYTE &&
+        frame_width <= ATLAS_MAX_IMAGE_SIZE && frame_height <= ATLAS_MAX_IMAGE_SIZE;
+
+    boost::scoped_array<unsigned char> sheet;
+    std::vector<unsigned char> frame_data;
+    const unsigned int bytes_pp = texture->BytesPP();
+    if (use_atlas) {
+        glBindTexture(GL_TEXTURE_2D, texture->OpenGLId());
+        sheet.reset(texture->GetRawBytes());
+        frame_data.resize(Value(frame_width) * Value(frame_height) * bytes_pp);
+    }
+
+    retval.reserve(frames);
+    for (std::size_t i = 0; i < frames; ++i) {
+        X x = static_cast<int>(i % cols) * (frame_width + INT_MARGIN) + INT_MARGIN;
+        Y y = static_cast<int>(i / cols) * (frame_height + INT_MARGIN) + INT_MARGIN;
+        if (use_atlas) {
+            const std::size_t row_bytes = Value(frame_width) * bytes_pp;
+            for (Y row = Y0; row < frame_height; ++row) {
+                std::memcpy(&frame_data[Value(row) * row_bytes],
+                            sheet.get() + (Value(y + row) * Value(texture->Width()) + Value(x)) * bytes_pp,
+                            row_bytes);
+            }
+            retval.push_back(AtlasImage(m_animation_atlas_pages, GL_LINEAR, frame_width, frame_height,
+                                        &frame_data[0], texture->m_format, bytes_pp));
+        } else {
+            retval.push_back(SubTexture(texture, x, y, x + frame_width, y + frame_height));
+        }
+    }
+
+    AnimationFrames cached;
+    cached.texture = texture;
+    cached.frame_width = frame_width;
+    cached.frame_height = frame_height;
+    cached.margin = margin;
+    cached.frames = retval;
+    m_animation_frames.push_back(cached);
+
+    return retval;
+}
+
+void TextureManager::UploadPendingTextures()
+{
+    if (!m_async_loader)
+        return;
+
+    std::deque<boost::shared_ptr<AsyncLoader::Job> >& uploading = m_async_loader->m_uploading;
+    {
+        boost::mutex::scoped_lock lock(m_async_loader->m_mutex);
+        uploading.insert(uploading.end(), m_async_loader->m_decoded.begin(), m_async_loader->m_decoded.end());
+        m_async_loader->m_decoded.clear();
+    }
+
+    const boost::uint64_t start = Microseconds();
+    bool first_piece = true;
+    while (!uploading.empty() && (first_piece || Microseconds() - start < m_upload_time_slice)) {
+        AsyncLoader::Job& job = *uploading.front();
+        Texture& texture = *job.texture;
+
+        // the load was abandoned if the texture was Clear()ed or
+        // re-initialized, or if no one holds the texture any more
+        if (!texture.m_loading || job.texture.unique()) {
+            uploading.pop_front();
+            continue;
+        }
+
+        if (!job.error.empty()) {
+            std::cerr << "Asynchronous load of texture \"" << texture.m_filename << "\" failed: " << job.error << "\n";
+            texture.m_loading = false;
+            uploading.pop_front();
+            continue;
+        }
+
+        first_piece = false;
+        try {
+            if (!job.storage_created) {
+                texture.InitStorage(job.width, job.height, 0,
+                                    job.format, GL_UNSIGNED_BYTE, job.bytes_pp, job.mipmap);
+                job.storage_created = true;
+            } else if (job.rows_uploaded < job.height) {
+                const int row_bytes = std::max(1, Value(job.width) * static_cast<int>(job.bytes_pp));
+                Y rows = std::min(Y(std::max(1, static_cast<int>(UPLOAD_BYTES_PER_PIECE) / row_bytes)),
+                                  job.height - job.rows_uploaded);
+                texture.UploadRows(job.data + Value(job.rows_uploaded) * row_bytes, job.rows_uploaded, rows);
+                job.rows_uploaded += rows;
+                if (job.rows_uploaded == job.height && job.mipmap_levels.empty()) {
+                    texture.FinishInit(job.data);
+                    texture.m_loading = false;
+                    uploading.pop_front();
+                }
+            } else {
+                // the levels built by the worker thread go up one per piece
+                const MipmapLevel& level = job.mipmap_levels[job.levels_uploaded];
+                texture.UploadMipmapLevel(++job.levels_uploaded, level.width, level.height, &level.data[0]);
+                if (job.levels_uploaded == job.mipmap_levels.size()) {
+                    texture.m_loading = false;
+                    uploading.pop_front();
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Asynchronous load of texture \"" << texture.m_filename << "\" failed: " << e.what() << "\n";
+            texture.m_loading = false;
+            uploading.pop_front();
+        }
+    }
+}
+
+void TextureManager::SetUploadTimeSlice(unsigned int microseconds)
+{ m_upload_time_slice = microseconds; }
+
+void TextureManager::SetAsyncLoadThreads(std::size_t threads)
+{ m_async_load_threads = threads; }
+
+void TextureManager::SetPlaceholder(const SubTexture& placeholder)
+{ m_placeholder = placeholder; }
+
+void TextureManager::EnableAtlas(bool b/* = true*/)
+{ m_atlas_enabled = b; }
+
 void TextureManager::FreeTexture(const std::string& name)
 {
     std::map<std::string, boost::shared_ptr<Texture> >::iterator it = m_textures.find(name);
     if (it != m_textures.end())
         m_textures.erase(it);
+    m_atlas_images.erase(name);
 }
 
 boost::shared_ptr<Texture> TextureManager::LoadTexture(const std::string& filename, bool mipmap/* = false*/)
@@ -693,6 +1614,61 @@ boost::shared_ptr<Texture> TextureManager::LoadTexture(const std::string& filena
     return (m_textures[filename] = temp);
 }
 
+SubTexture TextureManager::AtlasImage(std::vector<boost::shared_ptr<AtlasPage> >& pages, GLenum filter,
+                                      X width, Y height, const unsigned char* image, GLenum format,
+                                      unsigned int bytes_pp)
+{
+    Pt position;
+    // try the newest pages first, since the older ones are the likeliest to
+    // be full
+    boost::shared_ptr<AtlasPage> page;
+    for (std::size_t i = pages.size(); 0 < i; --i) {
+        if (pages[i - 1]->Allocate(width, height, position)) {
+            page = pages[i - 1];
+            break;
+        }
+    }
+    if (!page) {
+        page.reset(new AtlasPage(filter));
+        pages.push_back(page);
+        page->Allocate(width, height, position);
+    }
+
+    glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+    glPixelStorei(GL_UNPACK_SWAP_BYTES, false);
+    glPixelStorei(GL_UNPACK_LSB_FIRST, false);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // the gutter repeats the image's edge texels, so that linear filtering
+    // at its edges does not blend in whatever is next to it on the page
+    const int padded_width = Value(width) + 2 * ATLAS_GUTTER;
+    const int padded_height = Value(height) + 2 * ATLAS_GUTTER;
+    const std::size_t row_bytes = Value(width) * bytes_pp;
+    std::vector<unsigned char> padded(padded_width * padded_height * bytes_pp);
+    for (int row = 0; row < padded_height; ++row) {
+        const int image_row = std::min(std::max(row - ATLAS_GUTTER, 0), Value(height) - 1);
+        const unsigned char* src = image + image_row * row_bytes;
+        unsigned char* dst = &padded[row * padded_width * bytes_pp];
+        for (int i = 0; i < ATLAS_GUTTER; ++i) {
+            std::memcpy(dst + i * bytes_pp, src, bytes_pp);
+            std::memcpy(dst + (ATLAS_GUTTER + Value(width) + i) * bytes_pp, src + row_bytes - bytes_pp, bytes_pp);
+        }
+        std::memcpy(dst + ATLAS_GUTTER * bytes_pp, src, row_bytes);
+    }
+
+    // GL expands luminance and RGB images to the page's RGBA format
+    glBindTexture(GL_TEXTURE_2D, page->texture->OpenGLId());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, Value(position.x) - ATLAS_GUTTER, Value(position.y) - ATLAS_GUTTER,
+                    padded_width, padded_height, format, GL_UNSIGNED_BYTE, &padded[0]);
+
+    glPopClientAttrib();
+
+    return SubTexture(page->texture, position.x, position.y, position.x + width, position.y + height);
+}
+
 TextureManager& GG::GetTextureManager()
 {
     static TextureManager manager;
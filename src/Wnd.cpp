@@ -176,6 +176,7 @@ Wnd::Wnd(X x, Y y, X w, Y h, Flags<WndFlag> flags/* = INTERACTIVE | DRAGABLE*/)
     m_visible(true),
     m_child_clipping_mode(DontClip),
     m_non_client_child(false),
+    m_opaque(false),
     m_upperleft(x, y),
     m_lowerright(x + w, y + h),
     m_max_size(X(1 << 30), Y(1 << 30)),
@@ -228,6 +229,9 @@ Wnd::ChildClippingMode Wnd::GetChildClippingMode() const
 bool Wnd::NonClientChild() const
 { return m_non_client_child; }
 
+bool Wnd::Opaque() const
+{ return m_opaque; }
+
 bool Wnd::Visible() const
 { return m_visible; }
 
@@ -423,6 +427,9 @@ void Wnd::SetChildClippingMode(ChildClippingMode mode)
 void Wnd::NonClientChild(bool b)
 { m_non_client_child = b; }
 
+void Wnd::SetOpaque(bool b/* = true*/)
+{ m_opaque = b; }
+
 void Wnd::MoveTo(const Pt& pt)
 { SizeMove(pt, pt + Size()); }
 
@@ -8,9 +8,17 @@
 
 #include <GG/adobe/adam.hpp>
 
+#include <algorithm>
+#include <climits>
 #include <deque>
+#include <map>
+#include <vector>
 
 #include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <boost/function.hpp>
 #include <boost/variant.hpp>
@@ -30,8 +38,10 @@
 #include <GG/adobe/string.hpp>
 #include <GG/adobe/table_index.hpp>
 #include <GG/adobe/virtual_machine.hpp>
+#include <GG/adobe/implementation/token.hpp>
 
 #include <GG/ExpressionWriter.h>
+#include <GG/Profiler.h>
 
 #ifndef NDEBUG
 
@@ -77,10 +87,82 @@ struct empty_copy : T
 
 typedef adobe::sheet_t                              sheet_t;
 
-// This currently establishes an upperbound on the number of cells in the sheet at 1K.
-typedef std::bitset<1024>                           cell_bits_t;
 typedef int                                         priority_t;
 
+/**************************************************************************************************/
+
+/*
+    A set of cells, by cell_set_pos_m. The bits are stored only as far as the highest member, so
+    a set costs nothing until it is used and operations on it scale with the number of cells in
+    the sheet instead of a fixed cap. Trailing zero words are always trimmed so that equality is
+    a plain comparison of the words.
+*/
+
+class cell_bits_t
+{
+ public:
+    bool test(std::size_t pos) const
+    {
+        std::size_t word(pos / word_bits);
+        return word < words_m.size() && (words_m[word] & (word_t(1) << (pos % word_bits)));
+    }
+
+    void set(std::size_t pos)
+    {
+        std::size_t word(pos / word_bits);
+        if (words_m.size() <= word) words_m.resize(word + 1, 0);
+        words_m[word] |= word_t(1) << (pos % word_bits);
+    }
+
+    // Keeps the storage, since sets are cleared and refilled on every update.
+    void reset() { words_m.clear(); }
+
+    // One past the highest position that can be a member.
+    std::size_t size() const { return words_m.size() * word_bits; }
+
+    bool any() const { return !words_m.empty(); }
+    bool none() const { return words_m.empty(); }
+
+    // Equivalent to (*this & x).any() without building the intersection.
+    bool intersects(const cell_bits_t& x) const
+    {
+        for (std::size_t i(0), n(std::min(words_m.size(), x.words_m.size())); i != n; ++i)
+            if (words_m[i] & x.words_m[i]) return true;
+        return false;
+    }
+
+    cell_bits_t& operator|=(const cell_bits_t& x)
+    {
+        if (words_m.size() < x.words_m.size()) words_m.resize(x.words_m.size(), 0);
+        for (std::size_t i(0), n(x.words_m.size()); i != n; ++i) words_m[i] |= x.words_m[i];
+        return *this;
+    }
+
+    cell_bits_t& operator&=(const cell_bits_t& x)
+    {
+        if (x.words_m.size() < words_m.size()) words_m.resize(x.words_m.size());
+        for (std::size_t i(0), n(words_m.size()); i != n; ++i) words_m[i] &= x.words_m[i];
+        while (!words_m.empty() && !words_m.back()) words_m.pop_back();
+        return *this;
+    }
+
+    friend cell_bits_t operator&(cell_bits_t x, const cell_bits_t& y)
+    { return x &= y; }
+
+    friend bool operator==(const cell_bits_t& x, const cell_bits_t& y)
+    { return x.words_m == y.words_m; }
+
+    friend bool operator!=(const cell_bits_t& x, const cell_bits_t& y)
+    { return !(x == y); }
+
+ private:
+    typedef unsigned long word_t;
+
+    static const std::size_t word_bits = sizeof(word_t) * CHAR_BIT;
+
+    std::vector<word_t> words_m;
+};
+
 struct compare_contributing_t;
 
 enum access_specifier_t
@@ -105,8 +187,9 @@ enum access_specifier_t
     REVIST (sparent) : Some version of MSVC didn't like function level try blocks. Need to test.
 */
 
+template <typename Expression> // Expression is array_t or virtual_machine_t::compiled_expression_t
 void evaluate(adobe::virtual_machine_t& machine, const adobe::line_position_t& position,
-        const adobe::array_t& expression)
+        const Expression& expression)
 #ifdef BOOST_MSVC
 {
 #endif
@@ -146,6 +229,127 @@ struct scope_value_t : boost::noncopyable
 
 /**************************************************************************************************/
 
+/*
+    Collects the names of the variables read by expression. Names read only within the deferred
+    operands of &&, || and ?: (which are nested expression arrays) go in deferred, the rest in
+    definite.
+*/
+
+void collect_references(const adobe::array_t& expression, bool in_deferred,
+                        std::vector<adobe::name_t>& definite, std::vector<adobe::name_t>& deferred)
+{
+    for (adobe::array_t::const_iterator first(expression.begin()), last(expression.end());
+         first != last; ++first)
+    {
+        if (first->type_info() == adobe::type_info<adobe::array_t>()) {
+            collect_references(first->cast<adobe::array_t>(), true, definite, deferred);
+            continue;
+        }
+
+        adobe::name_t op;
+        if (!first->cast(op) || op != adobe::variable_k || first == expression.begin()) continue;
+
+        adobe::name_t variable;
+        if (!boost::prior(first)->cast(variable)) continue;
+
+        std::vector<adobe::name_t>& references(in_deferred ? deferred : definite);
+        if (std::find(references.begin(), references.end(), variable) == references.end())
+            references.push_back(variable);
+    }
+}
+
+/**************************************************************************************************/
+
+/*
+    A fixed set of threads which run the tasks [0, count) of one batch at a time. Tasks are
+    handed out one index at a time from a shared counter, so a thread that finishes early takes
+    more of the batch. The calling thread runs tasks too, and run() returns once every task has
+    finished; tasks must not throw.
+*/
+
+class parallel_pool_t : boost::noncopyable
+{
+ public:
+    typedef boost::function<void (std::size_t task, std::size_t worker)> task_t;
+
+    explicit parallel_pool_t(std::size_t thread_count) :
+        task_m(0),
+        count_m(0),
+        next_m(0),
+        busy_m(0),
+        generation_m(0),
+        stop_m(false)
+    {
+        for (std::size_t i = 1; i < thread_count; ++i)
+            threads_m.create_thread(boost::bind(&parallel_pool_t::work, this, i));
+    }
+
+    ~parallel_pool_t()
+    {
+        {
+            boost::mutex::scoped_lock lock(mutex_m);
+            stop_m = true;
+        }
+        wake_m.notify_all();
+        threads_m.join_all();
+    }
+
+    std::size_t size() const { return threads_m.size() + 1; }
+
+    void run(std::size_t count, const task_t& task)
+    {
+        boost::mutex::scoped_lock lock(mutex_m);
+        task_m = &task;
+        count_m = count;
+        next_m = 0;
+        ++generation_m;
+        wake_m.notify_all();
+        run_tasks(lock, 0);
+        while (busy_m) done_m.wait(lock);
+        task_m = 0;
+    }
+
+ private:
+    void work(std::size_t worker)
+    {
+        boost::mutex::scoped_lock lock(mutex_m);
+        std::size_t generation(generation_m);
+        while (true) {
+            while (!stop_m && generation == generation_m) wake_m.wait(lock);
+            if (stop_m) return;
+            generation = generation_m;
+            run_tasks(lock, worker);
+        }
+    }
+
+    void run_tasks(boost::mutex::scoped_lock& lock, std::size_t worker)
+    {
+        while (task_m && next_m < count_m) {
+            std::size_t task(next_m++);
+            const task_t& f(*task_m);
+            ++busy_m;
+            lock.unlock();
+            f(task, worker);
+            lock.lock();
+            --busy_m;
+        }
+        if (!busy_m) done_m.notify_all();
+    }
+
+    boost::mutex              mutex_m;
+    boost::condition_variable wake_m;
+    boost::condition_variable done_m;
+    boost::thread_group       threads_m;
+    const task_t*             task_m;
+    std::size_t               count_m;
+    std::size_t               next_m;
+    std::size_t               busy_m;
+    std::size_t               generation_m;
+    bool                      stop_m;
+};
+
+/**************************************************************************************************/
+
 } // namespace anonymous_adam_cpp
 using namespace anonymous_adam_cpp;
 
@@ -202,6 +406,8 @@ public:
     void update();
 
     void reinitialize();
+
+    void set_parallel_update(std::size_t thread_count);
     
     void set(const dictionary_t& dictionary); 
 // set input cells to corresponding values in dictionary.
@@ -217,6 +423,8 @@ private:
 
     typedef vector<relation_cell_t*>    relation_index_t;
     typedef std::vector<relation_t>     relation_set_t;
+    typedef virtual_machine_t::compiled_expression_t        compiled_expression_t;
+    typedef std::vector<compiled_expression_t>              compiled_expression_set_t;
     
     struct relation_cell_t
     {
@@ -227,13 +435,17 @@ private:
             position_m(position),
             conditional_m(conditional),
             terms_m(first, last)
-        { }
+        {
+            for (; first != last; ++first)
+                compiled_terms_m.push_back(compiled_expression_t(first->expression_m));
+        }
         
         bool                    resolved_m;
         
         line_position_t         position_m;
-        array_t                 conditional_m;
+        compiled_expression_t   conditional_m;
         relation_set_t          terms_m;
+        compiled_expression_set_t compiled_terms_m; // parallel to terms_m
         
         // REVISIT (sparent) : There should be a function object to set members
         void clear_resolved()
@@ -290,6 +502,17 @@ private:
         std::size_t                             cell_set_pos_m; // self index in sheet_t::cell_set_m
         
         calculator_t                            term_m;
+
+        // For cells calculated from an expression, the expression and the cells it reads, always
+        // (definite) or only in a nested expression (deferred); used to calculate independent
+        // cells in parallel. A reference is resolved to its cell when that cell is added, so
+        // unresolved_references_m counts the names not yet added. Empty otherwise.
+        line_position_t                         position_m;
+        compiled_expression_t                   expression_m;
+        std::vector<cell_t*>                    definite_references_m;
+        std::vector<cell_t*>                    deferred_references_m;
+        std::size_t                             unresolved_references_m;
+        bool                                    reads_self_m;
         
         // For output half of interface cells this points to corresponding input half. NULL otherwise.
         cell_t*                                 interface_input_m;
@@ -330,11 +553,38 @@ private:
     
     any_regular_t calculate_expression(const line_position_t& position, 
                                          const array_t& expression);
+    any_regular_t calculate_compiled_expression(const line_position_t& position,
+                                                const compiled_expression_t& expression);
     
     dictionary_t contributing_set(const dictionary_t&, const cell_bits_t&) const;
     
     void initialize_one(cell_t& cell);
 
+    // The result of calculating one cell on a worker thread.
+    struct parallel_result_t
+    {
+        parallel_result_t() : cell_m(0), calculated_m(false) {}
+
+        cell_t*         cell_m;
+        bool            calculated_m; // false if the calculation threw
+        any_regular_t   state_m;
+        cell_bits_t     contributing_m;
+        cell_bits_t     value_accessed_m;
+    };
+
+    typedef std::vector<parallel_result_t> parallel_results_t;
+
+    void set_expression(cell_t& cell, const line_position_t& position, const array_t& expression,
+                        const compiled_expression_t& compiled);
+    void resolve_references(cell_t& cell);
+    cell_t* find_cell(name_t name);
+    void calculate_output(cell_t& cell);
+    bool parallel_candidate(const cell_t& cell);
+    bool parallel_ready(const cell_t& cell);
+    void calculate_parallel();
+    void calculate_parallel_one(parallel_results_t& results, std::size_t task, std::size_t worker);
+    any_regular_t parallel_get(parallel_result_t& result, name_t name);
+
     void enabled_filter(const cell_bits_t& touch_set,
                            std::size_t contributing_index_pos,
                            monitor_enabled_t monitor,
@@ -587,6 +837,12 @@ private:
     
     cell_bits_t            accumulate_contributing_m;
 
+    std::size_t                             parallel_threads_m;
+    boost::scoped_ptr<parallel_pool_t>      parallel_pool_m;
+    // cells reading a name not yet added, and whether each read is definite
+    std::map<name_t, std::vector<std::pair<cell_t*, bool> > > unresolved_references_m;
+    std::vector<virtual_machine_t>          parallel_machines_m;
+
     bool                   has_output_m; // true if there are any output cells.
     bool                   initialize_mode_m; // true during reinitialize call.
 
@@ -615,8 +871,8 @@ sheet_t::implementation_t::enabled_filter(const cell_bits_t& touch_set,
 {
     cell_bits_t new_priority_accessed_touch = new_priority_accessed_bits & touch_set;
     cell_bits_t old_priority_accessed_touch = priority_accessed_m & touch_set;
-    bool unchanged_priority_accessed_touch = 
-            (new_priority_accessed_touch ^ old_priority_accessed_touch).none();
+    bool unchanged_priority_accessed_touch =
+            new_priority_accessed_touch == old_priority_accessed_touch;
             
     cell_t& cell = cell_set_m[contributing_index_pos];
     
@@ -668,6 +924,8 @@ sheet_t::implementation_t::cell_t::cell_t(name_t name, any_regular_t x,
     dirty_m(false),
     state_m(::adobe::move(x)),
     cell_set_pos_m(cell_set_pos),
+    unresolved_references_m(0),
+    reads_self_m(false),
     interface_input_m(0)
 {
     init_contributing_m.set(cell_set_pos);
@@ -688,6 +946,8 @@ sheet_t::implementation_t::cell_t::cell_t(name_t name, bool linked, const calcul
     relation_count_m(0),
     initial_relation_count_m(0),
     cell_set_pos_m(cell_set_pos),
+    unresolved_references_m(0),
+    reads_self_m(false),
     interface_input_m(0)
 {
     contributing_m.set(cell_set_pos);
@@ -709,6 +969,8 @@ sheet_t::implementation_t::cell_t::cell_t(access_specifier_t specifier, name_t n
     relation_count_m(0),
     initial_relation_count_m(0),
     cell_set_pos_m(cell_set_pos),
+    unresolved_references_m(0),
+    reads_self_m(false),
     interface_input_m(input)
 { }
     
@@ -727,6 +989,8 @@ sheet_t::implementation_t::cell_t::cell_t(access_specifier_t specifier, name_t n
     initial_relation_count_m(0),
     state_m(::adobe::move(x)),
     cell_set_pos_m(cell_set_pos),
+    unresolved_references_m(0),
+    reads_self_m(false),
     interface_input_m(0)
 { }
     
@@ -808,6 +1072,9 @@ void sheet_t::update()
 void sheet_t::reinitialize()
 { object_m->reinitialize(); }
 
+void sheet_t::set_parallel_update(std::size_t thread_count)
+{ object_m->set_parallel_update(thread_count); }
+
 void sheet_t::set(const dictionary_t& dictionary)
 { object_m->set(dictionary); }
 
@@ -836,6 +1103,7 @@ sheet_t::implementation_t::implementation_t(virtual_machine_t& machine) :
     priority_low_m(0),
     machine_m(machine),
     get_count_m(0),
+    parallel_threads_m(1),
     has_output_m(false),
     initialize_mode_m(false)
 #ifndef NDEBUG
@@ -932,6 +1200,7 @@ void sheet_t::implementation_t::add_input(name_t name, const line_position_t& po
     cell_set_m.push_back(cell_t(name, ::adobe::move(initial_value), cell_set_m.size()));
     // REVISIT (sparent) : Non-transactional on failure.
     input_index_m.insert(cell_set_m.back());
+    resolve_references(cell_set_m.back());
 }
     
 /**************************************************************************************************/
@@ -943,17 +1212,21 @@ void sheet_t::implementation_t::add_output(name_t output, const line_position_t&
         added_cells_m.push_back(added_cell_set_t(access_output));
     added_cells_m.back().added_cells_m.push_back(output_parameters_t(output, position, expression));
 
+    compiled_expression_t compiled(expression);
+
     // REVISIT (sparent) : Non-transactional on failure.
     cell_set_m.push_back(cell_t(access_output, output, 
-                                boost::bind(&implementation_t::calculate_expression,
-                                            boost::ref(*this), position, expression),
+                                boost::bind(&implementation_t::calculate_compiled_expression,
+                                            boost::ref(*this), position, compiled),
                                 cell_set_m.size()));
+    set_expression(cell_set_m.back(), position, expression, compiled);
 
     output_index_m.insert(cell_set_m.back());
     
     if (!name_index_m.insert(cell_set_m.back()).second) {
         throw stream_error_t(make_string("cell named '", output.c_str(), "'already exists."), position);
     }
+    resolve_references(cell_set_m.back());
     
     has_output_m = true;
 }
@@ -980,8 +1253,8 @@ void sheet_t::implementation_t::add_interface(name_t name, bool linked,
     scope_value_t<bool> scope(initialize_mode_m, true);
 
     if (initializer_expression.size()) {
-        cell_set_m.push_back(cell_t(name, linked, boost::bind(&implementation_t::calculate_expression,
-            boost::ref(*this), position1, initializer_expression), cell_set_m.size()));
+        cell_set_m.push_back(cell_t(name, linked, boost::bind(&implementation_t::calculate_compiled_expression,
+            boost::ref(*this), position1, compiled_expression_t(initializer_expression)), cell_set_m.size()));
     } else {
         cell_set_m.push_back(cell_t(name, linked, cell_t::calculator_t(), cell_set_m.size()));
     }
@@ -994,11 +1267,14 @@ void sheet_t::implementation_t::add_interface(name_t name, bool linked,
 
     if (expression.size())
     {
+        compiled_expression_t compiled(expression);
+
     // REVISIT (sparent) : Non-transactional on failure.
         cell_set_m.push_back(cell_t(access_interface_output, name, 
-                                    boost::bind(&implementation_t::calculate_expression,
-                                                boost::ref(*this), position2, expression),
+                                    boost::bind(&implementation_t::calculate_compiled_expression,
+                                                boost::ref(*this), position2, compiled),
                                     cell_set_m.size(), &cell_set_m.back()));
+        set_expression(cell_set_m.back(), position2, expression, compiled);
     }
     else
     {
@@ -1011,6 +1287,7 @@ void sheet_t::implementation_t::add_interface(name_t name, bool linked,
     if (!name_index_m.insert(cell_set_m.back()).second) {
         throw stream_error_t(make_string("cell named '", name.c_str(), "'already exists."), position2);
     }
+    resolve_references(cell_set_m.back());
 }
     
 /**************************************************************************************************/
@@ -1032,6 +1309,7 @@ void sheet_t::implementation_t::add_constant(name_t name, const line_position_t&
     if (!name_index_m.insert(cell_set_m.back()).second) {
         throw stream_error_t(make_string("cell named '", name.c_str(), "'already exists."), position);
     }
+    resolve_references(cell_set_m.back());
 }
     
 /**************************************************************************************************/
@@ -1043,14 +1321,18 @@ void sheet_t::implementation_t::add_logic(name_t logic, const line_position_t& p
         added_cells_m.push_back(added_cell_set_t(access_logic));
     added_cells_m.back().added_cells_m.push_back(logic_parameters_t(logic, position, expression));
 
+    compiled_expression_t compiled(expression);
+
     cell_set_m.push_back(cell_t(access_logic, logic, 
-                                boost::bind(&implementation_t::calculate_expression,
-                                            boost::ref(*this), position, expression),
+                                boost::bind(&implementation_t::calculate_compiled_expression,
+                                            boost::ref(*this), position, compiled),
                                 cell_set_m.size()));
+    set_expression(cell_set_m.back(), position, expression, compiled);
     
     if (!name_index_m.insert(cell_set_m.back()).second) {
         throw stream_error_t(make_string("cell named '", logic.c_str(), "'already exists."), position);
     }
+    resolve_references(cell_set_m.back());
 }
     
 /**************************************************************************************************/
@@ -1064,8 +1346,9 @@ void sheet_t::implementation_t::add_invariant(name_t invariant, const line_posit
 
     // REVISIT (sparent) : Should invariants also go in name_index_m?
     cell_set_m.push_back(cell_t(access_invariant, invariant, 
-                                boost::bind(&implementation_t::calculate_expression,
-                                            boost::ref(*this), position, expression),
+                                boost::bind(&implementation_t::calculate_compiled_expression,
+                                            boost::ref(*this), position,
+                                            compiled_expression_t(expression)),
                                 cell_set_m.size()));
     invariant_index_m.push_back(&cell_set_m.back());
 }
@@ -1108,6 +1391,20 @@ any_regular_t sheet_t::implementation_t::calculate_expression(
 
 /**************************************************************************************************/
 
+any_regular_t sheet_t::implementation_t::calculate_compiled_expression(
+        const line_position_t& position,
+        const compiled_expression_t& expression)
+{
+    evaluate(machine_m, position, expression);
+
+    any_regular_t result = ::adobe::move(machine_m.back());
+    machine_m.pop_back();
+
+    return result;
+}
+
+/**************************************************************************************************/
+
 sheet_t::connection_t 
 sheet_t::implementation_t::monitor_enabled(name_t n, const name_t* first, const name_t* last,
                                               const monitor_enabled_t& monitor)
@@ -1129,7 +1426,7 @@ sheet_t::implementation_t::monitor_enabled(name_t n, const name_t* first, const
         
     }
 
-    monitor(active_m.test(iter->cell_set_pos_m) || (touch_set & priority_accessed_m).any());
+    monitor(active_m.test(iter->cell_set_pos_m) || touch_set.intersects(priority_accessed_m));
 
     return monitor_enabled_m.connect(boost::bind(&sheet_t::implementation_t::enabled_filter,
                                                  this, touch_set, iter->cell_set_pos_m, monitor,
@@ -1290,6 +1587,7 @@ void sheet_t::implementation_t::flow(cell_bits_t& priority_accessed)
             
             cell_t* cell_to_resolve     = 0;
             const   relation_t* term    = 0;
+            const   compiled_expression_t* compiled_term = 0;
             bool    at_least_one        = false;
             
             for (relation_set_t::iterator tf((*f)->terms_m.begin()), tl((*f)->terms_m.end()); tf != tl; ++tf) {
@@ -1304,6 +1602,7 @@ void sheet_t::implementation_t::flow(cell_bits_t& priority_accessed)
                 if (!cell_to_resolve) {
                     cell_to_resolve = &cell;
                     term = &(*tf);
+                    compiled_term = &(*f)->compiled_terms_m[tf - (*f)->terms_m.begin()];
                     at_least_one = true;
                 } else {
                     cell_to_resolve = NULL; break;
@@ -1318,8 +1617,8 @@ void sheet_t::implementation_t::flow(cell_bits_t& priority_accessed)
             
             (*f)->resolved_m = true;          
             cell_to_resolve->resolved_m = true;
-            cell_to_resolve->term_m = boost::bind(&implementation_t::calculate_expression,
-                                            boost::ref(*this), term->position_m, term->expression_m); // cell needs to use the term for calculate.
+            cell_to_resolve->term_m = boost::bind(&implementation_t::calculate_compiled_expression,
+                                            boost::ref(*this), term->position_m, *compiled_term); // cell needs to use the term for calculate.
             --cell_to_resolve->relation_count_m;
             
             // This will be a derived cell and will have a priority lower than any cell contributing to it
@@ -1340,6 +1639,8 @@ void sheet_t::implementation_t::flow(cell_bits_t& priority_accessed)
 
 void sheet_t::implementation_t::update()
 {
+    GG_PROFILE_ZONE("adobe::sheet_t::update");
+
 #ifndef NDEBUG
     check_reentrancy checker(check_update_reentrancy_m);
     updated_m = true;
@@ -1361,7 +1662,7 @@ void sheet_t::implementation_t::update()
     {
         if (current_cell->conditional_m.empty()) continue;
                                 
-        if (!calculate_expression(current_cell->position_m, current_cell->conditional_m).cast<bool>())
+        if (!calculate_compiled_expression(current_cell->position_m, current_cell->conditional_m).cast<bool>())
         {
             // remove this relation from any terms.
             for (relation_set_t::iterator current_term(current_cell->terms_m.begin()),
@@ -1397,28 +1698,15 @@ void sheet_t::implementation_t::update()
 #endif
 
 // calculate the output/interface_output cells and apply.
+
+    if (parallel_threads_m > 1) calculate_parallel();
     
     for (index_t::const_iterator iter (output_index_m.begin()), last (output_index_m.end()); 
      iter != last; ++iter)
     {
         cell_t& cell(*iter);
         
-        // REVISIT (sparent) : This is a copy/paste of get();
-        
-        
-        if (!cell.evaluated_m) {
-            accumulate_contributing_m.reset();
-            
-            get_stack_m.push_back(cell.name_m);
-            
-            cell.calculate();
-            
-            get_stack_m.pop_back();
-            
-            cell.contributing_m = accumulate_contributing_m;
-            
-            cell.contributing_m |= conditional_indirect_contributing_m;
-        }
+        if (!cell.evaluated_m) calculate_output(cell);
             
         /*
             REVISIT (sparent) : This would be slightly more efficient if I moved the link flag
@@ -1467,7 +1755,7 @@ void sheet_t::implementation_t::update()
          iter != last; ++iter)
     {
         cell_t&         cell(*iter);
-        bool            invariant ((contributing & cell.contributing_m).none());
+        bool            invariant (!contributing.intersects(cell.contributing_m));
 
         if (invariant != cell.invariant_m) cell.monitor_invariant_m(invariant);
         cell.invariant_m = invariant;
@@ -1511,6 +1799,305 @@ void sheet_t::implementation_t::update()
 
 /**************************************************************************************************/
 
+void sheet_t::implementation_t::set_parallel_update(std::size_t thread_count)
+{
+    thread_count = (std::max)(thread_count, std::size_t(1));
+    if (thread_count == parallel_threads_m) return;
+
+    parallel_pool_m.reset();
+    parallel_machines_m.clear();
+    parallel_threads_m = thread_count;
+    if (1 < thread_count) parallel_pool_m.reset(new parallel_pool_t(thread_count));
+}
+
+/**************************************************************************************************/
+
+/*
+    Calculates an output or interface output cell during update(), recording the cells which
+    contribute to it.
+*/
+
+void sheet_t::implementation_t::calculate_output(cell_t& cell)
+{
+    // REVISIT (sparent) : This is a copy/paste of get();
+
+    accumulate_contributing_m.reset();
+
+    get_stack_m.push_back(cell.name_m);
+
+    cell.calculate();
+
+    get_stack_m.pop_back();
+
+    cell.contributing_m = accumulate_contributing_m;
+
+    cell.contributing_m |= conditional_indirect_contributing_m;
+}
+
+/**************************************************************************************************/
+
+/*
+    Records the expression a cell is calculated from, and resolves the variables it reads to
+    cells; a variable naming a cell not yet added is resolved by resolve_references() when that
+    cell is added.
+*/
+
+void sheet_t::implementation_t::set_expression(cell_t& cell, const line_position_t& position,
+                                               const array_t& expression,
+                                               const compiled_expression_t& compiled)
+{
+    cell.position_m = position;
+    cell.expression_m = compiled;
+
+    std::vector<name_t> definite;
+    std::vector<name_t> deferred;
+    collect_references(expression, false, definite, deferred);
+
+    for (int i = 0; i != 2; ++i) {
+        const std::vector<name_t>& names(i ? deferred : definite);
+        std::vector<cell_t*>& references(i ? cell.deferred_references_m
+                                           : cell.definite_references_m);
+        for (std::vector<name_t>::const_iterator first(names.begin()), last(names.end());
+             first != last; ++first)
+        {
+            if (*first == cell.name_m) {
+                cell.reads_self_m = true;
+                continue;
+            }
+            cell_t* reference(find_cell(*first));
+            if (reference) {
+                references.push_back(reference);
+            } else {
+                unresolved_references_m[*first].push_back(std::make_pair(&cell, i == 0));
+                ++cell.unresolved_references_m;
+            }
+        }
+    }
+}
+
+/**************************************************************************************************/
+
+void sheet_t::implementation_t::resolve_references(cell_t& cell)
+{
+    std::map<name_t, std::vector<std::pair<cell_t*, bool> > >::iterator
+        iter(unresolved_references_m.find(cell.name_m));
+    if (iter == unresolved_references_m.end()) return;
+
+    for (std::vector<std::pair<cell_t*, bool> >::const_iterator first(iter->second.begin()),
+             last(iter->second.end()); first != last; ++first)
+    {
+        cell_t& reader(*first->first);
+        (first->second ? reader.definite_references_m
+                       : reader.deferred_references_m).push_back(&cell);
+        --reader.unresolved_references_m;
+    }
+    unresolved_references_m.erase(iter);
+}
+
+/**************************************************************************************************/
+
+sheet_t::implementation_t::cell_t* sheet_t::implementation_t::find_cell(name_t name)
+{
+    index_t::iterator iter(name_index_m.find(name));
+    if (iter != name_index_m.end()) return &*iter;
+
+    iter = input_index_m.find(name);
+    return iter != input_index_m.end() ? &*iter : 0;
+}
+
+/**************************************************************************************************/
+
+/*
+    A cell can be calculated off the calling thread if it is calculated from an expression, is
+    not derived from a relation, and every variable it reads names some other cell (an interface
+    cell may also read its own input). A logic cell must also not read an interface cell, since
+    which half of an interface cell such a read gets depends on the cell being calculated when
+    the logic cell is first read.
+*/
+
+bool sheet_t::implementation_t::parallel_candidate(const cell_t& cell)
+{
+    if (cell.evaluated_m || !cell.term_m.empty() || cell.relation_count_m ||
+        cell.expression_m.empty() || cell.unresolved_references_m)
+        return false;
+
+    if (cell.reads_self_m && cell.specifier_m != access_interface_output) return false;
+
+    if (cell.specifier_m != access_logic) return true;
+
+    for (int i = 0; i != 2; ++i) {
+        const std::vector<cell_t*>& references(i ? cell.deferred_references_m
+                                                 : cell.definite_references_m);
+        for (std::vector<cell_t*>::const_iterator first(references.begin()),
+                 last(references.end()); first != last; ++first)
+        {
+            if ((*first)->specifier_m == access_interface_output) return false;
+        }
+    }
+    return true;
+}
+
+/**************************************************************************************************/
+
+bool sheet_t::implementation_t::parallel_ready(const cell_t& cell)
+{
+    for (int i = 0; i != 2; ++i) {
+        const std::vector<cell_t*>& references(i ? cell.deferred_references_m
+                                                 : cell.definite_references_m);
+        for (std::vector<cell_t*>::const_iterator first(references.begin()),
+                 last(references.end()); first != last; ++first)
+        {
+            if (!(*first)->evaluated_m) return false;
+        }
+    }
+    return true;
+}
+
+/**************************************************************************************************/
+
+/*
+    Calculates the output cells, and the logic cells they definitely read, in waves; each wave
+    is every remaining cell whose inputs have all been calculated, and its cells are calculated
+    concurrently on per-thread virtual machines. Interface cells without an expression only
+    read their own input, so they are calculated first, on the calling thread, and are ready
+    inputs for the first wave. Results are applied on the calling thread in output order,
+    exactly as cell_t::calculate() would have. Cells which are not candidates, or whose
+    calculation throws, are left for the serial pass in update() to calculate (and report).
+*/
+
+void sheet_t::implementation_t::calculate_parallel()
+{
+    GG_PROFILE_ZONE("adobe::sheet_t::calculate_parallel");
+
+    index_vector_t  pending;
+    cell_bits_t     queued;
+
+    for (index_t::iterator iter(output_index_m.begin()), last(output_index_m.end());
+         iter != last; ++iter)
+    {
+        if (iter->specifier_m == access_interface_output && iter->expression_m.empty() &&
+                !iter->evaluated_m && iter->term_m.empty() && !iter->relation_count_m)
+            calculate_output(*iter);
+    }
+
+    for (index_t::iterator iter(output_index_m.begin()), last(output_index_m.end());
+         iter != last; ++iter)
+    {
+        if (!parallel_candidate(*iter)) continue;
+        pending.push_back(&*iter);
+        queued.set(iter->cell_set_pos_m);
+    }
+
+    for (std::size_t i = 0; i != pending.size(); ++i) {
+        const std::vector<cell_t*>& references(pending[i]->definite_references_m);
+        for (std::vector<cell_t*>::const_iterator first(references.begin()),
+                 last(references.end()); first != last; ++first)
+        {
+            cell_t* reference(*first);
+            if (reference->specifier_m != access_logic || queued.test(reference->cell_set_pos_m) ||
+                    !parallel_candidate(*reference))
+                continue;
+            pending.push_back(reference);
+            queued.set(reference->cell_set_pos_m);
+        }
+    }
+
+    parallel_machines_m.assign(parallel_pool_m->size(), machine_m);
+
+    parallel_results_t  results;
+    index_vector_t      remaining;
+
+    while (!pending.empty()) {
+        results.clear();
+        remaining.clear();
+
+        for (index_vector_t::const_iterator first(pending.begin()), last(pending.end());
+             first != last; ++first)
+        {
+            if (parallel_ready(**first)) {
+                results.push_back(parallel_result_t());
+                results.back().cell_m = *first;
+            } else {
+                remaining.push_back(*first);
+            }
+        }
+
+        if (results.empty()) break;
+
+        parallel_pool_m->run(results.size(),
+                             boost::bind(&implementation_t::calculate_parallel_one, this,
+                                         boost::ref(results), _1, _2));
+
+        for (parallel_results_t::iterator first(results.begin()), last(results.end());
+             first != last; ++first)
+        {
+            if (!first->calculated_m) continue;
+
+            cell_t& cell(*first->cell_m);
+            cell.dirty_m = (first->state_m != cell.state_m);
+            cell.state_m = ::adobe::move(first->state_m);
+            cell.evaluated_m = true;
+            cell.contributing_m = first->contributing_m;
+            cell.contributing_m |= conditional_indirect_contributing_m;
+            value_accessed_m |= first->value_accessed_m;
+        }
+
+        pending.swap(remaining);
+    }
+
+    parallel_machines_m.clear();
+}
+
+/**************************************************************************************************/
+
+void sheet_t::implementation_t::calculate_parallel_one(parallel_results_t& results,
+                                                       std::size_t task, std::size_t worker)
+{
+    parallel_result_t& result(results[task]);
+    virtual_machine_t& machine(parallel_machines_m[worker]);
+
+    try {
+        machine.set_variable_lookup(boost::bind(&implementation_t::parallel_get, this,
+                                                boost::ref(result), _1));
+        evaluate(machine, result.cell_m->position_m, result.cell_m->expression_m);
+        result.state_m = ::adobe::move(machine.back());
+        machine.pop_back();
+        result.calculated_m = true;
+    } catch (...) {
+        // A throw can leave values on the stack.
+        try { machine = machine_m; } catch (...) { }
+    }
+}
+
+/**************************************************************************************************/
+
+/*
+    The worker thread counterpart of get() during update(); it only reads cells which have
+    already been calculated, and records what get() would have recorded in result instead of in
+    the sheet.
+*/
+
+any_regular_t sheet_t::implementation_t::parallel_get(parallel_result_t& result, name_t name)
+{
+    const cell_t* cell(0);
+
+    if (name == result.cell_m->name_m) {
+        cell = &*input_index_m.find(name);
+        result.value_accessed_m.set(cell->cell_set_pos_m);
+    } else {
+        cell = find_cell(name);
+        if (!cell || !cell->evaluated_m)
+            throw std::logic_error(make_string("variable ", name.c_str(), " not calculated."));
+        if (cell->specifier_m == access_interface_input)
+            result.value_accessed_m.set(cell->cell_set_pos_m);
+    }
+
+    result.contributing_m |= cell->contributing_m;
+    return cell->state_m;
+}
+
+/**************************************************************************************************/
+
 void sheet_t::implementation_t::initialize_one(cell_t& cell)
 {
     /*
@@ -1536,7 +2123,7 @@ void sheet_t::implementation_t::reinitialize()
         
         cell_t& cell = *f->interface_input_m;
         
-        if ((init_dirty_m & cell.init_contributing_m).none()) continue;
+        if (!init_dirty_m.intersects(cell.init_contributing_m)) continue;
             
         initialize_one(cell);
     }
@@ -1620,9 +2207,10 @@ dictionary_t sheet_t::implementation_t::contributing_set(const dictionary_t& mar
     dictionary_t touched;
     bool         include_touched(false);
     
-    for (std::size_t index(0), last(cell_set_m.size()); index != last; ++index)
+    for (std::size_t index(0), last(std::min(cell_set_m.size(), contributing.size()));
+            index != last; ++index)
     {
-        if (contributing[index])
+        if (contributing.test(index))
         {
             const cell_t&           cell = cell_set_m[index];
             const name_t&           name(cell.name_m);
@@ -4,121 +4,414 @@
 #include <GG/adobe/implementation/lex_shared.hpp>
 #include <GG/adobe/implementation/token.hpp>
 
+#include <boost/thread/tss.hpp>
+
+#include <algorithm>
+#include <deque>
+
+
+// Functions are compiled when they are defined.  Every variable a function
+// declares (its parameters included) is given a slot in the function's
+// frame, and each statement records which slot every name visible to it
+// refers to.  A call reserves a frame's worth of slots at the top of a
+// per-thread arena, so calls need no allocation beyond their expressions'
+// own, and no sheet_t is involved.
 
 namespace {
 
-    typedef std::pair<adobe::any_regular_t, bool> stack_variable_t;
-    typedef adobe::closed_hash_map<adobe::name_t, stack_variable_t> stack_frame_t;
+    typedef adobe::virtual_machine_t::compiled_expression_t compiled_expression_t;
 
-    struct variable_declarer
+    const std::size_t NONE = static_cast<std::size_t>(-1);
+
+    /** A variable visible at some point in a function body. */
+    struct binding_t
     {
-        variable_declarer(adobe::sheet_t& sheet, std::vector<stack_frame_t>& stack) :
-            m_sheet(sheet),
-            m_stack(stack)
+        binding_t(adobe::name_t name, std::size_t slot, bool const_) :
+            m_name(name),
+            m_slot(slot),
+            m_const(const_)
             {}
+        adobe::name_t m_name;
+        std::size_t m_slot;
+        bool m_const;
+    };
 
-        void operator()(adobe::name_t name, const adobe::array_t& expression, bool const_) const
-            {
-                if (!m_stack.empty()) {
-                    if (m_stack.back().count(name)) {
-                        throw std::runtime_error(
-                            adobe::make_string("Attempted to re-declare variable ", name.c_str())
-                        );
-                    }
-                    stack_variable_t& stack_variable = m_stack.back()[name];
-                    if (!expression.empty())
-                        stack_variable.first = m_sheet.inspect(expression);
-                    stack_variable.second = const_;
-                } else {
-                    if (const_) {
-                        m_sheet.add_constant(name, adobe::line_position_t(), expression);
-                    } else {
-                        m_sheet.add_interface(name,
-                                              false,
-                                              adobe::line_position_t(),
-                                              expression,
-                                              adobe::line_position_t(),
-                                              adobe::array_t());
-                    }
-                }
-            }
+    bool operator<(const binding_t& lhs, adobe::name_t rhs)
+    { return lhs.m_name < rhs; }
+
+    /** The variables visible at some point in a function body, sorted by
+        name. */
+    typedef std::vector<binding_t> scope_t;
+
+    const binding_t* find_binding(const scope_t& scope, adobe::name_t name)
+    {
+        scope_t::const_iterator it = std::lower_bound(scope.begin(), scope.end(), name);
+        return it != scope.end() && it->m_name == name ? &*it : 0;
+    }
+
+    struct statement_t
+    {
+        enum kind_t
+        {
+            assign_statement,
+            declare_statement,
+            redeclare_statement, // a declaration of a name already declared in the same block
+            ifelse_statement,
+            simple_for_statement,
+            complex_for_statement,
+            continue_statement,
+            break_statement,
+            return_statement
+        };
+
+        statement_t(kind_t kind, std::size_t scope) :
+            m_kind(kind),
+            m_scope(scope),
+            m_slot(NONE),
+            m_slot_2(NONE),
+            m_block(NONE),
+            m_else_block(NONE),
+            m_init_block(NONE),
+            m_in_loop(false)
+            {}
+
+        kind_t                m_kind;
+        std::size_t           m_scope;       ///< the names visible to the statement; an index into body_t::m_scopes
+        adobe::name_t         m_name;        ///< the declared variable
+        std::size_t           m_slot;        ///< the declared variable, or the first loop variable
+        std::size_t           m_slot_2;      ///< the second loop variable of a simple for, if any
+        adobe::array_t        m_lvalue;      ///< the target of an assignment
+        compiled_expression_t m_expression;  ///< the value, condition or sequence of the statement
+        std::size_t           m_block;       ///< the loop body, or the true branch
+        std::size_t           m_else_block;  ///< the false branch, or the assignments of a complex for
+        std::size_t           m_init_block;  ///< the declarations of a complex for
+        bool                  m_in_loop;     ///< true iff a continue or break is inside a loop
+    };
+
+    typedef std::vector<statement_t> block_t;
+}
+
+namespace adobe { namespace implementation {
+
+    /** A function body, compiled for execution on slot-indexed frames. */
+    struct adam_function_body_t
+    {
+        adam_function_body_t() : m_frame_size(0), m_statements(NONE) {}
+
+        std::size_t          m_frame_size;
+        std::size_t          m_statements; ///< the function's top-level block
+        std::deque<scope_t>  m_scopes;
+        std::deque<block_t>  m_blocks;
+    };
+
+} }
+
+namespace {
+
+    typedef adobe::implementation::adam_function_body_t body_t;
 
-        adobe::sheet_t& m_sheet;
-        std::vector<stack_frame_t>& m_stack;
+    /** The state of a block being compiled. */
+    struct scope_builder_t
+    {
+        scope_builder_t() : m_index(NONE) {}
+        /** Begins a block nested in \a outer. */
+        explicit scope_builder_t(const scope_builder_t* outer) :
+            m_visible(outer->m_visible),
+            m_index(outer->m_index)
+            {}
+        scope_t m_visible;
+        std::set<adobe::name_t> m_declared; ///< the names declared in this block
+        std::size_t m_index;                ///< the index of m_visible in body_t::m_scopes, or NONE
     };
 
-    struct variable_getter
+    class compiler_t
     {
-        variable_getter(adobe::sheet_t& sheet, std::vector<stack_frame_t>& stack) :
-            m_sheet(sheet),
-            m_stack(stack)
+    public:
+        compiler_t(body_t& body) :
+            m_body(body),
+            m_next_slot(0)
             {}
 
-        adobe::any_regular_t operator()(adobe::name_t name) const
+        /** Declares \a name in \a scope, and returns its slot, or NONE if
+            it was already declared in the same block. */
+        std::size_t declare(scope_builder_t& scope, adobe::name_t name, bool const_)
             {
-                for (std::vector<stack_frame_t>::const_reverse_iterator
-                         it = m_stack.rbegin(), end_it = m_stack.rend();
-                     it != end_it;
-                     ++it) {
-                    stack_frame_t::const_iterator frame_it = it->find(name);
-                    if (frame_it != it->end())
-                        return frame_it->second.first;
+                if (!scope.m_declared.insert(name).second)
+                    return NONE;
+                std::size_t slot = m_next_slot++;
+                m_body.m_frame_size = std::max(m_body.m_frame_size, m_next_slot);
+                scope_t::iterator it = std::lower_bound(scope.m_visible.begin(), scope.m_visible.end(), name);
+                if (it != scope.m_visible.end() && it->m_name == name)
+                    *it = binding_t(name, slot, const_);
+                else
+                    scope.m_visible.insert(it, binding_t(name, slot, const_));
+                scope.m_index = NONE;
+                return slot;
+            }
+
+        std::size_t scope_index(scope_builder_t& scope)
+            {
+                if (scope.m_index == NONE) {
+                    scope.m_index = m_body.m_scopes.size();
+                    m_body.m_scopes.push_back(scope.m_visible);
                 }
-                return m_sheet.get(name);
+                return scope.m_index;
             }
 
-        adobe::sheet_t& m_sheet;
-        std::vector<stack_frame_t>& m_stack;
+        std::size_t add_block(block_t& block)
+            {
+                m_body.m_blocks.push_back(block_t());
+                m_body.m_blocks.back().swap(block);
+                return m_body.m_blocks.size() - 1;
+            }
+
+        /** Compiles the statements [first, last) as a block nested in \a
+            outer; the slots of its variables are reused once it ends. */
+        std::size_t compile_block(adobe::array_t::const_iterator first,
+                                  adobe::array_t::const_iterator last,
+                                  const scope_builder_t& outer,
+                                  bool in_loop)
+            {
+                std::size_t slot_mark = m_next_slot;
+                scope_builder_t scope(&outer);
+                block_t block;
+                for (; first != last; ++first) {
+                    compile_statement(first->cast<adobe::array_t>(), scope, in_loop, block);
+                }
+                m_next_slot = slot_mark;
+                return add_block(block);
+            }
+
+        void compile_declaration(adobe::name_t name,
+                                 const adobe::array_t& initializer,
+                                 bool const_,
+                                 scope_builder_t& scope,
+                                 block_t& block)
+            {
+                std::size_t slot = declare(scope, name, const_);
+                statement_t statement(slot == NONE ? statement_t::redeclare_statement : statement_t::declare_statement,
+                                      scope_index(scope));
+                statement.m_name = name;
+                statement.m_slot = slot;
+                if (!initializer.empty())
+                    statement.m_expression = compiled_expression_t(initializer);
+                block.push_back(statement);
+            }
+
+        void compile_statement(const adobe::array_t& source,
+                               scope_builder_t& scope,
+                               bool in_loop,
+                               block_t& block);
+
+    private:
+        body_t& m_body;
+        std::size_t m_next_slot;
     };
 
-    struct variable_setter
+    void compiler_t::compile_statement(const adobe::array_t& source,
+                                       scope_builder_t& scope,
+                                       bool in_loop,
+                                       block_t& block)
     {
-        variable_setter(adobe::sheet_t& sheet, std::vector<stack_frame_t>& stack) :
-            m_sheet(sheet),
-            m_stack(stack)
-            {}
+        adobe::name_t op;
+        source.back().cast(op);
+
+        if (op == adobe::const_decl_k || op == adobe::decl_k) {
+            compile_declaration(source[0].cast<adobe::name_t>(),
+                                source[1].cast<adobe::array_t>(),
+                                op == adobe::const_decl_k,
+                                scope,
+                                block);
+            return;
+        }
 
-        void operator()(adobe::name_t name, const adobe::any_regular_t& value) const
-            {
-                for (std::vector<stack_frame_t>::reverse_iterator
-                         it = m_stack.rbegin(), end_it = m_stack.rend();
-                     it != end_it;
-                     ++it) {
-                    stack_frame_t::iterator frame_it = it->find(name);
-                    if (frame_it == it->end())
-                        continue;
-                    if (frame_it->second.second) {
-                        throw std::runtime_error(
-                            adobe::make_string("Attempted to set the value of const variable ", name.c_str())
-                        );
-                    }
-                    frame_it->second.first = value;
-                    return;
+        statement_t statement(statement_t::assign_statement, scope_index(scope));
+        statement.m_in_loop = in_loop;
+
+        if (op == adobe::assign_k) {
+            statement.m_lvalue = source[0].cast<adobe::array_t>();
+            statement.m_expression =
+                compiled_expression_t(adobe::array_t(source.begin() + 1, source.end() - 1));
+        } else if (op == adobe::stmt_ifelse_k) {
+            statement.m_kind = statement_t::ifelse_statement;
+            statement.m_expression = compiled_expression_t(source[0].cast<adobe::array_t>());
+            const adobe::array_t& true_block = source[1].cast<adobe::array_t>();
+            const adobe::array_t& false_block = source[2].cast<adobe::array_t>();
+            statement.m_block = compile_block(true_block.begin(), true_block.end(), scope, in_loop);
+            statement.m_else_block = compile_block(false_block.begin(), false_block.end(), scope, in_loop);
+        } else if (op == adobe::simple_for_k) {
+            std::size_t slot_mark = m_next_slot;
+            scope_builder_t for_scope(&scope);
+            statement.m_kind = statement_t::simple_for_statement;
+            statement.m_name = source[0].cast<adobe::name_t>();
+            statement.m_slot = declare(for_scope, statement.m_name, false);
+            adobe::name_t loop_var_1 = source[1].cast<adobe::name_t>();
+            if (loop_var_1) {
+                statement.m_slot_2 = declare(for_scope, loop_var_1, false);
+                if (statement.m_slot_2 == NONE) {
+                    statement.m_kind = statement_t::redeclare_statement;
+                    statement.m_name = loop_var_1;
                 }
-                m_sheet.set(name, value);
-                m_sheet.update();
             }
+            statement.m_scope = scope_index(for_scope);
+            statement.m_expression = compiled_expression_t(source[2].cast<adobe::array_t>());
+            const adobe::array_t& body = source[3].cast<adobe::array_t>();
+            statement.m_block = compile_block(body.begin(), body.end(), for_scope, true);
+            m_next_slot = slot_mark;
+        } else if (op == adobe::complex_for_k) {
+            std::size_t slot_mark = m_next_slot;
+            scope_builder_t for_scope(&scope);
+            statement.m_kind = statement_t::complex_for_statement;
+            block_t declarations;
+            const adobe::array_t& vars_array = source[0].cast<adobe::array_t>();
+            for (std::size_t i = 0; i < vars_array.size(); i += 3) {
+                compile_declaration(vars_array[i + 0].cast<adobe::name_t>(),
+                                    vars_array[i + 1].cast<adobe::array_t>(),
+                                    false,
+                                    for_scope,
+                                    declarations);
+            }
+            statement.m_init_block = add_block(declarations);
+            statement.m_scope = scope_index(for_scope);
+            statement.m_expression = compiled_expression_t(source[1].cast<adobe::array_t>());
+            const adobe::array_t& body = source[3].cast<adobe::array_t>();
+            statement.m_block = compile_block(body.begin(), body.end(), for_scope, true);
+            const adobe::array_t& assignments_array = source[2].cast<adobe::array_t>();
+            const adobe::any_regular_t assign_token(adobe::assign_k);
+            block_t assignments;
+            adobe::array_t::const_iterator it = assignments_array.begin();
+            const adobe::array_t::const_iterator end_it = assignments_array.end();
+            while (it != end_it) {
+                adobe::array_t::const_iterator assign_it = std::find(it, end_it, assign_token);
+                ++assign_it;
+                compile_statement(adobe::array_t(it, assign_it), for_scope, true, assignments);
+                it = assign_it;
+            }
+            statement.m_else_block = add_block(assignments);
+            m_next_slot = slot_mark;
+        } else if (op == adobe::continue_k) {
+            statement.m_kind = statement_t::continue_statement;
+        } else if (op == adobe::break_k) {
+            statement.m_kind = statement_t::break_statement;
+        } else if (op == adobe::return_k) {
+            statement.m_kind = statement_t::return_statement;
+            statement.m_expression =
+                compiled_expression_t(adobe::array_t(source.begin(), source.end() - 1));
+        } else {
+            return;
+        }
 
-        adobe::sheet_t& m_sheet;
-        std::vector<stack_frame_t>& m_stack;
-    };
+        block.push_back(statement);
+    }
+
+    typedef std::vector<adobe::any_regular_t> arena_t;
+
+    /** The per-thread stacks from which call frames are allocated.  This is
+        at namespace scope, since a function-local static's construction is
+        not thread-safe under C++98, and functions may first be called from
+        several threads at once. */
+    boost::thread_specific_ptr<arena_t> arena_s;
+
+    /** The calling thread's stack from which call frames are allocated. */
+    arena_t& local_arena()
+    {
+        if (!arena_s.get()) {
+            arena_s.reset(new arena_t);
+            arena_s->reserve(256);
+        }
+        return *arena_s;
+    }
 
-    struct scoped_stack_frame
+    /** A single call of a function.  Locals are always accessed by index,
+        since the arena may be reallocated by nested calls. */
+    class call_t
     {
-        scoped_stack_frame(std::vector<stack_frame_t>& stack) :
-            m_stack(stack)
-            { m_stack.push_back(stack_frame_t()); }
-        ~scoped_stack_frame()
-            { m_stack.pop_back(); }
+    public:
+        call_t(const body_t& body,
+               const adobe::adam_function_t::array_function_lookup_t& array_function_lookup,
+               const adobe::adam_function_t::dictionary_function_lookup_t& dictionary_function_lookup,
+               const adobe::adam_function_t::adam_function_lookup_t& adam_function_lookup) :
+            m_body(body),
+            m_arena(local_arena()),
+            m_base(m_arena.size()),
+            m_scope(&body.m_scopes.front())
+            {
+                m_arena.resize(m_base + body.m_frame_size);
+                m_machine.set_array_function_lookup(array_function_lookup);
+                m_machine.set_dictionary_function_lookup(dictionary_function_lookup);
+                m_machine.set_adam_function_lookup(adam_function_lookup);
+                m_machine.set_variable_lookup(boost::bind(&call_t::get, this, _1));
+            }
+
+        ~call_t()
+            { m_arena.resize(m_base); }
+
+        adobe::any_regular_t& local(std::size_t slot)
+            { return m_arena[m_base + slot]; }
+
+        adobe::any_regular_t get(adobe::name_t name) const
+            {
+                const binding_t* binding = find_binding(*m_scope, name);
+                if (!binding)
+                    throw std::runtime_error(adobe::make_string("Use of unknown variable ", name.c_str()));
+                return m_arena[m_base + binding->m_slot];
+            }
+
+        void set(adobe::name_t name, const adobe::any_regular_t& value)
+            {
+                const binding_t* binding = find_binding(*m_scope, name);
+                if (!binding)
+                    throw std::runtime_error(adobe::make_string("Assignment to unknown variable ", name.c_str()));
+                if (binding->m_const) {
+                    throw std::runtime_error(
+                        adobe::make_string("Attempted to set the value of const variable ", name.c_str())
+                    );
+                }
+                local(binding->m_slot) = value;
+            }
+
+        template <class Expression>
+        adobe::any_regular_t evaluate(const Expression& expression)
+            {
+                if (expression.empty())
+                    return adobe::any_regular_t();
+                m_machine.evaluate(expression);
+                adobe::any_regular_t retval = ::adobe::move(m_machine.back());
+                m_machine.pop_back();
+                return retval;
+            }
+
+        adobe::any_regular_t exec_block(std::size_t block,
+                                        bool& block_continue,
+                                        bool& block_break,
+                                        bool& function_done);
+
+    private:
+        adobe::any_regular_t exec_statement(const statement_t& statement,
+                                            bool& block_continue,
+                                            bool& block_break,
+                                            bool& function_done);
 
-        std::vector<stack_frame_t>& m_stack;
+        adobe::any_regular_t exec_loop_body(std::size_t block,
+                                            bool& block_break,
+                                            bool& function_done)
+            {
+                bool block_continue = false;
+                return exec_block(block, block_continue, block_break, function_done);
+            }
+
+        const body_t& m_body;
+        arena_t& m_arena;
+        std::size_t m_base;
+        const scope_t* m_scope;
+        adobe::virtual_machine_t m_machine;
     };
 
     struct lvalue
     {
-        lvalue(const variable_getter& get, const adobe::array_t& expression) :
+        lvalue(const call_t& call, const adobe::array_t& expression) :
             m_cell_name(expression[0].cast<adobe::name_t>()),
-            m_cell_value(new adobe::any_regular_t(get(m_cell_name))),
+            m_cell_value(new adobe::any_regular_t(call.get(m_cell_name))),
             m_lvalue(m_cell_value.get())
             {}
         adobe::name_t m_cell_name;
@@ -126,11 +419,9 @@ namespace {
         adobe::any_regular_t* m_lvalue;
     };
 
-    lvalue evaluate_lvalue_expression(adobe::sheet_t& sheet,
-                                      const variable_getter& get,
-                                      const adobe::array_t& expression)
+    lvalue evaluate_lvalue_expression(call_t& call, const adobe::array_t& expression)
     {
-        lvalue retval(get, expression);
+        lvalue retval(call, expression);
         adobe::array_t value_stack;
         for (adobe::array_t::const_iterator it(expression.begin()); it != expression.end(); ++it) {
             adobe::name_t op;
@@ -138,7 +429,7 @@ namespace {
                 if (op == adobe::variable_k) {
                     value_stack.pop_back();
                 } else if (op == adobe::bracket_index_k) {
-                    adobe::any_regular_t index = sheet.inspect(value_stack.back().cast<adobe::array_t>());
+                    adobe::any_regular_t index = call.evaluate(value_stack.back().cast<adobe::array_t>());
                     value_stack.pop_back();
                     if (index.type_info() == adobe::type_info<adobe::name_t>()) {
                         retval.m_lvalue =
@@ -157,11 +448,11 @@ namespace {
                         ];
                     value_stack.pop_back();
                 } else if (op == adobe::ifelse_k) {
-                    lvalue else_ = evaluate_lvalue_expression(sheet, get, value_stack.back().cast<adobe::array_t>());
+                    lvalue else_ = evaluate_lvalue_expression(call, value_stack.back().cast<adobe::array_t>());
                     value_stack.pop_back();
-                    lvalue if_ = evaluate_lvalue_expression(sheet, get, value_stack.back().cast<adobe::array_t>());
+                    lvalue if_ = evaluate_lvalue_expression(call, value_stack.back().cast<adobe::array_t>());
                     value_stack.pop_back();
-                    bool condition = sheet.inspect(value_stack.back().cast<adobe::array_t>()).cast<bool>();
+                    bool condition = call.evaluate(value_stack.back().cast<adobe::array_t>()).cast<bool>();
                     value_stack.pop_back();
                     retval = condition ? if_ : else_;
                 }
@@ -172,31 +463,14 @@ namespace {
         return retval;
     }
 
-    adobe::any_regular_t exec_statement(const adobe::array_t& statement,
-                                        adobe::sheet_t& local_scope,
-                                        std::vector<stack_frame_t>& stack,
-                                        bool in_loop,
-                                        bool& block_continue,
-                                        bool& block_break,
-                                        bool& function_done);
-
-    adobe::any_regular_t exec_block(adobe::array_t::const_iterator first,
-                                    adobe::array_t::const_iterator last,
-                                    adobe::sheet_t& local_scope,
-                                    std::vector<stack_frame_t>& stack,
-                                    bool in_loop,
-                                    bool& block_continue,
-                                    bool& block_break,
-                                    bool& function_done)
+    adobe::any_regular_t call_t::exec_block(std::size_t block,
+                                            bool& block_continue,
+                                            bool& block_break,
+                                            bool& function_done)
     {
-        for (; first != last; ++first) {
-            adobe::any_regular_t value = exec_statement(first->cast<adobe::array_t>(),
-                                                        local_scope,
-                                                        stack,
-                                                        in_loop,
-                                                        block_continue,
-                                                        block_break,
-                                                        function_done);
+        const block_t& statements = m_body.m_blocks[block];
+        for (block_t::const_iterator it = statements.begin(), end_it = statements.end(); it != end_it; ++it) {
+            adobe::any_regular_t value = exec_statement(*it, block_continue, block_break, function_done);
             if (block_continue || block_break)
                 break;
             if (function_done)
@@ -205,78 +479,58 @@ namespace {
         return adobe::any_regular_t();
     }
 
-    adobe::any_regular_t exec_statement(const adobe::array_t& statement,
-                                        adobe::sheet_t& local_scope,
-                                        std::vector<stack_frame_t>& stack,
-                                        bool in_loop,
-                                        bool& block_continue,
-                                        bool& block_break,
-                                        bool& function_done)
+    adobe::any_regular_t call_t::exec_statement(const statement_t& statement,
+                                                bool& block_continue,
+                                                bool& block_break,
+                                                bool& function_done)
     {
-        variable_declarer declare(local_scope, stack);
-        variable_getter get(local_scope, stack);
-        variable_setter set(local_scope, stack);
-
-        adobe::name_t op;
-        statement.back().cast(op);
+        m_scope = &m_body.m_scopes[statement.m_scope];
 
-        if (op == adobe::assign_k) {
-            adobe::any_regular_t value =
-                local_scope.inspect(adobe::array_t(statement.begin() + 1, statement.end() - 1));
-            lvalue l_value =
-                evaluate_lvalue_expression(local_scope, get, statement[0].cast<adobe::array_t>());
+        switch (statement.m_kind) {
+        case statement_t::assign_statement: {
+            adobe::any_regular_t value = evaluate(statement.m_expression);
+            lvalue l_value = evaluate_lvalue_expression(*this, statement.m_lvalue);
             *l_value.m_lvalue = value;
             set(l_value.m_cell_name, *l_value.m_cell_value);
-        } else if (op == adobe::const_decl_k || op == adobe::decl_k) {
-            declare(statement[0].cast<adobe::name_t>(),
-                    statement[1].cast<adobe::array_t>(),
-                    op == adobe::const_decl_k);
-        } else if (op == adobe::stmt_ifelse_k) {
-            const adobe::array_t& condition_expr =
-               statement[0].cast<adobe::array_t>();
-            const bool condition =
-                local_scope.inspect(condition_expr).cast<bool>();
-            const adobe::array_t& stmt_block =
-                (condition ? statement[1] : statement[2]).cast<adobe::array_t>();
-            scoped_stack_frame local_stack_frame(stack);
-            adobe::any_regular_t value = exec_block(stmt_block.begin(),
-                                                    stmt_block.end(),
-                                                    local_scope,
-                                                    stack,
-                                                    in_loop,
+            break;
+        }
+        case statement_t::declare_statement: {
+            // the initializer may refer to the variable itself, which is
+            // empty until it is initialized; evaluate before taking a
+            // reference into the arena, as nested calls may reallocate it
+            local(statement.m_slot) = adobe::any_regular_t();
+            adobe::any_regular_t value = evaluate(statement.m_expression);
+            local(statement.m_slot) = value;
+            break;
+        }
+        case statement_t::redeclare_statement:
+            throw std::runtime_error(
+                adobe::make_string("Attempted to re-declare variable ", statement.m_name.c_str())
+            );
+        case statement_t::ifelse_statement: {
+            const bool condition = evaluate(statement.m_expression).cast<bool>();
+            adobe::any_regular_t value = exec_block(condition ? statement.m_block : statement.m_else_block,
                                                     block_continue,
                                                     block_break,
                                                     function_done);
             if (function_done)
                 return value;
-        } else if (op == adobe::simple_for_k) {
-            scoped_stack_frame local_stack_frame(stack);
-            adobe::name_t loop_var_0 = statement[0].cast<adobe::name_t>();
-            declare(loop_var_0, adobe::array_t(), false);
-            adobe::name_t loop_var_1 = statement[1].cast<adobe::name_t>();
-            if (loop_var_1)
-                declare(loop_var_1, adobe::array_t(), false);
-            const adobe::any_regular_t sequence =
-                local_scope.inspect(statement[2].cast<adobe::array_t>());
-            const adobe::array_t& stmt_block = statement[3].cast<adobe::array_t>();
+            break;
+        }
+        case statement_t::simple_for_statement: {
+            local(statement.m_slot) = adobe::any_regular_t();
+            if (statement.m_slot_2 != NONE)
+                local(statement.m_slot_2) = adobe::any_regular_t();
+            const adobe::any_regular_t sequence = evaluate(statement.m_expression);
             if (sequence.type_info() == adobe::type_info<adobe::array_t>()) {
-                if (loop_var_1)
+                if (statement.m_slot_2 != NONE)
                     throw std::runtime_error("Two loop variables passed to a for loop over an array");
                 const adobe::array_t& array = sequence.cast<adobe::array_t>();
                 for (adobe::array_t::const_iterator it = array.begin(), end_it = array.end();
                      it != end_it;
                      ++it) {
-                    scoped_stack_frame local_stack_frame(stack);
-                    set(loop_var_0, *it);
-                    adobe::any_regular_t value = exec_block(stmt_block.begin(),
-                                                            stmt_block.end(),
-                                                            local_scope,
-                                                            stack,
-                                                            true,
-                                                            block_continue,
-                                                            block_break,
-                                                            function_done);
-                    block_continue = false;
+                    local(statement.m_slot) = *it;
+                    adobe::any_regular_t value = exec_loop_body(statement.m_block, block_break, function_done);
                     if (block_break) {
                         block_break = false;
                         break;
@@ -291,26 +545,17 @@ namespace {
                          it = dictionary.begin(), end_it = dictionary.end();
                      it != end_it;
                      ++it) {
-                    if (loop_var_1) {
-                        set(loop_var_0, adobe::any_regular_t(it->first));
-                        set(loop_var_1, it->second);
+                    if (statement.m_slot_2 != NONE) {
+                        local(statement.m_slot) = adobe::any_regular_t(it->first);
+                        local(statement.m_slot_2) = it->second;
                     } else {
                         adobe::dictionary_t value;
                         value[adobe::static_name_t("key")] =
                             adobe::any_regular_t(it->first);
                         value[adobe::static_name_t("value")] = it->second;
-                        set(loop_var_0, adobe::any_regular_t(value));
+                        local(statement.m_slot) = adobe::any_regular_t(value);
                     }
-                    scoped_stack_frame local_stack_frame(stack);
-                    adobe::any_regular_t value = exec_block(stmt_block.begin(),
-                                                            stmt_block.end(),
-                                                            local_scope,
-                                                            stack,
-                                                            true,
-                                                            block_continue,
-                                                            block_break,
-                                                            function_done);
-                    block_continue = false;
+                    adobe::any_regular_t value = exec_loop_body(statement.m_block, block_break, function_done);
                     if (block_break) {
                         block_break = false;
                         break;
@@ -319,114 +564,94 @@ namespace {
                         return value;
                 }
             }
-        } else if (op == adobe::complex_for_k) {
-            scoped_stack_frame local_stack_frame(stack);
-            const adobe::array_t& vars_array = statement[0].cast<adobe::array_t>();
-            for (std::size_t i = 0; i < vars_array.size(); i += 3) {
-                adobe::name_t var_name = vars_array[i + 0].cast<adobe::name_t>();
-                const adobe::array_t& initializer =
-                    vars_array[i + 1].cast<adobe::array_t>();
-                declare(var_name, initializer, false);
-            }
-            const adobe::array_t& condition = statement[1].cast<adobe::array_t>();
-            const adobe::array_t& assignments_array =
-                statement[2].cast<adobe::array_t>();
-            const adobe::array_t& stmt_block = statement[3].cast<adobe::array_t>();
-            const adobe::any_regular_t assign_token(adobe::assign_k);
-            adobe::any_regular_t condition_result = local_scope.inspect(condition);
-            while (condition_result.cast<bool>()) {
-                {
-                    scoped_stack_frame local_stack_frame(stack);
-                    adobe::any_regular_t value = exec_block(stmt_block.begin(),
-                                                            stmt_block.end(),
-                                                            local_scope,
-                                                            stack,
-                                                            true,
-                                                            block_continue,
-                                                            block_break,
-                                                            function_done);
-                    block_continue = false;
-                    if (block_break) {
-                        block_break = false;
-                        break;
-                    }
-                    if (function_done)
-                        return value;
-                }
-                adobe::array_t::const_iterator it = assignments_array.begin();
-                const adobe::array_t::const_iterator end_it =
-                    assignments_array.end();
-                while (it != end_it) {
-                    adobe::array_t::const_iterator assign_it =
-                        std::find(it, end_it, assign_token);
-                    ++assign_it;
-                    exec_statement(adobe::array_t(it, assign_it),
-                                   local_scope,
-                                   stack,
-                                   true,
-                                   block_continue,
-                                   block_break,
-                                   function_done);
-                    assert(!block_continue && !block_break && !function_done);
-                    it = assign_it;
+            break;
+        }
+        case statement_t::complex_for_statement: {
+            bool unused_continue = false, unused_break = false, unused_done = false;
+            exec_block(statement.m_init_block, unused_continue, unused_break, unused_done);
+            m_scope = &m_body.m_scopes[statement.m_scope];
+            while (evaluate(statement.m_expression).cast<bool>()) {
+                adobe::any_regular_t value = exec_loop_body(statement.m_block, block_break, function_done);
+                if (block_break) {
+                    block_break = false;
+                    break;
                 }
-                condition_result = local_scope.inspect(condition);
+                if (function_done)
+                    return value;
+                exec_block(statement.m_else_block, unused_continue, unused_break, unused_done);
+                assert(!unused_continue && !unused_break && !unused_done);
+                m_scope = &m_body.m_scopes[statement.m_scope];
             }
-        } else if (op == adobe::continue_k) {
-            if (!in_loop)
+            break;
+        }
+        case statement_t::continue_statement:
+            if (!statement.m_in_loop)
                 throw std::runtime_error("continue statement outside of loop");
             block_continue = true;
-        } else if (op == adobe::break_k) {
-            if (!in_loop)
+            break;
+        case statement_t::break_statement:
+            if (!statement.m_in_loop)
                 throw std::runtime_error("break statement outside of loop");
             block_break = true;
-        } else if (op == adobe::return_k) {
-            adobe::any_regular_t value =
-                local_scope.inspect(adobe::array_t(statement.begin(),
-                                                   statement.end() - 1));
+            break;
+        case statement_t::return_statement: {
+            adobe::any_regular_t value = evaluate(statement.m_expression);
             function_done = true;
             return value;
         }
+        }
 
         return adobe::any_regular_t();
     }
 
-    void common_init(
-        const adobe::adam_function_t::array_function_lookup_t& array_function_lookup,
-        const adobe::adam_function_t::dictionary_function_lookup_t& dictionary_function_lookup,
-        const adobe::adam_function_t::adam_function_lookup_t& adam_function_lookup,
-        const variable_getter& get,
-        adobe::sheet_t& local_scope
-    ) {
-        local_scope.machine_m.set_array_function_lookup(array_function_lookup);
-        local_scope.machine_m.set_dictionary_function_lookup(dictionary_function_lookup);
-        local_scope.machine_m.set_adam_function_lookup(adam_function_lookup);
-        local_scope.machine_m.set_variable_lookup(get);
+}
+
+namespace {
+
+    boost::shared_ptr<const body_t> compile_body(const std::vector<adobe::name_t>& parameter_names,
+                                                 const std::vector<adobe::array_t>& statements)
+    {
+        boost::shared_ptr<body_t> retval(new body_t);
+        compiler_t compiler(*retval);
+        scope_builder_t scope;
+        for (std::size_t i = 0; i < parameter_names.size(); ++i) {
+            compiler.declare(scope, parameter_names[i], false);
+        }
+        compiler.scope_index(scope);
+        block_t block;
+        for (std::size_t i = 0; i < statements.size(); ++i) {
+            compiler.compile_statement(statements[i], scope, false, block);
+        }
+        retval->m_statements = compiler.add_block(block);
+        return retval;
     }
 
-    adobe::any_regular_t common_impl(adobe::sheet_t& local_scope,
-                                     std::vector<stack_frame_t>& stack,
-                                     const std::vector<adobe::array_t>& statements)
+    adobe::any_regular_t parameter_value(const adobe::array_t& parameters, std::size_t i, adobe::name_t)
+    { return i < parameters.size() ? parameters[i] : adobe::any_regular_t(); }
+
+    adobe::any_regular_t parameter_value(const adobe::dictionary_t& parameters, std::size_t, adobe::name_t name)
     {
-        for (std::vector<adobe::array_t>::const_iterator
-                 it = statements.begin(),
-                 end_it = statements.end();
-             it != end_it;
-             ++it) {
-            bool function_done = false;
-            bool block_continue = false;
-            bool block_break = false;
-            adobe::any_regular_t value = exec_statement(*it,
-                                                        local_scope,
-                                                        stack,
-                                                        false,
-                                                        block_continue,
-                                                        block_break,
-                                                        function_done);
-            if (function_done)
-                return value;
+        adobe::dictionary_t::const_iterator it = parameters.find(name);
+        return it != parameters.end() ? it->second : adobe::any_regular_t();
+    }
+
+    template <class Parameters>
+    adobe::any_regular_t call_body(const body_t& body,
+                                   const std::vector<adobe::name_t>& parameter_names,
+                                   const Parameters& parameters,
+                                   const adobe::adam_function_t::array_function_lookup_t& array_function_lookup,
+                                   const adobe::adam_function_t::dictionary_function_lookup_t& dictionary_function_lookup,
+                                   const adobe::adam_function_t::adam_function_lookup_t& adam_function_lookup)
+    {
+        call_t call(body, array_function_lookup, dictionary_function_lookup, adam_function_lookup);
+        const scope_t& top_scope = body.m_scopes.front();
+        for (std::size_t i = 0; i < parameter_names.size(); ++i) {
+            const binding_t* binding = find_binding(top_scope, parameter_names[i]);
+            if (binding)
+                call.local(binding->m_slot) = parameter_value(parameters, i, parameter_names[i]);
         }
-        return adobe::any_regular_t();
+        bool block_continue = false, block_break = false, function_done = false;
+        return call.exec_block(body.m_statements, block_continue, block_break, function_done);
     }
 
 }
@@ -494,6 +719,7 @@ adam_function_t::adam_function_t(name_t name,
             }
         }
     }
+    m_body = compile_body(m_parameter_names, m_statements);
 }
 
 name_t adam_function_t::name() const
@@ -512,34 +738,14 @@ any_regular_t adam_function_t::operator()(
     const array_t& parameters
 ) const
 {
-    sheet_t local_scope;
-    std::vector<stack_frame_t> stack;
-
-    common_init(array_function_lookup,
-                dictionary_function_lookup,
-                adam_function_lookup,
-                variable_getter(local_scope, stack),
-                local_scope);
-
-    for (std::size_t i = 0; i < m_parameter_names.size(); ++i) {
-        if (i < parameters.size()) {
-            local_scope.add_interface(m_parameter_names[i],
-                                      false,
-                                      line_position_t(),
-                                      array_t(1, parameters[i]),
-                                      line_position_t(),
-                                      array_t());
-        } else {
-            local_scope.add_interface(m_parameter_names[i],
-                                      false,
-                                      line_position_t(),
-                                      array_t(),
-                                      line_position_t(),
-                                      array_t());
-        }
-    }
-
-    return common_impl(local_scope, stack, m_statements);
+    if (!m_body)
+        return any_regular_t();
+    return call_body(*m_body,
+                     m_parameter_names,
+                     parameters,
+                     array_function_lookup,
+                     dictionary_function_lookup,
+                     adam_function_lookup);
 }
 
 any_regular_t adam_function_t::operator()(
@@ -549,36 +755,14 @@ any_regular_t adam_function_t::operator()(
     const dictionary_t& parameters
 ) const
 {
-    sheet_t local_scope;
-    std::vector<stack_frame_t> stack;
-
-    common_init(array_function_lookup,
-                dictionary_function_lookup,
-                adam_function_lookup,
-                variable_getter(local_scope, stack),
-                local_scope);
-
-    for (std::size_t i = 0; i < m_parameter_names.size(); ++i) {
-        dictionary_t::const_iterator it =
-            parameters.find(m_parameter_names[i]);
-        if (it != parameters.end()) {
-            local_scope.add_interface(m_parameter_names[i],
-                                      false,
-                                      line_position_t(),
-                                      array_t(1, it->second),
-                                      line_position_t(),
-                                      array_t());
-        } else {
-            local_scope.add_interface(m_parameter_names[i],
-                                      false,
-                                      line_position_t(),
-                                      array_t(),
-                                      line_position_t(),
-                                      array_t());
-        }
-    }
-
-    return common_impl(local_scope, stack, m_statements);
+    if (!m_body)
+        return any_regular_t();
+    return call_body(*m_body,
+                     m_parameter_names,
+                     parameters,
+                     array_function_lookup,
+                     dictionary_function_lookup,
+                     adam_function_lookup);
 }
 
 }
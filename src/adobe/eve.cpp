@@ -88,6 +88,14 @@ struct view_proxy_t : adobe::extents_slices_t
 
     layout_attributes_t             geometry_m; // REVISIT (sparent) : make const
     place_data_t                    place_m;
+
+    bool                            dirty_m;               // must be measured before the next layout
+    bool                            place_dirty_m;         // must be placed even if place_m is unchanged
+    bool                            vertical_dirty_m;      // must be measured vertically again
+    extents_t                       measured_extents_m;    // result of the last measure
+    place_data_t::slice_t           measured_horizontal_m; // horizontal place at the last measure_vertical
+    extents_t::slice_t              measured_vertical_m;   // result of the last measure_vertical
+    place_data_t                    placed_m;              // place data at the last place
     
     long                            space_before_m;      // populated from spacing_m of parent
     boost::array<long, 2>           container_length_m;  // calculated length of container
@@ -95,6 +103,7 @@ struct view_proxy_t : adobe::extents_slices_t
     
     boost::array<fr_guide_set_t, 2> container_guide_set_m;         // forward/reverse guide set for container
 
+    bool measure();
     void calculate();
     void calculate_vertical();
     void place();
@@ -210,6 +219,32 @@ bool is_with(adobe::eve_t::placement_t placement, adobe::eve_t::slice_select_t s
 
 /*************************************************************************************************/
 
+bool equal_slices(const adobe::extents_t::slice_t& x, const adobe::extents_t::slice_t& y)
+{
+    return  x.length_m == y.length_m && x.outset_m == y.outset_m && x.frame_m == y.frame_m &&
+            x.inset_m == y.inset_m && x.guide_set_m == y.guide_set_m;
+}
+
+bool equal_extents(const adobe::extents_t& x, const adobe::extents_t& y)
+{
+    return  equal_slices(x.horizontal(), y.horizontal()) &&
+            equal_slices(x.vertical(), y.vertical());
+}
+
+bool equal_slices(const adobe::place_data_t::slice_t& x, const adobe::place_data_t::slice_t& y)
+{
+    return  x.length_m == y.length_m && x.position_m == y.position_m &&
+            x.outset_m == y.outset_m && x.guide_set_m == y.guide_set_m;
+}
+
+bool equal_places(const adobe::place_data_t& x, const adobe::place_data_t& y)
+{
+    return  equal_slices(x.horizontal(), y.horizontal()) &&
+            equal_slices(x.vertical(), y.vertical());
+}
+
+/*************************************************************************************************/
+
 } // namespace
 #endif
 /*************************************************************************************************/
@@ -249,6 +284,7 @@ public:
     ~implementation_t();
 
     std::pair<long, long> evaluate(evaluate_options_t, long width, long height);
+    std::pair<long, long> update(evaluate_options_t, long width, long height);
     std::pair<long, long> adjust(evaluate_options_t options, long width, long height);
     iterator              add_placeable(iterator parent,
                                            const layout_attributes_t&  initial,
@@ -256,8 +292,10 @@ public:
                                            poly_placeable_t&           placeable, 
                                            bool                        reverse);
     void                  set_visible(iterator, bool);
+    void                  set_dirty(iterator);
 
 private:
+    bool measure();
     void solve(slice_select_t select);
     void layout(slice_select_t select, long optional_length);
     
@@ -272,6 +310,15 @@ private:
     { return adobe::preorder_range(filter_fullorder_range(proxies_m, filter_visible())); }
 
     proxy_tree_t proxies_m;
+
+    /*
+        The arguments to and result of the last layout, so that update() can skip the layout if
+        nothing has changed since.
+    */
+    bool                    layout_dirty_m;
+    evaluate_options_t      options_m;
+    std::pair<long, long>   length_m;
+    std::pair<long, long>   result_m;
 };
 
 /*************************************************************************************************/
@@ -288,6 +335,9 @@ eve_t::~eve_t()
 std::pair<long, long> eve_t::evaluate(evaluate_options_t options, long width, long height)
 { return object_m->evaluate(options, width, height); }
 
+std::pair<long, long> eve_t::update(evaluate_options_t options, long width, long height)
+{ return object_m->update(options, width, height); }
+
 std::pair<long, long> eve_t::adjust(evaluate_options_t options, long width, long height)
 { return object_m->adjust(options, width, height); }
 
@@ -301,6 +351,9 @@ eve_t::iterator eve_t::add_placeable(iterator parent,
 void eve_t::set_visible(iterator c, bool visible)
 { return object_m->set_visible(c, visible); }
 
+void eve_t::set_dirty(iterator c)
+{ return object_m->set_dirty(c); }
+
 /*************************************************************************************************/
 
 #if 0
@@ -309,7 +362,9 @@ void eve_t::set_visible(iterator c, bool visible)
 
 /*************************************************************************************************/
 
-eve_t::implementation_t::implementation_t()
+eve_t::implementation_t::implementation_t() :
+    layout_dirty_m(true),
+    options_m(evaluate_nested)
 { }
 
 /*************************************************************************************************/
@@ -340,12 +395,47 @@ eve_t::iterator eve_t::implementation_t::add_placeable(
     if (!is_container_type)
         parent->geometry_m.placement_m = place_leaf;
 
+    layout_dirty_m = true;
+
     return parent;
 }
 
 /*************************************************************************************************/
 
-void eve_t::implementation_t::set_visible(iterator c, bool visible) { c->visible_m = visible; }
+void eve_t::implementation_t::set_visible(iterator c, bool visible)
+{
+    if (c->visible_m == visible) return;
+
+    c->visible_m = visible;
+    layout_dirty_m = true;
+
+    if (!visible) return;
+
+    // Elements which were hidden may have changed unnoticed - measure them again.
+
+    iterator last(boost::next(adobe::trailing_of(c)));
+
+    for (iterator first(adobe::leading_of(c)); first != last; ++first) first->dirty_m = true;
+}
+
+/*************************************************************************************************/
+
+void eve_t::implementation_t::set_dirty(iterator c) { c->dirty_m = true; }
+
+/*************************************************************************************************/
+
+bool eve_t::implementation_t::measure()
+{
+    bool changed (false);
+
+    for (postorder_iterator first(boost::begin(postorder_range())),
+            last(boost::end(postorder_range())); first != last; ++first)
+    {
+        changed |= first->measure();
+    }
+
+    return changed;
+}
 
 /*************************************************************************************************/
 
@@ -415,6 +505,36 @@ void eve_t::implementation_t::layout(slice_select_t select, long optional_length
 
 std::pair<long, long> eve_t::implementation_t::evaluate(evaluate_options_t options, long width, long height)
 {
+    // Measure everything
+    
+    for (postorder_iterator first(boost::begin(postorder_range())),
+            last(boost::end(postorder_range())); first != last; ++first)
+    {
+        first->dirty_m = true;
+    }
+
+    measure();
+
+    // Calculate
+    
+    adobe::for_each(postorder_range(), &proxy_tree_t::value_type::calculate);
+
+    // adjust
+    
+    return adjust(options, width, height);
+}
+
+/*************************************************************************************************/
+
+std::pair<long, long> eve_t::implementation_t::update(evaluate_options_t options, long width, long height)
+{
+    // Measure only what is dirty
+    
+    bool changed (measure());
+
+    if (!changed && !layout_dirty_m && options == options_m && length_m == std::make_pair(width, height))
+        return result_m;
+
     // Calculate
     
     adobe::for_each(postorder_range(), &proxy_tree_t::value_type::calculate);
@@ -474,8 +594,13 @@ std::pair<long, long> eve_t::implementation_t::adjust(evaluate_options_t options
     
     adobe::for_each(preorder_range(), &proxy_tree_t::value_type::place);
 
-    return std::pair<long, long>(proxies_m.front().place_m.horizontal().length_m,
-                                 proxies_m.front().place_m.vertical().length_m);
+    layout_dirty_m = false;
+    options_m = options;
+    length_m = std::make_pair(width, height);
+    result_m = std::make_pair(proxies_m.front().place_m.horizontal().length_m,
+                              proxies_m.front().place_m.vertical().length_m);
+
+    return result_m;
 }
 
 /*************************************************************************************************/
@@ -504,24 +629,44 @@ struct calculate : public boost::static_visitor<>
 
 view_proxy_t::view_proxy_t( const adobe::layout_attributes_t& d,
                             poly_placeable_t& p) :
-    placeable_m(p), visible_m(true), geometry_m(d)
+    placeable_m(p), visible_m(true), geometry_m(d),
+    dirty_m(true), place_dirty_m(true), vertical_dirty_m(true)
 { }
 
 /*************************************************************************************************/
 
-void view_proxy_t::calculate()
+bool view_proxy_t::measure()
 {
+    if (!dirty_m) return false;
+
     /*
-        REVISIT (sparent) : What we want is for the data from placeable widgets to be preserved
-        unless they are explicity dirtied - rather than calling measure for every update.
-        For now, there are several bugs caused by the measuring code in widgets assuming that the
-        initial extents it is handed is a defaulted extents. Without that - some code accumulates
-        metrics into the extents giving ever increasing growth when a window is resized (as an
-        example). This fix is a hack - to just always clear the extents before measuring.
+        REVISIT (sparent) : There are several bugs caused by the measuring code in widgets assuming
+        that the initial extents it is handed is a defaulted extents. Without that - some code
+        accumulates metrics into the extents giving ever increasing growth when a window is resized
+        (as an example). So always measure into a cleared extents.
     */
-    geometry_m.extents_m = extents_t();
+    extents_t extents;
+
+    placeable_m.measure(extents);
 
-    placeable_m.measure(geometry_m.extents_m);
+    dirty_m = false;
+    place_dirty_m = true;
+    vertical_dirty_m = true;
+
+    if (equal_extents(extents, measured_extents_m)) return false;
+
+    measured_extents_m = extents;
+
+    return true;
+}
+
+/*************************************************************************************************/
+
+void view_proxy_t::calculate()
+{
+    // The data from placeable widgets is preserved unless they are explicitly dirtied.
+
+    geometry_m.extents_m = measured_extents_m;
 
     extents_t::slice_t& eslice = geometry_m.extents_m.horizontal();
     
@@ -557,10 +702,17 @@ void view_proxy_t::calculate_vertical()
 
     if(poly_placeable_twopass_t* p = poly_cast<poly_placeable_twopass_t*>(&placeable_m))
     {
+        // The vertical extents only depend on the horizontal placement.
+        if (vertical_dirty_m || !equal_slices(place_m.horizontal(), measured_horizontal_m))
+        {
  // We pass a copy of the geometry so client can't modify horizontal properties.
-       extents_t vertical_stuff(geometry_m.extents_m);
-       p->measure_vertical(vertical_stuff, place_m);
-       eslice = vertical_stuff.vertical();
+           extents_t vertical_stuff(geometry_m.extents_m);
+           p->measure_vertical(vertical_stuff, place_m);
+           measured_vertical_m = vertical_stuff.vertical();
+           measured_horizontal_m = place_m.horizontal();
+           vertical_dirty_m = false;
+        }
+        eslice = measured_vertical_m;
     }
     
     place_m.vertical().length_m = eslice.length_m;
@@ -576,7 +728,12 @@ void view_proxy_t::calculate_vertical()
 
 void view_proxy_t::place()
 {
+    if (!place_dirty_m && equal_places(place_m, placed_m)) return;
+
     placeable_m.place(place_m);
+
+    placed_m = place_m;
+    place_dirty_m = false;
 }
 
 /*************************************************************************************************/
@@ -8,8 +8,8 @@
 
 #define ADOBE_DLL_SAFE 0
 
-#include <GG/AdamParser.h>
 #include <GG/GUI.h>
+#include <GG/ParsedDefinition.h>
 #include <GG/Wnd.h>
 
 #include <GG/adobe/config.hpp>
@@ -29,55 +29,6 @@ namespace adobe {
 
 /****************************************************************************************************/
 
-std::string getline(std::istream& stream)
-{
-    std::string result;
-
-    result.reserve(128);
-
-    while (true)
-    {
-        int c(stream.get());
-
-        if (c == EOF || c == '\n')
-        {
-            break;
-        }
-        else if (c == '\r')
-        {
-            c = stream.get();
-
-            if (c != '\n')
-                stream.putback(c);
-
-            break;
-        }
-
-        result += static_cast<char>(c);
-    }
-
-    return result;
-}
-
-/****************************************************************************************************/
-
-std::string mdi_error_getline(std::istream& layout_definition, name_t, std::streampos line_start_position)
-{
-    std::streampos old_pos(layout_definition.tellg());
-
-    layout_definition.clear();
-
-    layout_definition.seekg(line_start_position);
-
-    std::string result(getline(layout_definition));
-
-    layout_definition.seekg(old_pos);
-
-    return result;
-}
-
-/****************************************************************************************************/
-
 modal_dialog_t::modal_dialog_t() :
     display_options_m(dialog_display_s),
     parent_m(platform_display_type()),
@@ -90,6 +41,26 @@ platform_display_type modal_dialog_t::init(std::istream& layout,
                                            const std::string& layout_source,
                                            std::istream& sheet,
                                            const std::string& sheet_source)
+{
+    std::string sheet_contents;
+    std::getline(sheet, sheet_contents, '\0');
+    GG::ParsedDefinition sheet_definition;
+    if (!sheet_definition.Parse(GG::ParsedDefinition::ADAM, sheet_contents, sheet_source))
+        throw std::logic_error("Adam parse failed.");
+
+    std::string layout_contents;
+    std::getline(layout, layout_contents, '\0');
+    GG::ParsedDefinition layout_definition;
+    if (!layout_definition.Parse(GG::ParsedDefinition::EVE, layout_contents, layout_source))
+        throw std::logic_error("Eve parse failed.");
+
+    return init(layout_definition, sheet_definition);
+}
+
+/****************************************************************************************************/
+
+platform_display_type modal_dialog_t::init(const GG::ParsedDefinition& layout,
+                                           const GG::ParsedDefinition& sheet)
 {
     GG::ScopedResourcePath scoped_path(working_directory_m);
 
@@ -99,13 +70,10 @@ platform_display_type modal_dialog_t::init(std::istream& layout,
     result_m = dialog_result_t();
 
     //
-    // Parse the proprty model stream
+    // Replay the property model definition into the sheet
     //
 
-    std::string sheet_contents;
-    std::getline(sheet, sheet_contents, '\0');
-    if (!GG::Parse(sheet_contents, sheet_source, bind_to_sheet(sheet_m)))
-        throw std::logic_error("Adam parse failed.");
+    sheet.Replay(bind_to_sheet(sheet_m));
 
     //
     // REVISIT (2006/09/28, fbrereto): The sheet initializers don't run until the first update().
@@ -161,12 +129,8 @@ platform_display_type modal_dialog_t::init(std::istream& layout,
     if ((display_options_m == dialog_no_display_s && need_ui_m) ||
         display_options_m == dialog_display_s)
     {
-        line_position_t::getline_proc_t getline_proc(new line_position_t::getline_proc_impl_t(boost::bind(&mdi_error_getline, boost::ref(layout), _1, _2)));
-
         view_m.reset(
             make_view(
-                layout_source,
-                getline_proc,
                 layout,
                 sheet_m,
                 root_behavior_m,
@@ -131,7 +131,7 @@ namespace {
             return adobe::any_regular_t(adobe::empty_t());
 
         std::string texture_name;
-        boost::shared_ptr<GG::Texture> texture;
+        GG::SubTexture texture;
         int x1;
         int x2;
         int y1;
@@ -141,17 +141,19 @@ namespace {
 
         if (get_value(named_argument_set, adobe::static_name_t("texture"), texture_name)) {
             try {
-                texture = GG::GUI::GetGUI()->GetTexture(texture_name);
+                texture = GG::GUI::GetGUI()->GetSubTexture(texture_name);
             } catch (...) {}
         } else {
-            get_value(named_argument_set, adobe::static_name_t("texture"), texture);
+            boost::shared_ptr<GG::Texture> whole_texture;
+            if (get_value(named_argument_set, adobe::static_name_t("texture"), whole_texture))
+                texture = GG::SubTexture(whole_texture);
         }
         all_needed_args &= get_value(named_argument_set, adobe::static_name_t("x1"), x1);
         all_needed_args &= get_value(named_argument_set, adobe::static_name_t("y1"), y1);
         all_needed_args &= get_value(named_argument_set, adobe::static_name_t("x2"), x2);
         all_needed_args &= get_value(named_argument_set, adobe::static_name_t("y2"), y2);
 
-        if (texture && all_needed_args)
+        if (!texture.Empty() && all_needed_args)
             return adobe::any_regular_t(GG::SubTexture(texture, GG::X(x1), GG::Y(y1), GG::X(x2), GG::Y(y2)));
         else
             return adobe::any_regular_t(adobe::empty_t());
@@ -6,7 +6,7 @@
 
 /*************************************************************************************************/
 
-#include <GG/EveParser.h>
+#include <GG/ParsedDefinition.h>
 
 #include <GG/adobe/adam.hpp>
 #include <GG/adobe/array.hpp>
@@ -268,7 +268,7 @@ namespace adobe {
 /*************************************************************************************************/
 
 auto_ptr<eve_client_holder> make_view(const std::string&                     stream_source,
-                                      const line_position_t::getline_proc_t& getline_proc,
+                                      const line_position_t::getline_proc_t&,
                                       std::istream&                          stream,
                                       sheet_t&                               sheet,
                                       behavior_t&                            root_behavior,
@@ -280,6 +280,39 @@ auto_ptr<eve_client_holder> make_view(const std::string&                     str
                                       size_enum_t                            dialog_size,
                                       const widget_factory_proc_t&           proc,
                                       platform_display_type                  display_root)
+{
+    std::string stream_contents;
+    std::getline(stream, stream_contents, '\0');
+    GG::ParsedDefinition layout;
+    if (!layout.Parse(GG::ParsedDefinition::EVE, stream_contents, stream_source))
+        throw std::logic_error("Eve parse failed.");
+
+    return make_view(layout,
+                     sheet,
+                     root_behavior,
+                     lookup,
+                     top_level_button_notifier,
+                     button_notifier,
+                     signal_notifier,
+                     row_factory,
+                     dialog_size,
+                     proc,
+                     display_root);
+}
+
+/*************************************************************************************************/
+
+auto_ptr<eve_client_holder> make_view(const GG::ParsedDefinition&            layout,
+                                      sheet_t&                               sheet,
+                                      behavior_t&                            root_behavior,
+                                      vm_lookup_t&                           lookup,
+                                      const button_notifier_t&               top_level_button_notifier,
+                                      const button_notifier_t&               button_notifier,
+                                      const signal_notifier_t&               signal_notifier,
+                                      const row_factory_t&                   row_factory,
+                                      size_enum_t                            dialog_size,
+                                      const widget_factory_proc_t&           proc,
+                                      platform_display_type                  display_root)
 {
     adobe::auto_ptr<eve_client_holder>  result(new eve_client_holder(root_behavior));
     factory_token_t                     token(get_main_display(),
@@ -300,19 +333,13 @@ auto_ptr<eve_client_holder> make_view(const std::string&                     str
         empty eve iterator and the given dialog size.
     */
     get_main_display().set_root(display_root);
-    std::string stream_contents;
-    std::getline(stream, stream_contents, '\0');
-    if (!GG::Parse(stream_contents,
-                   stream_source,
-                   widget_node_t(dialog_size,
-                                 eve_t::iterator(),
-                                 get_main_display().root(),
-                                 keyboard_t::iterator()),
-                   bind_layout(boost::bind(&client_assembler, boost::ref(token), _1, _2, _3, boost::cref(proc)),
-                               result->layout_sheet_m,
-                               evaluator))) {
-        throw std::logic_error("Eve parse failed.");
-    }
+    layout.Replay(widget_node_t(dialog_size,
+                                eve_t::iterator(),
+                                get_main_display().root(),
+                                keyboard_t::iterator()),
+                  bind_layout(boost::bind(&client_assembler, boost::ref(token), _1, _2, _3, boost::cref(proc)),
+                              result->layout_sheet_m,
+                              evaluator));
 
     result->contributing_m = sheet.contributing();
 
@@ -79,6 +79,7 @@ void create_widget(const dictionary_t& parameters,
 /*************************************************************************************************/
 
 void subscribe_view_to_model(image_t&                control,
+                             eve_t::iterator         eve_token,
                              name_t                  cell, 
                              basic_sheet_t*          layout_sheet,
                              sheet_t*                model_sheet,
@@ -87,7 +88,7 @@ void subscribe_view_to_model(image_t&                control,
 {
     typedef force_relayout_view_adaptor<image_t> adaptor_type;
 
-    adaptor_type* view_adaptor(new adaptor_type(control, visible_queue));
+    adaptor_type* view_adaptor(new adaptor_type(control, eve_token, visible_queue));
 
     assemblage_cleanup_ptr(assemblage, view_adaptor);
 
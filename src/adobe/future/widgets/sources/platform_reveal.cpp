@@ -29,20 +29,20 @@ namespace {
 
 GG::SubTexture default_showing_image()
 {
-    static boost::shared_ptr<GG::Texture> texture_s;
-    if (!texture_s)
-        texture_s = GG::GUI::GetGUI()->GetTexture("reveal_up.png");
-    return GG::SubTexture(texture_s);
+    static GG::SubTexture subtexture_s;
+    if (subtexture_s.Empty())
+        subtexture_s = GG::GUI::GetGUI()->GetSubTexture("reveal_up.png");
+    return subtexture_s;
 }
 
 /****************************************************************************************************/
 
 GG::SubTexture default_hidden_image()
 {
-    static boost::shared_ptr<GG::Texture> texture_s;
-    if (!texture_s)
-        texture_s = GG::GUI::GetGUI()->GetTexture("reveal_down.png");
-    return GG::SubTexture(texture_s);
+    static GG::SubTexture subtexture_s;
+    if (subtexture_s.Empty())
+        subtexture_s = GG::GUI::GetGUI()->GetSubTexture("reveal_down.png");
+    return subtexture_s;
 }
 
 /****************************************************************************************************/
@@ -200,6 +200,11 @@ bool get_subtexture(const any_regular_t& value, GG::SubTexture& subtexture)
         std::string texture_name;
         if (value.cast(texture_name)) {
             try {
+                if (GG::GetTextureManager().AtlasEnabled()) {
+                    // atlas pages are already GL_NEAREST-filtered
+                    subtexture = GG::GUI::GetGUI()->GetSubTexture(texture_name);
+                    return true;
+                }
                 texture = GG::GUI::GetGUI()->GetTexture(texture_name);
                 texture->SetFilters(GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST);
             } catch (...) {}
@@ -16,11 +16,19 @@
 
 /*************************************************************************************************/
 
-ADOBE_GLOBAL_MUTEX_DEFINITION(name_t)
+namespace {
 
 /*************************************************************************************************/
 
-namespace {
+adobe::once_flag             unique_string_flag_s = ADOBE_ONCE_INIT;
+adobe::unique_string_pool_t* unique_string_pool_s = 0;
+
+void init_unique_string_pool()
+{
+    static adobe::unique_string_pool_t unique_string_s;
+
+    unique_string_pool_s = &unique_string_s;
+}
 
 /*************************************************************************************************/
 
@@ -31,12 +39,11 @@ const char* unique_string(const char* string_name)
     static const char* empty_string_s = "";
 
     if (!string_name || !*string_name) return empty_string_s;
-    
-    ADOBE_GLOBAL_MUTEX_INSTANCE(name_t);
 
-    static adobe::unique_string_pool_t unique_string_s;
+    // The pool is safe to use from several threads; only its construction needs guarding.
+    adobe::call_once(&init_unique_string_pool, unique_string_flag_s);
 
-    return unique_string_s.add(string_name);
+    return unique_string_pool_s->add(string_name);
 }
 
 /*************************************************************************************************/
@@ -10,8 +10,12 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstring>
+#include <deque>
 #include <list>
-#include <set>
+#include <vector>
+
+#include <boost/version.hpp>
 
 #include <GG/adobe/algorithm/for_each.hpp>
 #include <GG/adobe/algorithm/copy.hpp>
@@ -19,6 +23,11 @@
 #include <GG/adobe/once.hpp>
 #include <GG/adobe/string.hpp>
 
+#if defined(BOOST_HAS_THREADS) && BOOST_VERSION >= 105300
+    #include <boost/atomic.hpp>
+    #define ADOBE_STRING_POOL_LOCK_FREE_LOOKUP
+#endif
+
 /*************************************************************************************************/
 
 namespace detail {
@@ -39,9 +48,10 @@ public:
     { adobe::for_each(pool_m, adobe::delete_ptr<char*>()); }
 
     const char* add(const char* ident)
+    { return add(ident, std::strlen(ident)); }
+
+    const char* add(const char* ident, std::size_t n)
     {
-        std::size_t n = std::strlen(ident);
-    
         char* result(allocate(n));
 
         adobe::copy_n(ident, n, result);
@@ -79,6 +89,41 @@ private:
 
 /*************************************************************************************************/
 
+/*
+    A pointer that may be read by one thread while another replaces it. Stores release and loads
+    acquire, so everything written before a pointer is stored is visible through the loaded
+    pointer. Without atomics every access must be made under a lock instead.
+*/
+
+template <typename T>
+class published_ptr_t : boost::noncopyable
+{
+public:
+    published_ptr_t() : ptr_m(0) { }
+
+#if defined(ADOBE_STRING_POOL_LOCK_FREE_LOOKUP)
+    T* load() const
+    { return ptr_m.load(boost::memory_order_acquire); }
+
+    void store(T* ptr)
+    { ptr_m.store(ptr, boost::memory_order_release); }
+
+private:
+    boost::atomic<T*> ptr_m;
+#else
+    T* load() const
+    { return ptr_m; }
+
+    void store(T* ptr)
+    { ptr_m = ptr; }
+
+private:
+    T* ptr_m;
+#endif
+};
+
+/*************************************************************************************************/
+
 } // namespace detail
 
 /*************************************************************************************************/
@@ -91,7 +136,16 @@ struct unique_string_pool_t::implementation_t
 {
 public:
     implementation_t()
-    { }
+    {
+        for (std::size_t i(0); i < shard_count_k; ++i)
+            shard_m[i].table_m.store(shard_m[i].new_table(initial_bucket_count_k));
+    }
+
+    ~implementation_t()
+    {
+        for (std::size_t i(0); i < shard_count_k; ++i)
+            adobe::for_each(shard_m[i].tables_m, adobe::delete_ptr<table_t*>());
+    }
 
     // Precondition: length only need be non-zero if not copying
     // Precondition: if str is null then length must be zero
@@ -101,22 +155,149 @@ public:
 
         if (!str || !*str) return empty_string_s;
 
-        name_store_t::iterator iter = store_m.find(str);
+        std::size_t length(0);
+        std::size_t hash(hash_string(str, length));
+        shard_t&    shard(shard_m[hash % shard_count_k]);
+
+        hash /= shard_count_k;
+
+#if defined(ADOBE_STRING_POOL_LOCK_FREE_LOOKUP)
+        // Names are almost always already interned, so look without locking first.
+        if (const char* result = find(*shard.table_m.load(), str, hash))
+            return result;
+#endif
+
+        lock_t lock(shard.mutex_m);
+
+        const table_t* table(shard.table_m.load());
+
+        if (const char* result = find(*table, str, hash))
+            return result;
+
+        if (shard.size_m >= table->bucket_count_m)
+            table = shard.grow();
+
+        const char* result(shard.pool_m.add(str, length));
 
-        if (iter == store_m.end())
+        shard.nodes_m.push_back(node_t(result, hash, table->bucket_m[hash & table->mask_m].load()));
+        table->bucket_m[hash & table->mask_m].store(&shard.nodes_m.back());
+        ++shard.size_m;
+
+        return result;
+    }
+
+private:
+    enum
+    {
+        shard_count_k = 16,
+        initial_bucket_count_k = 64
+    };
+
+#if defined(BOOST_HAS_THREADS)
+    typedef boost::mutex                mutex_t;
+    typedef boost::mutex::scoped_lock   lock_t;
+#else
+    struct mutex_t { };
+    struct lock_t { explicit lock_t(mutex_t&) { } };
+#endif
+
+    /*
+        Nodes and bucket tables are never modified once they are published, and never freed until
+        the pool is destroyed, so readers may walk them without taking a lock. Growing a shard
+        publishes a new table with new nodes; the old ones stay valid for readers still using them.
+    */
+
+    struct node_t
+    {
+        node_t(const char* str, std::size_t hash, const node_t* next) :
+            str_m(str), hash_m(hash), next_m(next)
+        { }
+
+        const char*     str_m;
+        std::size_t     hash_m;
+        const node_t*   next_m;
+    };
+
+    struct table_t : boost::noncopyable
+    {
+        explicit table_t(std::size_t bucket_count) :
+            bucket_count_m(bucket_count),
+            mask_m(bucket_count - 1),
+            bucket_m(new ::detail::published_ptr_t<const node_t>[bucket_count])
+        { }
+
+        ~table_t()
+        { delete [] bucket_m; }
+
+        std::size_t                                 bucket_count_m;
+        std::size_t                                 mask_m;
+        ::detail::published_ptr_t<const node_t>*    bucket_m;
+    };
+
+    struct shard_t : boost::noncopyable
+    {
+        shard_t() : size_m(0) { }
+
+        table_t* new_table(std::size_t bucket_count)
+        {
+            tables_m.push_back(new table_t(bucket_count));
+            return tables_m.back();
+        }
+
+        const table_t* grow()
         {
-            str = pool_m.add(str);
-            iter = store_m.insert(str).first;
+            const table_t&  old_table(*table_m.load());
+            table_t*        table(new_table(old_table.bucket_count_m * 2));
+
+            for (std::size_t i(0); i < old_table.bucket_count_m; ++i)
+            {
+                for (const node_t* node(old_table.bucket_m[i].load()); node; node = node->next_m)
+                {
+                    ::detail::published_ptr_t<const node_t>&
+                        bucket(table->bucket_m[node->hash_m & table->mask_m]);
+                    nodes_m.push_back(node_t(node->str_m, node->hash_m, bucket.load()));
+                    bucket.store(&nodes_m.back());
+                }
+            }
+
+            table_m.store(table);
+
+            return table;
         }
 
-        return *iter;
+        mutex_t                                     mutex_m;
+        ::detail::published_ptr_t<const table_t>    table_m;
+        std::size_t                                 size_m;
+        std::deque<node_t>                          nodes_m;
+        std::vector<table_t*>                       tables_m;
+        ::detail::string_pool_t                     pool_m;
+    };
+
+    static std::size_t hash_string(const char* str, std::size_t& length)
+    {
+        const char* first(str);
+        std::size_t result(2166136261u);
+
+        for (; *first; ++first)
+            result = (result ^ static_cast<unsigned char>(*first)) * 16777619u;
+
+        length = first - str;
+
+        return result;
     }
 
-private:
-    typedef std::set<const char*, str_less_t> name_store_t;
+    static const char* find(const table_t& table, const char* str, std::size_t hash)
+    {
+        for (const node_t* node(table.bucket_m[hash & table.mask_m].load()); node; node = node->next_m)
+        {
+            if (node->hash_m == hash && std::strcmp(node->str_m, str) == 0)
+                return node->str_m;
+        }
+
+        return 0;
+    }
 
-    name_store_t    store_m;
-    ::detail::string_pool_t   pool_m;
+    shard_t shard_m[shard_count_k];
 };
 
 /*************************************************************************************************/
@@ -8,12 +8,15 @@
 
 #include <boost/config.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <numeric>
 #include <typeinfo>
 #include <vector>
 
 #include <boost/iterator/transform_iterator.hpp>
+#include <boost/next_prior.hpp>
 
 #include <GG/adobe/algorithm/minmax.hpp>
 #include <GG/adobe/adam_function.hpp>
@@ -302,6 +305,39 @@ void throw_function_not_defined(adobe::name_t function_name)
 
 /*************************************************************************************************/
 
+bool is_token(const adobe::any_regular_t& value, adobe::name_t token)
+{
+    return value.type_info() == adobe::type_info<adobe::name_t>() &&
+           value.cast<adobe::name_t>() == token;
+}
+
+/*************************************************************************************************/
+
+/*
+    Constants in a compiled expression are shared only when they are identical. Doubles are
+    compared bitwise, as -0.0 == 0.0 but 1 / -0.0 != 1 / 0.0.
+*/
+struct same_constant_t
+{
+    explicit same_constant_t(const adobe::any_regular_t& value) : value_m(value) { }
+
+    bool operator()(const adobe::any_regular_t& x) const
+    {
+        if (x.type_info() == adobe::type_info<double>() &&
+            value_m.type_info() == adobe::type_info<double>())
+        {
+            double a(x.cast<double>());
+            double b(value_m.cast<double>());
+            return std::memcmp(&a, &b, sizeof(double)) == 0;
+        }
+        return x == value_m;
+    }
+
+    const adobe::any_regular_t& value_m;
+};
+
+/*************************************************************************************************/
+
 } // namespace
 
 /*************************************************************************************************/
@@ -310,12 +346,56 @@ namespace adobe {
 
 /*************************************************************************************************/
 
+struct virtual_machine_t::compiled_expression_t::implementation_t
+{
+    enum opcode_t
+    {
+        op_push_k,          // push constants_m[operand_m]
+        op_call_k,          // call operator_m
+        op_variable_k,      // push the value of the variable names_m[operand_m]
+        op_and_k,           // if the bool on top of the stack is false jump to operand_m, else pop it
+        op_or_k,            // if the bool on top of the stack is true jump to operand_m, else pop it
+        op_require_bool_k,  // throw unless the top of the stack is a bool
+        op_branch_k,        // pop the bool on top of the stack, and jump to operand_m if it is false
+        op_jump_k,          // jump to operand_m
+        op_unknown_k        // call the operator names_m[operand_m], which was not found when compiled
+    };
+
+    struct instruction_t
+    {
+        instruction_t(opcode_t opcode, std::size_t operand, operator_t oper = 0) :
+            opcode_m(opcode),
+            operator_m(oper),
+            operand_m(operand)
+        { }
+
+        opcode_t    opcode_m;
+        operator_t  operator_m;
+        std::size_t operand_m;
+    };
+
+    explicit implementation_t(const array_t& expression);
+
+    void compile(const array_t& expression);
+    std::size_t constant(const any_regular_t& value);
+    std::size_t name(name_t value);
+
+    std::vector<instruction_t>  code_m;
+    std::vector<any_regular_t>  constants_m;
+    std::vector<name_t>         names_m;
+};
+
+/*************************************************************************************************/
+
 class virtual_machine_t::implementation_t
 {
  public:
+    typedef compiled_expression_t::implementation_t compiled_t;
+
     implementation_t();
 
     void evaluate(const array_t& expression);
+    void evaluate(const compiled_t& expression);
     
     const any_regular_t& back() const;
     any_regular_t& back();
@@ -340,13 +420,17 @@ class virtual_machine_t::implementation_t
     template <template<class T> class Operator, class OperandType>
     void binary_operator();
 
+    template <typename Expression>
+    void logical_operator(const Expression& operand_exp, bool do_and);
     void logical_operator(bool do_and);
     void logical_and_operator();
     void logical_or_operator();
     void add_operator();
     void index_operator();
     void ifelse_operator();
+    void ifelse_operator(const array_t& then_exp, const array_t& else_exp);
     void variable_operator();
+    void push_variable(adobe::name_t variable);
     void function_operator();
     void array_operator();
     void dictionary_operator();
@@ -469,7 +553,24 @@ void virtual_machine_t::implementation_t::evaluate(const array_t& expression)
 {
     for(expression_t::const_iterator iter(expression.begin()); iter != expression.end(); ++iter)
     {
-        if (iter->type_info() == type_info<adobe::name_t>() && iter->cast<adobe::name_t>().c_str()[0] == '.')
+        expression_t::const_iterator next(boost::next(iter));
+
+        // The deferred operands of &&, || and ?: are evaluated where they are, rather than
+        // being copied onto the stack first.
+        if (iter->type_info() == type_info<array_t>() && next != expression.end() &&
+            (is_token(*next, and_k) || is_token(*next, or_k)))
+        {
+            logical_operator(iter->cast<array_t>(), is_token(*next, and_k));
+            iter = next;
+        }
+        else if (iter->type_info() == type_info<array_t>() && next != expression.end() &&
+                 next->type_info() == type_info<array_t>() &&
+                 boost::next(next) != expression.end() && is_token(*boost::next(next), ifelse_k))
+        {
+            ifelse_operator(iter->cast<array_t>(), next->cast<array_t>());
+            iter = boost::next(next);
+        }
+        else if (iter->type_info() == type_info<adobe::name_t>() && iter->cast<adobe::name_t>().c_str()[0] == '.')
         {
             if (iter->cast<adobe::name_t>() != parenthesized_expression_k &&
                 iter->cast<adobe::name_t>() != name_k)
@@ -484,6 +585,52 @@ void virtual_machine_t::implementation_t::evaluate(const array_t& expression)
     }
 }
     
+/*************************************************************************************************/
+
+void virtual_machine_t::implementation_t::evaluate(const compiled_t& expression)
+{
+    for (std::size_t pc(0), last(expression.code_m.size()); pc != last; )
+    {
+        const compiled_t::instruction_t& instruction(expression.code_m[pc++]);
+
+        switch (instruction.opcode_m)
+        {
+        case compiled_t::op_push_k:
+            value_stack_m.push_back(expression.constants_m[instruction.operand_m]);
+            break;
+        case compiled_t::op_call_k:
+            ((*this).*(instruction.operator_m))();
+            break;
+        case compiled_t::op_variable_k:
+            push_variable(expression.names_m[instruction.operand_m]);
+            break;
+        case compiled_t::op_and_k:
+        case compiled_t::op_or_k:
+            if (back().cast<bool>() == (instruction.opcode_m == compiled_t::op_and_k))
+                pop_back();
+            else
+                pc = instruction.operand_m;
+            break;
+        case compiled_t::op_require_bool_k:
+            if (back().type_info() != type_info<bool>()) throw std::bad_cast();
+            break;
+        case compiled_t::op_branch_k:
+        {
+            bool predicate(back().cast<bool>());
+            pop_back();
+            if (!predicate) pc = instruction.operand_m;
+            break;
+        }
+        case compiled_t::op_jump_k:
+            pc = instruction.operand_m;
+            break;
+        case compiled_t::op_unknown_k:
+            ((*this).*(find_operator(expression.names_m[instruction.operand_m])))();
+            break;
+        }
+    }
+}
+
 /*************************************************************************************************/
     
 const any_regular_t& virtual_machine_t::implementation_t::back() const
@@ -555,14 +702,10 @@ void virtual_machine_t::implementation_t::unary_operator()
 
 /*************************************************************************************************/
 
-void virtual_machine_t::implementation_t::logical_operator(bool do_and)
+template <typename Expression>
+void virtual_machine_t::implementation_t::logical_operator(const Expression& operand_exp, bool do_and)
 {
-    adobe::array_t operand_exp (back().cast<adobe::array_t>());
-    pop_back();
-    
-    any_regular_t operand1 = back();
-
-    if (operand1.cast<bool>() == do_and)
+    if (back().cast<bool>() == do_and)
     {
         pop_back();
         evaluate(operand_exp);
@@ -571,6 +714,16 @@ void virtual_machine_t::implementation_t::logical_operator(bool do_and)
 
         if (operand2.type_info() != type_info<bool>()) throw std::bad_cast();
     }
+}
+
+/*************************************************************************************************/
+
+void virtual_machine_t::implementation_t::logical_operator(bool do_and)
+{
+    adobe::array_t operand_exp (::adobe::move(back().cast<adobe::array_t>()));
+    pop_back();
+
+    logical_operator(operand_exp, do_and);
 } 
 
 /*************************************************************************************************/
@@ -596,10 +749,8 @@ void virtual_machine_t::implementation_t::add_operator()
     adobe::any_regular_t& operand1(*(iter - 2));
     adobe::any_regular_t& operand2(*(iter - 1));
 
-    std::string str1;
-    std::string str2;
-    if (operand1.cast(str1) && operand2.cast(str2)) {
-        operand1.assign(str1 + str2);
+    if (operand1.type_info() == type_info<string_t>() && operand2.type_info() == type_info<string_t>()) {
+        operand1.cast<string_t>() += operand2.cast<string_t>();
         pop_back();
     } else {
         binary_operator<std::plus, double>();
@@ -640,11 +791,19 @@ void virtual_machine_t::implementation_t::index_operator()
 
 void virtual_machine_t::implementation_t::ifelse_operator()
 {
-    adobe::array_t else_exp (back().cast<adobe::array_t>());
+    adobe::array_t else_exp (::adobe::move(back().cast<adobe::array_t>()));
     pop_back();
-    adobe::array_t then_exp (back().cast<adobe::array_t>());
+    adobe::array_t then_exp (::adobe::move(back().cast<adobe::array_t>()));
     pop_back();
-    
+
+    ifelse_operator(then_exp, else_exp);
+}
+
+/*************************************************************************************************/
+
+void virtual_machine_t::implementation_t::ifelse_operator(const array_t& then_exp,
+                                                          const array_t& else_exp)
+{
     bool            predicate(back().cast<bool>());
     pop_back();
             
@@ -658,7 +817,14 @@ void virtual_machine_t::implementation_t::variable_operator()
     adobe::name_t variable(back().cast<adobe::name_t>());
 
     pop_back();
-    
+
+    push_variable(variable);
+}
+
+/*************************************************************************************************/
+
+void virtual_machine_t::implementation_t::push_variable(adobe::name_t variable)
+{
     if (!variable_lookup_m)
         throw std::logic_error("No variable lookup installed.");
 
@@ -811,6 +977,147 @@ void virtual_machine_t::implementation_t::function_operator()
 #pragma mark -
 #endif
 
+/*************************************************************************************************/
+
+virtual_machine_t::compiled_expression_t::implementation_t::implementation_t(
+        const array_t& expression)
+{
+    ADOBE_ONCE_INSTANCE(adobe_virtual_machine);
+
+    compile(expression);
+}
+
+/*************************************************************************************************/
+
+/*
+    Appends the code for expression. Literal arrays which are the deferred operands of &&, ||
+    and ?: are compiled inline, with jumps around them, so that evaluation never copies or
+    re-reads them.
+*/
+
+void virtual_machine_t::compiled_expression_t::implementation_t::compile(const array_t& expression)
+{
+    typedef array_t::const_iterator iterator;
+
+    for (iterator first(expression.begin()), last(expression.end()); first != last; ++first)
+    {
+        iterator next(boost::next(first));
+
+        if (first->type_info() == type_info<adobe::name_t>())
+        {
+            adobe::name_t token(first->cast<adobe::name_t>());
+
+            if (token.c_str()[0] != '.')
+            {
+                if (next != last && is_token(*next, variable_k))
+                {
+                    code_m.push_back(instruction_t(op_variable_k, name(token)));
+                    ++first;
+                }
+                else
+                {
+                    code_m.push_back(instruction_t(op_push_k, constant(*first)));
+                }
+            }
+            else if (token != parenthesized_expression_k && token != name_k)
+            {
+                operator_t oper;
+
+                if ((*virtual_machine_t::implementation_t::operator_table_g)(token, oper))
+                    code_m.push_back(instruction_t(op_call_k, 0, oper));
+                else
+                    code_m.push_back(instruction_t(op_unknown_k, name(token)));
+            }
+        }
+        else if (first->type_info() == type_info<array_t>() && next != last &&
+                 (is_token(*next, and_k) || is_token(*next, or_k)))
+        {
+            std::size_t jump(code_m.size());
+
+            code_m.push_back(instruction_t(is_token(*next, and_k) ? op_and_k : op_or_k, 0));
+            compile(first->cast<array_t>());
+            code_m.push_back(instruction_t(op_require_bool_k, 0));
+            code_m[jump].operand_m = code_m.size();
+            first = next;
+        }
+        else if (first->type_info() == type_info<array_t>() && next != last &&
+                 next->type_info() == type_info<array_t>() &&
+                 boost::next(next) != last && is_token(*boost::next(next), ifelse_k))
+        {
+            std::size_t branch(code_m.size());
+
+            code_m.push_back(instruction_t(op_branch_k, 0));
+            compile(first->cast<array_t>());
+
+            std::size_t jump(code_m.size());
+
+            code_m.push_back(instruction_t(op_jump_k, 0));
+            code_m[branch].operand_m = code_m.size();
+            compile(next->cast<array_t>());
+            code_m[jump].operand_m = code_m.size();
+            first = boost::next(next);
+        }
+        else
+        {
+            code_m.push_back(instruction_t(op_push_k, constant(*first)));
+        }
+    }
+}
+
+/*************************************************************************************************/
+
+std::size_t
+virtual_machine_t::compiled_expression_t::implementation_t::constant(const any_regular_t& value)
+{
+    std::vector<any_regular_t>::iterator iter(std::find_if(constants_m.begin(), constants_m.end(),
+                                                           same_constant_t(value)));
+
+    if (iter != constants_m.end()) return iter - constants_m.begin();
+
+    constants_m.push_back(value);
+
+    return constants_m.size() - 1;
+}
+
+/*************************************************************************************************/
+
+std::size_t virtual_machine_t::compiled_expression_t::implementation_t::name(adobe::name_t value)
+{
+    std::vector<adobe::name_t>::iterator iter(std::find(names_m.begin(), names_m.end(), value));
+
+    if (iter != names_m.end()) return iter - names_m.begin();
+
+    names_m.push_back(value);
+
+    return names_m.size() - 1;
+}
+
+/*************************************************************************************************/
+
+virtual_machine_t::compiled_expression_t::compiled_expression_t()
+{
+}
+
+/*************************************************************************************************/
+
+virtual_machine_t::compiled_expression_t::compiled_expression_t(const expression_t& expression) :
+    object_m(new implementation_t(expression))
+{
+}
+
+/*************************************************************************************************/
+
+bool virtual_machine_t::compiled_expression_t::empty() const
+{
+    return !object_m || object_m->code_m.empty();
+}
+
+/*************************************************************************************************/
+
+#if 0
+#pragma mark -
+#endif
+
 /*************************************************************************************************/
 #if !defined(ADOBE_NO_DOCUMENTATION)
 
@@ -871,6 +1178,13 @@ void virtual_machine_t::evaluate(const expression_t& expression)
 {
     object_m->evaluate(expression);
 }
+
+/*************************************************************************************************/
+
+void virtual_machine_t::evaluate(const compiled_expression_t& expression)
+{
+    if (expression.object_m) object_m->evaluate(*expression.object_m);
+}
     
 /*************************************************************************************************/
     
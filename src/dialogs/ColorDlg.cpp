@@ -157,40 +157,42 @@ HSVClr::HSVClr(double h_, double s_, double v_, GLubyte a_/* = 255*/) :
 HueSaturationPicker::HueSaturationPicker(X x, Y y, X w, Y h) :
     Control(x, y, w, h, INTERACTIVE),
     m_hue(0.0),
-    m_saturation(0.0)
-{
-    const int SAMPLES = 100;
-    const double INCREMENT = 1.0 / (SAMPLES + 1);
-    const double VALUE = 1.0;
-    m_vertices.resize(SAMPLES, std::vector<std::pair<double, double> >(2 * (SAMPLES + 1)));
-    m_colors.resize(SAMPLES, std::vector<Clr>(2 * (SAMPLES + 1)));
-    for (int col = 0; col < SAMPLES; ++col) {
-        for (int row = 0; row < SAMPLES + 1; ++row) {
-            m_vertices[col][2 * row] = std::make_pair(col * INCREMENT, row * INCREMENT);
-            m_vertices[col][2 * row + 1] = std::make_pair((col + 1) * INCREMENT, row * INCREMENT);
-            m_colors[col][2 * row] = Convert(HSVClr(col * INCREMENT, 1.0 - row * INCREMENT, VALUE));
-            m_colors[col][2 * row + 1] = Convert(HSVClr((col + 1) * INCREMENT, 1.0 - row * INCREMENT, VALUE));
-        }
-    }
-}
+    m_saturation(0.0),
+    m_gradient(new RetainedGeometry)
+{}
 
 void HueSaturationPicker::Render()
 {
     Pt ul = UpperLeft(), lr = LowerRight();
     Pt size = Size();
+
+    // the gradient is built in the unit square, so it does not change when
+    // the picker is moved or resized
+    RetainedGeometry& gradient = *m_gradient;
+    if (gradient.Empty()) {
+        const int SAMPLES = 100;
+        const double INCREMENT = 1.0 / (SAMPLES + 1);
+        const double VALUE = 1.0;
+        std::vector<GLfloat> vertices(4 * (SAMPLES + 1));
+        std::vector<Clr> colors(2 * (SAMPLES + 1));
+        for (int col = 0; col < SAMPLES; ++col) {
+            for (int row = 0; row < SAMPLES + 1; ++row) {
+                vertices[4 * row + 0] = col * INCREMENT;
+                vertices[4 * row + 1] = row * INCREMENT;
+                vertices[4 * row + 2] = (col + 1) * INCREMENT;
+                vertices[4 * row + 3] = row * INCREMENT;
+                colors[2 * row] = Convert(HSVClr(col * INCREMENT, 1.0 - row * INCREMENT, VALUE));
+                colors[2 * row + 1] = Convert(HSVClr((col + 1) * INCREMENT, 1.0 - row * INCREMENT, VALUE));
+            }
+            gradient.Add(GL_QUAD_STRIP, vertices, colors);
+        }
+    }
+
     glDisable(GL_TEXTURE_2D);
     glPushMatrix();
     glTranslated(Value(ul.x), Value(ul.y), 0.0);
     glScaled(Value(size.x), Value(size.y), 1.0);
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glEnableClientState(GL_COLOR_ARRAY);
-    for (std::size_t i = 0; i < m_vertices.size(); ++i) {
-        glVertexPointer(2, GL_DOUBLE, 0, &m_vertices[i][0]);
-        glColorPointer(4, GL_UNSIGNED_BYTE, 0, &m_colors[i][0]);
-        glDrawArrays(GL_QUAD_STRIP, 0, m_vertices[i].size());
-    }
-    glDisableClientState(GL_VERTEX_ARRAY);
-    glDisableClientState(GL_COLOR_ARRAY);
+    gradient.Render();
     glPopMatrix();
     Pt color_position(static_cast<X>(ul.x + size.x * m_hue),
                       static_cast<Y>(ul.y + size.y * (1.0 - m_saturation)));
@@ -0,0 +1,44 @@
+// -*- C++ -*-
+#ifndef _HeadlessBackend_h_
+#define _HeadlessBackend_h_
+
+#include <GG/Headless/HeadlessGUI.h>
+
+
+class MinimalHeadlessGUI : public GG::HeadlessGUI
+{
+public:
+    MinimalHeadlessGUI() : 
+        HeadlessGUI(1024, 768, "GiGi (headless backend)")
+        {}
+
+    virtual void Render()
+        {
+            if (CustomRender)
+                CustomRender();
+            GUI::Render();
+        }
+
+    static boost::function<void ()> CustomInit;
+    static boost::function<void ()> CustomRender;
+
+private:
+    virtual void Initialize()
+        {
+            RenderCursor(true);
+            if (CustomInit)
+                CustomInit();
+        }
+};
+
+boost::function<void ()> MinimalHeadlessGUI::CustomInit;
+boost::function<void ()> MinimalHeadlessGUI::CustomRender;
+
+int MinimalHeadlessMain()
+{
+    MinimalHeadlessGUI gui;
+    gui();
+    return 0;
+}
+
+#endif
@@ -0,0 +1,214 @@
+#include <GG/AdamParser.h>
+
+#include <GG/adobe/adam.hpp>
+#include <GG/adobe/adam_evaluate.hpp>
+#include <GG/adobe/dictionary.hpp>
+
+#include <boost/bind.hpp>
+
+#include <iostream>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include "TestingUtils.h"
+
+
+const char* g_input_file = 0;
+
+namespace {
+
+    struct Names
+    {
+        std::vector<adobe::name_t> m_interface;
+        std::vector<adobe::name_t> m_monitored;
+    };
+
+    struct AddCell
+    {
+        AddCell(const adobe::adam_callback_suite_t::add_cell_proc_t& proc, Names& names) :
+            m_proc(proc),
+            m_names(names)
+            {}
+
+        void operator()(adobe::adam_callback_suite_t::cell_type_t type,
+                        adobe::name_t cell_name,
+                        const adobe::line_position_t& position,
+                        const adobe::array_t& expr_or_init,
+                        const std::string& brief,
+                        const std::string& detailed)
+        {
+            m_proc(type, cell_name, position, expr_or_init, brief, detailed);
+            if (type == adobe::adam_callback_suite_t::output_k)
+                m_names.m_monitored.push_back(cell_name);
+        }
+
+        adobe::adam_callback_suite_t::add_cell_proc_t m_proc;
+        Names& m_names;
+    };
+
+    struct AddInterface
+    {
+        AddInterface(const adobe::adam_callback_suite_t::add_interface_proc_t& proc, Names& names) :
+            m_proc(proc),
+            m_names(names)
+            {}
+
+        void operator()(adobe::name_t cell_name,
+                        bool linked,
+                        const adobe::line_position_t& position1,
+                        const adobe::array_t& initializer,
+                        const adobe::line_position_t& position2,
+                        const adobe::array_t& expression,
+                        const std::string& brief,
+                        const std::string& detailed)
+        {
+            m_proc(cell_name, linked, position1, initializer, position2, expression, brief, detailed);
+            m_names.m_interface.push_back(cell_name);
+            m_names.m_monitored.push_back(cell_name);
+        }
+
+        adobe::adam_callback_suite_t::add_interface_proc_t m_proc;
+        Names& m_names;
+    };
+
+    void StoreValue(adobe::dictionary_t& values, adobe::name_t name, const adobe::any_regular_t& value)
+    { values[name] = value; }
+
+    /** Parses the sheet in \a file_contents into \a sheet, recording the
+        names of its interface and output cells in \a names. */
+    bool LoadSheet(const std::string& file_contents, adobe::sheet_t& sheet, Names& names)
+    {
+        sheet.machine_m.set_variable_lookup(boost::bind(&adobe::sheet_t::get, &sheet, _1));
+        adobe::adam_callback_suite_t callbacks(adobe::bind_to_sheet(sheet));
+        callbacks.add_cell_proc_m = AddCell(callbacks.add_cell_proc_m, names);
+        callbacks.add_interface_proc_m = AddInterface(callbacks.add_interface_proc_m, names);
+        return GG::Parse(file_contents, g_input_file, callbacks);
+    }
+
+    /** Updates \a sheet and returns the values of the cells in \a names
+        and the contributing cells, or an empty dictionary if the update
+        throws.  The cells are monitored, storing their values in \a
+        values, after the first update. */
+    adobe::dictionary_t Update(adobe::sheet_t& sheet, const Names& names, adobe::dictionary_t& values,
+                               bool& threw)
+    {
+        adobe::dictionary_t retval;
+        threw = false;
+        try {
+            sheet.update();
+            if (values.empty()) {
+                for (std::size_t i = 0; i < names.m_monitored.size(); ++i) {
+                    adobe::name_t name = names.m_monitored[i];
+                    sheet.monitor_value(name, boost::bind(&StoreValue, boost::ref(values), name, _1));
+                }
+            }
+            retval[adobe::name_t("values")] = adobe::any_regular_t(values);
+            retval[adobe::name_t("contributing")] =
+                adobe::any_regular_t(sheet.contributing(adobe::dictionary_t()));
+        } catch (const std::exception& e) {
+            threw = true;
+        }
+        return retval;
+    }
+
+    /** Returns a value different from each bool and number among the
+        interface cells' current \a values. */
+    adobe::dictionary_t ChangedInterfaceValues(const Names& names, const adobe::dictionary_t& values)
+    {
+        adobe::dictionary_t retval;
+        for (std::size_t i = 0; i < names.m_interface.size(); ++i) {
+            adobe::name_t name = names.m_interface[i];
+            adobe::dictionary_t::const_iterator it = values.find(name);
+            if (it == values.end())
+                continue;
+            bool b;
+            double d;
+            if (it->second.cast(b))
+                retval[name] = adobe::any_regular_t(!b);
+            else if (it->second.cast(d))
+                retval[name] = adobe::any_regular_t(d + 1.0);
+        }
+        return retval;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE( adam_parallel_update )
+{
+    std::string file_contents = read_file(g_input_file);
+
+    std::cout << "filename: " << g_input_file << '\n';
+
+    adobe::sheet_t serial_sheet;
+    Names serial_names;
+    adobe::dictionary_t serial_values;
+
+    adobe::sheet_t parallel_sheet;
+    parallel_sheet.set_parallel_update(4);
+    Names parallel_names;
+    adobe::dictionary_t parallel_values;
+
+    bool serial_loaded = LoadSheet(file_contents, serial_sheet, serial_names);
+    bool parallel_loaded = LoadSheet(file_contents, parallel_sheet, parallel_names);
+    BOOST_REQUIRE_EQUAL(serial_loaded, parallel_loaded);
+    if (!serial_loaded)
+        return;
+
+    bool serial_threw;
+    bool parallel_threw;
+    adobe::dictionary_t serial_result = Update(serial_sheet, serial_names, serial_values, serial_threw);
+    adobe::dictionary_t parallel_result = Update(parallel_sheet, parallel_names, parallel_values, parallel_threw);
+    BOOST_CHECK_EQUAL(serial_threw, parallel_threw);
+    BOOST_CHECK(serial_result == parallel_result);
+    if (serial_threw || parallel_threw)
+        return;
+
+    adobe::dictionary_t changes = ChangedInterfaceValues(serial_names, serial_values);
+    serial_sheet.set(changes);
+    parallel_sheet.set(changes);
+    serial_result = Update(serial_sheet, serial_names, serial_values, serial_threw);
+    parallel_result = Update(parallel_sheet, parallel_names, parallel_values, parallel_threw);
+    BOOST_CHECK_EQUAL(serial_threw, parallel_threw);
+    BOOST_CHECK(serial_result == parallel_result);
+
+    if (!(serial_result == parallel_result)) {
+        std::cout << "serial:\n";
+        verbose_dump(serial_result);
+        std::cout << "parallel:\n";
+        verbose_dump(parallel_result);
+    }
+}
+
+// Most of this is boilerplate cut-and-pasted from Boost.Test.  We need to
+// select which test(s) to do, so we can't use it here unmodified.
+
+#ifdef BOOST_TEST_ALTERNATIVE_INIT_API
+bool init_unit_test()                   {
+#else
+::boost::unit_test::test_suite*
+init_unit_test_suite( int, char* [] )   {
+#endif
+
+#ifdef BOOST_TEST_MODULE
+    using namespace ::boost::unit_test;
+    assign_op( framework::master_test_suite().p_name.value, BOOST_TEST_STRINGIZE( BOOST_TEST_MODULE ).trim( "\"" ), 0 );
+
+#endif
+
+#ifdef BOOST_TEST_ALTERNATIVE_INIT_API
+    return true;
+}
+#else
+    return 0;
+}
+#endif
+
+int BOOST_TEST_CALL_DECL
+main( int argc, char* argv[] )
+{
+    g_input_file = argv[1];
+    return ::boost::unit_test::unit_test_main( &init_unit_test, argc, argv );
+}
@@ -2,6 +2,8 @@
 
 #if USE_SDL_BACKEND
 #include "SDLBackend.h"
+#elif USE_HEADLESS_BACKEND
+#include "HeadlessBackend.h"
 #else
 #include "OgreBackend.h"
 #endif
@@ -232,6 +234,8 @@ BOOST_AUTO_TEST_CASE( adam_writer )
 {
 #if USE_SDL_BACKEND
     MinimalSDLGUI gui;
+#elif USE_HEADLESS_BACKEND
+    MinimalHeadlessGUI gui;
 #else
     MinimalOgreGUI gui;
 #endif
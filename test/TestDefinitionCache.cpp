@@ -0,0 +1,198 @@
+#include <GG/DefinitionCache.h>
+
+#include <GG/adobe/array.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include "TestingUtils.h"
+
+
+const char* g_input_file = 0;
+
+namespace {
+
+    const char* TEMP_FILE = "definition_cache_test.adm";
+
+    /** Empties the cache and its statistics, and restores its capacity,
+        before and after each test. */
+    struct CacheFixture
+    {
+        CacheFixture()
+            { Reset(); }
+        ~CacheFixture()
+            {
+                Reset();
+                boost::filesystem::remove(TEMP_FILE);
+            }
+        void Reset()
+            {
+                GG::GetDefinitionCache().SetCapacity(GG::DefinitionCache::DEFAULT_CAPACITY);
+                GG::GetDefinitionCache().Clear();
+                GG::GetDefinitionCache().ResetStatistics();
+            }
+    };
+
+    GG::ParsedDefinition GetFromString(const std::string& contents, const std::string& filename)
+    {
+        std::istringstream is(contents, std::ios::in | std::ios::binary);
+        return GG::GetDefinitionCache().Get(is, filename, GG::ParsedDefinition::ADAM);
+    }
+
+    void WriteFile(const std::string& contents)
+    {
+        std::ofstream ofs(TEMP_FILE, std::ios::out | std::ios::binary);
+        ofs << contents;
+    }
+
+    void CheckStatistics(std::size_t hits, std::size_t misses, std::size_t evictions, std::size_t entries)
+    {
+        GG::DefinitionCache::Statistics statistics = GG::GetDefinitionCache().GetStatistics();
+        BOOST_CHECK_EQUAL(statistics.m_hits, hits);
+        BOOST_CHECK_EQUAL(statistics.m_misses, misses);
+        BOOST_CHECK_EQUAL(statistics.m_evictions, evictions);
+        BOOST_CHECK_EQUAL(statistics.m_entries, entries);
+    }
+
+}
+
+BOOST_FIXTURE_TEST_CASE( stream_hits_and_misses, CacheFixture )
+{
+    std::string contents = read_file(g_input_file);
+
+    GG::ParsedDefinition first = GetFromString(contents, g_input_file);
+    CheckStatistics(0, 1, 0, 1);
+
+    GG::ParsedDefinition second = GetFromString(contents, g_input_file);
+    CheckStatistics(1, 1, 0, 1);
+    BOOST_CHECK(first.Records() == second.Records());
+
+    // the same contents under another filename, and changed contents under
+    // the same filename, are both misses
+    GetFromString(contents, "other.adm");
+    CheckStatistics(1, 2, 0, 2);
+    GetFromString(contents + "\n", g_input_file);
+    CheckStatistics(1, 3, 0, 3);
+}
+
+BOOST_FIXTURE_TEST_CASE( lru_eviction, CacheFixture )
+{
+    std::string contents = read_file(g_input_file);
+
+    GG::GetDefinitionCache().SetCapacity(2);
+    GetFromString(contents, "a.adm");
+    GetFromString(contents, "b.adm");
+    GetFromString(contents, "a.adm"); // a is now the most recently used
+    CheckStatistics(1, 2, 0, 2);
+
+    GetFromString(contents, "c.adm"); // evicts b
+    CheckStatistics(1, 3, 1, 2);
+
+    GetFromString(contents, "a.adm");
+    CheckStatistics(2, 3, 1, 2);
+    GetFromString(contents, "b.adm"); // evicts c
+    CheckStatistics(2, 4, 2, 2);
+
+    GG::GetDefinitionCache().SetCapacity(1); // evicts a
+    CheckStatistics(2, 4, 3, 1);
+    GetFromString(contents, "b.adm");
+    CheckStatistics(3, 4, 3, 1);
+}
+
+BOOST_FIXTURE_TEST_CASE( zero_capacity, CacheFixture )
+{
+    std::string contents = read_file(g_input_file);
+
+    GetFromString(contents, g_input_file);
+    GG::GetDefinitionCache().SetCapacity(0);
+    CheckStatistics(0, 1, 1, 0);
+
+    GG::ParsedDefinition first = GetFromString(contents, g_input_file);
+    GG::ParsedDefinition second = GetFromString(contents, g_input_file);
+    CheckStatistics(0, 3, 1, 0);
+    BOOST_CHECK(first.Records() == second.Records());
+}
+
+BOOST_FIXTURE_TEST_CASE( file_reload, CacheFixture )
+{
+    std::string contents = read_file(g_input_file);
+
+    WriteFile(contents);
+    GG::GetDefinitionCache().Get(TEMP_FILE, GG::ParsedDefinition::ADAM);
+    GG::GetDefinitionCache().Get(TEMP_FILE, GG::ParsedDefinition::ADAM);
+    CheckStatistics(1, 1, 0, 1);
+
+    // a change in size is reloaded, even within the resolution of the
+    // modification time
+    WriteFile(contents + "\n");
+    GG::GetDefinitionCache().Get(TEMP_FILE, GG::ParsedDefinition::ADAM);
+    CheckStatistics(1, 2, 0, 1);
+
+    // as is a change in modification time alone
+    boost::filesystem::last_write_time(TEMP_FILE, boost::filesystem::last_write_time(TEMP_FILE) + 60);
+    GG::GetDefinitionCache().Get(TEMP_FILE, GG::ParsedDefinition::ADAM);
+    CheckStatistics(1, 3, 0, 1);
+
+    GG::GetDefinitionCache().Get(TEMP_FILE, GG::ParsedDefinition::ADAM);
+    CheckStatistics(2, 3, 0, 1);
+}
+
+BOOST_FIXTURE_TEST_CASE( precompiled_stream, CacheFixture )
+{
+    GG::ParsedDefinition parsed;
+    BOOST_REQUIRE(parsed.Parse(GG::ParsedDefinition::ADAM, read_file(g_input_file), g_input_file));
+
+    std::ostringstream os(std::ios::out | std::ios::binary);
+    parsed.Write(os);
+    std::string precompiled = os.str();
+    BOOST_REQUIRE(GG::ParsedDefinition::IsPrecompiled(precompiled.data(), precompiled.size()));
+
+    // the whole stream is read, including any NUL bytes
+    GG::ParsedDefinition first = GetFromString(precompiled, g_input_file);
+    BOOST_CHECK(first.Records() == parsed.Records());
+
+    GG::ParsedDefinition second = GetFromString(precompiled, g_input_file);
+    BOOST_CHECK(second.Records() == parsed.Records());
+    CheckStatistics(1, 1, 0, 1);
+
+    std::istringstream is(precompiled, std::ios::in | std::ios::binary);
+    BOOST_CHECK_THROW(GG::GetDefinitionCache().Get(is, "other.eve", GG::ParsedDefinition::EVE),
+                      std::runtime_error);
+}
+
+// Most of this is boilerplate cut-and-pasted from Boost.Test.  We need to
+// select which test(s) to do, so we can't use it here unmodified.
+
+#ifdef BOOST_TEST_ALTERNATIVE_INIT_API
+bool init_unit_test()                   {
+#else
+::boost::unit_test::test_suite*
+init_unit_test_suite( int, char* [] )   {
+#endif
+
+#ifdef BOOST_TEST_MODULE
+    using namespace ::boost::unit_test;
+    assign_op( framework::master_test_suite().p_name.value, BOOST_TEST_STRINGIZE( BOOST_TEST_MODULE ).trim( "\"" ), 0 );
+
+#endif
+
+#ifdef BOOST_TEST_ALTERNATIVE_INIT_API
+    return true;
+}
+#else
+    return 0;
+}
+#endif
+
+int BOOST_TEST_CALL_DECL
+main( int argc, char* argv[] )
+{
+    g_input_file = argv[1];
+    return ::boost::unit_test::unit_test_main( &init_unit_test, argc, argv );
+}
@@ -0,0 +1,301 @@
+#include <GG/adobe/eve.hpp>
+#include <GG/adobe/poly_placeable.hpp>
+#include <GG/adobe/future/widgets/headers/visible_change_queue.hpp>
+
+#include <boost/cstdint.hpp>
+
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE EveIncrementalLayout
+
+#include <boost/test/unit_test.hpp>
+
+
+// Checks that eve_t::update() places every view where eve_t::evaluate()
+// does.  Two copies of each random forest of views are laid out side by
+// side, through random show/hide, content and resize steps; one copy
+// measures only what it is told has changed, and the other measures
+// everything, every time.  Also checks that views marked dirty through a
+// visible_change_queue_t are measured once, by the queue's next update.
+
+namespace {
+
+    const std::size_t NUM_FORESTS = 400;
+    const std::size_t NUM_STEPS = 40;
+    const int MAX_DEPTH = 3;
+
+    /** A linear congruential generator, so that the forests are the same
+        on every platform. */
+    struct Random
+    {
+        Random(unsigned int seed) :
+            m_state(seed * 2654435761u + 1)
+            {}
+
+        std::size_t operator()(std::size_t n)
+            {
+                m_state = m_state * 1664525u + 1013904223u;
+                return (m_state >> 16) % n;
+            }
+
+        boost::uint32_t m_state;
+    };
+
+    /** A view of a fixed size, optionally with a guide, whose height
+        optionally depends on its placed width. */
+    struct Leaf
+    {
+        Leaf() :
+            m_width(0),
+            m_height(0),
+            m_guide(-1),
+            m_twopass(false),
+            m_measures(0)
+            {}
+
+        void measure(adobe::extents_t& result)
+            {
+                ++m_measures;
+                result.width() = m_width;
+                result.height() = m_twopass ? 0 : m_height;
+                if (0 <= m_guide) {
+                    result.horizontal().guide_set_m.push_back(m_guide);
+                    result.vertical().guide_set_m.push_back(m_guide / 2);
+                }
+            }
+
+        void measure_vertical(adobe::extents_t& result, const adobe::place_data_t& place_data)
+            {
+                long width = place_data.horizontal().length_m ? place_data.horizontal().length_m : 1;
+                result.height() = (m_width * m_height + width - 1) / width;
+            }
+
+        void place(const adobe::place_data_t& place_data)
+            { m_place = place_data; }
+
+        long                 m_width;
+        long                 m_height;
+        long                 m_guide;
+        bool                 m_twopass;
+        std::size_t          m_measures;
+        adobe::place_data_t  m_place;
+    };
+
+    /** A random forest of views in an eve_t; the same seed always gives
+        the same forest. */
+    struct Forest
+    {
+        Forest(unsigned int seed) :
+            m_random(seed)
+            {
+                adobe::layout_attributes_t root;
+                root.placement_m = adobe::layout_attributes_t::place_column;
+                Add(adobe::eve_t::iterator(), root, true, new Leaf);
+                Build(m_nodes.back(), 0);
+            }
+
+        ~Forest()
+            {
+                for (std::size_t i = 0; i < m_placeables.size(); ++i) {
+                    delete m_placeables[i];
+                }
+                for (std::size_t i = 0; i < m_twopass_placeables.size(); ++i) {
+                    delete m_twopass_placeables[i];
+                }
+                for (std::size_t i = 0; i < m_leaves.size(); ++i) {
+                    delete m_leaves[i];
+                }
+            }
+
+        adobe::layout_attributes_t::alignment_t RandomAlignment()
+            {
+                static const adobe::layout_attributes_t::alignment_t ALIGNMENTS[] = {
+                    adobe::layout_attributes_t::align_forward,
+                    adobe::layout_attributes_t::align_center,
+                    adobe::layout_attributes_t::align_proportional,
+                    adobe::layout_attributes_t::align_fill
+                };
+                return ALIGNMENTS[m_random(sizeof(ALIGNMENTS) / sizeof(ALIGNMENTS[0]))];
+            }
+
+        void Add(adobe::eve_t::iterator parent, const adobe::layout_attributes_t& attributes,
+                 bool is_container, Leaf* leaf)
+            {
+                adobe::poly_placeable_t* placeable = 0;
+                if (leaf->m_twopass) {
+                    m_twopass_placeables.push_back(new adobe::poly_placeable_twopass_t(leaf));
+                    placeable = &adobe::poly_cast<adobe::poly_placeable_t&>(*m_twopass_placeables.back());
+                } else {
+                    m_placeables.push_back(new adobe::poly_placeable_t(leaf));
+                    placeable = m_placeables.back();
+                }
+                m_leaves.push_back(leaf);
+                m_nodes.push_back(m_eve.add_placeable(parent, attributes, is_container, *placeable));
+            }
+
+        void Build(adobe::eve_t::iterator parent, int depth)
+            {
+                std::size_t children = 1 + m_random(4);
+                for (std::size_t i = 0; i < children; ++i) {
+                    adobe::layout_attributes_t attributes;
+                    bool is_container = depth < MAX_DEPTH && m_random(3) == 0;
+                    if (is_container) {
+                        static const adobe::layout_attributes_t::placement_t PLACEMENTS[] = {
+                            adobe::layout_attributes_t::place_column,
+                            adobe::layout_attributes_t::place_row,
+                            adobe::layout_attributes_t::place_overlay
+                        };
+                        attributes.placement_m = PLACEMENTS[m_random(3)];
+                        attributes.slice_m[adobe::extents_slices_t::horizontal].margin_m.first = m_random(5);
+                        attributes.slice_m[adobe::extents_slices_t::vertical].margin_m.second = m_random(5);
+                        attributes.slice_m[adobe::extents_slices_t::horizontal].child_alignment_m = RandomAlignment();
+                        attributes.slice_m[adobe::extents_slices_t::vertical].child_alignment_m = RandomAlignment();
+                    }
+                    if (m_random(3) == 0)
+                        attributes.slice_m[adobe::extents_slices_t::horizontal].alignment_m = RandomAlignment();
+                    if (m_random(3) == 0)
+                        attributes.slice_m[adobe::extents_slices_t::vertical].alignment_m = RandomAlignment();
+
+                    Leaf* leaf = new Leaf;
+                    leaf->m_width = 5 + m_random(80);
+                    leaf->m_height = 5 + m_random(30);
+                    if (!is_container && m_random(4) == 0)
+                        leaf->m_guide = m_random(leaf->m_width);
+                    leaf->m_twopass = !is_container && m_random(5) == 0;
+
+                    Add(parent, attributes, is_container, leaf);
+
+                    if (is_container) {
+                        if (m_random(2) == 0)
+                            m_optional.push_back(m_nodes.size() - 1);
+                        Build(m_nodes.back(), depth + 1);
+                    }
+                }
+            }
+
+        std::size_t Measures() const
+            {
+                std::size_t retval = 0;
+                for (std::size_t i = 0; i < m_leaves.size(); ++i) {
+                    retval += m_leaves[i]->m_measures;
+                }
+                return retval;
+            }
+
+        Random                                        m_random;
+        adobe::eve_t                                  m_eve;
+        std::vector<Leaf*>                            m_leaves;
+        std::vector<adobe::poly_placeable_t*>         m_placeables;
+        std::vector<adobe::poly_placeable_twopass_t*> m_twopass_placeables;
+        std::vector<adobe::eve_t::iterator>           m_nodes;
+        std::vector<std::size_t>                      m_optional; // indices of the containers that are shown and hidden
+    };
+
+    bool EqualSlices(const adobe::place_data_t::slice_t& lhs, const adobe::place_data_t::slice_t& rhs)
+    {
+        return lhs.length_m == rhs.length_m && lhs.position_m == rhs.position_m &&
+            lhs.outset_m == rhs.outset_m && lhs.guide_set_m == rhs.guide_set_m;
+    }
+
+    void CheckSamePlaces(const Forest& incremental, const Forest& full, unsigned int seed, std::size_t step)
+    {
+        for (std::size_t i = 0; i < full.m_leaves.size(); ++i) {
+            const adobe::place_data_t& lhs = incremental.m_leaves[i]->m_place;
+            const adobe::place_data_t& rhs = full.m_leaves[i]->m_place;
+            BOOST_CHECK_MESSAGE(EqualSlices(lhs.horizontal(), rhs.horizontal()) &&
+                                EqualSlices(lhs.vertical(), rhs.vertical()),
+                                "forest " << seed << ", step " << step << ", view " << i);
+        }
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE( update_matches_evaluate )
+{
+    std::size_t incremental_measures = 0;
+    std::size_t full_measures = 0;
+
+    for (unsigned int seed = 0; seed < NUM_FORESTS; ++seed) {
+        Forest incremental(seed);
+        Forest full(seed);
+        BOOST_REQUIRE_EQUAL(incremental.m_leaves.size(), full.m_leaves.size());
+
+        BOOST_CHECK(incremental.m_eve.update(adobe::eve_t::evaluate_nested) ==
+                    full.m_eve.evaluate(adobe::eve_t::evaluate_nested));
+        CheckSamePlaces(incremental, full, seed, 0);
+
+        std::vector<bool> visible(full.m_optional.size(), true);
+        Random choose(seed + NUM_FORESTS);
+        for (std::size_t step = 1; step <= NUM_STEPS; ++step) {
+            std::pair<long, long> incremental_result;
+            std::pair<long, long> full_result;
+            std::size_t operation = choose(3);
+            if (operation == 0 && !full.m_optional.empty()) {
+                std::size_t i = choose(full.m_optional.size());
+                visible[i] = !visible[i];
+                incremental.m_eve.set_visible(incremental.m_nodes[full.m_optional[i]], visible[i]);
+                full.m_eve.set_visible(full.m_nodes[full.m_optional[i]], visible[i]);
+                incremental_result = incremental.m_eve.update(adobe::eve_t::evaluate_nested);
+                full_result = full.m_eve.evaluate(adobe::eve_t::evaluate_nested);
+            } else if (operation == 1) {
+                std::size_t i = 1 + choose(full.m_leaves.size() - 1);
+                if (choose(2)) {
+                    long width = 5 + choose(80);
+                    incremental.m_leaves[i]->m_width = width;
+                    full.m_leaves[i]->m_width = width;
+                }
+                incremental.m_eve.set_dirty(incremental.m_nodes[i]);
+                incremental_result = incremental.m_eve.update(adobe::eve_t::evaluate_nested);
+                full_result = full.m_eve.evaluate(adobe::eve_t::evaluate_nested);
+            } else {
+                long width = 400 + choose(200);
+                long height = 600 + choose(200);
+                incremental_result = incremental.m_eve.adjust(adobe::eve_t::evaluate_nested, width, height);
+                full_result = full.m_eve.adjust(adobe::eve_t::evaluate_nested, width, height);
+            }
+            BOOST_CHECK_MESSAGE(incremental_result == full_result,
+                                "forest " << seed << ", step " << step);
+            CheckSamePlaces(incremental, full, seed, step);
+        }
+
+        incremental_measures += incremental.Measures();
+        full_measures += full.Measures();
+    }
+
+    // update() should have measured no more often than evaluate()
+    BOOST_CHECK_LE(incremental_measures, full_measures);
+}
+
+BOOST_AUTO_TEST_CASE( queue_defers_dirty_views )
+{
+    Forest forest(0);
+    adobe::visible_change_queue_t queue(forest.m_eve);
+    queue.force_m = true;
+    queue.update();
+
+    std::vector<std::size_t> measures_before(forest.m_leaves.size());
+    for (std::size_t i = 0; i < forest.m_leaves.size(); ++i) {
+        measures_before[i] = forest.m_leaves[i]->m_measures;
+    }
+
+    // marking views dirty measures nothing until the queue is updated
+    const std::size_t first = 1;
+    const std::size_t last = forest.m_leaves.size() - 1;
+    queue.set_dirty(forest.m_nodes[first]);
+    queue.set_dirty(forest.m_nodes[last]);
+    queue.set_dirty(forest.m_nodes[first]);
+    for (std::size_t i = 0; i < forest.m_leaves.size(); ++i) {
+        BOOST_CHECK_EQUAL(forest.m_leaves[i]->m_measures, measures_before[i]);
+    }
+
+    // a single update measures each dirty view once
+    queue.update();
+    BOOST_CHECK_EQUAL(forest.m_leaves[first]->m_measures, measures_before[first] + 1);
+    BOOST_CHECK_EQUAL(forest.m_leaves[last]->m_measures, measures_before[last] + 1);
+
+    // and an update with nothing dirty measures nothing
+    std::size_t measures = forest.Measures();
+    queue.update();
+    BOOST_CHECK_EQUAL(forest.Measures(), measures);
+}
@@ -1,5 +1,7 @@
 #if USE_SDL_BACKEND
 #include "SDLBackend.h"
+#elif USE_HEADLESS_BACKEND
+#include "HeadlessBackend.h"
 #else
 #include "OgreBackend.h"
 #endif
@@ -416,6 +418,9 @@ BOOST_AUTO_TEST_CASE( eve_layout )
 #if USE_SDL_BACKEND
     MinimalSDLGUI::CustomInit = &CustomInit;
     MinimalSDLMain();
+#elif USE_HEADLESS_BACKEND
+    MinimalHeadlessGUI::CustomInit = &CustomInit;
+    MinimalHeadlessMain();
 #else
     MinimalOgreGUI::CustomInit = &CustomInit;
     MinimalOgreMain();
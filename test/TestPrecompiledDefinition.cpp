@@ -0,0 +1,274 @@
+#include <GG/AdamParser.h>
+#include <GG/EveParser.h>
+#include <GG/ParsedDefinition.h>
+
+#include <GG/adobe/adam_parser.hpp>
+#include <GG/adobe/array.hpp>
+#include <GG/adobe/eve_parser.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include "TestingUtils.h"
+
+
+const char* g_input_file = 0;
+
+namespace {
+
+    // These record the arguments of each callback the parser (or a replay)
+    // makes, including positions, so that a replay can be compared with a
+    // direct parse.
+
+    void push_back_position(adobe::array_t& array, const adobe::line_position_t& position)
+    {
+        push_back(array, position.stream_name());
+        push_back(array, position.line_number_m);
+        push_back(array, std::size_t(position.line_start_m));
+        push_back(array, std::size_t(position.position_m));
+    }
+
+    void add_adam_cell(adobe::array_t& array,
+                       adobe::adam_callback_suite_t::cell_type_t type,
+                       adobe::name_t cell_name,
+                       const adobe::line_position_t& position,
+                       const adobe::array_t& expr_or_init,
+                       const std::string& brief,
+                       const std::string& detailed)
+    {
+        push_back(array, std::size_t(type));
+        push_back(array, cell_name);
+        push_back_position(array, position);
+        push_back(array, expr_or_init);
+        push_back(array, brief);
+        push_back(array, detailed);
+    }
+
+    void add_adam_relation(adobe::array_t& array,
+                           const adobe::line_position_t& position,
+                           const adobe::array_t& conditional,
+                           const adobe::adam_callback_suite_t::relation_t* first,
+                           const adobe::adam_callback_suite_t::relation_t* last,
+                           const std::string& brief,
+                           const std::string& detailed)
+    {
+        push_back_position(array, position);
+        push_back(array, conditional);
+        for (; first != last; ++first) {
+            push_back(array, first->name_m);
+            push_back_position(array, first->position_m);
+            push_back(array, first->expression_m);
+            push_back(array, first->detailed_m);
+            push_back(array, first->brief_m);
+        }
+        push_back(array, brief);
+        push_back(array, detailed);
+    }
+
+    void add_adam_interface(adobe::array_t& array,
+                            adobe::name_t cell_name,
+                            bool linked,
+                            const adobe::line_position_t& position1,
+                            const adobe::array_t& initializer,
+                            const adobe::line_position_t& position2,
+                            const adobe::array_t& expression,
+                            const std::string& brief,
+                            const std::string& detailed)
+    {
+        push_back(array, cell_name);
+        push_back(array, linked);
+        push_back_position(array, position1);
+        push_back(array, initializer);
+        push_back_position(array, position2);
+        push_back(array, expression);
+        push_back(array, brief);
+        push_back(array, detailed);
+    }
+
+    boost::any add_eve_view(adobe::array_t& array,
+                            const boost::any& parent,
+                            const adobe::line_position_t& position,
+                            adobe::name_t name,
+                            const adobe::array_t& parameters,
+                            const std::string& brief,
+                            const std::string& detailed)
+    {
+        push_back(array, parent.empty() ? std::size_t(0) : boost::any_cast<std::size_t>(parent));
+        push_back_position(array, position);
+        push_back(array, name);
+        push_back(array, parameters);
+        push_back(array, brief);
+        push_back(array, detailed);
+        return boost::any(array.size());
+    }
+
+    void add_eve_cell(adobe::array_t& array,
+                      adobe::eve_callback_suite_t::cell_type_t type,
+                      adobe::name_t name,
+                      const adobe::line_position_t& position,
+                      const adobe::array_t& initializer,
+                      const std::string& brief,
+                      const std::string& detailed)
+    {
+        push_back(array, std::size_t(type));
+        push_back(array, name);
+        push_back_position(array, position);
+        push_back(array, initializer);
+        push_back(array, brief);
+        push_back(array, detailed);
+    }
+
+    adobe::adam_callback_suite_t adam_callbacks(adobe::array_t& array)
+    {
+        adobe::adam_callback_suite_t retval;
+        retval.add_cell_proc_m = boost::bind(&add_adam_cell, boost::ref(array), _1, _2, _3, _4, _5, _6);
+        retval.add_relation_proc_m = boost::bind(&add_adam_relation, boost::ref(array), _1, _2, _3, _4, _5, _6);
+        retval.add_interface_proc_m =
+            boost::bind(&add_adam_interface, boost::ref(array), _1, _2, _3, _4, _5, _6, _7, _8);
+        return retval;
+    }
+
+    adobe::eve_callback_suite_t eve_callbacks(adobe::array_t& array)
+    {
+        adobe::eve_callback_suite_t retval;
+        retval.add_view_proc_m = boost::bind(&add_eve_view, boost::ref(array), _1, _2, _3, _4, _5, _6);
+        retval.add_cell_proc_m = boost::bind(&add_eve_cell, boost::ref(array), _1, _2, _3, _4, _5, _6);
+        return retval;
+    }
+
+    // These write values in the precompiled format, for building malformed
+    // definitions.
+
+    const std::size_t HEADER_SIZE = 8;
+    const char NUMBER_TAG = 3;
+    const char STRING_TAG = 4;
+    const char ARRAY_TAG = 6;
+
+    void append_uint32(std::string& str, boost::uint32_t n)
+    { str.append(reinterpret_cast<const char*>(&n), sizeof(n)); }
+
+    /** Returns a precompiled definition with the header of \a precompiled
+        and no names, whose only record has \a record_size elements: the
+        record type \a record_type, then empty strings. */
+    std::string malformed_definition(const std::string& precompiled, double record_type, std::size_t record_size)
+    {
+        std::string retval(precompiled, 0, HEADER_SIZE);
+        append_uint32(retval, 0);
+        retval += ARRAY_TAG;
+        append_uint32(retval, 1);
+        retval += ARRAY_TAG;
+        append_uint32(retval, record_size);
+        retval += NUMBER_TAG;
+        retval.append(reinterpret_cast<const char*>(&record_type), sizeof(record_type));
+        for (std::size_t i = 1; i < record_size; ++i) {
+            retval += STRING_TAG;
+            append_uint32(retval, 0);
+        }
+        return retval;
+    }
+
+    bool names_record_0(const std::runtime_error& e)
+    { return std::string(e.what()).find("record 0") != std::string::npos; }
+
+}
+
+BOOST_AUTO_TEST_CASE( precompiled_definition )
+{
+    const std::string file_contents = read_file(g_input_file);
+    const std::size_t length = std::strlen(g_input_file);
+    const bool adam = 4 <= length && !std::strcmp(g_input_file + length - 4, ".adm");
+    const GG::ParsedDefinition::Language language = adam ? GG::ParsedDefinition::ADAM : GG::ParsedDefinition::EVE;
+
+    adobe::array_t direct_parse;
+    const bool direct_parse_succeeded = adam ?
+        GG::Parse(file_contents, g_input_file, adam_callbacks(direct_parse)) :
+        GG::Parse(file_contents, g_input_file, boost::any(), eve_callbacks(direct_parse));
+
+    GG::ParsedDefinition definition;
+    BOOST_CHECK_EQUAL(definition.Parse(language, file_contents, g_input_file), direct_parse_succeeded);
+    if (!direct_parse_succeeded) {
+        BOOST_CHECK(definition.Empty());
+        return;
+    }
+
+    const std::string precompiled_file = std::string(g_input_file) + "c";
+    {
+        std::ofstream ofs(precompiled_file.c_str(), std::ios_base::binary);
+        definition.Write(ofs);
+    }
+    GG::ParsedDefinition loaded = GG::LoadDefinition(precompiled_file, language);
+
+    BOOST_CHECK(loaded.GetLanguage() == language);
+    BOOST_CHECK(loaded.Records() == definition.Records());
+
+    adobe::array_t replay;
+    if (adam)
+        loaded.Replay(adam_callbacks(replay));
+    else
+        loaded.Replay(boost::any(), eve_callbacks(replay));
+
+    const bool pass = replay == direct_parse;
+    std::cout << g_input_file << ": replay of precompiled definition " << (pass ? "PASS" : "FAIL") << "\n";
+    if (!pass) {
+        std::cout << "direct parse (verbose):\n";
+        verbose_dump(direct_parse);
+        std::cout << "replay (verbose):\n";
+        verbose_dump(replay);
+    }
+    BOOST_CHECK(pass);
+
+    std::stringstream truncated;
+    definition.Write(truncated);
+    const std::string bytes = truncated.str();
+    GG::ParsedDefinition corrupt;
+    BOOST_CHECK_THROW(corrupt.Read(bytes.data(), bytes.size() - 1), std::runtime_error);
+
+    // a cell record that is too short, and one of the right length whose
+    // cell type is a string
+    const double cell_record = adam ? 0.0 : 4.0;
+    const std::string short_record = malformed_definition(bytes, cell_record, 2);
+    BOOST_CHECK_EXCEPTION(corrupt.Read(short_record.data(), short_record.size()), std::runtime_error, names_record_0);
+    const std::string mistyped_record = malformed_definition(bytes, cell_record, 7);
+    BOOST_CHECK_EXCEPTION(corrupt.Read(mistyped_record.data(), mistyped_record.size()), std::runtime_error, names_record_0);
+}
+
+// Most of this is boilerplate cut-and-pasted from Boost.Test.  We need to
+// select which test(s) to do, so we can't use it here unmodified.
+
+#ifdef BOOST_TEST_ALTERNATIVE_INIT_API
+bool init_unit_test()                   {
+#else
+::boost::unit_test::test_suite*
+init_unit_test_suite( int, char* [] )   {
+#endif
+
+#ifdef BOOST_TEST_MODULE
+    using namespace ::boost::unit_test;
+    assign_op( framework::master_test_suite().p_name.value, BOOST_TEST_STRINGIZE( BOOST_TEST_MODULE ).trim( "\"" ), 0 );
+    
+#endif
+
+#ifdef BOOST_TEST_ALTERNATIVE_INIT_API
+    return true;
+}
+#else
+    return 0;
+}
+#endif
+
+int BOOST_TEST_CALL_DECL
+main( int argc, char* argv[] )
+{
+    g_input_file = argv[1];
+    return ::boost::unit_test::unit_test_main( &init_unit_test, argc, argv );
+}
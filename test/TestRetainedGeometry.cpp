@@ -0,0 +1,131 @@
+#if USE_SDL_BACKEND
+#include "SDLBackend.h"
+#elif USE_HEADLESS_BACKEND
+#include "HeadlessBackend.h"
+#else
+#include "OgreBackend.h"
+#endif
+
+#include <GG/ClrConstants.h>
+#include <GG/DrawUtil.h>
+#include <GG/GUI.h>
+
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE RetainedGeometry
+
+#include <boost/test/unit_test.hpp>
+
+
+// Checks that primitives added to a GG::RetainedGeometry after it has been
+// rendered are drawn along with the ones added before, by drawing a red
+// left half and then a green right half of the viewport, and reading the
+// pixels back.
+
+namespace {
+
+    std::size_t g_vertices_after_first_render = 0;
+    std::size_t g_vertices_after_second_render = 0;
+    bool g_left_red_after_first_render = false;
+    bool g_right_clear_after_first_render = false;
+    bool g_left_red_after_second_render = false;
+    bool g_right_green_after_second_render = false;
+
+    /** Adds an axis-aligned rectangle of \a color, in normalized device
+        coordinates, to \a geometry. */
+    void AddRectangle(GG::RetainedGeometry& geometry, GLfloat x1, GLfloat x2, GG::Clr color)
+    {
+        std::vector<GLfloat> vertices;
+        vertices.push_back(x1); vertices.push_back(-1.0f);
+        vertices.push_back(x2); vertices.push_back(-1.0f);
+        vertices.push_back(x2); vertices.push_back(1.0f);
+        vertices.push_back(x1); vertices.push_back(1.0f);
+        geometry.Add(GL_QUADS, vertices, std::vector<GG::Clr>(4, color));
+    }
+
+    GG::Clr ReadPixel(int x, int y)
+    {
+        GLubyte pixel[4] = { 0, 0, 0, 0 };
+        glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+        return GG::Clr(pixel[0], pixel[1], pixel[2], pixel[3]);
+    }
+
+    bool SameRGB(GG::Clr lhs, GG::Clr rhs)
+    { return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b; }
+
+    void Draw(GG::RetainedGeometry& geometry)
+    {
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        geometry.Render();
+        glFinish();
+    }
+
+    void CustomInit()
+    {
+        const int WIDTH = Value(GG::GUI::GetGUI()->AppWidth());
+        const int HEIGHT = Value(GG::GUI::GetGUI()->AppHeight());
+
+        glPushAttrib(GL_ALL_ATTRIB_BITS);
+        glDisable(GL_TEXTURE_2D);
+        glDisable(GL_BLEND);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_SCISSOR_TEST);
+        glDisable(GL_STENCIL_TEST);
+        glViewport(0, 0, WIDTH, HEIGHT);
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
+
+        {
+            GG::RetainedGeometry geometry;
+            AddRectangle(geometry, -1.0f, 0.0f, GG::CLR_RED);
+            Draw(geometry);
+            g_vertices_after_first_render = geometry.Vertices();
+            g_left_red_after_first_render = SameRGB(ReadPixel(WIDTH / 4, HEIGHT / 2), GG::CLR_RED);
+            g_right_clear_after_first_render = SameRGB(ReadPixel(3 * WIDTH / 4, HEIGHT / 2), GG::CLR_BLACK);
+
+            AddRectangle(geometry, 0.0f, 1.0f, GG::CLR_GREEN);
+            Draw(geometry);
+            g_vertices_after_second_render = geometry.Vertices();
+            g_left_red_after_second_render = SameRGB(ReadPixel(WIDTH / 4, HEIGHT / 2), GG::CLR_RED);
+            g_right_green_after_second_render = SameRGB(ReadPixel(3 * WIDTH / 4, HEIGHT / 2), GG::CLR_GREEN);
+        }
+
+        glMatrixMode(GL_MODELVIEW);
+        glPopMatrix();
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+        glPopAttrib();
+
+        GG::GUI::GetGUI()->Exit(0);
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE( add_after_render )
+{
+#if USE_SDL_BACKEND
+    MinimalSDLGUI::CustomInit = &CustomInit;
+    MinimalSDLMain();
+#elif USE_HEADLESS_BACKEND
+    MinimalHeadlessGUI::CustomInit = &CustomInit;
+    MinimalHeadlessMain();
+#else
+    MinimalOgreGUI::CustomInit = &CustomInit;
+    MinimalOgreMain();
+#endif
+
+    BOOST_CHECK_EQUAL(g_vertices_after_first_render, 4u);
+    BOOST_CHECK(g_left_red_after_first_render);
+    BOOST_CHECK(g_right_clear_after_first_render);
+
+    BOOST_CHECK_EQUAL(g_vertices_after_second_render, 8u);
+    BOOST_CHECK(g_left_red_after_second_render);
+    BOOST_CHECK(g_right_green_after_second_render);
+}
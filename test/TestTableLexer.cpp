@@ -0,0 +1,278 @@
+#include <GG/Lexer.h>
+
+#include <boost/spirit/include/lex_lexertl.hpp>
+#include <boost/spirit/include/qi.hpp>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TableLexer
+
+#include <boost/test/unit_test.hpp>
+
+
+// Checks that GG::lexer, on detail::table_lexer, splits random inputs into
+// the same tokens as the same token definitions compiled by lexertl, which
+// GG::lexer used before, including where lexing stops on input neither can
+// match.
+
+adobe::aggregate_name_t input_k      = { "input" };
+adobe::aggregate_name_t output_k     = { "output" };
+adobe::aggregate_name_t interface_k  = { "interface" };
+adobe::aggregate_name_t logic_k      = { "logic" };
+adobe::aggregate_name_t constant_k   = { "constant" };
+adobe::aggregate_name_t invariant_k  = { "invariant" };
+adobe::aggregate_name_t sheet_k      = { "sheet" };
+adobe::aggregate_name_t unlink_k     = { "unlink" };
+adobe::aggregate_name_t when_k       = { "when" };
+adobe::aggregate_name_t relate_k     = { "relate" };
+adobe::aggregate_name_t layout_k     = { "layout" };
+adobe::aggregate_name_t view_k       = { "view" };
+
+namespace {
+
+    const std::size_t NUM_INPUTS = 400;
+    const std::size_t MAX_FRAGMENTS = 60;
+
+    /** The token definitions of GG::lexer, with the same ids, compiled into a
+        DFA by lexertl. */
+    struct lexertl_lexer :
+        boost::spirit::lex::lexer<boost::spirit::lex::lexertl::actor_lexer<GG::token_type> >
+    {
+        lexertl_lexer(const adobe::name_t* first_keyword,
+                      const adobe::name_t* last_keyword) :
+            keyword_true_false("true|false"),
+            keyword_empty("empty"),
+            identifier("[a-zA-Z]\\w*", GG::detail::LexerTokenID(GG::detail::LEXER_WORD)),
+            lead_comment("\\/\\*[^*]*\\*+([^/*][^*]*\\*+)*\\/", GG::detail::LexerTokenID(GG::detail::LEXER_LEAD_COMMENT)),
+            trail_comment("\\/\\/.*$", GG::detail::LexerTokenID(GG::detail::LEXER_TRAIL_COMMENT)),
+            quoted_string("\\\"[^\\\"]*\\\"|'[^']*'", GG::detail::LexerTokenID(GG::detail::LEXER_QUOTED_STRING)),
+            number("\\d+(\\.\\d*)?", GG::detail::LexerTokenID(GG::detail::LEXER_NUMBER)),
+            eq_op("==|!=", GG::detail::LexerTokenID(GG::detail::LEXER_EQ_OP)),
+            rel_op("<|>|<=|>=", GG::detail::LexerTokenID(GG::detail::LEXER_REL_OP)),
+            mul_op("\\*|\\/|%", GG::detail::LexerTokenID(GG::detail::LEXER_MUL_OP)),
+            define("<==", GG::detail::LexerTokenID(GG::detail::LEXER_DEFINE)),
+            or_("\"||\"", GG::detail::LexerTokenID(GG::detail::LEXER_OR)),
+            and_("&&", GG::detail::LexerTokenID(GG::detail::LEXER_AND))
+            {
+                namespace lex = boost::spirit::lex;
+
+                self
+                    =     keyword_true_false
+                    |     keyword_empty;
+
+                while (first_keyword != last_keyword) {
+                    self.add(keywords[*first_keyword] = lex::token_def<>(first_keyword->c_str()));
+                    ++first_keyword;
+                }
+
+                self
+                    +=    identifier
+                    |     lead_comment
+                    |     trail_comment
+                    |     quoted_string
+                    |     number
+                    |     eq_op
+                    |     rel_op
+                    |     mul_op
+                    |     define
+                    |     or_
+                    |     and_
+                    |     '='
+                    |     '+'
+                    |     '-'
+                    |     '!'
+                    |     '?'
+                    |     ':'
+                    |     '.'
+                    |     ','
+                    |     '('
+                    |     ')'
+                    |     '['
+                    |     ']'
+                    |     '{'
+                    |     '}'
+                    |     '@'
+                    |     ';'
+                    ;
+
+                self("WS") = lex::token_def<>("\\s+", GG::detail::LexerTokenID(GG::detail::LEXER_WHITESPACE));
+            }
+
+        boost::spirit::lex::token_def<> keyword_true_false;
+        boost::spirit::lex::token_def<> keyword_empty;
+        boost::spirit::lex::token_def<> identifier;
+        boost::spirit::lex::token_def<> lead_comment;
+        boost::spirit::lex::token_def<> trail_comment;
+        boost::spirit::lex::token_def<> quoted_string;
+        boost::spirit::lex::token_def<> number;
+        boost::spirit::lex::token_def<> eq_op;
+        boost::spirit::lex::token_def<> rel_op;
+        boost::spirit::lex::token_def<> mul_op;
+        boost::spirit::lex::token_def<> define;
+        boost::spirit::lex::token_def<> or_;
+        boost::spirit::lex::token_def<> and_;
+        std::map<adobe::name_t, boost::spirit::lex::token_def<> > keywords;
+    };
+
+    struct Token
+    {
+        Token(std::size_t id_, std::size_t state_, const std::string& text_, std::size_t line_) :
+            id(id_),
+            state(state_),
+            text(text_),
+            line(line_)
+            {}
+
+        bool operator==(const Token& rhs) const
+            { return id == rhs.id && state == rhs.state && text == rhs.text && line == rhs.line; }
+
+        bool operator!=(const Token& rhs) const
+            { return !(*this == rhs); }
+
+        std::size_t id;
+        std::size_t state;
+        std::string text;
+        std::size_t line;
+    };
+
+    std::ostream& operator<<(std::ostream& os, const Token& token)
+    { return os << token.id << '@' << token.state << ':' << token.line << " \"" << token.text << '"'; }
+
+    std::vector<Token>* g_tokens = 0;
+
+}
+
+
+// A Spirit.Qi parser that matches any valid token, and appends it to
+// *g_tokens.
+
+namespace table_lexer_test {
+    BOOST_SPIRIT_TERMINAL(record_token);
+}
+
+namespace boost { namespace spirit {
+    template <>
+    struct use_terminal<qi::domain, table_lexer_test::tag::record_token> :
+        mpl::true_
+    {};
+} }
+
+namespace table_lexer_test {
+    struct record_token_parser :
+        boost::spirit::qi::primitive_parser<record_token_parser>
+    {
+        template <typename Context, typename Iter>
+        struct attribute
+        { typedef boost::spirit::unused_type type; };
+
+        template <typename Iter, typename Context, typename Skipper, typename Attribute>
+        bool parse(Iter& first, Iter const& last, Context&, Skipper const& skipper, Attribute&) const
+        {
+            boost::spirit::qi::skip_over(first, last, skipper);
+            if (first == last || !boost::spirit::lex::lexertl::token_is_valid(*first))
+                return false;
+            g_tokens->push_back(Token(first->id(),
+                                      first->state(),
+                                      std::string(first->matched().begin(), first->matched().end()),
+                                      boost::spirit::get_line(first->matched().begin())));
+            ++first;
+            return true;
+        }
+
+        template <typename Context>
+        boost::spirit::info what(Context&) const
+        { return boost::spirit::info("record_token"); }
+    };
+}
+
+namespace boost { namespace spirit { namespace qi {
+    template <typename Modifiers>
+    struct make_primitive<table_lexer_test::tag::record_token, Modifiers>
+    {
+        typedef table_lexer_test::record_token_parser result_type;
+        result_type operator()(unused_type, unused_type) const
+        { return result_type(); }
+    };
+} } }
+
+namespace {
+
+    /** Returns \a str cut into tokens by \a lexer, skipping whitespace as
+        the GG parsers do; the last token is "<<FULL>>" if all of \a str was
+        lexed, and "<<PARTIAL>>" otherwise. */
+    template <typename Lexer>
+    std::vector<Token> Lex(Lexer& lexer, const std::string& str)
+    {
+        std::vector<Token> retval;
+        g_tokens = &retval;
+        GG::text_iterator it(str.begin());
+        typename Lexer::iterator_type iter = lexer.begin(it, GG::text_iterator(str.end()));
+        typename Lexer::iterator_type end = lexer.end();
+        boost::spirit::qi::phrase_parse(iter, end, *table_lexer_test::record_token,
+                                        boost::spirit::qi::in_state("WS")[lexer.self]);
+        retval.push_back(Token(0, 0, iter == end ? "<<FULL>>" : "<<PARTIAL>>", 0));
+        g_tokens = 0;
+        return retval;
+    }
+
+    /** Returns a random input, made of pieces of Adam and Eve source and
+        characters neither lexer matches. */
+    std::string RandomInput(unsigned int seed)
+    {
+        static const char* const FRAGMENTS[] = {
+            "input", "inputs", "output", "interface", "logic", "constant", "invariant", "sheet",
+            "unlink", "when", "relate", "layout", "view", "true", "false", "empty", "truex",
+            "x1", "a", "_", "3", "3.", "4.25", ".5", "0",
+            "==", "!=", "<", ">", "<=", ">=", "<==", "=", "*", "/", "%", "+", "-", "!", "?", ":",
+            ".", ",", "(", ")", "[", "]", "{", "}", "@", ";", "||", "&&", "|", "&",
+            "\"", "'", "\"b\"", "'c d'", "/*", "*/", "/* e */", "//", "// f\n",
+            " ", "\t", "\n", "\r\n", "$", "#", "\\", "\xc3\xa9"
+        };
+        const std::size_t NUM_FRAGMENTS = sizeof(FRAGMENTS) / sizeof(FRAGMENTS[0]);
+
+        boost::uint32_t state = seed * 2654435761u + 1;
+        state = state * 1664525u + 1013904223u;
+        std::size_t fragments = 1 + (state >> 16) % MAX_FRAGMENTS;
+        std::string retval;
+        for (std::size_t i = 0; i < fragments; ++i) {
+            state = state * 1664525u + 1013904223u;
+            retval += FRAGMENTS[(state >> 16) % NUM_FRAGMENTS];
+        }
+        return retval;
+    }
+
+    void CheckRandomInputs(const adobe::name_t* first_keyword, const adobe::name_t* last_keyword)
+    {
+        GG::lexer table(first_keyword, last_keyword);
+        lexertl_lexer dfa(first_keyword, last_keyword);
+        for (std::size_t i = 0; i < NUM_INPUTS; ++i) {
+            std::string input = RandomInput(i);
+            std::vector<Token> table_tokens = Lex(table, input);
+            std::vector<Token> dfa_tokens = Lex(dfa, input);
+            BOOST_CHECK_MESSAGE(table_tokens == dfa_tokens, "input " << i << ": \"" << input << '"');
+            if (table_tokens != dfa_tokens) {
+                BOOST_CHECK_EQUAL_COLLECTIONS(table_tokens.begin(), table_tokens.end(),
+                                              dfa_tokens.begin(), dfa_tokens.end());
+            }
+        }
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE( adam_keywords )
+{
+    const adobe::name_t keywords[] = {
+        input_k, output_k, interface_k, logic_k, constant_k, invariant_k, sheet_k, unlink_k, when_k, relate_k
+    };
+    CheckRandomInputs(keywords, keywords + sizeof(keywords) / sizeof(keywords[0]));
+}
+
+BOOST_AUTO_TEST_CASE( eve_keywords )
+{
+    const adobe::name_t keywords[] = { interface_k, constant_k, layout_k, view_k };
+    CheckRandomInputs(keywords, keywords + sizeof(keywords) / sizeof(keywords[0]));
+}
@@ -0,0 +1,67 @@
+#include <GG/Filesystem.h>
+#include <GG/ParsedDefinition.h>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <iostream>
+#include <string>
+
+// Adam and Eve definition precompiler
+//
+// Each file named on the command line is parsed, and its precompiled binary
+// form is written next to it, with a "c" appended to the extension, so that
+// dialog.adm becomes dialog.admc and dialog.eve becomes dialog.evec.  The
+// language of each file is taken from its extension.  GG::LoadDefinition(),
+// and so GG::ExecuteModalDialog() and GG::MakeEveDialog(), accept the
+// precompiled files wherever they accept source files.
+//
+// Usage: gg-precompile file.adm|file.eve ...
+
+
+namespace {
+    bool Precompile(const boost::filesystem::path& path)
+    {
+        const std::string extension = GG::PathToUTF8(path.extension());
+        GG::ParsedDefinition::Language language;
+        if (extension == ".adm") {
+            language = GG::ParsedDefinition::ADAM;
+        } else if (extension == ".eve") {
+            language = GG::ParsedDefinition::EVE;
+        } else {
+            std::cerr << GG::PathToUTF8(path) << ": unknown extension; expected .adm or .eve\n";
+            return false;
+        }
+
+        try {
+            GG::ParsedDefinition definition = GG::LoadDefinition(path, language);
+            boost::filesystem::path output = path;
+            output.replace_extension(extension + "c");
+            boost::filesystem::ofstream ofs(output, std::ios_base::binary);
+            definition.Write(ofs);
+            if (!ofs) {
+                std::cerr << GG::PathToUTF8(output) << ": write failed\n";
+                return false;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << GG::PathToUTF8(path) << ": " << e.what() << "\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " file.adm|file.eve ...\n";
+        return 1;
+    }
+
+    bool success = true;
+    for (int i = 1; i < argc; ++i) {
+        if (!Precompile(boost::filesystem::path(argv[i])))
+            success = false;
+    }
+    return success ? 0 : 1;
+}